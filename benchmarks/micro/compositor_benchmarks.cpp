@@ -0,0 +1,57 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/compositor/multi_monitor_arbiter.h"
+#include "src/server/compositor/queueing_schedule.h"
+
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+// Each iteration a client submits a buffer and every monitor acquires it
+void multi_monitor_arbiter_compositor_acquire(benchmark::State& state)
+{
+    auto const monitors = state.range(0);
+    auto const schedule = std::make_shared<mc::QueueingSchedule>();
+    mc::MultiMonitorArbiter arbiter{schedule};
+
+    std::vector<std::shared_ptr<mg::Buffer>> const buffers{
+        std::make_shared<mtd::StubBuffer>(),
+        std::make_shared<mtd::StubBuffer>(),
+        std::make_shared<mtd::StubBuffer>()};
+    std::vector<int> compositors(monitors);
+
+    size_t next = 0;
+    for (auto _ : state)
+    {
+        schedule->schedule(buffers[next++ % buffers.size()]);
+        for (auto& compositor : compositors)
+            benchmark::DoNotOptimize(arbiter.compositor_acquire(&compositor));
+    }
+
+    state.SetItemsProcessed(state.iterations() * monitors);
+}
+}
+
+BENCHMARK(multi_monitor_arbiter_compositor_acquire)->Arg(1)->Arg(2)->Arg(4);
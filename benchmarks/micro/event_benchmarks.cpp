@@ -0,0 +1,85 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/events/event_builders.h"
+#include "mir/events/event.h"
+
+#include <benchmark/benchmark.h>
+
+#include <xkbcommon/xkbcommon-keysyms.h>
+
+namespace mev = mir::events;
+
+namespace
+{
+MirInputDeviceId const device_id{7};
+std::chrono::nanoseconds const timestamp{123456789};
+std::vector<uint8_t> const cookie(32, 0xaa);
+
+auto key_event() -> mir::EventUPtr
+{
+    return mev::make_event(
+        device_id, timestamp, cookie, mir_keyboard_action_down, XKB_KEY_a, 30, mir_input_event_modifier_none);
+}
+
+auto pointer_event() -> mir::EventUPtr
+{
+    return mev::make_event(
+        device_id, timestamp, cookie, mir_input_event_modifier_none, mir_pointer_action_motion, 0,
+        100.0f, 200.0f, 0.0f, 0.0f, 1.0f, 2.0f);
+}
+
+void create_key_event(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(key_event());
+}
+
+void create_pointer_event(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(pointer_event());
+}
+
+void clone_pointer_event(benchmark::State& state)
+{
+    auto const event = pointer_event();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(mev::clone_event(*event));
+}
+
+void serialize_pointer_event(benchmark::State& state)
+{
+    auto const event = pointer_event();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(MirEvent::serialize(event.get()));
+}
+
+void deserialize_pointer_event(benchmark::State& state)
+{
+    auto const bytes = MirEvent::serialize(pointer_event().get());
+    for (auto _ : state)
+        benchmark::DoNotOptimize(MirEvent::deserialize(bytes));
+
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+}
+
+BENCHMARK(create_key_event);
+BENCHMARK(create_pointer_event);
+BENCHMARK(clone_pointer_event);
+BENCHMARK(serialize_pointer_event);
+BENCHMARK(deserialize_pointer_event);
@@ -0,0 +1,144 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/wayland_executor.h"
+#include "src/server/frontend/protobuf_message_processor.h"
+#include "src/server/report/null_report_factory.h"
+
+#include "mir/frontend/protobuf_message_sender.h"
+#include "mir_protobuf_wire.pb.h"
+
+#include "mir/test/doubles/stub_display_server.h"
+
+#include <benchmark/benchmark.h>
+
+#include <wayland-server-core.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace mf = mir::frontend;
+namespace mfd = mir::frontend::detail;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+// Work spawned from the dispatching thread runs inline, so the loop gets its own thread
+class DispatchingLoop
+{
+public:
+    DispatchingLoop() :
+        loop{wl_event_loop_create()},
+        executor{std::make_unique<mf::WaylandExecutor>(loop)},
+        dispatcher{[this] { while (!stopped) wl_event_loop_dispatch(loop, -1); }}
+    {
+    }
+
+    ~DispatchingLoop()
+    {
+        executor->spawn([this] { stopped = true; });
+        dispatcher.join();
+        executor.reset();
+        wl_event_loop_destroy(loop);
+    }
+
+    wl_event_loop* const loop;
+    std::unique_ptr<mf::WaylandExecutor> executor;
+
+private:
+    bool stopped{false};
+    std::thread dispatcher;
+};
+
+void wayland_executor_spawn(benchmark::State& state)
+{
+    auto const batch = state.range(0);
+    DispatchingLoop loop;
+
+    std::mutex mutex;
+    std::condition_variable done;
+    int64_t completed = 0;
+
+    for (auto _ : state)
+    {
+        for (int64_t i = 0; i != batch; ++i)
+        {
+            loop.executor->spawn([&]
+                {
+                    std::lock_guard<std::mutex> lock{mutex};
+                    if (++completed == batch)
+                        done.notify_one();
+                });
+        }
+
+        std::unique_lock<std::mutex> lock{mutex};
+        done.wait(lock, [&] { return completed == batch; });
+        completed = 0;
+    }
+
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+
+struct NullMessageSender : mfd::ProtobufMessageSender
+{
+    void send_response(
+        google::protobuf::uint32,
+        google::protobuf::MessageLite*,
+        mf::FdSets const&) override
+    {
+    }
+};
+
+struct RespondingDisplayServer : mtd::StubDisplayServer
+{
+    void connect(
+        mir::protobuf::ConnectParameters const*,
+        mir::protobuf::Connection*,
+        google::protobuf::Closure* done) override
+    {
+        done->Run();
+    }
+};
+
+// Parse, dispatch and respond to a "connect" call, less the socket I/O
+void protobuf_message_processor_dispatch(benchmark::State& state)
+{
+    auto const processor = std::make_shared<mfd::ProtobufMessageProcessor>(
+        std::make_shared<NullMessageSender>(),
+        std::make_shared<RespondingDisplayServer>(),
+        mir::report::null_message_processor_report());
+    mfd::MessageProcessor& message_processor = *processor;
+
+    mir::protobuf::ConnectParameters parameters;
+    parameters.set_application_name("benchmark");
+
+    mir::protobuf::wire::Invocation invocation;
+    invocation.set_id(1);
+    invocation.set_method_name("connect");
+    invocation.set_parameters(parameters.SerializeAsString());
+    invocation.set_protocol_version(1);
+
+    std::vector<mir::Fd> const no_fds;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(message_processor.dispatch(mfd::Invocation{invocation}, no_fds));
+
+    state.SetItemsProcessed(state.iterations());
+}
+}
+
+BENCHMARK(wayland_executor_spawn)->Arg(1)->Arg(16)->Arg(256)->UseRealTime();
+BENCHMARK(protobuf_message_processor_dispatch);
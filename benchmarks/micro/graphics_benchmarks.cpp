@@ -0,0 +1,77 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/common/server/shm_buffer.h"
+#include "src/platforms/common/server/egl_context_executor.h"
+#include "mir/renderer/gl/context.h"
+
+#include "mir/test/doubles/mock_gl.h"
+#include "mir/test/doubles/mock_egl.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace mg = mir::graphics;
+namespace mgc = mir::graphics::common;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+namespace
+{
+class StubGLContext : public mir::renderer::gl::Context
+{
+public:
+    void make_current() const override {}
+    void release_current() const override {}
+};
+
+struct PlatformlessShmBuffer : mgc::MemoryBackedShmBuffer
+{
+    using MemoryBackedShmBuffer::MemoryBackedShmBuffer;
+
+    std::shared_ptr<mg::NativeBuffer> native_buffer_handle() const override
+    {
+        return nullptr;
+    }
+};
+
+// The CPU side of a software client's upload: copying its pixels into the buffer.
+// GL is mocked, so the texture upload itself is not measured here.
+void shm_buffer_write(benchmark::State& state)
+{
+    testing::NiceMock<mtd::MockEGL> mock_egl;
+    testing::NiceMock<mtd::MockGL> mock_gl;
+
+    geom::Size const size{state.range(0), state.range(1)};
+    PlatformlessShmBuffer buffer{
+        size,
+        mir_pixel_format_argb_8888,
+        std::make_shared<mgc::EGLContextExecutor>(std::make_unique<StubGLContext>())};
+
+    std::vector<unsigned char> const pixels(buffer.stride().as_uint32_t() * size.height.as_uint32_t(), 0x7f);
+
+    for (auto _ : state)
+    {
+        buffer.write(pixels.data(), pixels.size());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * pixels.size());
+}
+}
+
+BENCHMARK(shm_buffer_write)->Args({256, 256})->Args({1024, 1024})->Args({1920, 1080});
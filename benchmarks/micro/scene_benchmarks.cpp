@@ -0,0 +1,97 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/scene/surface_stack.h"
+#include "src/server/scene/basic_surface.h"
+#include "src/server/compositor/occlusion.h"
+#include "src/server/report/null_report_factory.h"
+#include "mir/compositor/scene_element.h"
+#include "mir/geometry/rectangle.h"
+#include "mir/input/input_reception_mode.h"
+
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/stub_buffer_stream.h"
+#include "mir/test/doubles/stub_scene_element.h"
+
+#include <benchmark/benchmark.h>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace ms = mir::scene;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+namespace
+{
+geom::Rectangle const output{{0, 0}, {1920, 1080}};
+
+// Windows cascading across the output, so later windows partly cover earlier ones
+auto window_area(int i) -> geom::Rectangle
+{
+    return {{(i * 37) % 1600, (i * 23) % 800}, {320, 240}};
+}
+
+void surface_stack_scene_elements_for(benchmark::State& state)
+{
+    ms::SurfaceStack stack{mir::report::null_scene_report()};
+    auto const compositor_id = &stack;
+    stack.register_compositor(compositor_id);
+
+    for (int i = 0; i != state.range(0); ++i)
+    {
+        auto const stream = std::make_shared<mtd::StubBufferStream>();
+        stack.add_surface(
+            std::make_shared<ms::BasicSurface>(
+                nullptr /* session */,
+                "benchmark",
+                window_area(i),
+                mir_pointer_unconfined,
+                std::list<ms::StreamInfo>{{stream, {}, {}}},
+                std::shared_ptr<mg::CursorImage>(),
+                mir::report::null_scene_report()),
+            mir::input::InputReceptionMode::normal);
+    }
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(stack.scene_elements_for(compositor_id));
+
+    state.SetComplexityN(state.range(0));
+    stack.unregister_compositor(compositor_id);
+}
+
+// Filtering mutates the sequence, so each iteration also copies it
+void filter_occlusions_from(benchmark::State& state)
+{
+    mc::SceneElementSequence elements;
+    for (int i = 0; i != state.range(0); ++i)
+    {
+        auto const area = window_area(i);
+        elements.push_back(std::make_shared<mtd::StubSceneElement>(
+            std::make_shared<mtd::FakeRenderable>(area)));
+    }
+
+    for (auto _ : state)
+    {
+        auto list = elements;
+        benchmark::DoNotOptimize(mc::filter_occlusions_from(list, output));
+    }
+
+    state.SetComplexityN(state.range(0));
+}
+}
+
+BENCHMARK(surface_stack_scene_elements_for)->RangeMultiplier(10)->Range(10, 1000)->Complexity();
+BENCHMARK(filter_occlusions_from)->RangeMultiplier(10)->Range(10, 1000)->Complexity();
@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/recursive_read_write_mutex.h"
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+mir::RecursiveReadWriteMutex mutex;
+
+void recursive_read_write_mutex_read(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        mutex.read_lock();
+        mutex.read_unlock();
+    }
+}
+
+// One writer among the threads, as when the shell changes the scene while compositors read it
+void recursive_read_write_mutex_read_with_writer(benchmark::State& state)
+{
+    auto const writer = state.thread_index() == 0;
+    for (auto _ : state)
+    {
+        if (writer)
+        {
+            mutex.write_lock();
+            mutex.write_unlock();
+        }
+        else
+        {
+            mutex.read_lock();
+            mutex.read_unlock();
+        }
+    }
+}
+
+void recursive_read_write_mutex_nested_read(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        mutex.read_lock();
+        mutex.read_lock();
+        mutex.read_unlock();
+        mutex.read_unlock();
+    }
+}
+}
+
+BENCHMARK(recursive_read_write_mutex_read)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(recursive_read_write_mutex_read_with_writer)->ThreadRange(2, 8)->UseRealTime();
+BENCHMARK(recursive_read_write_mutex_nested_read)->ThreadRange(1, 8)->UseRealTime();
@@ -53,6 +53,13 @@ void fatal_error_except(char const* reason, ...);
  */
 void fatal_error_abort(char const* reason, ...);
 
+/**
+ * If set, called by fatal_error_abort() before it aborts (e.g. to write out
+ * queued log messages). It should neither block indefinitely nor throw.
+ * \remark As with fatal_error, this should be set before spinning up the Mir server.
+ */
+extern void (*fatal_error_flush)();
+
 // Utility class to override & restore existing error handler
 class FatalErrorStrategy
 {
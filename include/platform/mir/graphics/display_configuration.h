@@ -91,6 +91,31 @@ struct DisplayConfigurationMode
     double vrefresh_hz;
 };
 
+/**
+ * Static HDR metadata (as in CTA-861-G) describing the content sent to a display.
+ */
+struct HdrOutputMetadata
+{
+    enum class Eotf
+    {
+        traditional_sdr = 0,
+        traditional_hdr = 1,
+        smpte_st2084 = 2,   ///< "PQ"
+        hlg = 3
+    };
+
+    Eotf eotf{Eotf::traditional_sdr};
+    /** CIE 1931 xy chromaticities of the mastering display's red, green and blue primaries */
+    glm::vec2 primaries[3]{};
+    glm::vec2 white_point{};
+    /** Mastering display luminance range, in cd/m² */
+    float max_mastering_luminance{0};
+    float min_mastering_luminance{0};
+    /** Content light levels (MaxCLL and MaxFALL), in cd/m²; zero if unknown */
+    unsigned max_content_light_level{0};
+    unsigned max_frame_average_light_level{0};
+};
+
 /**
  * Configuration information for a display output.
  */
@@ -143,6 +168,16 @@ struct DisplayConfigurationOutput
 
     mir::optional_value<geometry::Size> custom_logical_size;
 
+    /** Whether the display can vary its refresh rate to follow the content (Adaptive-Sync/FreeSync) */
+    bool vrr_capable{false};
+
+    /** Colour transformation matrix applied before gamma (e.g. for a night light), in linear light where
+        the display hardware supports it. Like gamma, changing it does not require recreating the outputs. */
+    glm::mat3 colour_transform{1};
+
+    /** Static HDR metadata to send to the display, if any */
+    mir::optional_value<HdrOutputMetadata> hdr_metadata;
+
     /** The logical rectangle occupied by the output, based on its position,
         current mode and orientation (rotation) */
     geometry::Rectangle extents() const;
@@ -187,6 +222,9 @@ struct UserDisplayConfigurationOutput
     MirOutputGammaSupported const& gamma_supported;
     std::vector<uint8_t const> const& edid;
     mir::optional_value<geometry::Size>& custom_logical_size;
+    bool const& vrr_capable;
+    glm::mat3& colour_transform;
+    mir::optional_value<HdrOutputMetadata>& hdr_metadata;
 
     UserDisplayConfigurationOutput(DisplayConfigurationOutput& master);
     geometry::Rectangle extents() const;
@@ -43,6 +43,8 @@ public:
     virtual void report_drm_master_failure(int error) = 0;
     virtual void report_vt_switch_away_failure() = 0;
     virtual void report_vt_switch_back_failure() = 0;
+    /// A frame on output_id is composited rather than scanned out directly from a client buffer
+    virtual void report_bypass_failure(unsigned int output_id, char const* reason) = 0;
 
 protected:
     DisplayReport() = default;
@@ -20,6 +20,7 @@
 #define MIR_GRAPHICS_GRAPHIC_BUFFER_ALLOCATOR_H_
 
 #include "mir/graphics/buffer.h"
+#include "mir/fd.h"
 
 #include <vector>
 #include <memory>
@@ -90,6 +91,23 @@ public:
         std::shared_ptr<mir::Executor> wayland_executor,
         std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer> = 0;
 
+    /**
+     * Fences that must signal before the client's rendering into a buffer is complete
+     *
+     * Each fence is a file descriptor that becomes readable once it has signalled (for
+     * example, the implicit fence of a dma-buf). The frontend holds a commit until the
+     * fences of its buffer have signalled, so the compositor neither samples an incomplete
+     * buffer nor stalls waiting for it.
+     *
+     * \param buffer [in]   A wl_buffer that is not a wl_shm buffer
+     * \return              The fences to wait on, or an empty vector if the buffer is
+     *                      ready or its readiness can't be determined
+     */
+    virtual auto fences_for_resource(wl_resource* /*buffer*/) -> std::vector<Fd>
+    {
+        return {};
+    }
+
 protected:
     GraphicBufferAllocator() = default;
     GraphicBufferAllocator(const GraphicBufferAllocator&) = delete;
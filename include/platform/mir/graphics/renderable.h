@@ -52,6 +52,12 @@ public:
     virtual geometry::Rectangle screen_position() const = 0;
     virtual std::experimental::optional<geometry::Rectangle> clip_area() const = 0;
 
+    /**
+     * The region of buffer() (in buffer pixels) that is scaled to fill
+     * screen_position(). If unset the whole buffer is used.
+     */
+    virtual std::experimental::optional<geometry::Rectangle> src_bounds() const = 0;
+
     // These are from the old CompositingCriteria. There is a little bit
     // of function overlap with the above functions still.
     virtual float alpha() const = 0;
@@ -73,6 +79,13 @@ public:
     virtual bool shaped() const = 0;  // meaning the pixel format has alpha
 
     virtual unsigned int swap_interval() const = 0;
+
+    /**
+     * Whether the client would rather its buffer were shown as soon as
+     * possible, even if that tears, than wait for vsync (e.g. as hinted
+     * with wp_tearing_control_v1).
+     */
+    virtual bool tearing_allowed() const = 0;
 protected:
     Renderable() = default;
     Renderable(Renderable const&) = delete;
@@ -48,12 +48,17 @@ extern char const* const cursor_opt;
 extern char const* const fatal_except_opt;
 extern char const* const debug_opt;
 extern char const* const composite_delay_opt;
+extern char const* const idle_timeout_opt;
+extern char const* const renderer_opt;
 extern char const* const enable_key_repeat_opt;
 extern char const* const x11_display_opt;
 extern char const* const wayland_extensions_opt;
 extern char const* const add_wayland_extensions_opt;
 extern char const* const drop_wayland_extensions_opt;
 extern char const* const enable_mirclient_opt;
+extern char const* const metrics_socket_opt;
+extern char const* const client_buffer_quota_opt;
+extern char const* const texture_cache_budget_opt;
 
 extern char const* const offscreen_opt;
 
@@ -62,6 +67,7 @@ extern char const* const enable_key_repeat_opt;
 extern char const* const off_opt_value;
 extern char const* const log_opt_value;
 extern char const* const lttng_opt_value;
+extern char const* const metrics_opt_value;
 
 extern char const* const platform_graphics_lib;
 extern char const* const platform_input_lib;
@@ -22,7 +22,9 @@
 #include "mir/geometry/rectangle.h"
 #include "mir/graphics/renderable.h"
 #include "mir_toolkit/common.h"
+#include "mir/optional_value.h"
 #include <glm/glm.hpp>
+#include <chrono>
 
 namespace mir
 {
@@ -39,6 +41,18 @@ public:
     virtual void render(graphics::RenderableList const&) const = 0;
     virtual void suspend() = 0; // called when render() is skipped
 
+    /// How long the stages of the most recent render() took
+    struct FrameTiming
+    {
+        std::chrono::nanoseconds texture_upload{0};
+        std::chrono::nanoseconds draw{0};
+        std::chrono::nanoseconds swap{0};
+        /// GPU execution time, if the renderer can measure it. As this is
+        /// collected without stalling the pipeline it may be from an earlier frame.
+        optional_value<std::chrono::nanoseconds> gpu;
+    };
+    virtual auto last_frame_timing() const -> FrameTiming { return {}; }
+
 protected:
     Renderer() = default;
     Renderer(const Renderer&) = delete;
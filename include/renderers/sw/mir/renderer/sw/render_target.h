@@ -0,0 +1,62 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SW_RENDER_TARGET_H_
+#define MIR_RENDERER_SW_RENDER_TARGET_H_
+
+#include "mir/renderer/sw/pixel_source.h"
+
+#include <memory>
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+
+/**
+ * A DisplayBuffer's native_display_buffer() implements this if it can be
+ * rendered to with the CPU (e.g. it is backed by dumb or shm buffers).
+ */
+class RenderTarget
+{
+public:
+    virtual ~RenderTarget() = default;
+
+    /**
+     * Map the buffer that will be shown by the next present_back_buffer().
+     *
+     * The whole mapping is written by the renderer, so its previous content
+     * does not need to be preserved. The mapping must be released before
+     * present_back_buffer() is called.
+     */
+    virtual auto map_back_buffer() -> std::unique_ptr<Mapping<unsigned char>> = 0;
+
+    /** Show the content last written through map_back_buffer(). */
+    virtual void present_back_buffer() = 0;
+
+protected:
+    RenderTarget() = default;
+    RenderTarget(RenderTarget const&) = delete;
+    RenderTarget& operator=(RenderTarget const&) = delete;
+};
+
+}
+}
+}
+
+#endif /* MIR_RENDERER_SW_RENDER_TARGET_H_ */
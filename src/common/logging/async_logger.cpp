@@ -0,0 +1,559 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/logging/async_logger.h"
+#include "mir/logging/timestamped_logger.h"
+#include "mir/thread_name.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace ml = mir::logging;
+
+namespace
+{
+auto const component = "logging";
+
+// How often a run of repeated messages is summarised while it continues
+auto const repeat_interval = std::chrono::seconds(1);
+
+// How long a critical message or a flush waits for the writer thread to finish with the sink
+auto const flush_timeout = std::chrono::seconds(1);
+
+// The size of a record header: any space left at the end of a ring can then hold a padding header
+auto const record_alignment = 32;
+
+auto aligned(size_t size) -> size_t
+{
+    return (size + record_alignment - 1) & ~size_t(record_alignment - 1);
+}
+
+std::atomic<uint64_t> next_logger_id{1};
+
+// Orders messages from all threads
+std::atomic<uint64_t> next_sequence{0};
+
+// Whether this thread is writing to a sink (and so holds an AsyncLogger's write_mutex)
+thread_local bool writing{false};
+
+struct LiveLoggers
+{
+    std::timed_mutex mutex;
+    std::vector<ml::AsyncLogger*> loggers;
+};
+
+// Never destroyed, as a fatal error may flush during exit
+auto live_loggers() -> LiveLoggers&
+{
+    static auto const live = new LiveLoggers;
+    return *live;
+}
+}
+
+/*
+ * A single-producer, single-consumer ring of variable length records. The
+ * logging thread is the only producer and the writer thread the only
+ * consumer, so neither ever waits for the other.
+ */
+class ml::AsyncLogger::Ring
+{
+public:
+    struct Record
+    {
+        Severity severity;
+        Timestamp logged_at;
+        std::string component;
+        std::string message;
+    };
+
+    Ring(size_t capacity, uint64_t owner) :
+        owner{owner},
+        capacity{std::max(aligned(capacity), size_t(4 * record_alignment))},
+        buffer{new char[this->capacity]}
+    {
+    }
+
+    /// Called only by the owning thread
+    bool push(Severity severity, char const* component, size_t component_length,
+              char const* message, size_t message_length)
+    {
+        // No record may take more than half the ring, so a full-size record
+        // always fits once the ring is drained; longer messages are truncated.
+        auto const max_payload = capacity / 2 - sizeof(Header);
+        component_length = std::min(component_length, max_payload);
+        message_length = std::min(message_length, max_payload - component_length);
+        auto const size = aligned(sizeof(Header) + component_length + message_length);
+
+        auto position = head.load(std::memory_order_relaxed);
+        auto const used = position - tail.load(std::memory_order_acquire);
+        auto offset = position % capacity;
+        auto const to_end = capacity - offset;
+        auto const needed = size <= to_end ? size : to_end + size;
+
+        if (capacity - used < needed)
+        {
+            dropped_count.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        if (size > to_end)
+        {
+            // Records are contiguous, so skip the unusable space at the end
+            Header const padding{static_cast<uint32_t>(to_end), 0, true, 0, 0, 0, 0, 0};
+            memcpy(buffer.get() + offset, &padding, sizeof padding);
+            position += to_end;
+            offset = 0;
+        }
+
+        Header const header{
+            static_cast<uint32_t>(size),
+            static_cast<uint8_t>(severity),
+            false,
+            static_cast<uint16_t>(component_length),
+            static_cast<uint32_t>(message_length),
+            0,
+            next_sequence.fetch_add(1, std::memory_order_relaxed),
+            std::chrono::system_clock::now().time_since_epoch().count()};
+        auto const record = buffer.get() + offset;
+        memcpy(record, &header, sizeof header);
+        memcpy(record + sizeof header, component, component_length);
+        memcpy(record + sizeof header + component_length, message, message_length);
+
+        head.store(position + size, std::memory_order_release);
+        return true;
+    }
+
+    /// Called only by the writer: where the records written so far end
+    auto end() const -> size_t
+    {
+        return head.load(std::memory_order_acquire);
+    }
+
+    /// Called only by the writer: the sequence number of the next record before end, if any
+    bool peek(size_t end, uint64_t& sequence)
+    {
+        auto position = tail.load(std::memory_order_relaxed);
+        while (position != end)
+        {
+            Header header;
+            memcpy(&header, buffer.get() + position % capacity, sizeof header);
+            if (!header.padding)
+            {
+                sequence = header.sequence;
+                return true;
+            }
+
+            position += header.size;
+            tail.store(position, std::memory_order_release);
+        }
+        return false;
+    }
+
+    /// Called only by the writer, after peek() has found a record
+    auto pop() -> Record
+    {
+        auto const position = tail.load(std::memory_order_relaxed);
+        auto const record = buffer.get() + position % capacity;
+        Header header;
+        memcpy(&header, record, sizeof header);
+
+        auto const component = record + sizeof header;
+        Record result{
+            static_cast<Severity>(header.severity),
+            Timestamp{Timestamp::duration{header.logged_at}},
+            std::string{component, header.component_length},
+            std::string{component + header.component_length, header.message_length}};
+
+        // Release the space, so the producer can reuse it
+        tail.store(position + header.size, std::memory_order_release);
+        return result;
+    }
+
+    bool empty() const
+    {
+        return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+    }
+
+    auto dropped() const -> uint64_t
+    {
+        return dropped_count.load(std::memory_order_relaxed);
+    }
+
+    uint64_t const owner;
+    std::atomic<bool> released{false};
+
+private:
+    struct Header
+    {
+        uint32_t size;
+        uint8_t severity;
+        bool padding;
+        uint16_t component_length;
+        uint32_t message_length;
+        uint32_t reserved;
+        uint64_t sequence;
+        Timestamp::rep logged_at;
+    };
+    static_assert(sizeof(Header) == record_alignment, "A padding header must fit wherever a record can't");
+
+    size_t const capacity;
+    std::unique_ptr<char[]> const buffer;
+
+    // Keep the producer's and consumer's positions on separate cache lines
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+    alignas(64) std::atomic<uint64_t> dropped_count{0};
+};
+
+// The writer's view of a ring (which is owned by rings)
+struct ml::AsyncLogger::Source
+{
+    explicit Source(Ring* ring) : ring{ring} {}
+
+    Ring* ring;
+    size_t end{0};
+
+    bool has_last{false};
+    Severity last_severity{Severity::debug};
+    std::string last_component;
+    std::string last_message;
+    unsigned long repeats{0};
+    Timestamp last_repeat;
+    std::chrono::steady_clock::time_point repeats_since;
+};
+
+ml::AsyncLogger::AsyncLogger(std::shared_ptr<Logger> const& sink, size_t ring_capacity) :
+    sink{sink},
+    timestamped_sink{dynamic_cast<TimestampedLogger*>(sink.get())},
+    ring_capacity{ring_capacity},
+    id{next_logger_id++},
+    writer{[this] { run(); }}
+{
+    auto& live = live_loggers();
+    std::lock_guard<std::timed_mutex> lock{live.mutex};
+    live.loggers.push_back(this);
+}
+
+ml::AsyncLogger::~AsyncLogger()
+{
+    {
+        auto& live = live_loggers();
+        std::lock_guard<std::timed_mutex> lock{live.mutex};
+        live.loggers.erase(std::remove(live.loggers.begin(), live.loggers.end(), this), live.loggers.end());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{wake_mutex};
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+
+    std::lock_guard<std::mutex> lock{rings_mutex};
+    for (auto const& ring : rings)
+        ring->released = true;
+}
+
+void ml::AsyncLogger::log(Severity severity, std::string const& message, std::string const& component)
+{
+    if (severity == Severity::critical)
+    {
+        log_critical(message, component);
+        return;
+    }
+
+    enqueue(severity, component.data(), component.size(), message.data(), message.size());
+}
+
+void ml::AsyncLogger::log(char const* component, Severity severity, char const* format, ...)
+{
+    auto const bufsize = 4096;
+    va_list va;
+    va_start(va, format);
+    char message[bufsize];
+    auto const length = vsnprintf(message, bufsize, format, va);
+    va_end(va);
+
+    if (severity == Severity::critical)
+    {
+        log_critical(message, component);
+        return;
+    }
+
+    enqueue(severity, component, strlen(component), message, std::clamp(length, 0, bufsize - 1));
+}
+
+auto ml::AsyncLogger::dropped_messages() const -> uint64_t
+{
+    std::lock_guard<std::mutex> lock{rings_mutex};
+
+    auto result = dropped_from_released_rings.load();
+    for (auto const& ring : rings)
+        result += ring->dropped();
+    return result;
+}
+
+void ml::AsyncLogger::flush()
+{
+    if (writing)
+        return;
+
+    std::unique_lock<std::timed_mutex> lock{write_mutex, std::defer_lock};
+    if (lock.try_lock_for(flush_timeout))
+        write_pending(true);
+}
+
+void ml::AsyncLogger::flush_all()
+{
+    // We may be here because of a fatal error while the list is locked
+    auto& live = live_loggers();
+    std::unique_lock<std::timed_mutex> lock{live.mutex, std::defer_lock};
+    if (!lock.try_lock_for(flush_timeout))
+        return;
+
+    for (auto const logger : live.loggers)
+        logger->flush();
+}
+
+void ml::AsyncLogger::enqueue(
+    Severity severity,
+    char const* component, size_t component_length,
+    char const* message, size_t message_length)
+{
+    if (ring_for_this_thread().push(severity, component, component_length, message, message_length))
+        wake_writer();
+}
+
+void ml::AsyncLogger::log_critical(std::string const& message, std::string const& component)
+{
+    auto const logged_at = std::chrono::system_clock::now();
+
+    // The process may be about to abort, so write this from the calling thread, but
+    // after whatever led up to it. If the writer is stuck in the sink, don't wait.
+    std::unique_lock<std::timed_mutex> lock{write_mutex, std::defer_lock};
+    if (!writing && lock.try_lock_for(flush_timeout))
+        write_pending(true);
+
+    write(logged_at, Severity::critical, message, component);
+}
+
+auto ml::AsyncLogger::ring_for_this_thread() -> Ring&
+{
+    thread_local std::vector<std::shared_ptr<Ring>> thread_rings;
+
+    for (auto const& ring : thread_rings)
+    {
+        if (ring->owner == id)
+            return *ring;
+    }
+
+    // First message from this thread: forget rings of any loggers that have gone away...
+    thread_rings.erase(
+        std::remove_if(thread_rings.begin(), thread_rings.end(), [](auto const& ring) { return ring->released.load(); }),
+        thread_rings.end());
+
+    // ...and give it its own ring
+    auto const ring = std::make_shared<Ring>(ring_capacity, id);
+    {
+        std::lock_guard<std::mutex> lock{rings_mutex};
+        rings.push_back(ring);
+    }
+    thread_rings.push_back(ring);
+    return *ring;
+}
+
+void ml::AsyncLogger::wake_writer()
+{
+    // Only the first record after the writer has caught up needs to wake it
+    if (!pending.exchange(true))
+    {
+        // Ensures the writer is either waiting or has yet to check pending
+        { std::lock_guard<std::mutex> lock{wake_mutex}; }
+        wake.notify_one();
+    }
+}
+
+void ml::AsyncLogger::run()
+{
+    mir::set_thread_name("Mir/Log");
+
+    auto const woken = [this] { return stopping || pending.load(); };
+    auto repeats_due = std::chrono::steady_clock::time_point::max();
+
+    std::unique_lock<std::mutex> lock{wake_mutex};
+    while (!stopping)
+    {
+        // Sleep until there's something logged, unless a run of repeats needs summarising first
+        if (repeats_due == std::chrono::steady_clock::time_point::max())
+            wake.wait(lock, woken);
+        else
+            wake.wait_until(lock, repeats_due, woken);
+        pending = false;
+
+        lock.unlock();
+        {
+            std::lock_guard<std::timed_mutex> write_lock{write_mutex};
+            repeats_due = write_pending(false);
+        }
+        lock.lock();
+    }
+    lock.unlock();
+
+    std::lock_guard<std::timed_mutex> write_lock{write_mutex};
+    write_pending(true);
+}
+
+void ml::AsyncLogger::write(
+    Timestamp logged_at,
+    Severity severity,
+    std::string const& message,
+    std::string const& component)
+{
+    if (timestamped_sink)
+        timestamped_sink->log(logged_at, severity, message, component);
+    else
+        sink->log(severity, message, component);
+}
+
+// Called with write_mutex held
+auto ml::AsyncLogger::write_pending(bool flush_repeats) -> std::chrono::steady_clock::time_point
+{
+    struct Writing
+    {
+        Writing() { writing = true; }
+        ~Writing() { writing = false; }
+    } const writing_guard;
+
+    auto const now = std::chrono::steady_clock::now();
+
+    auto const write_repeats = [this, now](Source& source)
+        {
+            if (source.repeats)
+            {
+                char message[64];
+                snprintf(message, sizeof message, "Previous message repeated %lu times", source.repeats);
+                write(source.last_repeat, source.last_severity, message, source.last_component);
+            }
+            source.repeats = 0;
+            source.repeats_since = now;
+        };
+
+    {
+        std::lock_guard<std::mutex> lock{rings_mutex};
+
+        // Rings only referenced from here belong to threads that have exited
+        for (auto ring = rings.begin(); ring != rings.end();)
+        {
+            if (ring->use_count() == 1 && (*ring)->empty())
+            {
+                auto const source = std::find_if(sources.begin(), sources.end(),
+                    [&](auto const& source) { return source.ring == ring->get(); });
+                if (source != sources.end())
+                {
+                    write_repeats(*source);
+                    sources.erase(source);
+                }
+                dropped_from_released_rings += (*ring)->dropped();
+                ring = rings.erase(ring);
+            }
+            else
+            {
+                ++ring;
+            }
+        }
+
+        for (auto const& ring : rings)
+        {
+            if (std::none_of(sources.begin(), sources.end(),
+                    [&](auto const& source) { return source.ring == ring.get(); }))
+                sources.emplace_back(ring.get());
+        }
+
+        // Only write what has been logged so far, so busy threads can't keep us here.
+        // This is done with rings_mutex held, so a ring added later holds only later messages.
+        for (auto& source : sources)
+            source.end = source.ring->end();
+    }
+
+    // Merge the rings, writing records in the order they were logged. A record is only
+    // seen once its thread has published it, so one logged concurrently with this drain
+    // may miss it and be written in the next, after records with later sequence numbers.
+    for (;;)
+    {
+        Source* next = nullptr;
+        uint64_t next_sequence = 0;
+        for (auto& source : sources)
+        {
+            uint64_t sequence;
+            if (source.ring->peek(source.end, sequence) && (!next || sequence < next_sequence))
+            {
+                next = &source;
+                next_sequence = sequence;
+            }
+        }
+
+        if (!next)
+            break;
+
+        auto& source = *next;
+        auto record = source.ring->pop();
+
+        if (source.has_last &&
+            record.severity == source.last_severity &&
+            record.message == source.last_message &&
+            record.component == source.last_component)
+        {
+            if (!source.repeats++)
+                source.repeats_since = now;
+            source.last_repeat = record.logged_at;
+            continue;
+        }
+
+        write_repeats(source);
+        write(record.logged_at, record.severity, record.message, record.component);
+
+        source.has_last = true;
+        source.last_severity = record.severity;
+        source.last_component = std::move(record.component);
+        source.last_message = std::move(record.message);
+    }
+
+    uint64_t dropped = dropped_from_released_rings;
+    auto repeats_due = std::chrono::steady_clock::time_point::max();
+    for (auto& source : sources)
+    {
+        if (source.repeats && (flush_repeats || now - source.repeats_since >= repeat_interval))
+            write_repeats(source);
+        else if (source.repeats)
+            repeats_due = std::min(repeats_due, source.repeats_since + repeat_interval);
+
+        dropped += source.ring->dropped();
+    }
+
+    if (dropped > reported_dropped)
+    {
+        char message[128];
+        snprintf(message, sizeof message,
+                 "Dropped %llu log messages as they were logged faster than they could be written",
+                 static_cast<unsigned long long>(dropped - reported_dropped));
+        write(std::chrono::system_clock::now(), Severity::warning, message, component);
+        reported_dropped = dropped;
+    }
+
+    return repeats_due;
+}
@@ -28,6 +28,15 @@ void ml::DumbConsoleLogger::log(ml::Severity severity,
                                 const std::string& message,
                                 const std::string& component)
 {
+    log(std::chrono::system_clock::now(), severity, message, component);
+}
+
+void ml::DumbConsoleLogger::log(
+    std::chrono::system_clock::time_point logged_at,
+    ml::Severity severity,
+    std::string const& message,
+    std::string const& component)
+{
 
     static const char* lut[5] =
     {
@@ -40,11 +49,13 @@ void ml::DumbConsoleLogger::log(ml::Severity severity,
 
     std::ostream& out = severity < ml::Severity::informational ? std::cerr : std::cout;
 
-    struct timespec ts;
-    clock_gettime(CLOCK_REALTIME, &ts);
+    auto const since_epoch = logged_at.time_since_epoch();
+    auto const seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+    time_t const tv_sec = seconds.count();
+    long const usec = std::chrono::duration_cast<std::chrono::microseconds>(since_epoch - seconds).count();
     char now[32];
-    auto offset = strftime(now, sizeof(now), "%F %T", localtime(&ts.tv_sec));
-    snprintf(now+offset, sizeof(now)-offset, ".%06ld", ts.tv_nsec / 1000);
+    auto offset = strftime(now, sizeof(now), "%F %T", localtime(&tv_sec));
+    snprintf(now+offset, sizeof(now)-offset, ".%06ld", usec);
 
     out << "["
         << now
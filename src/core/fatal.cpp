@@ -34,6 +34,9 @@ void mir::fatal_error_abort(char const* reason, ...)
     // Keep this as simple as possible, avoiding any object construction and
     // minimizing the potential for heap operations between the error location
     // and the abort().
+    if (fatal_error_flush)
+        fatal_error_flush();
+
     va_start(args, reason);
     fprintf(stderr, "Mir fatal error: ");
     vfprintf(stderr, reason, args);
@@ -56,3 +59,5 @@ void mir::fatal_error_except(char const* reason, ...)
 }
 
 void (*mir::fatal_error)(char const* reason, ...){&mir::fatal_error_abort};
+
+void (*mir::fatal_error_flush)(){nullptr};
@@ -23,6 +23,19 @@
 
 namespace mgl = mir::gl;
 
+mgl::DefaultProgramFactory::DefaultProgramFactory()
+    : DefaultProgramFactory(default_texture_cache_budget, std::make_shared<TextureCacheCounters>())
+{
+}
+
+mgl::DefaultProgramFactory::DefaultProgramFactory(
+    size_t texture_cache_budget,
+    std::shared_ptr<TextureCacheCounters> const& counters)
+    : texture_cache_budget{texture_cache_budget},
+      texture_cache_counters{counters}
+{
+}
+
 std::unique_ptr<mgl::Program>
 mgl::DefaultProgramFactory::create_gl_program(
     std::string const& vertex_shader,
@@ -35,5 +48,5 @@ mgl::DefaultProgramFactory::create_gl_program(
 
 std::unique_ptr<mgl::TextureCache> mgl::DefaultProgramFactory::create_texture_cache() const
 {
-    return std::make_unique<RecentlyUsedCache>();
+    return std::make_unique<RecentlyUsedCache>(texture_cache_budget, texture_cache_counters);
 }
@@ -29,22 +29,68 @@ namespace mgl = mir::gl;
 namespace geom = mir::geometry;
 namespace mrgl = mir::renderer::gl;
 
+namespace
+{
+auto bytes_in(mg::Buffer const& buffer) -> size_t
+{
+    auto const size = buffer.size();
+    auto const bpp = MIR_BYTES_PER_PIXEL(buffer.pixel_format());
+    return size_t(size.width.as_uint32_t()) * size.height.as_uint32_t() * (bpp ? bpp : 4);
+}
+}
+
+mgl::RecentlyUsedCache::RecentlyUsedCache(
+    size_t budget_bytes,
+    std::shared_ptr<TextureCacheCounters> const& counters)
+    : budget_bytes{budget_bytes},
+      counters{counters}
+{
+}
+
+mgl::RecentlyUsedCache::~RecentlyUsedCache()
+{
+    counters->cached_bytes -= cached_bytes;
+}
+
 std::shared_ptr<mgl::Texture> mgl::RecentlyUsedCache::load(mg::Renderable const& renderable)
 {
     auto const& buffer = renderable.buffer();
     auto buffer_id = buffer->id();
-    auto& texture = textures[renderable.id()];
-    texture.texture->bind();
+    auto const id = renderable.id();
 
     auto const texture_source = dynamic_cast<mrgl::TextureSource*>(buffer->native_buffer_base());
     if (!texture_source)
         BOOST_THROW_EXCEPTION(std::logic_error("Buffer does not support GL rendering"));
 
+    auto found = textures.find(id);
+    if (found == textures.end())
+    {
+        found = textures.emplace(id, Entry{}).first;
+        found->second.lru_position = lru.insert(lru.begin(), id);
+    }
+    else
+    {
+        lru.splice(lru.begin(), lru, found->second.lru_position);
+    }
+
+    auto& texture = found->second;
+    texture.texture->bind();
+
     if ((texture.last_bound_buffer != buffer_id) || (!texture.valid_binding))
     {
         texture_source->bind();
         texture.resource = buffer;
         texture.last_bound_buffer = buffer_id;
+
+        auto const bytes = bytes_in(*buffer);
+        cached_bytes += bytes - texture.bytes;
+        counters->cached_bytes += int64_t(bytes) - int64_t(texture.bytes);
+        texture.bytes = bytes;
+        ++counters->misses;
+    }
+    else
+    {
+        ++counters->hits;
     }
     texture_source->secure_for_render();
 
@@ -62,19 +108,30 @@ void mgl::RecentlyUsedCache::invalidate()
 
 void mgl::RecentlyUsedCache::drop_unused()
 {
-    auto t = textures.begin();
-    while (t != textures.end())
+    size_t undrawn_bytes = 0;
+    for (auto const& t : textures)
     {
-        auto& tex = t->second;
-        tex.resource.reset();
-        if (tex.used)
-        {
-            tex.used = false;
-            ++t;
-        }
-        else
-        {
-            t = textures.erase(t);
-        }
+        if (!t.second.used)
+            undrawn_bytes += t.second.bytes;
+    }
+
+    // Only textures that weren't drawn this frame are evicted. As the list is
+    // in order of use, those are all behind the ones that were drawn.
+    while (undrawn_bytes > budget_bytes)
+    {
+        auto const victim = textures.find(lru.back());
+
+        undrawn_bytes -= victim->second.bytes;
+        cached_bytes -= victim->second.bytes;
+        counters->cached_bytes -= victim->second.bytes;
+        textures.erase(victim);
+        lru.pop_back();
+    }
+
+    for (auto& t : textures)
+    {
+        t.second.resource.reset();
+        t.second.used = false;
     }
 }
+
@@ -24,6 +24,7 @@
 #include "mir/gl/texture.h"
 #include "mir/graphics/buffer_id.h"
 #include "mir/graphics/renderable.h"
+#include <list>
 #include <unordered_map>
 
 namespace mir
@@ -31,9 +32,22 @@ namespace mir
 namespace graphics { class Buffer; }
 namespace gl
 {
+/**
+ * Keeps the textures of renderables that have been drawn recently.
+ *
+ * Textures that were not drawn in the last frame are kept (so a surface that
+ * is briefly hidden doesn't need its buffer uploaded again) until they add up
+ * to more than the budget, when the least recently drawn are freed first.
+ * Textures drawn in the last frame don't count against the budget.
+ */
 class RecentlyUsedCache : public TextureCache
 {
 public:
+    /// \param budget_bytes    How much texture memory to keep for renderables not drawn in the last frame
+    /// \param counters        Where to add this cache's hits, misses and size
+    RecentlyUsedCache(size_t budget_bytes, std::shared_ptr<TextureCacheCounters> const& counters);
+    ~RecentlyUsedCache();
+
     std::shared_ptr<Texture> load(graphics::Renderable const& renderable) override;
     void invalidate() override;
     void drop_unused() override;
@@ -49,9 +63,15 @@ private:
         bool used{true};
         bool valid_binding{false};
         std::shared_ptr<graphics::Buffer> resource;
+        size_t bytes{0};
+        std::list<graphics::Renderable::ID>::iterator lru_position;
     };
 
+    size_t const budget_bytes;
+    std::shared_ptr<TextureCacheCounters> const counters;
     std::unordered_map<graphics::Renderable::ID, Entry> textures;
+    std::list<graphics::Renderable::ID> lru; ///< Most recently loaded first
+    size_t cached_bytes{0};
 };
 }
 }
@@ -36,13 +36,31 @@ mgl::Primitive mgl::tessellate_renderable_into_rectangle(
     mgl::Primitive rectangle;
     rectangle.type = GL_TRIANGLE_STRIP;
 
-    GLfloat const tex_right = 1.0f;
-    GLfloat const tex_bottom = 1.0f;
+    GLfloat tex_left = 0.0f;
+    GLfloat tex_top = 0.0f;
+    GLfloat tex_right = 1.0f;
+    GLfloat tex_bottom = 1.0f;
+
+    if (auto const src = renderable.src_bounds())
+    {
+        // Only sample the requested part of the buffer (e.g. wp_viewport cropping)
+        auto const buffer_size = renderable.buffer()->size();
+        GLfloat const buffer_width = buffer_size.width.as_int();
+        GLfloat const buffer_height = buffer_size.height.as_int();
+
+        if (buffer_width > 0 && buffer_height > 0)
+        {
+            tex_left = src->left().as_int() / buffer_width;
+            tex_top = src->top().as_int() / buffer_height;
+            tex_right = src->right().as_int() / buffer_width;
+            tex_bottom = src->bottom().as_int() / buffer_height;
+        }
+    }
 
     auto& vertices = rectangle.vertices;
-    vertices[0] = {{left,  top,    0.0f}, {0.0f,      0.0f}};
-    vertices[1] = {{left,  bottom, 0.0f}, {0.0f,      tex_bottom}};
-    vertices[2] = {{right, top,    0.0f}, {tex_right, 0.0f}};
+    vertices[0] = {{left,  top,    0.0f}, {tex_left,  tex_top}};
+    vertices[1] = {{left,  bottom, 0.0f}, {tex_left,  tex_bottom}};
+    vertices[2] = {{right, top,    0.0f}, {tex_right, tex_top}};
     vertices[3] = {{right, bottom, 0.0f}, {tex_right, tex_bottom}};
     return rectangle;
 }
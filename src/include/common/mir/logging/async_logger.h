@@ -0,0 +1,119 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_LOGGING_ASYNC_LOGGER_H_
+#define MIR_LOGGING_ASYNC_LOGGER_H_
+
+#include "mir/logging/logger.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mir
+{
+namespace logging
+{
+class TimestampedLogger;
+
+/**
+ * A Logger that hands messages to another Logger on a background thread,
+ * so that threads which log (e.g. the compositor and input threads) never
+ * block on the output.
+ *
+ * Each logging thread writes formatted records into its own lock-free ring
+ * buffer of ring_capacity bytes. If a thread logs faster than the records
+ * can be written out its ring fills and further messages are dropped (and
+ * counted) rather than growing without bound. Runs of identical messages
+ * from a thread are collapsed into a single "repeated" line.
+ *
+ * Messages are stamped with the time and their order when they are logged.
+ * Messages from one thread are always written in order; messages from
+ * different threads are merged in the order they were logged, but this is
+ * best-effort: a message logged just as the writer collects a batch may be
+ * written after messages logged slightly later. If the sink is a
+ * TimestampedLogger it is given the time the message was logged, so the
+ * timestamps are exact even when the order is not.
+ *
+ * Critical messages are written from the thread that logs them (after
+ * everything queued before them), as the process may be about to abort.
+ */
+class AsyncLogger : public Logger
+{
+public:
+    static size_t const default_ring_capacity = 64 * 1024;
+
+    explicit AsyncLogger(std::shared_ptr<Logger> const& sink, size_t ring_capacity = default_ring_capacity);
+    ~AsyncLogger();
+
+    void log(Severity severity, std::string const& message, std::string const& component) override;
+    void log(char const* component, Severity severity, char const* format, ...) override
+        __attribute__ ((format (printf, 4, 5)));
+
+    /// The total number of messages dropped because a ring buffer was full
+    auto dropped_messages() const -> uint64_t;
+
+    /// Write out the messages logged so far from the calling thread, unless the
+    /// writer thread is stuck in the sink for longer than a second
+    void flush();
+
+    /// Flush every AsyncLogger; suitable for mir::fatal_error_flush
+    static void flush_all();
+
+private:
+    class Ring;
+    struct Source;
+    using Timestamp = std::chrono::system_clock::time_point;
+
+    void enqueue(Severity severity, char const* component, size_t component_length,
+                 char const* message, size_t message_length);
+    void log_critical(std::string const& message, std::string const& component);
+    auto ring_for_this_thread() -> Ring&;
+    void wake_writer();
+    void run();
+    /// \return when a run of repeated messages next needs summarising (or time_point::max())
+    auto write_pending(bool flush_repeats) -> std::chrono::steady_clock::time_point;
+    void write(Timestamp logged_at, Severity severity, std::string const& message, std::string const& component);
+
+    std::shared_ptr<Logger> const sink;
+    TimestampedLogger* const timestamped_sink;
+    size_t const ring_capacity;
+    uint64_t const id;
+
+    std::mutex mutable rings_mutex;
+    std::vector<std::shared_ptr<Ring>> rings;
+    std::atomic<uint64_t> dropped_from_released_rings{0};
+
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    std::atomic<bool> pending{false};
+    bool stopping{false};
+
+    // Held while writing to the sink, by the writer thread or a thread flushing
+    std::timed_mutex write_mutex;
+    std::vector<Source> sources;
+    uint64_t reported_dropped{0};
+
+    std::thread writer;
+};
+}
+}
+
+#endif // MIR_LOGGING_ASYNC_LOGGER_H_
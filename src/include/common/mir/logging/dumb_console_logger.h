@@ -19,18 +19,23 @@
 #ifndef MIR_LOGGING_DUMB_CONSOLE_LOGGER_H_
 #define MIR_LOGGING_DUMB_CONSOLE_LOGGER_H_
 
-#include "mir/logging/logger.h"
+#include "mir/logging/timestamped_logger.h"
 
 namespace mir
 {
 namespace logging
 {
-class DumbConsoleLogger : public Logger
+class DumbConsoleLogger : public TimestampedLogger
 {
 public:
 
 protected:
     void log(Severity severity, const std::string& message, const std::string& component) override;
+    void log(
+        std::chrono::system_clock::time_point logged_at,
+        Severity severity,
+        std::string const& message,
+        std::string const& component) override;
 };
 }
 }
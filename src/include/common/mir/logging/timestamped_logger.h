@@ -0,0 +1,49 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_LOGGING_TIMESTAMPED_LOGGER_H_
+#define MIR_LOGGING_TIMESTAMPED_LOGGER_H_
+
+#include "mir/logging/logger.h"
+
+#include <chrono>
+
+namespace mir
+{
+namespace logging
+{
+/**
+ * A Logger that can be told when a message was logged, so a message written
+ * some time later (e.g. by AsyncLogger) still shows when it happened.
+ */
+class TimestampedLogger : public Logger
+{
+public:
+    using Logger::log;
+
+    virtual void log(
+        std::chrono::system_clock::time_point logged_at,
+        Severity severity,
+        std::string const& message,
+        std::string const& component) = 0;
+
+protected:
+    TimestampedLogger() = default;
+};
+}
+}
+
+#endif // MIR_LOGGING_TIMESTAMPED_LOGGER_H_
@@ -20,15 +20,24 @@
 #define MIR_GL_DEFAULT_PROGRAM_FACTORY_H_
 
 #include "program_factory.h"
+#include "texture_cache.h"
+#include <cstddef>
 #include <mutex>
 
 namespace mir
 {
 namespace gl
 {
+/// Texture memory a cache keeps for renderables that were not drawn in the last frame
+size_t const default_texture_cache_budget{64 * 1024 * 1024};
+
 class DefaultProgramFactory : public ProgramFactory
 {
 public:
+    DefaultProgramFactory();
+    /// Texture caches created will keep textures within the budget and add to counters
+    DefaultProgramFactory(size_t texture_cache_budget, std::shared_ptr<TextureCacheCounters> const& counters);
+
     std::unique_ptr<Program> create_gl_program(std::string const&, std::string const&) const override;
     std::unique_ptr<TextureCache> create_texture_cache() const override;
 
@@ -40,6 +49,8 @@ private:
      * have the same or shared EGL contexts.
      */
     std::mutex mutable mutex;
+    size_t const texture_cache_budget;
+    std::shared_ptr<TextureCacheCounters> const texture_cache_counters;
 };
 }
 }
@@ -20,6 +20,8 @@
 #ifndef MIR_GL_TEXTURE_CACHE_H_
 #define MIR_GL_TEXTURE_CACHE_H_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 
 namespace mir
@@ -28,6 +30,15 @@ namespace graphics { class Renderable; }
 namespace gl
 {
 class Texture;
+
+/// Totals for a set of texture caches (e.g. one per output), safe to read from any thread
+struct TextureCacheCounters
+{
+    std::atomic<uint64_t> hits{0};          ///< Loads that reused the texture already holding the buffer
+    std::atomic<uint64_t> misses{0};        ///< Loads that had to bind (and maybe upload) the buffer
+    std::atomic<int64_t> cached_bytes{0};   ///< Approximate size of the textures held
+};
+
 class TextureCache
 {
 public:
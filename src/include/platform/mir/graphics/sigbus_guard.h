@@ -0,0 +1,54 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_SIGBUS_GUARD_H_
+#define MIR_GRAPHICS_SIGBUS_GUARD_H_
+
+#include <cstddef>
+#include <functional>
+
+namespace mir
+{
+namespace graphics
+{
+/**
+ * Install the SIGBUS handler used by access_guarding_sigbus()
+ *
+ * SIGBUS raised outside a guarded access is passed on to the handler this replaces.
+ * This is done by the server core rather than by platform modules, which may be unloaded.
+ */
+void install_sigbus_guard_handler();
+
+/// Restore the SIGBUS handler that install_sigbus_guard_handler() replaced
+void remove_sigbus_guard_handler();
+
+/**
+ * Run access, which reads the size bytes of client-owned shared memory at data.
+ *
+ * If the client truncates the backing file, the pages that can no longer be read are replaced by
+ * zero-filled pages rather than the server being killed by SIGBUS. This needs the handler from
+ * install_sigbus_guard_handler(); without it SIGBUS is handled as if access were unguarded.
+ *
+ * \return  false if any page of the range had to be replaced
+ */
+auto access_guarding_sigbus(
+    void const* data,
+    size_t size,
+    std::function<void()> const& access) -> bool;
+}
+}
+
+#endif // MIR_GRAPHICS_SIGBUS_GUARD_H_
@@ -49,6 +49,7 @@ public:
     virtual void drop_old_buffers() = 0;
     virtual auto has_submitted_buffer() const -> bool = 0;
     virtual auto framedropping() const -> bool = 0;
+    virtual auto tearing_allowed() const -> bool = 0;
 };
 
 }
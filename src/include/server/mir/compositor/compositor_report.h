@@ -21,6 +21,8 @@
 
 #include "mir/graphics/renderable.h"
 
+#include <chrono>
+
 namespace mir
 {
 namespace compositor
@@ -30,11 +32,25 @@ class CompositorReport
 {
 public:
     typedef const void* SubCompositorId;  // e.g. thread/display buffer ID
+
+    /// The stages of producing a frame that frame_stage_timing() reports
+    enum class FrameStage
+    {
+        scene_snapshot, ///< Collecting the scene elements to composite
+        occlusion,      ///< Filtering out occluded elements
+        texture_upload, ///< Binding (and uploading if needed) client buffers
+        draw,           ///< Issuing draw commands
+        gpu,            ///< GPU execution of the draw commands, where measurable
+        swap,           ///< Swapping the render target's buffers
+        post            ///< Posting to the display, including waiting for page flips
+    };
+
     virtual void added_display(int width, int height, int x, int y, SubCompositorId id) = 0;
     virtual void began_frame(SubCompositorId id) = 0;
     virtual void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) = 0;
     virtual void rendered_frame(SubCompositorId id) = 0;
     virtual void finished_frame(SubCompositorId id) = 0;
+    virtual void frame_stage_timing(SubCompositorId id, FrameStage stage, std::chrono::nanoseconds duration) = 0;
     virtual void started() = 0;
     virtual void stopped() = 0;
     virtual void scheduled() = 0;
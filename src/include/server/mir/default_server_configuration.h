@@ -84,6 +84,7 @@ class Shell;
 class ShellReport;
 class SurfaceStack;
 class PersistentSurfaceStore;
+class BasicIdleHandler;
 namespace decoration { class Manager; }
 namespace detail { class FrontendShell; }
 }
@@ -109,6 +110,7 @@ class SceneReport;
 class PromptSessionListener;
 class PromptSessionManager;
 class CoordinateTranslator;
+class IdleHub;
 }
 namespace graphics
 {
@@ -120,6 +122,7 @@ class GraphicBufferAllocator;
 class Cursor;
 class CursorImage;
 class GLConfig;
+class MemoryAccounting;
 namespace nested
 {
 class HostConnection;
@@ -159,6 +162,7 @@ class Configuration;
 namespace report
 {
 class ReportFactory;
+namespace metrics { class Registry; }
 }
 
 namespace renderer
@@ -259,6 +263,9 @@ public:
     virtual std::shared_ptr<compositor::Scene>                  the_scene();
     /** @} */
 
+    /// The buffer memory held by each client process, charged by the_buffer_allocator()
+    auto the_memory_accounting() -> std::shared_ptr<graphics::MemoryAccounting>;
+
     /** @name frontend configuration - dependencies
      * dependencies of frontend on the rest of the Mir
      *  @{ */
@@ -290,6 +297,7 @@ public:
     virtual auto the_shell() -> std::shared_ptr<shell::Shell>;
     virtual auto the_window_manager_builder() -> shell::WindowManagerBuilder;
     virtual auto the_decoration_manager() -> std::shared_ptr<shell::decoration::Manager>;
+    virtual auto the_idle_handler() -> std::shared_ptr<shell::BasicIdleHandler>;
     virtual std::shared_ptr<scene::SessionListener>     the_session_listener();
     virtual std::shared_ptr<shell::DisplayLayout>       the_shell_display_layout();
     virtual std::shared_ptr<scene::PromptSessionListener> the_prompt_session_listener();
@@ -325,6 +333,7 @@ public:
      *  @{ */
     virtual std::shared_ptr<scene::SessionCoordinator>  the_session_coordinator();
     virtual std::shared_ptr<scene::CoordinateTranslator> the_coordinate_translator();
+    virtual std::shared_ptr<scene::IdleHub> the_idle_hub();
     /** @} */
 
 
@@ -363,6 +372,9 @@ public:
     virtual std::shared_ptr<ConsoleServices> the_console_services();
     auto default_reports() -> std::shared_ptr<void>;
 
+    /// The registry updated by reports set to "metrics", served on the metrics socket
+    auto the_metrics_registry() -> std::shared_ptr<report::metrics::Registry>;
+
 private:
     // We need to ensure the platform library is destroyed last as the
     // DisplayConfiguration can hold weak_ptrs to objects created from the library
@@ -414,6 +426,7 @@ protected:
     CachedPtr<input::Seat> seat;
     CachedPtr<graphics::Platform>     graphics_platform;
     CachedPtr<graphics::GraphicBufferAllocator> buffer_allocator;
+    CachedPtr<graphics::MemoryAccounting> memory_accounting;
     CachedPtr<graphics::Display>      display;
     CachedPtr<graphics::Cursor>       cursor;
     CachedPtr<graphics::CursorImage>  default_cursor_image;
@@ -454,6 +467,7 @@ protected:
     CachedPtr<scene::PromptSessionManager> prompt_session_manager;
     CachedPtr<scene::SessionCoordinator> session_coordinator;
     CachedPtr<scene::CoordinateTranslator> coordinate_translator;
+    CachedPtr<scene::IdleHub> idle_hub;
     CachedPtr<EmergencyCleanup> emergency_cleanup;
     CachedPtr<shell::HostLifecycleEventListener> host_lifecycle_event_listener;
     CachedPtr<shell::PersistentSurfaceStore> persistent_surface_store;
@@ -461,6 +475,7 @@ protected:
     CachedPtr<shell::Shell> shell;
     CachedPtr<shell::ShellReport> shell_report;
     CachedPtr<shell::decoration::Manager> decoration_manager;
+    CachedPtr<shell::BasicIdleHandler> idle_handler;
     CachedPtr<scene::ApplicationNotRespondingDetector> application_not_responding_detector;
     CachedPtr<cookie::Authority> cookie_authority;
     CachedPtr<input::KeyMapper> key_mapper;
@@ -485,6 +500,7 @@ private:
     std::shared_ptr<scene::BroadcastingSessionEventSink> the_broadcasting_session_event_sink();
 
     auto report_factory(char const* report_opt) -> std::unique_ptr<report::ReportFactory>;
+    CachedPtr<report::metrics::Registry> metrics_registry;
 
     CachedPtr<shell::detail::FrontendShell> frontend_shell;
     std::vector<WaylandExtensionHook> wayland_extension_hooks;
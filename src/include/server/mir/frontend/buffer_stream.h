@@ -54,6 +54,8 @@ public:
     //TODO: framedropping for swapinterval-0 can probably be effectively managed from the client
     //      side once we only support the NBS system.
     virtual void allow_framedropping(bool) = 0;
+    /// Whether the compositor may show buffers without waiting for vsync, even if that tears
+    virtual void set_tearing_allowed(bool) = 0;
     virtual void set_scale(float scale) = 0;
 protected:
     BufferStream() = default;
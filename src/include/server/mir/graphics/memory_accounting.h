@@ -0,0 +1,147 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_GRAPHICS_MEMORY_ACCOUNTING_H_
+#define MIR_GRAPHICS_MEMORY_ACCOUNTING_H_
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace mir
+{
+namespace graphics
+{
+class Buffer;
+
+enum class MemoryKind
+{
+    shm,        ///< Client wl_shm buffers, which the server maps and uploads
+    hardware,   ///< Client GPU buffers (dmabuf, wl_drm or EGLStream)
+    internal,   ///< Buffers the server allocates, e.g. for decorations and cursors
+};
+
+struct MemoryUsage
+{
+    size_t buffers{0};
+    size_t bytes{0};
+};
+
+/// Usage of each kind of buffer held by one client
+using ClientMemoryUsage = std::map<MemoryKind, MemoryUsage>;
+
+/**
+ * A client connection that buffers are charged to
+ *
+ * Clients are told apart by id rather than by process: several may share a
+ * process (e.g. Xwayland and other clients the server connects over a
+ * socketpair report the server's own pid).
+ */
+struct MemoryClient
+{
+    uint64_t id;    ///< Unique for the life of the MemoryAccounting; 0 for the server itself
+    pid_t pid;      ///< The process at the other end of the connection, for reporting
+};
+
+struct ClientMemoryAccount
+{
+    pid_t pid;
+    ClientMemoryUsage usage;
+};
+
+class MemoryQuotaExceeded : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * Counts the buffer memory held on behalf of each client.
+ *
+ * A buffer is charged to a client when it is created and credited back when
+ * the last reference to it goes. Charges that would take a client over its
+ * quota throw MemoryQuotaExceeded instead. The server itself has no quota.
+ *
+ * Only the buffers themselves are counted, not copies of them (such as the
+ * textures the GL renderer caches).
+ */
+class MemoryAccounting : public std::enable_shared_from_this<MemoryAccounting>
+{
+public:
+    /// \param client_quota_bytes   The most a client may hold, or 0 for no limit
+    explicit MemoryAccounting(size_t client_quota_bytes);
+
+    /// The account for buffers the server allocates for itself
+    auto server() const -> MemoryClient;
+
+    /// A new account for a client connection from pid
+    auto new_client(pid_t pid) -> MemoryClient;
+
+    /// Drop any per-client quota for a client that has disconnected; its buffers stay charged until destroyed
+    void remove_client(MemoryClient const& client);
+
+    /**
+     * Charge buffer to client until it is destroyed
+     *
+     * eturn  The same buffer, held together with the charge
+     * 	hrow   MemoryQuotaExceeded if client would go over its quota
+     */
+    auto charge(std::shared_ptr<Buffer> const& buffer, MemoryClient const& client, MemoryKind kind)
+        -> std::shared_ptr<Buffer>;
+
+    /**
+     * Charge the memory of buffer to client until the returned charge is released
+     *
+     * This lets a single charge cover each Buffer imported from the same client buffer.
+     * 	hrow   MemoryQuotaExceeded if client would go over its quota
+     */
+    auto charge_for(Buffer const& buffer, MemoryClient const& client, MemoryKind kind) -> std::shared_ptr<void>;
+
+    /// Override the quota for a single client (0 for no limit)
+    void set_quota(MemoryClient const& client, size_t bytes);
+
+    /// The accounts holding buffers, by client id
+    auto usage() const -> std::map<uint64_t, ClientMemoryAccount>;
+
+private:
+    struct Charge;
+
+    void credit(uint64_t client_id, MemoryKind kind, size_t bytes);
+
+    size_t const client_quota_bytes;
+    pid_t const server_pid;
+
+    std::mutex mutable mutex;
+    uint64_t next_client_id{1};
+    std::map<uint64_t, ClientMemoryAccount> accounts;
+    std::map<uint64_t, size_t> quotas;
+};
+
+/// The same buffer, which holds charge (from MemoryAccounting::charge_for()) until it is destroyed
+auto with_charge(std::shared_ptr<Buffer> const& buffer, std::shared_ptr<void> const& charge) -> std::shared_ptr<Buffer>;
+
+auto total_bytes(ClientMemoryUsage const& usage) -> size_t;
+auto to_string(MemoryKind kind) -> char const*;
+}
+}
+
+#endif /* MIR_GRAPHICS_MEMORY_ACCOUNTING_H_ */
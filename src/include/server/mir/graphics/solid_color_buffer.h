@@ -0,0 +1,60 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_GRAPHICS_SOLID_COLOR_BUFFER_H_
+#define MIR_GRAPHICS_SOLID_COLOR_BUFFER_H_
+
+#include "mir/graphics/buffer_basic.h"
+#include "mir/renderer/sw/pixel_source.h"
+
+#include <cstdint>
+
+namespace mir
+{
+namespace graphics
+{
+/**
+ * A single premultiplied ARGB colour, with no pixel storage or texture behind it.
+ *
+ * The buffer is 1×1 and is meant to be scaled to fill its surface or stream.
+ * The GL renderer draws it without a texture; anything else can read the one
+ * pixel through ReadMappableBuffer.
+ */
+class SolidColorBuffer
+    : public BufferBasic,
+      public NativeBufferBase,
+      public renderer::software::ReadMappableBuffer
+{
+public:
+    explicit SolidColorBuffer(uint32_t argb);
+
+    auto color() const -> uint32_t;
+
+    std::shared_ptr<NativeBuffer> native_buffer_handle() const override;
+    geometry::Size size() const override;
+    MirPixelFormat pixel_format() const override;
+    NativeBufferBase* native_buffer_base() override;
+
+    auto map_readable() -> std::unique_ptr<renderer::software::Mapping<unsigned char const>> override;
+
+private:
+    uint32_t const argb;
+};
+}
+}
+
+#endif /* MIR_GRAPHICS_SOLID_COLOR_BUFFER_H_ */
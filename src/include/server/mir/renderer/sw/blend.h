@@ -0,0 +1,50 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SW_BLEND_H_
+#define MIR_RENDERER_SW_BLEND_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+/*
+ * Pixels are 32-bit premultiplied ARGB (mir_pixel_format_argb_8888) and
+ * "alpha" is an additional opacity applied to every source pixel, matching
+ * the blend modes of the GL renderer.
+ */
+
+/// dst = src × alpha + dst × (1 - src.a × alpha)
+void blend_over(uint32_t* dst, uint32_t const* src, size_t count, uint8_t alpha);
+
+/// As blend_over(), but src is treated as opaque whatever its alpha channel holds
+void blend_opaque(uint32_t* dst, uint32_t const* src, size_t count, uint8_t alpha);
+
+/// dst = color × coverage + dst × (1 - color.a × coverage), for drawing antialiased glyphs in a solid color
+void blend_coverage(uint32_t* dst, uint8_t const* coverage, size_t count, uint32_t color);
+
+/// Swap the red and blue channels (converting between ARGB and ABGR)
+void swap_red_blue(uint32_t* dst, uint32_t const* src, size_t count);
+}
+}
+}
+
+#endif /* MIR_RENDERER_SW_BLEND_H_ */
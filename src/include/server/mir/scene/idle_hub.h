@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SCENE_IDLE_HUB_H_
+#define MIR_SCENE_IDLE_HUB_H_
+
+#include <chrono>
+#include <memory>
+
+namespace mir
+{
+namespace scene
+{
+class IdleStateObserver
+{
+public:
+    IdleStateObserver() = default;
+    virtual ~IdleStateObserver() = default;
+
+    /// There has been no activity for the timeout this observer was registered with
+    virtual void idle() = 0;
+
+    /// There has been activity since idle() was called
+    virtual void active() = 0;
+
+private:
+    IdleStateObserver(IdleStateObserver const&) = delete;
+    IdleStateObserver& operator=(IdleStateObserver const&) = delete;
+};
+
+/**
+ * Tracks how long it has been since the user was last active
+ *
+ * \note All members are threadsafe. Observers are called without any internal locks held, and may be
+ *       called on any thread.
+ */
+class IdleHub
+{
+public:
+    IdleHub() = default;
+    virtual ~IdleHub() = default;
+
+    /// Notes activity (such as user input), restarting the idle timeouts
+    virtual void poke() = 0;
+
+    /// observer is told when there has been no activity for timeout, and again when activity resumes
+    virtual void register_interest(
+        std::weak_ptr<IdleStateObserver> const& observer,
+        std::chrono::milliseconds timeout) = 0;
+
+    virtual void unregister_interest(IdleStateObserver const& observer) = 0;
+
+    /// Nothing goes idle while the returned handle is held
+    virtual auto inhibit_idle() -> std::shared_ptr<void> = 0;
+
+private:
+    IdleHub(IdleHub const&) = delete;
+    IdleHub& operator=(IdleHub const&) = delete;
+};
+}
+}
+
+#endif // MIR_SCENE_IDLE_HUB_H_
@@ -57,6 +57,19 @@ public:
      * overridden by a client's requested configuration if that client is focused.
      */
     virtual std::shared_ptr<graphics::DisplayConfiguration> base_configuration() = 0;
+
+    /**
+     * Turn the outputs in use off, or back on.
+     *
+     * This applies to whichever configuration is in effect, including one a focused
+     * client has set. It doesn't change the base configuration or any client's
+     * configuration. While the outputs are off, any configuration applied is
+     * applied with its outputs off.
+     *
+     * \param [in]  off     Whether the outputs should be off
+     * \return              False if the change could not be applied
+     */
+    virtual bool set_outputs_off(bool off) = 0;
 };
 }
 }
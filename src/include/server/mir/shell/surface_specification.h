@@ -24,6 +24,7 @@
 #include "mir/frontend/surface_id.h"
 #include "mir/geometry/point.h"
 #include "mir/geometry/displacement.h"
+#include "mir/geometry/rectangle.h"
 #include "mir/graphics/buffer_properties.h"
 #include "mir/graphics/display_configuration.h"
 #include "mir/frontend/buffer_stream_id.h"
@@ -50,6 +51,8 @@ struct StreamSpecification
     std::weak_ptr<frontend::BufferStream> stream;
     geometry::Displacement displacement;
     optional_value<geometry::Size> size;
+    /// The region of the stream's buffers to show, in buffer pixels (the whole buffer if not set)
+    optional_value<geometry::Rectangle> src_bounds{};
 };
 auto operator==(StreamSpecification const& lhs, StreamSpecification const& rhs) -> bool;
 
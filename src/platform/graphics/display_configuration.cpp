@@ -133,6 +133,17 @@ std::ostream& mg::operator<<(std::ostream& out, mg::DisplayConfigurationOutput c
     out << std::endl;
 
     out << "\torientation: " << val.orientation << '\n';
+    out << "\tvariable refresh: " << (val.vrr_capable ? "supported" : "unsupported") << '\n';
+    if (val.colour_transform != glm::mat3{1})
+    {
+        out << "\tcolour transform: [";
+        for (int row = 0; row != 3; ++row)
+            out << (row ? "; " : " ") << val.colour_transform[0][row] << ", "
+                << val.colour_transform[1][row] << ", " << val.colour_transform[2][row];
+        out << " ]\n";
+    }
+    if (val.hdr_metadata.is_set())
+        out << "\tHDR EOTF: " << static_cast<int>(val.hdr_metadata.value().eotf) << '\n';
     out << "}" << std::endl;
 
     return out;
@@ -331,7 +342,10 @@ mg::UserDisplayConfigurationOutput::UserDisplayConfigurationOutput(
         gamma(master.gamma),
         gamma_supported(master.gamma_supported),
         edid(*reinterpret_cast<std::vector<uint8_t const>*>(&master.edid)),
-        custom_logical_size(master.custom_logical_size)
+        custom_logical_size(master.custom_logical_size),
+        vrr_capable(master.vrr_capable),
+        colour_transform(master.colour_transform),
+        hdr_metadata(master.hdr_metadata)
 {
 }
 
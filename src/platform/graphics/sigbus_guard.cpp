@@ -0,0 +1,148 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/graphics/sigbus_guard.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <cstdint>
+#include <mutex>
+#include <system_error>
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace mg = mir::graphics;
+
+namespace
+{
+/// The range being accessed by this thread; only touched by this thread and its signal handler
+struct GuardedRange
+{
+    uintptr_t begin;
+    uintptr_t end;
+    bool truncated;
+};
+
+thread_local GuardedRange* guarded_range{nullptr};
+
+std::mutex handler_mutex;
+bool handler_installed{false};
+struct sigaction previous_action;
+
+void chain_to_previous_handler(int sig, siginfo_t* info, void* context)
+{
+    if (previous_action.sa_flags & SA_SIGINFO)
+    {
+        previous_action.sa_sigaction(sig, info, context);
+    }
+    else if (previous_action.sa_handler == SIG_DFL || previous_action.sa_handler == SIG_IGN)
+    {
+        // SIGBUS cannot usefully be ignored; restore the default behaviour and let it kill us
+        sigaction(SIGBUS, &previous_action, nullptr);
+        raise(SIGBUS);
+    }
+    else
+    {
+        previous_action.sa_handler(sig);
+    }
+}
+
+extern "C" void handle_sigbus(int sig, siginfo_t* info, void* context)
+{
+    auto const range = guarded_range;
+    auto const address = reinterpret_cast<uintptr_t>(info->si_addr);
+
+    if (!range || address < range->begin || address >= range->end)
+    {
+        chain_to_previous_handler(sig, info, context);
+        return;
+    }
+
+    // Replace the whole range so we take at most one fault per access
+    if (mmap(
+            reinterpret_cast<void*>(range->begin),
+            range->end - range->begin,
+            PROT_READ | PROT_WRITE,
+            MAP_FIXED | MAP_PRIVATE | MAP_ANONYMOUS,
+            -1, 0) == MAP_FAILED)
+    {
+        chain_to_previous_handler(sig, info, context);
+        return;
+    }
+
+    range->truncated = true;
+}
+}
+
+void mg::install_sigbus_guard_handler()
+{
+    std::lock_guard<std::mutex> lock{handler_mutex};
+    if (handler_installed)
+        return;
+
+    struct sigaction action{};
+    action.sa_sigaction = &handle_sigbus;
+    action.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sigemptyset(&action.sa_mask);
+
+    if (sigaction(SIGBUS, &action, &previous_action) != 0)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to install SIGBUS handler"}));
+    }
+    handler_installed = true;
+}
+
+void mg::remove_sigbus_guard_handler()
+{
+    std::lock_guard<std::mutex> lock{handler_mutex};
+    if (!handler_installed)
+        return;
+
+    sigaction(SIGBUS, &previous_action, nullptr);
+    handler_installed = false;
+}
+
+auto mg::access_guarding_sigbus(
+    void const* data,
+    size_t size,
+    std::function<void()> const& access) -> bool
+{
+    static auto const page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    auto const begin = reinterpret_cast<uintptr_t>(data);
+
+    GuardedRange range{
+        begin & ~(page_size - 1),
+        (begin + size + page_size - 1) & ~(page_size - 1),
+        false};
+
+    // The access may itself make a guarded access; restore the outer range afterwards
+    auto const outer_range = guarded_range;
+    guarded_range = &range;
+    try
+    {
+        access();
+    }
+    catch (...)
+    {
+        guarded_range = outer_range;
+        throw;
+    }
+    guarded_range = outer_range;
+
+    return !range.truncated;
+}
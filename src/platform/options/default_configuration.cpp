@@ -48,16 +48,22 @@ char const* const mo::cursor_opt                  = "cursor";
 char const* const mo::fatal_except_opt            = "on-fatal-error-except";
 char const* const mo::debug_opt                   = "debug";
 char const* const mo::composite_delay_opt         = "composite-delay";
+char const* const mo::idle_timeout_opt            = "idle-timeout";
+char const* const mo::renderer_opt                = "renderer";
 char const* const mo::enable_key_repeat_opt       = "enable-key-repeat";
 char const* const mo::x11_display_opt             = "enable-x11";
 char const* const mo::wayland_extensions_opt      = "wayland-extensions";
 char const* const mo::add_wayland_extensions_opt  = "add-wayland-extensions";
 char const* const mo::drop_wayland_extensions_opt = "drop-wayland-extensions";
 char const* const mo::enable_mirclient_opt        = "enable-mirclient";
+char const* const mo::metrics_socket_opt          = "metrics-socket";
+char const* const mo::client_buffer_quota_opt     = "client-buffer-quota";
+char const* const mo::texture_cache_budget_opt    = "texture-cache-budget";
 
 char const* const mo::off_opt_value = "off";
 char const* const mo::log_opt_value = "log";
 char const* const mo::lttng_opt_value = "lttng";
+char const* const mo::metrics_opt_value = "metrics";
 
 char const* const mo::platform_graphics_lib = "platform-graphics-lib";
 char const* const mo::platform_input_lib = "platform-input-lib";
@@ -158,32 +164,52 @@ mo::DefaultConfiguration::DefaultConfiguration(
         (enable_input_opt, po::value<bool>()->default_value(enable_input_default),
             "Enable input.")
         (compositor_report_opt, po::value<std::string>()->default_value(off_opt_value),
-            "Compositor reporting [{log,lttng,off}]")
+            "Compositor reporting [{log,lttng,metrics,off}]")
         (connector_report_opt, po::value<std::string>()->default_value(off_opt_value),
             "How to handle the Connector report. [{log,lttng,off}]")
         (display_report_opt, po::value<std::string>()->default_value(off_opt_value),
-            "How to handle the Display report. [{log,lttng,off}]")
+            "How to handle the Display report. [{log,lttng,metrics,off}]")
         (input_report_opt, po::value<std::string>()->default_value(off_opt_value),
-            "How to handle to Input report. [{log,lttng,off}]")
+            "How to handle to Input report. [{log,lttng,metrics,off}]")
         (legacy_input_report_opt, po::value<std::string>()->default_value(off_opt_value),
             "How to handle the Legacy Input report. [{log,off}]")
         (seat_report_opt, po::value<std::string>()->default_value(off_opt_value),
             "How to handle to Seat report. [{log,off}]")
         (session_mediator_report_opt, po::value<std::string>()->default_value(off_opt_value),
-            "How to handle the SessionMediator report. [{log,lttng,off}]")
+            "How to handle the SessionMediator report. [{log,lttng,metrics,off}]")
         (msg_processor_report_opt, po::value<std::string>()->default_value(off_opt_value),
-            "How to handle the MessageProcessor report. [{log,lttng,off}]")
+            "How to handle the MessageProcessor report. [{log,lttng,metrics,off}]")
         (scene_report_opt, po::value<std::string>()->default_value(off_opt_value),
-            "How to handle the scene report. [{log,lttng,off}]")
+            "How to handle the scene report. [{log,lttng,metrics,off}]")
         (shared_library_prober_report_opt, po::value<std::string>()->default_value(log_opt_value),
             "How to handle the SharedLibraryProber report. [{log,lttng,off}]")
         (shell_report_opt, po::value<std::string>()->default_value(off_opt_value),
          "How to handle the Shell report. [{log,off}]")
+        (metrics_socket_opt, po::value<std::string>(),
+            "Socket to serve the metrics reports on. "
+            "[string:default=$XDG_RUNTIME_DIR/mir_metrics]")
         (composite_delay_opt, po::value<int>()->default_value(0),
             "Compositor frame delay in milliseconds (how long to wait for new "
             "frames from clients before compositing). Higher values result in "
             "lower latency but risk causing frame skipping. "
             "Default: A negative value means decide automatically.")
+        (idle_timeout_opt, po::value<int>()->default_value(0),
+            "Time in seconds without user activity before the displays are dimmed "
+            "and then turned off. Zero means never.")
+        (renderer_opt, po::value<std::string>()->default_value("gl"),
+            "Compositing renderer to use [{gl,software}]. The software renderer "
+            "composites with the CPU and needs outputs and client buffers that "
+            "support CPU access.")
+        (client_buffer_quota_opt, po::value<int>()->default_value(0),
+            "Most buffer memory, in MiB, that each client connection may hold. "
+            "A client that tries to submit buffers beyond it is disconnected. "
+            "Only the client's buffers are counted: textures the GL renderer "
+            "caches from them are not (see --texture-cache-budget). "
+            "Zero means no limit.")
+        (texture_cache_budget_opt, po::value<int>()->default_value(64),
+            "Texture memory, in MiB, that the GL renderer keeps on each output "
+            "for surfaces it did not draw in the last frame, so that hidden "
+            "surfaces can be shown again without uploading their buffers again.")
         (offscreen_opt,
             "Render to offscreen buffers instead of the real outputs.")
         (touchspots_opt,
@@ -20,6 +20,7 @@
 #include "buffer_from_wl_shm.h"
 #include "shm_buffer.h"
 
+#include "mir/graphics/sigbus_guard.h"
 #include "mir/renderer/sw/pixel_source.h"
 #include "mir/executor.h"
 #include "mir/renderer/gl/context.h"
@@ -28,16 +29,24 @@
 #include "mir/log.h"
 
 #include <boost/throw_exception.hpp>
+#include <cstring>
 #include <mutex>
 #include <atomic>
+#include <unordered_map>
 
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
 
 #include <wayland-server-core.h>
 #include <wayland-server-protocol.h>
+#include <wayland-version.h>
 #include <cassert>
 
+#if (WAYLAND_VERSION_MAJOR > 1 || (WAYLAND_VERSION_MAJOR == 1 && WAYLAND_VERSION_MINOR >= 20))
+// libwayland defers resizing (and so possibly moving) a pool while the compositor holds a reference to it
+#define MIR_WL_SHM_POOL_MAPPING_IS_STABLE
+#endif
+
 namespace mg = mir::graphics;
 namespace mgc = mir::graphics::common;
 
@@ -302,6 +311,274 @@ private:
     }
 };
 
+class ShmPoolMapping;
+
+#ifdef MIR_WL_SHM_POOL_MAPPING_IS_STABLE
+/**
+ * A reference to the mapping of a client's wl_shm_pool
+ *
+ * All the buffers we import from a pool share one ShmPoolMapping. Holding it keeps the pool mapped,
+ * and at the same address, even after the client has destroyed the wl_buffer and wl_shm_pool, so
+ * the pixels can be read from any thread without going back to the Wayland resources.
+ *
+ * libwayland defers any wl_shm_pool.resize until the last reference goes, and until then rejects
+ * buffers in the new part of the pool. So buffers only hold this until they have been consumed,
+ * and ShmPoolKeeper lets go of it as soon as the client asks for a resize.
+ */
+class ShmPoolMapping
+{
+public:
+    /*
+     * NOTE: This must be called on the Wayland event loop
+     */
+    static auto for_buffer(
+        wl_resource* buffer,
+        wl_shm_buffer* shm_buffer,
+        std::shared_ptr<mir::Executor> const& wayland_executor) -> std::shared_ptr<ShmPoolMapping>;
+
+    /**
+     * Call do_with_pixels with the size bytes of pool data at pixels
+     *
+     * If the client has truncated the pool, the missing part reads as zeros.
+     */
+    void read(
+        unsigned char const* pixels,
+        size_t size,
+        std::function<void(unsigned char const*)> const& do_with_pixels)
+    {
+        if (!mg::access_guarding_sigbus(pixels, size, [&]() { do_with_pixels(pixels); }) &&
+            !truncation_reported.exchange(true))
+        {
+            mir::log_warning("Client truncated a wl_shm_pool in use; rendering will be incomplete");
+        }
+    }
+
+    /// Set while ShmPoolKeeper drops mappings on the Wayland event loop, so they can unref the pool at once
+    static thread_local bool on_wayland_loop;
+
+private:
+    explicit ShmPoolMapping(wl_shm_pool* pool)
+        : pool{pool}
+    {
+    }
+
+    ~ShmPoolMapping() = default;
+
+    /// Must be called on the Wayland event loop
+    static void release(ShmPoolMapping* mapping)
+    {
+        auto const cached = mappings.find(mapping->pool);
+        if (cached != mappings.end() && cached->second.expired())
+        {
+            mappings.erase(cached);
+        }
+        wl_shm_pool_unref(mapping->pool);
+        delete mapping;
+    }
+
+    /// Only accessed on the Wayland event loop
+    static std::unordered_map<wl_shm_pool*, std::weak_ptr<ShmPoolMapping>> mappings;
+
+    wl_shm_pool* const pool;
+    std::atomic<bool> truncation_reported{false};
+};
+
+std::unordered_map<wl_shm_pool*, std::weak_ptr<ShmPoolMapping>> ShmPoolMapping::mappings;
+thread_local bool ShmPoolMapping::on_wayland_loop{false};
+
+/**
+ * Keeps each pool's ShmPoolMapping for as long as the client has the wl_shm_pool
+ *
+ * Clients cycle through a few buffers from one pool, so this saves taking and dropping a pool
+ * reference for every frame. The mapping is let go when the client asks to resize the pool, so
+ * libwayland can remap it once the buffers in flight are consumed; the next import maps it afresh.
+ *
+ * NOTE: This is only used on the Wayland event loop
+ */
+class ShmPoolKeeper
+{
+public:
+    static void keep(wl_resource* buffer, wl_shm_pool* pool, std::shared_ptr<ShmPoolMapping> const& mapping)
+    {
+        static_assert(
+            std::is_standard_layout<Kept>::value,
+            "Kept must be Standard Layout for wl_container_of to be defined behaviour");
+
+        if (kept.count(pool))
+            return;
+
+        auto const client = wl_resource_get_client(buffer);
+        auto const pool_resource = find_pool_resource(client, pool);
+        if (!pool_resource)
+        {
+            // The client has already destroyed the pool, so it can't resize it or make more buffers from it
+            return;
+        }
+
+        watch_for_resizes(wl_client_get_display(client));
+
+        auto entry = std::make_unique<Kept>(pool, mapping);
+        wl_resource_add_destroy_listener(pool_resource, &entry->destroy_listener);
+        kept.emplace(pool, std::move(entry));
+    }
+
+private:
+    struct Kept
+    {
+        Kept(wl_shm_pool* pool, std::shared_ptr<ShmPoolMapping> mapping)
+            : pool{pool},
+              mapping{std::move(mapping)}
+        {
+            destroy_listener.notify = &on_pool_destroyed;
+        }
+
+        ~Kept()
+        {
+            wl_list_remove(&destroy_listener.link);
+        }
+
+        wl_shm_pool* const pool;
+        std::shared_ptr<ShmPoolMapping> const mapping;
+        wl_listener destroy_listener;
+    };
+
+    struct ResizeWatch
+    {
+        wl_protocol_logger* logger;
+        wl_listener destroy_listener;
+    };
+
+    static auto find_pool_resource(wl_client* client, wl_shm_pool* pool) -> wl_resource*
+    {
+        struct Search
+        {
+            wl_shm_pool* const pool;
+            wl_resource* found;
+        } search{pool, nullptr};
+
+        wl_client_for_each_resource(
+            client,
+            [](wl_resource* resource, void* context) -> wl_iterator_result
+            {
+                auto const search = static_cast<Search*>(context);
+                // libwayland's wl_shm_pool resources have the pool as their user data
+                if (strcmp(wl_resource_get_class(resource), wl_shm_pool_interface.name) == 0 &&
+                    wl_resource_get_user_data(resource) == search->pool)
+                {
+                    search->found = resource;
+                    return WL_ITERATOR_STOP;
+                }
+                return WL_ITERATOR_CONTINUE;
+            },
+            &search);
+
+        return search.found;
+    }
+
+    static void watch_for_resizes(wl_display* display)
+    {
+        if (resize_watches.count(display))
+            return;
+
+        auto watch = std::make_unique<ResizeWatch>();
+        watch->logger = wl_display_add_protocol_logger(display, &on_protocol_message, nullptr);
+        watch->destroy_listener.notify = &on_display_destroyed;
+        wl_display_add_destroy_listener(display, &watch->destroy_listener);
+        resize_watches.emplace(display, std::move(watch));
+    }
+
+    static void on_protocol_message(
+        void* /*user_data*/,
+        wl_protocol_logger_type type,
+        wl_protocol_logger_message const* message)
+    {
+        // wl_shm_pool.resize; the server protocol header only has event opcodes
+        int const resize_opcode{2};
+
+        // Loggers see requests before they are dispatched, so we let go before libwayland handles the resize
+        if (type == WL_PROTOCOL_LOGGER_REQUEST &&
+            message->message == &wl_shm_pool_interface.methods[resize_opcode])
+        {
+            release(static_cast<wl_shm_pool*>(wl_resource_get_user_data(message->resource)));
+        }
+    }
+
+    static void on_pool_destroyed(wl_listener* listener, void*)
+    {
+        Kept* entry;
+        entry = wl_container_of(listener, entry, destroy_listener);
+        release(entry->pool);
+    }
+
+    static void on_display_destroyed(wl_listener* listener, void* data)
+    {
+        auto const watch = resize_watches.find(static_cast<wl_display*>(data));
+        if (watch != resize_watches.end())
+        {
+            wl_protocol_logger_destroy(watch->second->logger);
+            resize_watches.erase(watch);
+        }
+        (void)listener;
+    }
+
+    static void release(wl_shm_pool* pool)
+    {
+        auto const entry = kept.find(pool);
+        if (entry == kept.end())
+            return;
+
+        auto released = std::move(entry->second);
+        kept.erase(entry);
+
+        // We're on the Wayland event loop, so the pool can be unreferenced straight away
+        ShmPoolMapping::on_wayland_loop = true;
+        released.reset();
+        ShmPoolMapping::on_wayland_loop = false;
+    }
+
+    static std::unordered_map<wl_shm_pool*, std::unique_ptr<Kept>> kept;
+    static std::unordered_map<wl_display*, std::unique_ptr<ResizeWatch>> resize_watches;
+};
+
+std::unordered_map<wl_shm_pool*, std::unique_ptr<ShmPoolKeeper::Kept>> ShmPoolKeeper::kept;
+std::unordered_map<wl_display*, std::unique_ptr<ShmPoolKeeper::ResizeWatch>> ShmPoolKeeper::resize_watches;
+
+auto ShmPoolMapping::for_buffer(
+    wl_resource* buffer,
+    wl_shm_buffer* shm_buffer,
+    std::shared_ptr<mir::Executor> const& wayland_executor) -> std::shared_ptr<ShmPoolMapping>
+{
+    auto const pool = wl_shm_buffer_ref_pool(shm_buffer);
+    auto& cached = mappings[pool];
+
+    if (auto const existing = cached.lock())
+    {
+        // existing already holds a reference to the pool
+        wl_shm_pool_unref(pool);
+        return existing;
+    }
+
+    std::shared_ptr<ShmPoolMapping> const mapping{
+        new ShmPoolMapping{pool},
+        [wayland_executor](ShmPoolMapping* mapping)
+        {
+            if (on_wayland_loop)
+            {
+                release(mapping);
+            }
+            else
+            {
+                // The pool reference count is only safe to touch on the Wayland event loop
+                wayland_executor->spawn([mapping]() { release(mapping); });
+            }
+        }};
+
+    cached = mapping;
+    ShmPoolKeeper::keep(buffer, pool, mapping);
+    return mapping;
+}
+#endif
+
 class WlShmBuffer :
     public mg::common::ShmBuffer,
     public mir::renderer::software::PixelSource
@@ -309,6 +586,8 @@ class WlShmBuffer :
 public:
     WlShmBuffer(
         SharedWlBuffer buffer,
+        std::shared_ptr<ShmPoolMapping> pool_mapping,
+        unsigned char const* pixels,
         std::shared_ptr<mgc::EGLContextExecutor> egl_delegate,
         mir::geometry::Size const& size,
         mir::geometry::Stride stride,
@@ -317,6 +596,8 @@ public:
         : ShmBuffer(size, format, std::move(egl_delegate)),
           on_consumed{std::move(on_consumed)},
           buffer{std::move(buffer)},
+          pool_mapping{std::move(pool_mapping)},
+          pixels{pixels},
           stride_{stride}
     {
     }
@@ -333,12 +614,12 @@ public:
         if (!uploaded)
         {
             read_internal(
+                pool_mapping,
                 [this](unsigned char const* pixels)
                 {
                     upload_to_texture(pixels, stride());
                 });
-            on_consumed();
-            on_consumed = [](){};
+            consumed();
             uploaded = true;
         }
     }
@@ -351,11 +632,15 @@ public:
 
     void read(std::function<void(unsigned char const*)> const& do_with_pixels) override
     {
-        read_internal(do_with_pixels);
+        std::shared_ptr<ShmPoolMapping> mapping;
+        {
+            std::lock_guard<std::mutex> lock{consumption_mutex};
+            mapping = pool_mapping;
+        }
+        read_internal(mapping, do_with_pixels);
         {
             std::lock_guard<std::mutex> lock{consumption_mutex};
-            on_consumed();
-            on_consumed = [](){};
+            consumed();
         }
     }
 
@@ -365,8 +650,28 @@ public:
     }
 
 private:
-    void read_internal(std::function<void(unsigned char const*)> const& do_with_pixels)
+    /// Called with consumption_mutex held
+    void consumed()
     {
+        on_consumed();
+        on_consumed = [](){};
+        // Let the client resize the pool; any later reads go through the wl_buffer
+        pool_mapping.reset();
+    }
+
+    void read_internal(
+        std::shared_ptr<ShmPoolMapping> const& mapping,
+        std::function<void(unsigned char const*)> const& do_with_pixels)
+    {
+#ifdef MIR_WL_SHM_POOL_MAPPING_IS_STABLE
+        if (mapping)
+        {
+            mapping->read(pixels, size_t{stride_.as_uint32_t()} * size().height.as_uint32_t(), do_with_pixels);
+            return;
+        }
+#else
+        (void)mapping;
+#endif
         if (auto const locked_buffer = buffer.lock())
         {
             auto const shm_buffer = wl_shm_buffer_get(locked_buffer);
@@ -385,6 +690,9 @@ private:
     bool uploaded{false};
     std::function<void()> on_consumed;
     SharedWlBuffer const buffer;
+    /// Until consumed, pixels points into this mapping and is read without locking buffer
+    std::shared_ptr<ShmPoolMapping> pool_mapping;
+    unsigned char const* const pixels;
     mir::geometry::Stride const stride_;
 };
 
@@ -399,8 +707,18 @@ auto mg::wayland::buffer_from_wl_shm(
     {
         BOOST_THROW_EXCEPTION((std::logic_error{"Attempt to import a non-SHM buffer as a SHM buffer"}));
     }
+
+#ifdef MIR_WL_SHM_POOL_MAPPING_IS_STABLE
+    auto pool_mapping = ShmPoolMapping::for_buffer(buffer, shm_buffer, executor);
+#else
+    std::shared_ptr<ShmPoolMapping> pool_mapping;
+#endif
+    auto const pixels = static_cast<unsigned char const*>(wl_shm_buffer_get_data(shm_buffer));
+
     return std::make_shared<WlShmBuffer>(
-        SharedWlBuffer{buffer, std::move(executor)},
+        SharedWlBuffer{buffer, executor},
+        std::move(pool_mapping),
+        pixels,
         std::move(egl_delegate),
         mir::geometry::Size{
             wl_shm_buffer_get_width(shm_buffer),
@@ -0,0 +1,236 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "drm_event_dispatcher.h"
+
+#include <boost/throw_exception.hpp>
+#include <boost/exception/enable_error_info.hpp>
+#include <boost/exception/info.hpp>
+
+#include <xf86drm.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <system_error>
+
+namespace mgk = mir::graphics::kms;
+
+namespace
+{
+auto error_from_errno(char const* message) -> std::exception_ptr
+{
+    return std::make_exception_ptr(
+        boost::enable_error_info(std::system_error{errno, std::system_category(), message})
+            << boost::throw_file(__FILE__)
+            << boost::throw_line(__LINE__)
+            << boost::throw_function(__PRETTY_FUNCTION__));
+}
+}
+
+mgk::DRMEventDispatcher::DRMEventDispatcher(mir::Fd drm_fd)
+    : drm_fd{std::move(drm_fd)},
+      shutdown_signal{eventfd(0, EFD_CLOEXEC)}
+{
+    if (shutdown_signal == mir::Fd::invalid)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{
+            errno,
+            std::system_category(),
+            "Failed to create DRM event dispatcher shutdown eventfd"}));
+    }
+
+    dispatch_thread = std::thread{[this]() { dispatch_loop(); }};
+}
+
+mgk::DRMEventDispatcher::~DRMEventDispatcher()
+{
+    uint64_t const one{1};
+    if (write(shutdown_signal, &one, sizeof(one)) == sizeof(one))
+    {
+        dispatch_thread.join();
+    }
+    else
+    {
+        // We can't stop it, but we mustn't crash on exit either
+        dispatch_thread.detach();
+    }
+}
+
+auto mgk::DRMEventDispatcher::event_data_for(CrtcId crtc) -> void*
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    return &crtcs.emplace(crtc, Crtc{this, crtc, {}}).first->second;
+}
+
+auto mgk::DRMEventDispatcher::expect_flip_event(CrtcId crtc, FlipHandler on_flip) -> std::future<void>
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto& slot = crtcs.emplace(crtc, Crtc{this, crtc, {}}).first->second;
+    if (slot.expected)
+    {
+        BOOST_THROW_EXCEPTION((std::logic_error{"Flip event for CRTC is already expected"}));
+    }
+
+    if (dispatch_error)
+    {
+        // Nothing is reading events any more, so this flip would never complete
+        std::promise<void> failed;
+        failed.set_exception(dispatch_error);
+        return failed.get_future();
+    }
+
+    slot.expected = Expectation{std::move(on_flip), std::promise<void>{}};
+    return slot.expected->completion.get_future();
+}
+
+void mgk::DRMEventDispatcher::cancel_flip_event(CrtcId crtc)
+{
+    std::experimental::optional<Expectation> cancelled;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        auto const slot = crtcs.find(crtc);
+        if (slot != crtcs.end())
+        {
+            std::swap(cancelled, slot->second.expected);
+        }
+    }
+
+    if (cancelled)
+    {
+        cancelled->completion.set_value();
+    }
+}
+
+void mgk::DRMEventDispatcher::flip_handler(
+    int /*drm_fd*/,
+    unsigned int frame_number,
+    unsigned int sec,
+    unsigned int usec,
+    void* data) noexcept
+{
+    /*
+     * No need to lock; this is only called from drmHandleEvent() on the dispatch thread,
+     * which holds the lock while calling it.
+     */
+    auto const crtc = static_cast<Crtc*>(data);
+    if (crtc->expected)
+    {
+        crtc->dispatcher->completed.push_back(Completion{
+            std::move(*crtc->expected),
+            frame_number,
+            std::chrono::seconds{sec} + std::chrono::microseconds{usec}});
+        crtc->expected = {};
+    }
+}
+
+void mgk::DRMEventDispatcher::dispatch_loop() noexcept
+{
+    drmEventContext ctx;
+    ::memset(&ctx, 0, sizeof(ctx));
+    ctx.version = 2;
+    ctx.page_flip_handler = &flip_handler;
+
+    for (;;)
+    {
+        pollfd fds[2] = {
+            {shutdown_signal, POLLIN, 0},
+            {drm_fd, POLLIN, 0}};
+
+        if (::poll(fds, 2, -1) == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            stop_dispatching(error_from_errno("Error waiting for DRM event"));
+            return;
+        }
+
+        if (fds[0].revents)
+        {
+            return;
+        }
+
+        if (fds[1].revents & (POLLERR | POLLHUP | POLLNVAL))
+        {
+            errno = EIO;
+            stop_dispatching(error_from_errno("DRM device failed"));
+            return;
+        }
+
+        if (fds[1].revents & POLLIN)
+        {
+            bool handled;
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                handled = drmHandleEvent(drm_fd, &ctx) == 0;
+            }
+
+            // Callbacks run without the lock so they may take their own locks and expect new flips
+            for (auto& flip : completed)
+            {
+                try
+                {
+                    flip.expectation.on_flip(flip.frame_number, flip.frame_time);
+                    flip.expectation.completion.set_value();
+                }
+                catch (...)
+                {
+                    flip.expectation.completion.set_exception(std::current_exception());
+                }
+            }
+            completed.clear();
+
+            if (!handled)
+            {
+                fail_all_expectations(error_from_errno("Failed to handle DRM event"));
+            }
+        }
+    }
+}
+
+void mgk::DRMEventDispatcher::stop_dispatching(std::exception_ptr const& error)
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        dispatch_error = error;
+    }
+    fail_all_expectations(error);
+}
+
+void mgk::DRMEventDispatcher::fail_all_expectations(std::exception_ptr const& error)
+{
+    std::vector<Expectation> failed;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        for (auto& crtc : crtcs)
+        {
+            if (crtc.second.expected)
+            {
+                failed.push_back(std::move(*crtc.second.expected));
+                crtc.second.expected = {};
+            }
+        }
+    }
+
+    for (auto& expectation : failed)
+    {
+        expectation.completion.set_exception(error);
+    }
+}
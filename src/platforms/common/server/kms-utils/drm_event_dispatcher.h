@@ -0,0 +1,125 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_COMMON_KMS_UTILS_DRM_EVENT_DISPATCHER_H_
+#define MIR_GRAPHICS_COMMON_KMS_UTILS_DRM_EVENT_DISPATCHER_H_
+
+#include "mir/fd.h"
+
+#include <chrono>
+#include <cstdint>
+#include <experimental/optional>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+namespace kms
+{
+/**
+ * Dispatches the events of a DRM device from a dedicated thread
+ *
+ * There should be one of these per DRM device, shared by everything that flips on it. Each flip
+ * completion is delivered to whoever is waiting on that CRTC, so nothing waiting for one output
+ * is woken (or blocked) by another.
+ */
+class DRMEventDispatcher
+{
+public:
+    using CrtcId = uint32_t;
+    using FlipHandler = std::function<void(unsigned int frame_number, std::chrono::nanoseconds frame_time)>;
+
+    explicit DRMEventDispatcher(mir::Fd drm_fd);
+    ~DRMEventDispatcher();
+
+    DRMEventDispatcher(DRMEventDispatcher const&) = delete;
+    DRMEventDispatcher& operator=(DRMEventDispatcher const&) = delete;
+
+    /// The user data to submit with a flip of crtc (e.g. to drmModePageFlip())
+    auto event_data_for(CrtcId crtc) -> void*;
+
+    /**
+     * Expect a flip event for crtc
+     *
+     * This must be called before the flip is submitted to the kernel.
+     *
+     * \param on_flip   Called on the dispatch thread when the flip completes. The frame time is
+     *                  from the clock reported by DRM_CAP_TIMESTAMP_MONOTONIC.
+     * \return          Becomes ready after on_flip has returned, or holds an exception if
+     *                  reading DRM events fails (or already has, so the flip would never be seen).
+     */
+    auto expect_flip_event(CrtcId crtc, FlipHandler on_flip) -> std::future<void>;
+
+    /// Abandon an expected flip that was never submitted
+    void cancel_flip_event(CrtcId crtc);
+
+private:
+    struct Expectation
+    {
+        FlipHandler on_flip;
+        std::promise<void> completion;
+    };
+
+    struct Crtc
+    {
+        DRMEventDispatcher* const dispatcher;
+        CrtcId const id;
+        std::experimental::optional<Expectation> expected;
+    };
+
+    struct Completion
+    {
+        Expectation expectation;
+        unsigned int frame_number;
+        std::chrono::nanoseconds frame_time;
+    };
+
+    static void flip_handler(
+        int drm_fd,
+        unsigned int frame_number,
+        unsigned int sec,
+        unsigned int usec,
+        void* data) noexcept;
+
+    void dispatch_loop() noexcept;
+    void fail_all_expectations(std::exception_ptr const& error);
+    /// Fail everything expected now or later, as the dispatch thread is exiting
+    void stop_dispatching(std::exception_ptr const& error);
+
+    mir::Fd const drm_fd;
+    mir::Fd const shutdown_signal;
+
+    std::mutex mutex;
+    /// Node-based, so the Crtc addresses given to the kernel stay valid
+    std::unordered_map<CrtcId, Crtc> crtcs;
+    /// Why the dispatch thread stopped, if it has failed
+    std::exception_ptr dispatch_error;
+    /// Flips completed during the current drmHandleEvent(); only touched on the dispatch thread
+    std::vector<Completion> completed;
+
+    std::thread dispatch_thread;
+};
+}
+}
+}
+
+#endif // MIR_GRAPHICS_COMMON_KMS_UTILS_DRM_EVENT_DISPATCHER_H_
@@ -22,6 +22,7 @@
 #include "mir/graphics/program_factory.h"
 #include "mir/graphics/program.h"
 #include "egl_context_executor.h"
+#include "shm_buffer_pool.h"
 
 #define MIR_LOG_COMPONENT "gfx-common"
 #include "mir/log.h"
@@ -110,10 +111,45 @@ mgc::MemoryBackedShmBuffer::MemoryBackedShmBuffer(
     std::shared_ptr<EGLContextExecutor> egl_delegate)
     : ShmBuffer(size, pixel_format, std::move(egl_delegate)),
       stride_{MIR_BYTES_PER_PIXEL(pixel_format) * size.width.as_uint32_t()},
-      pixels{new unsigned char[stride_.as_int() * size.height.as_int()]}
+      capacity{stride_.as_uint32_t() * size.height.as_uint32_t()},
+      pixels{new unsigned char[capacity]}
 {
 }
 
+mgc::MemoryBackedShmBuffer::MemoryBackedShmBuffer(
+    geom::Size const& size,
+    MirPixelFormat const& pixel_format,
+    std::shared_ptr<EGLContextExecutor> egl_delegate,
+    std::shared_ptr<ShmBufferPool> const& pool)
+    : MemoryBackedShmBuffer(size, pixel_format, std::move(egl_delegate), pool, pool->take_pixels(
+          MIR_BYTES_PER_PIXEL(pixel_format) * size.width.as_uint32_t() * size.height.as_uint32_t()))
+{
+}
+
+mgc::MemoryBackedShmBuffer::MemoryBackedShmBuffer(
+    geom::Size const& size,
+    MirPixelFormat const& pixel_format,
+    std::shared_ptr<EGLContextExecutor> egl_delegate,
+    std::shared_ptr<ShmBufferPool> const& pool,
+    PixelStorage&& storage)
+    : ShmBuffer(size, pixel_format, std::move(egl_delegate)),
+      stride_{MIR_BYTES_PER_PIXEL(pixel_format) * size.width.as_uint32_t()},
+      pool{pool},
+      capacity{storage.capacity},
+      pixels{std::move(storage.data)}
+{
+    if (auto const texture = pool->take_texture(size, pixel_format))
+        adopt_texture(texture);
+}
+
+mgc::MemoryBackedShmBuffer::~MemoryBackedShmBuffer() noexcept
+{
+    if (auto const recycler = pool.lock())
+    {
+        recycler->recycle({std::move(pixels), capacity}, release_texture(), size(), pixel_format());
+    }
+}
+
 mgc::ShmBuffer::~ShmBuffer() noexcept
 {
     if (tex_id != 0)
@@ -161,15 +197,31 @@ void mgc::ShmBuffer::upload_to_texture(void const* pixels, geom::Stride const& s
         glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, stride_in_px);
         glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            format,
-            size().width.as_int(), size().height.as_int(),
-            0,
-            format,
-            type,
-            pixels);
+        if (tex_allocated)
+        {
+            // A recycled texture already has storage of the right size and format
+            glTexSubImage2D(
+                GL_TEXTURE_2D,
+                0,
+                0, 0,
+                size().width.as_int(), size().height.as_int(),
+                format,
+                type,
+                pixels);
+        }
+        else
+        {
+            glTexImage2D(
+                GL_TEXTURE_2D,
+                0,
+                format,
+                size().width.as_int(), size().height.as_int(),
+                0,
+                format,
+                type,
+                pixels);
+            tex_allocated = true;
+        }
 
         // Be nice to other users of the GL context by reverting our changes to shared state
         glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, 0);     // 0 is default, meaning “use width”
@@ -184,6 +236,22 @@ void mgc::ShmBuffer::upload_to_texture(void const* pixels, geom::Stride const& s
     }
 }
 
+void mgc::ShmBuffer::adopt_texture(GLuint texture)
+{
+    std::lock_guard<decltype(tex_id_mutex)> lock{tex_id_mutex};
+    tex_id = texture;
+    tex_allocated = true;
+}
+
+auto mgc::ShmBuffer::release_texture() -> GLuint
+{
+    std::lock_guard<decltype(tex_id_mutex)> lock{tex_id_mutex};
+    auto const texture = tex_allocated ? tex_id : 0;
+    if (texture)
+        tex_id = 0;
+    return texture;
+}
+
 void mgc::MemoryBackedShmBuffer::write(unsigned char const* data, size_t data_size)
 {
     if (data_size != stride_.as_uint32_t()*size().height.as_uint32_t())
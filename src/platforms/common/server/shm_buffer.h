@@ -31,6 +31,7 @@
 
 #include <GLES2/gl2.h>
 
+#include <memory>
 #include <mutex>
 
 namespace mir
@@ -42,6 +43,7 @@ namespace graphics
 namespace common
 {
 class EGLContextExecutor;
+class ShmBufferPool;
 
 class ShmBuffer :
     public BufferBasic,
@@ -69,12 +71,25 @@ protected:
 
     /// \note This must be called with a current GL context
     void upload_to_texture(void const* pixels, geometry::Stride const& stride);
+
+    /// Use an existing texture, already allocated with this buffer's size and format
+    void adopt_texture(GLuint texture);
+    /// Give up ownership of the texture (if any), so it is not deleted with the buffer
+    auto release_texture() -> GLuint;
 private:
     geometry::Size const size_;
     MirPixelFormat const pixel_format_;
     std::shared_ptr<EGLContextExecutor> const egl_delegate;
     std::mutex tex_id_mutex;
     GLuint tex_id{0};
+    bool tex_allocated{false};
+};
+
+/// Pixel memory for a MemoryBackedShmBuffer; may be larger than the buffer needs
+struct PixelStorage
+{
+    std::unique_ptr<unsigned char[]> data;
+    size_t capacity;
 };
 
 class MemoryBackedShmBuffer :
@@ -87,6 +102,16 @@ public:
         MirPixelFormat const& pixel_format,
         std::shared_ptr<EGLContextExecutor> egl_delegate);
 
+    /// Takes pixel storage, and a texture when one is available, from the pool and
+    /// returns them to it on destruction
+    MemoryBackedShmBuffer(
+        geometry::Size const& size,
+        MirPixelFormat const& pixel_format,
+        std::shared_ptr<EGLContextExecutor> egl_delegate,
+        std::shared_ptr<ShmBufferPool> const& pool);
+
+    ~MemoryBackedShmBuffer() noexcept override;
+
     void write(unsigned char const* data, size_t size) override;
     void read(std::function<void(unsigned char const*)> const& do_with_pixels) override;
     geometry::Stride stride() const override;
@@ -98,8 +123,17 @@ public:
     MemoryBackedShmBuffer(MemoryBackedShmBuffer const&) = delete;
     MemoryBackedShmBuffer& operator=(MemoryBackedShmBuffer const&) = delete;
 private:
+    MemoryBackedShmBuffer(
+        geometry::Size const& size,
+        MirPixelFormat const& pixel_format,
+        std::shared_ptr<EGLContextExecutor> egl_delegate,
+        std::shared_ptr<ShmBufferPool> const& pool,
+        PixelStorage&& storage);
+
     geometry::Stride const stride_;
-    std::unique_ptr<unsigned char[]> const pixels;
+    std::weak_ptr<ShmBufferPool> const pool;
+    size_t const capacity;
+    std::unique_ptr<unsigned char[]> pixels;
     std::mutex uploaded_mutex;
     bool uploaded{false};
 };
@@ -0,0 +1,142 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "shm_buffer_pool.h"
+#include "egl_context_executor.h"
+
+#include <vector>
+
+namespace mgc = mir::graphics::common;
+namespace geom = mir::geometry;
+
+namespace
+{
+size_t const min_bucket = 4096;
+
+// Rounds up to a quarter of the power of two below size: at most 25% is wasted
+auto bucket_for(size_t size) -> size_t
+{
+    if (size <= min_bucket)
+        return min_bucket;
+
+    size_t power = min_bucket;
+    while (power * 2 <= size)
+        power *= 2;
+
+    auto const step = power / 4;
+    return (size + step - 1) / step * step;
+}
+}
+
+mgc::ShmBufferPool::ShmBufferPool(
+    std::shared_ptr<EGLContextExecutor> egl_delegate,
+    size_t max_cached_bytes,
+    size_t max_cached_textures) :
+    egl_delegate{std::move(egl_delegate)},
+    max_cached_bytes{max_cached_bytes},
+    max_cached_textures{max_cached_textures}
+{
+}
+
+mgc::ShmBufferPool::~ShmBufferPool()
+{
+    if (free_textures.empty())
+        return;
+
+    std::vector<GLuint> textures;
+    for (auto const& texture : free_textures)
+        textures.push_back(texture.second);
+
+    egl_delegate->spawn(
+        [textures = std::move(textures)]()
+        {
+            glDeleteTextures(textures.size(), textures.data());
+        });
+}
+
+auto mgc::ShmBufferPool::alloc(geom::Size size, MirPixelFormat format) -> std::shared_ptr<MemoryBackedShmBuffer>
+{
+    return std::make_shared<MemoryBackedShmBuffer>(size, format, egl_delegate, shared_from_this());
+}
+
+auto mgc::ShmBufferPool::take_pixels(size_t size) -> PixelStorage
+{
+    auto const bucket = bucket_for(size);
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+
+        // Don't tie up a much larger block for a small buffer
+        auto const cached = free_pixels.lower_bound(bucket);
+        if (cached != free_pixels.end() && cached->first <= 2 * bucket)
+        {
+            PixelStorage result{std::move(cached->second), cached->first};
+            free_bytes -= cached->first;
+            free_pixels.erase(cached);
+            return result;
+        }
+    }
+
+    return {std::unique_ptr<unsigned char[]>{new unsigned char[bucket]}, bucket};
+}
+
+auto mgc::ShmBufferPool::take_texture(geom::Size size, MirPixelFormat format) -> GLuint
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    auto const cached = free_textures.find(TextureKey{size.width.as_int(), size.height.as_int(), format});
+    if (cached == free_textures.end())
+        return 0;
+
+    auto const texture = cached->second;
+    free_textures.erase(cached);
+    return texture;
+}
+
+void mgc::ShmBufferPool::recycle(PixelStorage&& pixels, GLuint texture, geom::Size size, MirPixelFormat format)
+{
+    std::unique_lock<decltype(mutex)> lock{mutex};
+
+    if (pixels.data && free_bytes + pixels.capacity <= max_cached_bytes)
+    {
+        free_bytes += pixels.capacity;
+        free_pixels.emplace(pixels.capacity, std::move(pixels.data));
+    }
+
+    if (texture)
+    {
+        if (free_textures.size() < max_cached_textures)
+        {
+            free_textures.emplace(TextureKey{size.width.as_int(), size.height.as_int(), format}, texture);
+        }
+        else
+        {
+            lock.unlock();
+            egl_delegate->spawn([texture]() { glDeleteTextures(1, &texture); });
+        }
+    }
+}
+
+auto mgc::ShmBufferPool::cached_bytes() const -> size_t
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    return free_bytes;
+}
+
+auto mgc::ShmBufferPool::cached_textures() const -> size_t
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    return free_textures.size();
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_COMMON_SHM_BUFFER_POOL_H_
+#define MIR_GRAPHICS_COMMON_SHM_BUFFER_POOL_H_
+
+#include "shm_buffer.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+namespace mir
+{
+namespace graphics
+{
+namespace common
+{
+class EGLContextExecutor;
+
+/**
+ * Recycles the pixel storage and textures of server-allocated software buffers.
+ *
+ * Server-side producers (decorations, cursors, touchspots, internal clients)
+ * allocate a new buffer for every redraw, and during an interactive resize the
+ * size changes every time. Storage is kept in size buckets a quarter of a power
+ * of two apart, so a buffer a little larger than the last can reuse its storage;
+ * textures are only reused by buffers of exactly the same size and format.
+ */
+class ShmBufferPool : public std::enable_shared_from_this<ShmBufferPool>
+{
+public:
+    ShmBufferPool(
+        std::shared_ptr<EGLContextExecutor> egl_delegate,
+        size_t max_cached_bytes = 32 * 1024 * 1024,
+        size_t max_cached_textures = 16);
+    ~ShmBufferPool();
+
+    auto alloc(geometry::Size size, MirPixelFormat format) -> std::shared_ptr<MemoryBackedShmBuffer>;
+
+    /// Storage of at least size bytes, recycled if possible
+    auto take_pixels(size_t size) -> PixelStorage;
+    /// A texture allocated with this size and format, or 0 if none is cached
+    auto take_texture(geometry::Size size, MirPixelFormat format) -> GLuint;
+    /// Keep storage and (if non-zero) texture for reuse, within the pool's limits
+    void recycle(PixelStorage&& pixels, GLuint texture, geometry::Size size, MirPixelFormat format);
+
+    auto cached_bytes() const -> size_t;
+    auto cached_textures() const -> size_t;
+
+    ShmBufferPool(ShmBufferPool const&) = delete;
+    ShmBufferPool& operator=(ShmBufferPool const&) = delete;
+
+private:
+    using TextureKey = std::tuple<int, int, MirPixelFormat>;
+
+    std::shared_ptr<EGLContextExecutor> const egl_delegate;
+    size_t const max_cached_bytes;
+    size_t const max_cached_textures;
+
+    std::mutex mutable mutex;
+    std::multimap<size_t, std::unique_ptr<unsigned char[]>> free_pixels;
+    size_t free_bytes{0};
+    std::multimap<TextureKey, GLuint> free_textures;
+};
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_COMMON_SHM_BUFFER_POOL_H_ */
@@ -23,6 +23,7 @@
 #include "buffer_texture_binder.h"
 #include "mir/anonymous_shm_file.h"
 #include "shm_buffer.h"
+#include "shm_buffer_pool.h"
 #include "buffer_from_wl_shm.h"
 #include "mir/graphics/buffer_properties.h"
 #include "mir/renderer/gl/context_source.h"
@@ -97,7 +98,8 @@ std::unique_ptr<mir::renderer::gl::Context> context_for_output(mg::Display const
 mge::BufferAllocator::BufferAllocator(mg::Display const& output)
     : wayland_ctx{context_for_output(output)},
       egl_delegate{
-          std::make_shared<mgc::EGLContextExecutor>(context_for_output(output))}
+          std::make_shared<mgc::EGLContextExecutor>(context_for_output(output))},
+      software_buffers{std::make_shared<mgc::ShmBufferPool>(egl_delegate)}
 {
 }
 
@@ -112,7 +114,7 @@ std::shared_ptr<mg::Buffer> mge::BufferAllocator::alloc_software_buffer(geom::Si
                 "Trying to create SHM buffer with unsupported pixel format"));
     }
 
-    return std::make_shared<mgc::MemoryBackedShmBuffer>(size, format, egl_delegate);
+    return software_buffers->alloc(size, format);
 }
 
 std::vector<MirPixelFormat> mge::BufferAllocator::supported_pixel_formats()
@@ -46,6 +46,10 @@ namespace gl
 {
 class Program;
 }
+namespace common
+{
+class ShmBufferPool;
+}
 
 namespace eglstream
 {
@@ -89,6 +93,7 @@ private:
     EGLExtensions::LazyDisplayExtensions<EGLExtensions::NVStreamAttribExtensions> const nv_extensions;
     std::shared_ptr<renderer::gl::Context> const wayland_ctx;
     std::shared_ptr<common::EGLContextExecutor> const egl_delegate;
+    std::shared_ptr<common::ShmBufferPool> const software_buffers;
     std::unique_ptr<gl::Program> shader;
     static struct wl_eglstream_controller_interface const impl;
 };
@@ -22,7 +22,7 @@
 #include "egl_output.h"
 
 #include "kms-utils/drm_mode_resources.h"
-#include "threaded_drm_event_handler.h"
+#include "kms-utils/drm_event_dispatcher.h"
 
 #include "mir/graphics/display_configuration.h"
 #include "mir/graphics/display_configuration_policy.h"
@@ -136,7 +136,7 @@ public:
         EGLDisplay dpy,
         EGLContext ctx,
         EGLConfig config,
-        std::shared_ptr<mge::DRMEventHandler> event_handler,
+        std::shared_ptr<mg::kms::DRMEventDispatcher> event_dispatcher,
         mge::kms::EGLOutput const& output,
         std::shared_ptr<mg::DisplayReport> display_report)
         : dpy{dpy},
@@ -146,7 +146,7 @@ public:
           view_area_{output.extents()},
           transform{output.transformation()},
           drm_node{std::move(drm_node)},
-          event_handler{std::move(event_handler)},
+          event_dispatcher{std::move(event_dispatcher)},
           display_report{std::move(display_report)}
     {
         EGLint const stream_attribs[] = {
@@ -252,9 +252,9 @@ public:
         // Wait for the last flip to finish, if it hasn't already.
         pending_flip.get();
 
-        pending_flip = event_handler->expect_flip_event(
+        pending_flip = event_dispatcher->expect_flip_event(
             crtc_id,
-            [this](unsigned frame_count, std::chrono::milliseconds frame_time)
+            [this](unsigned frame_count, std::chrono::nanoseconds frame_time)
             {
                 // TODO: Um, why does NVIDIA always call this with 0, 0ms?
                 display_report->report_vsync(
@@ -265,7 +265,7 @@ public:
             });
 
         EGLAttrib const acquire_attribs[] = {
-            EGL_DRM_FLIP_EVENT_DATA_NV, reinterpret_cast<EGLAttrib>(event_handler->drm_event_data()),
+            EGL_DRM_FLIP_EVENT_DATA_NV, reinterpret_cast<EGLAttrib>(event_dispatcher->event_data_for(crtc_id)),
             EGL_NONE
         };
         if (nv_stream(dpy).eglStreamConsumerAcquireAttribNV(dpy, output_stream, acquire_attribs) != EGL_TRUE)
@@ -294,7 +294,7 @@ private:
     EGLStreamKHR output_stream;
     EGLSurface surface;
     mir::Fd const drm_node;
-    std::shared_ptr<mge::DRMEventHandler> const event_handler;
+    std::shared_ptr<mg::kms::DRMEventDispatcher> const event_dispatcher;
     std::future<void> pending_flip;
     mg::EGLExtensions::LazyDisplayExtensions<mg::EGLExtensions::NVStreamAttribExtensions> nv_stream;
     std::shared_ptr<mg::DisplayReport> const display_report;
@@ -325,7 +325,7 @@ mge::Display::Display(
       config{choose_config(display, gl_conf)},
       context{create_context(display, config)},
       display_configuration{create_display_configuration(this->drm_node, display, context)},
-      event_handler{std::make_shared<ThreadedDRMEventHandler>(drm_node)},
+      event_dispatcher{std::make_shared<mg::kms::DRMEventDispatcher>(drm_node)},
       display_report{std::move(display_report)}
 {
     auto ret = drmSetClientCap(drm_node, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1);
@@ -374,7 +374,7 @@ void mge::Display::configure(DisplayConfiguration const& conf)
                          display,
                          context,
                          config,
-                         event_handler,
+                         event_dispatcher,
                          output,
                          display_report));
              }
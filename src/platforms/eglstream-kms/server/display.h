@@ -34,9 +34,13 @@ class DisplayConfigurationPolicy;
 class GLConfig;
 class DisplayReport;
 
+namespace kms
+{
+class DRMEventDispatcher;
+}
+
 namespace eglstream
 {
-class DRMEventHandler;
 
 class Display : public mir::graphics::Display
 {
@@ -82,7 +86,7 @@ private:
     std::mutex mutable configuration_mutex;
     KMSDisplayConfiguration display_configuration;
 
-    std::shared_ptr<DRMEventHandler> const event_handler;
+    std::shared_ptr<graphics::kms::DRMEventDispatcher> const event_dispatcher;
     std::vector<std::unique_ptr<DisplaySyncGroup>> active_sync_groups;
     std::shared_ptr<DisplayConfigurationPolicy> const configuration_policy;
     std::shared_ptr<DisplayReport> const display_report;
@@ -23,6 +23,7 @@
 #include "buffer_texture_binder.h"
 #include "mir/anonymous_shm_file.h"
 #include "shm_buffer.h"
+#include "shm_buffer_pool.h"
 #include "display_helpers.h"
 #include "gbm_format_conversions.h"
 #include "egl_context_executor.h"
@@ -241,6 +242,7 @@ mgg::BufferAllocator::BufferAllocator(
     : ctx{context_for_output(output)},
       egl_delegate{
           std::make_shared<mgc::EGLContextExecutor>(context_for_output(output))},
+      software_buffers{std::make_shared<mgc::ShmBufferPool>(egl_delegate)},
       device(device),
       egl_extensions(std::make_shared<mg::EGLExtensions>()),
       bypass_option(buffer_import_method == mgg::BufferImportMethod::dma_buf ?
@@ -260,7 +262,7 @@ std::shared_ptr<mg::Buffer> mgg::BufferAllocator::alloc_software_buffer(
                 "Trying to create SHM buffer with unsupported pixel format"));
     }
 
-    return std::make_shared<mgc::MemoryBackedShmBuffer>(size, format, egl_delegate);
+    return software_buffers->alloc(size, format);
 }
 
 std::vector<MirPixelFormat> mgg::BufferAllocator::supported_pixel_formats()
@@ -390,6 +392,15 @@ std::shared_ptr<mg::Buffer> mgg::BufferAllocator::buffer_from_resource(
         wayland_executor);
 }
 
+auto mgg::BufferAllocator::fences_for_resource(wl_resource* buffer) -> std::vector<Fd>
+{
+    if (dmabuf_extension)
+    {
+        return dmabuf_extension->fences_for_resource(buffer);
+    }
+    return {};
+}
+
 auto mgg::BufferAllocator::buffer_from_shm(
     wl_resource* buffer,
     std::shared_ptr<Executor> wayland_executor,
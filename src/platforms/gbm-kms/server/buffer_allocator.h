@@ -52,6 +52,7 @@ struct EGLExtensions;
 namespace common
 {
 class EGLContextExecutor;
+class ShmBufferPool;
 }
 
 namespace gbm
@@ -86,12 +87,14 @@ public:
         wl_resource* buffer,
         std::shared_ptr<Executor> wayland_executor,
         std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer> override;
+    auto fences_for_resource(wl_resource* buffer) -> std::vector<Fd> override;
 private:
     std::shared_ptr<Buffer> alloc_hardware_buffer(
         graphics::BufferProperties const& buffer_properties);
 
     std::shared_ptr<renderer::gl::Context> const ctx;
     std::shared_ptr<common::EGLContextExecutor> const egl_delegate;
+    std::shared_ptr<common::ShmBufferPool> const software_buffers;
     std::shared_ptr<Executor> wayland_executor;
     std::unique_ptr<LinuxDmaBufUnstable, std::function<void(LinuxDmaBufUnstable*)>> dmabuf_extension;
     gbm_device* const device;
@@ -18,6 +18,7 @@
 
 #include "mir/graphics/renderable.h"
 #include "mir/graphics/display_buffer.h"
+#include "mir/graphics/buffer.h"
 #include "bypass.h"
 
 using namespace mir;
@@ -26,6 +27,7 @@ namespace mgg = mir::graphics::gbm;
 mgg::BypassMatch::BypassMatch(geometry::Rectangle const& rect)
     : view_area(rect),
       bypass_is_feasible(true),
+      reason("no surface covers the output"),
       identity(1)
 {
 }
@@ -43,6 +45,25 @@ bool mgg::BypassMatch::operator()(std::shared_ptr<graphics::Renderable> const& r
     auto const is_opaque = !((renderable->alpha() != 1.0f) || renderable->shaped());
     auto const fits = (renderable->screen_position() == view_area);
     auto const is_orthogonal = (renderable->transformation() == identity);
-    bypass_is_feasible = (is_opaque && fits && is_orthogonal);
+    // We can only scan out whole buffers; a cropped (wp_viewport) buffer needs compositing
+    auto const src_bounds = renderable->src_bounds();
+    auto const is_uncropped = !src_bounds ||
+        (src_bounds.value() == geometry::Rectangle{{0, 0}, renderable->buffer()->size()});
+    bypass_is_feasible = (is_opaque && fits && is_orthogonal && is_uncropped);
+
+    if (!is_opaque)
+        reason = "topmost surface is translucent";
+    else if (!fits)
+        reason = "topmost surface does not exactly fill the output";
+    else if (!is_orthogonal)
+        reason = "topmost surface is transformed";
+    else if (!is_uncropped)
+        reason = "topmost surface is cropped or scaled";
+
     return bypass_is_feasible;
 }
+
+char const* mgg::BypassMatch::failure_reason() const
+{
+    return reason;
+}
@@ -33,9 +33,13 @@ class BypassMatch
 public:
     BypassMatch(geometry::Rectangle const& rect);
     bool operator()(std::shared_ptr<graphics::Renderable> const&);
+
+    /// Why no renderable matched, for reporting
+    char const* failure_reason() const;
 private:
     geometry::Rectangle const view_area;
     bool bypass_is_feasible;
+    char const* reason;
     glm::mat4 const identity;
 };
 
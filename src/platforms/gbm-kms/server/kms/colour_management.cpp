@@ -0,0 +1,177 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "colour_management.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace mg = mir::graphics;
+namespace mgc = mir::graphics::gbm::colour;
+
+namespace
+{
+auto const max_lut_value = 0xffff;
+
+auto clamp_to_lut(double value) -> uint16_t
+{
+    return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0, double(max_lut_value))));
+}
+
+// The value of curve at x in [0, 1]; an empty curve is linear
+auto sample(mg::GammaCurve const& curve, double x) -> double
+{
+    if (curve.empty())
+        return x * max_lut_value;
+    if (curve.size() == 1)
+        return curve.front();
+
+    auto const position = std::clamp(x, 0.0, 1.0) * (curve.size() - 1);
+    auto const below = static_cast<size_t>(position);
+    auto const above = std::min(below + 1, curve.size() - 1);
+    auto const fraction = position - below;
+    return curve[below] + (double(curve[above]) - curve[below]) * fraction;
+}
+
+auto srgb_encode(double linear) -> double
+{
+    return linear <= 0.0031308 ? 12.92 * linear : 1.055 * std::pow(linear, 1 / 2.4) - 0.055;
+}
+
+auto srgb_decode(double encoded) -> double
+{
+    return encoded <= 0.04045 ? encoded / 12.92 : std::pow((encoded + 0.055) / 1.055, 2.4);
+}
+
+auto lut_position(size_t i, size_t size) -> double
+{
+    return size > 1 ? double(i) / (size - 1) : 0.0;
+}
+
+// S31.32 sign-magnitude, as CTM expects (not two's complement)
+auto s31_32(float value) -> uint64_t
+{
+    auto const magnitude = static_cast<uint64_t>(std::llround(std::abs(double(value)) * (1ull << 32)));
+    return (magnitude & ~(1ull << 63)) | (value < 0 ? (1ull << 63) : 0);
+}
+
+auto chromaticity(float coordinate) -> uint16_t
+{
+    // In units of 0.00002
+    return static_cast<uint16_t>(std::lround(std::clamp(coordinate, 0.0f, 1.0f) * 50000));
+}
+
+auto luminance(double value) -> uint16_t
+{
+    return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0, 65535.0)));
+}
+}
+
+bool mgc::is_diagonal(glm::mat3 const& transform)
+{
+    for (int column = 0; column != 3; ++column)
+        for (int row = 0; row != 3; ++row)
+            if (row != column && transform[column][row] != 0)
+                return false;
+    return true;
+}
+
+auto mgc::tinted(GammaCurves const& curves, glm::mat3 const& transform) -> GammaCurves
+{
+    auto scaled = [](GammaCurve curve, float factor)
+        {
+            for (auto& entry : curve)
+                entry = clamp_to_lut(entry * double(factor));
+            return curve;
+        };
+
+    return {
+        scaled(curves.red, transform[0][0]),
+        scaled(curves.green, transform[1][1]),
+        scaled(curves.blue, transform[2][2])};
+}
+
+auto mgc::resample(GammaCurve const& curve, size_t size) -> GammaCurve
+{
+    if (curve.size() == size)
+        return curve;
+
+    GammaCurve result(size);
+    for (size_t i = 0; i != size; ++i)
+        result[i] = clamp_to_lut(sample(curve, lut_position(i, size)));
+    return result;
+}
+
+auto mgc::drm_ctm_for(glm::mat3 const& transform) -> drm_color_ctm
+{
+    drm_color_ctm ctm{};
+    for (int row = 0; row != 3; ++row)
+        for (int column = 0; column != 3; ++column)
+            ctm.matrix[row * 3 + column] = s31_32(transform[column][row]);
+    return ctm;
+}
+
+auto mgc::drm_gamma_lut_for(GammaCurves const& curves, size_t size, bool linear_input)
+    -> std::vector<drm_color_lut>
+{
+    std::vector<drm_color_lut> lut(size);
+    for (size_t i = 0; i != size; ++i)
+    {
+        auto x = lut_position(i, size);
+        if (linear_input)
+            x = srgb_encode(x);
+
+        lut[i].red = clamp_to_lut(sample(curves.red, x));
+        lut[i].green = clamp_to_lut(sample(curves.green, x));
+        lut[i].blue = clamp_to_lut(sample(curves.blue, x));
+    }
+    return lut;
+}
+
+auto mgc::srgb_degamma_lut(size_t size) -> std::vector<drm_color_lut>
+{
+    std::vector<drm_color_lut> lut(size);
+    for (size_t i = 0; i != size; ++i)
+    {
+        auto const value = clamp_to_lut(srgb_decode(lut_position(i, size)) * max_lut_value);
+        lut[i].red = lut[i].green = lut[i].blue = value;
+    }
+    return lut;
+}
+
+auto mgc::drm_hdr_metadata_for(HdrOutputMetadata const& metadata) -> hdr_output_metadata
+{
+    hdr_output_metadata result{};
+    result.metadata_type = 0;   // HDMI_STATIC_METADATA_TYPE1
+
+    auto& infoframe = result.hdmi_metadata_type1;
+    infoframe.eotf = static_cast<uint8_t>(metadata.eotf);
+    infoframe.metadata_type = 0;
+    for (int i = 0; i != 3; ++i)
+    {
+        infoframe.display_primaries[i].x = chromaticity(metadata.primaries[i].x);
+        infoframe.display_primaries[i].y = chromaticity(metadata.primaries[i].y);
+    }
+    infoframe.white_point.x = chromaticity(metadata.white_point.x);
+    infoframe.white_point.y = chromaticity(metadata.white_point.y);
+    infoframe.max_display_mastering_luminance = luminance(metadata.max_mastering_luminance);
+    // In units of 0.0001 cd/m²
+    infoframe.min_display_mastering_luminance = luminance(metadata.min_mastering_luminance * 10000.0);
+    infoframe.max_cll = luminance(metadata.max_content_light_level);
+    infoframe.max_fall = luminance(metadata.max_frame_average_light_level);
+    return result;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_GBM_COLOUR_MANAGEMENT_H_
+#define MIR_GRAPHICS_GBM_COLOUR_MANAGEMENT_H_
+
+#include "mir/graphics/gamma_curves.h"
+#include "mir/graphics/display_configuration.h"
+
+#include <glm/glm.hpp>
+#include <xf86drmMode.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+namespace gbm
+{
+/**
+ * Conversions between Mir's colour settings and the layouts the KMS colour
+ * management properties (DEGAMMA_LUT, CTM, GAMMA_LUT, HDR_OUTPUT_METADATA) expect.
+ */
+namespace colour
+{
+/// Whether transform only scales each channel independently (as a night light does)
+bool is_diagonal(glm::mat3 const& transform);
+
+/// The curves with each channel scaled by the corresponding entry in transform's diagonal
+auto tinted(GammaCurves const& curves, glm::mat3 const& transform) -> GammaCurves;
+
+/// Samples curve at size evenly spaced points, interpolating linearly
+auto resample(GammaCurve const& curve, size_t size) -> GammaCurve;
+
+/// The matrix in the row-major, S31.32 sign-magnitude layout of the CTM property
+auto drm_ctm_for(glm::mat3 const& transform) -> drm_color_ctm;
+
+/**
+ * A GAMMA_LUT of size entries applying curves.
+ *
+ * If linear_input is set the LUT's input is linear light (i.e. follows a
+ * DEGAMMA_LUT from srgb_degamma_lut()), so it re-applies the sRGB encoding
+ * before looking up the curves. Empty curves are treated as linear ramps.
+ */
+auto drm_gamma_lut_for(GammaCurves const& curves, size_t size, bool linear_input) -> std::vector<drm_color_lut>;
+
+/// A DEGAMMA_LUT decoding sRGB-encoded pixels to linear light
+auto srgb_degamma_lut(size_t size) -> std::vector<drm_color_lut>;
+
+/// The metadata as an HDMI static metadata (type 1) infoframe for HDR_OUTPUT_METADATA
+auto drm_hdr_metadata_for(HdrOutputMetadata const& metadata) -> hdr_output_metadata;
+}
+}
+}
+}
+
+#endif // MIR_GRAPHICS_GBM_COLOUR_MANAGEMENT_H_
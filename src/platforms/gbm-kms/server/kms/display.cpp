@@ -20,6 +20,7 @@
 #include "cursor.h"
 #include "platform.h"
 #include "display_buffer.h"
+#include "colour_management.h"
 #include "kms_display_configuration.h"
 #include "kms_output.h"
 #include "kms_page_flipper.h"
@@ -45,6 +46,7 @@
 
 #include <stdexcept>
 #include <algorithm>
+#include <cstring>
 #include <unordered_map>
 
 namespace mgg = mir::graphics::gbm;
@@ -79,6 +81,30 @@ private:
     mgg::helpers::EGLHelper egl;
 };
 
+bool same_hdr_metadata(
+    mir::optional_value<mg::HdrOutputMetadata> const& a,
+    mir::optional_value<mg::HdrOutputMetadata> const& b)
+{
+    if (!a.is_set() || !b.is_set())
+        return a.is_set() == b.is_set();
+
+    // Compare what the display would be sent, as the outputs do
+    auto const drm_a = mgg::colour::drm_hdr_metadata_for(a.value());
+    auto const drm_b = mgg::colour::drm_hdr_metadata_for(b.value());
+    return memcmp(&drm_a, &drm_b, sizeof drm_a) == 0;
+}
+
+/// Whether going from one configuration of an output to another reprograms its colour pipeline or HDR metadata
+bool colour_settings_change(mg::DisplayConfigurationOutput const& from, mg::DisplayConfigurationOutput const& to)
+{
+    return
+        to.colour_transform != from.colour_transform ||
+        to.gamma.red != from.gamma.red ||
+        to.gamma.green != from.gamma.green ||
+        to.gamma.blue != from.gamma.blue ||
+        !same_hdr_metadata(to.hdr_metadata, from.hdr_metadata);
+}
+
 std::vector<int> drm_fds_from_drm_helpers(
     std::vector<std::shared_ptr<mgg::helpers::DRMHelper>> const& helpers)
 {
@@ -377,7 +403,7 @@ void mgg::Display::clear_connected_unused_outputs()
 
             kms_output->clear_crtc();
             kms_output->set_power_mode(conf_output.power_mode);
-            kms_output->set_gamma(conf_output.gamma);
+            kms_output->set_colour_pipeline(conf_output.gamma, conf_output.colour_transform);
         }
     });
 }
@@ -493,6 +519,8 @@ void mgg::Display::configure_locked(
             std::vector<std::vector<std::shared_ptr<KMSOutput>>> kms_output_groups;
             glm::mat2 transformation;
             geom::Size current_mode_resolution;
+            /// Colour settings to reprogram without disturbing the running compositor
+            std::vector<std::function<void()>> colour_changes;
 
             group.for_each_output(
                 [&](DisplayConfigurationOutput const& conf_output)
@@ -505,7 +533,40 @@ void mgg::Display::configure_locked(
                     if (!comp)
                     {
                         kms_output->set_power_mode(conf_output.power_mode);
-                        kms_output->set_gamma(conf_output.gamma);
+                    }
+
+                    /*
+                     * Colour settings don't affect compatibility, so changing
+                     * them (e.g. animating a night light) never needs new
+                     * DisplayBuffers; the outputs skip anything unchanged.
+                     */
+                    auto set_colour =
+                        [kms_output,
+                         gamma = conf_output.gamma,
+                         colour_transform = conf_output.colour_transform,
+                         hdr_metadata = conf_output.hdr_metadata]
+                        {
+                            kms_output->set_colour_pipeline(gamma, colour_transform);
+                            kms_output->set_hdr_metadata(hdr_metadata);
+                        };
+
+                    if (!comp)
+                    {
+                        set_colour();
+                    }
+                    else
+                    {
+                        // The compositor may be running, so only reprogram what has changed, between its flips
+                        current_display_configuration.for_each_output(
+                            [&](DisplayConfigurationOutput const& previous)
+                            {
+                                if (previous.id == conf_output.id && colour_settings_change(previous, conf_output))
+                                    colour_changes.push_back(set_colour);
+                            });
+                    }
+
+                    if (!comp)
+                    {
                         add_to_drm_device_group(kms_output_groups, std::move(kms_output));
                     }
 
@@ -520,8 +581,17 @@ void mgg::Display::configure_locked(
 
             if (comp)
             {
-                display_buffers[group_idx++]->set_transformation(transformation,
-                                                                 bounding_rect);
+                auto const& db = display_buffers[group_idx++];
+                db->set_transformation(transformation, bounding_rect);
+
+                if (!colour_changes.empty())
+                {
+                    db->between_flips([&]
+                        {
+                            for (auto const& change : colour_changes)
+                                change();
+                        });
+                }
             }
             else
             {
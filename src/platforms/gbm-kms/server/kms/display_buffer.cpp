@@ -43,6 +43,7 @@
 #include <chrono>
 #include <thread>
 #include <algorithm>
+#include <functional>
 
 namespace mg = mir::graphics;
 namespace mgg = mir::graphics::gbm;
@@ -458,7 +459,31 @@ mgg::DisplayBuffer::DisplayBuffer(
     if (!temporary_front)
         fatal_error("Failed to get frontbuffer");
 
-    if (needs_bounce_buffer(*outputs.front(), temporary_front))
+    bool const hybrid = needs_bounce_buffer(*outputs.front(), temporary_front);
+    bool const single_device = std::all_of(
+        outputs.begin(), outputs.end(),
+        [&](auto const& output) { return output->drm_fd() == outputs.front()->drm_fd(); });
+    if (hybrid && !single_device)
+    {
+        /*
+         * Frames are imported (or copied) onto the first output's device, so
+         * outputs on any other device would have nothing they can scan out.
+         */
+        BOOST_THROW_EXCEPTION(std::invalid_argument(
+            "Attempted to create a DisplayBuffer spanning multiple GPU memory domains"));
+    }
+
+    if (hybrid && outputs.front()->prime_fb_for(temporary_front))
+    {
+        /*
+         * The display device can scan out of the rendering GPU's (linear)
+         * buffers directly, so there's no need to copy each frame across.
+         */
+        mir::log_info("Hybrid GPU setup detected; DisplayBuffer scanning out rendered buffers via PRIME");
+        prime_scanout = true;
+        get_front_buffer = [](auto&& fb) { return std::move(fb); };
+    }
+    else if (hybrid)
     {
         mir::log_info("Hybrid GPU setup detected; DisplayBuffer using EGL buffer copies for migration");
         get_front_buffer = std::bind(
@@ -484,14 +509,16 @@ mgg::DisplayBuffer::DisplayBuffer(
      */
     for (auto const& output : outputs)
     {
-        if (output->buffer_requires_migration(visible_composite_frame))
+        if (!prime_scanout && output->buffer_requires_migration(visible_composite_frame))
         {
             BOOST_THROW_EXCEPTION(std::invalid_argument(
                 "Attempted to create a DisplayBuffer spanning multiple GPU memory domains"));
         }
     }
 
-    set_crtc(*outputs.front()->fb_for(visible_composite_frame));
+    for (auto& output : outputs)
+        output->set_scanout_transformation(glm::mat2{1});
+    set_crtc(*fb_for_composite_frame(visible_composite_frame));
 
     release_current();
 
@@ -526,32 +553,82 @@ void mgg::DisplayBuffer::set_transformation(glm::mat2 const& t, geometry::Rectan
 
 bool mgg::DisplayBuffer::overlay(RenderableList const& renderable_list)
 {
+    bypass_buf = nullptr;
+    bypass_bufobj = nullptr;
+
+    if (bypass_option != mgg::BypassOption::allowed)
+        return false;
+
+    if (auto const reason = try_bypass(renderable_list))
+    {
+        if (reason != bypass_failure)
+        {
+            for (auto const& output : outputs)
+                listener->report_bypass_failure(output->id(), reason);
+            bypass_failure = reason;
+        }
+        return false;
+    }
+
+    bypass_failure = nullptr;
+    return true;
+}
+
+auto mgg::DisplayBuffer::try_bypass(RenderableList const& renderable_list) -> char const*
+{
+    /*
+     * Every output in this DisplayBuffer scans out the same framebuffer, so
+     * clones can only share a client buffer if they share a mode.
+     */
     glm::mat2 static const no_transformation(1);
-    if (transform == no_transformation &&
-       (bypass_option == mgg::BypassOption::allowed))
+    for (auto const& output : outputs)
     {
-        mgg::BypassMatch bypass_match(area);
-        auto bypass_it = std::find_if(renderable_list.rbegin(), renderable_list.rend(), bypass_match);
-        if (bypass_it != renderable_list.rend())
+        if (outputs.size() > 1 && output->size() != surface.size())
+            return "cloned outputs have different modes";
+        if (transform != no_transformation && !output->supports_scanout_transformation(transform))
+            return "output transformation is not supported by the display hardware";
+    }
+
+    mgg::BypassMatch bypass_match(area);
+    auto bypass_it = std::find_if(renderable_list.rbegin(), renderable_list.rend(), std::ref(bypass_match));
+    if (bypass_it == renderable_list.rend())
+        return bypass_match.failure_reason();
+
+    auto bypass_buffer = (*bypass_it)->buffer();
+    if (bypass_buffer->size() != surface.size())
+        return "surface buffer size does not match the output mode";
+
+    auto dmabuf_image = dynamic_cast<mg::DMABufBuffer*>(bypass_buffer->native_buffer_base());
+    if (!dmabuf_image)
+        return "surface buffer is not a dmabuf";
+
+    auto bufobj = outputs.front()->fb_for(*dmabuf_image);
+    if (!bufobj)
+        return "surface buffer can not be imported for scanout";
+
+    /*
+     * The client buffer is drawn in the logical orientation, so the hardware
+     * has to rotate it. If that fails, the frame is composited upright instead.
+     */
+    if (transform != no_transformation)
+    {
+        std::lock_guard<std::mutex> flip_lock{flip_mutex};
+        for (auto const& output : outputs)
         {
-            auto bypass_buffer = (*bypass_it)->buffer();
-            auto dmabuf_image = dynamic_cast<mg::DMABufBuffer*>(bypass_buffer->native_buffer_base());
-            if (dmabuf_image &&
-                bypass_buffer->size() == surface.size())
+            if (!output->set_scanout_transformation(transform))
             {
-                if (auto bufobj = outputs.front()->fb_for(*dmabuf_image))
-                {
-                    bypass_buf = bypass_buffer;
-                    bypass_bufobj = bufobj;
-                    return true;
-                }
+                for (auto const& upright : outputs)
+                    upright->set_scanout_transformation(no_transformation);
+                return "output transformation could not be applied by the display hardware";
             }
         }
     }
 
-    bypass_buf = nullptr;
-    bypass_bufobj = nullptr;
-    return false;
+    bypass_buf = bypass_buffer;
+    bypass_bufobj = bufobj;
+    // The client asked not to wait for vsync (e.g. the tearing-control hint)
+    bypass_async = (*bypass_it)->tearing_allowed();
+    return nullptr;
 }
 
 void mgg::DisplayBuffer::for_each_display_buffer(
@@ -603,17 +680,52 @@ void mgg::DisplayBuffer::post()
     else
     {
         scheduled_composite_frame = get_front_buffer(surface.lock_front());
-        bufobj = outputs.front()->fb_for(scheduled_composite_frame);
+        bufobj = fb_for_composite_frame(scheduled_composite_frame);
         if (!bufobj)
             fatal_error("Failed to get front buffer object");
     }
 
     scheduled_fb = std::move(bufobj);
+
+    // Keep between_flips() from reprogramming the outputs while we do
+    std::unique_lock<std::mutex> flip_lock{flip_mutex};
+
+    /*
+     * Composited frames are already rendered in the output's orientation.
+     * (Bypassed client buffers had the hardware rotation set by overlay().)
+     * Resetting it can only fail if the driver does, which the output logs.
+     */
+    if (!bypass_buf)
+    {
+        for (auto& output : outputs)
+            output->set_scanout_transformation(glm::mat2{1});
+    }
+
+    /*
+     * A bypassed fullscreen client is presenting straight to the output, so
+     * let the display refresh as it commits rather than at a fixed rate.
+     * Cloned outputs can't all follow the one client.
+     */
+    bool const want_vrr = bypass_buf && outputs.size() == 1;
+    vrr_enabled = false;
+    for (auto& output : outputs)
+    {
+        if (output->set_vrr_enabled(want_vrr))
+            vrr_enabled = true;
+    }
+
+    /*
+     * A bypassed client that opted out of vsync gets its buffer on screen
+     * as soon as possible, at the cost of tearing. As with variable refresh,
+     * cloned outputs stay in sync with each other instead.
+     */
+    bool const async_flip = bypass_buf && bypass_async && outputs.size() == 1;
+
     /*
      * Try to schedule a page flip as first preference to avoid tearing.
      * [will complete in a background thread]
      */
-    if (!needs_set_crtc && !schedule_page_flip(*scheduled_fb))
+    if (!needs_set_crtc && !schedule_page_flip(*scheduled_fb, async_flip))
         needs_set_crtc = true;
 
     /*
@@ -630,6 +742,8 @@ void mgg::DisplayBuffer::post()
         needs_set_crtc = false;
     }
 
+    flip_lock.unlock();
+
     using namespace std::chrono_literals;  // For operator""ms()
 
     // Predicted worst case render time for the next frame...
@@ -676,8 +790,12 @@ void mgg::DisplayBuffer::post()
     bypass_buf = nullptr;
     bypass_bufobj = nullptr;
 
+    /*
+     * With variable refresh or async flips the client's commits pace the
+     * display, so sleeping here would only add latency.
+     */
     recommend_sleep = 0ms;
-    if (outputs.size() == 1)
+    if (outputs.size() == 1 && !vrr_enabled && !async_flip)
     {
         auto const& output = outputs.front();
         auto const min_frame_interval = 1000ms / output->max_refresh_rate();
@@ -691,21 +809,28 @@ std::chrono::milliseconds mgg::DisplayBuffer::recommended_sleep() const
     return recommend_sleep;
 }
 
-bool mgg::DisplayBuffer::schedule_page_flip(FBHandle const& bufobj)
+bool mgg::DisplayBuffer::schedule_page_flip(FBHandle const& bufobj, bool async)
 {
     /*
      * Schedule the current front buffer object for display. Note that
-     * the page flip is asynchronous and synchronized with vertical refresh.
+     * the page flip is asynchronous and, unless async is requested and
+     * the output supports it, synchronized with vertical refresh.
      */
     for (auto& output : outputs)
     {
-        if (output->schedule_page_flip(bufobj))
+        if ((async && output->schedule_async_page_flip(bufobj)) ||
+            output->schedule_page_flip(bufobj))
             page_flips_pending = true;
     }
 
     return page_flips_pending;
 }
 
+auto mgg::DisplayBuffer::fb_for_composite_frame(gbm_bo* frame) const -> std::shared_ptr<FBHandle const>
+{
+    return prime_scanout ? outputs.front()->prime_fb_for(frame) : outputs.front()->fb_for(frame);
+}
+
 void mgg::DisplayBuffer::wait_for_page_flip()
 {
     if (page_flips_pending)
@@ -748,6 +873,16 @@ void mgg::DisplayBuffer::release_current()
     surface.release_current();
 }
 
+void mgg::DisplayBuffer::between_flips(std::function<void()> const& change)
+{
+    /*
+     * The kernel completes a (blocking) property change after any pending
+     * flip, so it's enough that post() isn't scheduling a flip meanwhile.
+     */
+    std::lock_guard<std::mutex> lock{flip_mutex};
+    change();
+}
+
 void mgg::DisplayBuffer::schedule_set_crtc()
 {
     needs_set_crtc = true;
@@ -29,6 +29,8 @@
 #include <vector>
 #include <memory>
 #include <atomic>
+#include <functional>
+#include <mutex>
 
 namespace mir
 {
@@ -125,18 +127,32 @@ public:
     void set_transformation(glm::mat2 const& t, geometry::Rectangle const& a);
     void schedule_set_crtc();
     void wait_for_page_flip();
+    /**
+     * Run \p change while no page flip is being scheduled on our outputs
+     *
+     * This is for reprogramming outputs (e.g. their colour properties) while the compositor runs.
+     */
+    void between_flips(std::function<void()> const& change);
 
 private:
-    bool schedule_page_flip(FBHandle const& bufobj);
+    bool schedule_page_flip(FBHandle const& bufobj, bool async);
     void set_crtc(FBHandle const&);
+    /// Selects a client buffer to scan out, or returns why none can be
+    auto try_bypass(RenderableList const& renderable_list) -> char const*;
+    auto fb_for_composite_frame(gbm_bo* frame) const -> std::shared_ptr<FBHandle const>;
 
     std::shared_ptr<graphics::Buffer> visible_bypass_frame, scheduled_bypass_frame;
     std::shared_ptr<Buffer> bypass_buf{nullptr};
     std::shared_ptr<FBHandle const> bypass_bufobj{nullptr};
+    bool bypass_async{false};
+    /// The reason last reported for not bypassing, so we only report changes
+    char const* bypass_failure{nullptr};
     std::shared_ptr<DisplayReport> const listener;
     BypassOption bypass_option;
 
     std::vector<std::shared_ptr<KMSOutput>> outputs;
+    /// Composited frames are rendered on another GPU and PRIME-imported for scanout
+    bool prime_scanout{false};
 
     /*
      * Destruction order is important here:
@@ -156,7 +172,10 @@ private:
     geometry::Rectangle area;
     glm::mat2 transform;
     std::atomic<bool> needs_set_crtc;
+    /// Held while post() programs the outputs for a frame, so between_flips() can't interleave with it
+    std::mutex flip_mutex;
     std::chrono::milliseconds recommend_sleep{0};
+    bool vrr_enabled{false};
     bool page_flips_pending;
 };
 
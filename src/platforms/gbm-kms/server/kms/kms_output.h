@@ -68,6 +68,13 @@ public:
     virtual bool set_crtc(FBHandle const& fb) = 0;
     virtual void clear_crtc() = 0;
     virtual bool schedule_page_flip(FBHandle const& fb) = 0;
+    /**
+     * Schedule a page flip that doesn't wait for vblank, so may tear.
+     *
+     * \return False if the output can't flip asynchronously; the caller
+     *         should then use schedule_page_flip().
+     */
+    virtual bool schedule_async_page_flip(FBHandle const& fb) = 0;
     virtual void wait_for_page_flip() = 0;
 
     virtual bool set_cursor(gbm_bo* buffer) = 0;
@@ -75,8 +82,50 @@ public:
     virtual bool clear_cursor() = 0;
     virtual bool has_cursor() const = 0;
 
+    /**
+     * Let the output's refresh follow our page flips rather than a fixed rate.
+     *
+     * Only has an effect if the connected display supports variable refresh
+     * (VESA Adaptive-Sync/FreeSync).
+     *
+     * \return True if variable refresh is now enabled on the output.
+     */
+    virtual bool set_vrr_enabled(bool enabled) = 0;
+
+    /**
+     * Whether the display hardware can apply transformation to the image
+     * as it scans it out (i.e. by rotating the primary plane).
+     *
+     * With the legacy KMS API the plane keeps the mode's size, so only
+     * transformations that preserve it (i.e. 180°) are supported.
+     */
+    virtual bool supports_scanout_transformation(glm::mat2 const& transformation) const = 0;
+
+    /**
+     * Have the display hardware apply transformation as it scans out.
+     *
+     * This takes effect immediately rather than with the next page flip.
+     *
+     * \return False if the hardware can't (see supports_scanout_transformation())
+     *         or the driver fails to; the output is then left as it was.
+     */
+    virtual bool set_scanout_transformation(glm::mat2 const& transformation) = 0;
+
     virtual void set_power_mode(MirPowerMode mode) = 0;
     virtual void set_gamma(GammaCurves const& gamma) = 0;
+
+    /**
+     * Program the CRTC's colour pipeline with colour_transform followed by gamma.
+     *
+     * The transformation is applied by the display hardware where it can be
+     * (in linear light, if the hardware has a degamma stage). Unchanged
+     * settings are not sent to the hardware again, so this is cheap to call
+     * on every configuration change.
+     */
+    virtual void set_colour_pipeline(GammaCurves const& gamma, glm::mat3 const& colour_transform) = 0;
+
+    /// Send (or, if unset, stop sending) static HDR metadata to the display
+    virtual void set_hdr_metadata(optional_value<HdrOutputMetadata> const& metadata) = 0;
     virtual Frame last_frame() const = 0;
 
     /**
@@ -107,6 +156,19 @@ public:
     virtual auto fb_for(gbm_bo* bo) const -> std::shared_ptr<FBHandle const> = 0;
     virtual auto fb_for(DMABufBuffer const& buffer) const -> std::shared_ptr<FBHandle const> = 0;
 
+    /**
+     * Get a DRM FB for a gbm_bo allocated on a different GPU, by importing it
+     * into this output's device via PRIME.
+     *
+     * This avoids copying rendered frames between GPUs, but only works if the
+     * display hardware can scan out of the buffer's memory (it should be linear).
+     *
+     * \param   [in] bo The GBM bo containing the image
+     * \return  An opaque handle to a DRM FB, or nullptr if the buffer could not
+     *          be imported for scanout.
+     */
+    virtual auto prime_fb_for(gbm_bo* bo) const -> std::shared_ptr<FBHandle const> = 0;
+
     /**
      * Check whether buffer need to be migrated to GPU-private memory for display.
      *
@@ -21,29 +21,30 @@
 
 #include <stdexcept>
 #include <boost/throw_exception.hpp>
-#include <boost/exception/errinfo_errno.hpp>
 
 #include <xf86drm.h>
 #include <xf86drmMode.h>
 #include <chrono>
-#include <cstring>
 
 namespace mg = mir::graphics;
 namespace mgg = mir::graphics::gbm;
 
 namespace
 {
-
-void page_flip_handler(int /*fd*/, unsigned int seq,
-                       unsigned int sec, unsigned int usec,
-                       void* data)
+clockid_t timestamp_clock_for(int drm_fd)
 {
-    auto page_flip_data = static_cast<mgg::PageFlipEventData*>(data);
-    std::chrono::nanoseconds ns{sec*1000000000LL + usec*1000LL};
-    page_flip_data->flipper->notify_page_flip(page_flip_data->crtc_id,
-                                              seq, ns);
+    uint64_t mono = 0;
+    if (drmGetCap(drm_fd, DRM_CAP_TIMESTAMP_MONOTONIC, &mono) || !mono)
+        return CLOCK_REALTIME;
+    else
+        return CLOCK_MONOTONIC;
 }
 
+bool supports_async_page_flip(int drm_fd)
+{
+    uint64_t async = 0;
+    return !drmGetCap(drm_fd, DRM_CAP_ASYNC_PAGE_FLIP, &async) && async;
+}
 }
 
 mgg::KMSPageFlipper::KMSPageFlipper(
@@ -51,26 +52,63 @@ mgg::KMSPageFlipper::KMSPageFlipper(
     std::shared_ptr<DisplayReport> const& report) :
     drm_fd{drm_fd},
     report{report},
-    pending_page_flips(),
-    worker_tid()
+    clock_id{timestamp_clock_for(drm_fd)},
+    async_flip_supported{supports_async_page_flip(drm_fd)},
+    event_dispatcher{mir::Fd{IntOwnedFd{drm_fd}}}
 {
-    uint64_t mono = 0;
-    if (drmGetCap(drm_fd, DRM_CAP_TIMESTAMP_MONOTONIC, &mono) || !mono)
-        clock_id = CLOCK_REALTIME;
-    else
-        clock_id = CLOCK_MONOTONIC;
 }
 
 bool mgg::KMSPageFlipper::schedule_flip(uint32_t crtc_id,
                                         uint32_t fb_id,
                                         uint32_t connector_id)
+{
+    return schedule_flip_with_flags(crtc_id, fb_id, connector_id, DRM_MODE_PAGE_FLIP_EVENT);
+}
+
+bool mgg::KMSPageFlipper::schedule_async_flip(uint32_t crtc_id,
+                                              uint32_t fb_id,
+                                              uint32_t connector_id)
+{
+    if (!async_flip_supported)
+        return false;
+
+    /*
+     * The kernel still sends a completion event for async flips, so they
+     * are waited for just like vsynced ones. Drivers may refuse an async
+     * flip (e.g. if the new FB's format differs), in which case the caller
+     * falls back to a regular flip.
+     */
+    return schedule_flip_with_flags(crtc_id, fb_id, connector_id,
+                                    DRM_MODE_PAGE_FLIP_EVENT | DRM_MODE_PAGE_FLIP_ASYNC);
+}
+
+bool mgg::KMSPageFlipper::schedule_flip_with_flags(uint32_t crtc_id,
+                                                   uint32_t fb_id,
+                                                   uint32_t connector_id,
+                                                   uint32_t flags)
 {
     std::unique_lock<std::mutex> lock{pf_mutex};
 
-    if (pending_page_flips.find(crtc_id) != pending_page_flips.end())
-        BOOST_THROW_EXCEPTION(std::logic_error("Page flip for crtc_id is already scheduled"));
+    auto const pending = pending_page_flips.find(crtc_id);
+    if (pending != pending_page_flips.end())
+    {
+        if (pending->second.wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+            BOOST_THROW_EXCEPTION(std::logic_error("Page flip for crtc_id is already scheduled"));
 
-    pending_page_flips[crtc_id] = PageFlipEventData{crtc_id, connector_id, this};
+        /* The previous flip completed but nobody waited for it */
+        pending_page_flips.erase(pending);
+    }
+
+    /*
+     * The event may be dispatched before drmModePageFlip() returns, so the
+     * expectation must be in place first.
+     */
+    auto completion = event_dispatcher.expect_flip_event(
+        crtc_id,
+        [this, crtc_id, connector_id](unsigned int seq, std::chrono::nanoseconds ust)
+        {
+            notify_page_flip(crtc_id, connector_id, seq, ust);
+        });
 
     /*
      * It appears we can't tell the difference between flipping being
@@ -79,112 +117,49 @@ bool mgg::KMSPageFlipper::schedule_flip(uint32_t crtc_id,
      * apparently valid.
      */
     auto ret = drmModePageFlip(drm_fd, crtc_id, fb_id,
-                               DRM_MODE_PAGE_FLIP_EVENT,
-                               &pending_page_flips[crtc_id]);
+                               flags,
+                               event_dispatcher.event_data_for(crtc_id));
 
     if (ret)
-        pending_page_flips.erase(crtc_id);
+        event_dispatcher.cancel_flip_event(crtc_id);
+    else
+        pending_page_flips[crtc_id] = std::move(completion);
 
     return (ret == 0);
 }
 
 mg::Frame mgg::KMSPageFlipper::wait_for_flip(uint32_t crtc_id)
 {
-    drmEventContext evctx;
-    memset(&evctx, 0, sizeof evctx);
-    evctx.version = 2;  // We only support the old v2 page_flip_handler
-    evctx.page_flip_handler = &page_flip_handler;
-
-    static std::thread::id const invalid_tid;
+    std::unique_lock<std::mutex> lock{pf_mutex};
 
+    auto const pending = pending_page_flips.find(crtc_id);
+    if (pending != pending_page_flips.end())
     {
-        std::unique_lock<std::mutex> lock{pf_mutex};
+        auto completion = std::move(pending->second);
+        pending_page_flips.erase(pending);
 
         /*
-         * While another thread is the worker (it is controlling the
-         * page flip event loop) and our event has not arrived, wait.
+         * Only this CRTC's flip is waited for; the dispatcher delivers
+         * the events for other CRTCs to their own waiters.
          */
-        while (worker_tid != invalid_tid && !page_flip_is_done(crtc_id))
-            pf_cv.wait(lock);
-
-        /* If the page flip we are waiting for has arrived we are done. */
-        if (page_flip_is_done(crtc_id))
-            return completed_page_flips[crtc_id];
-
-        /* ...otherwise we become the worker */
-        worker_tid = std::this_thread::get_id();
+        lock.unlock();
+        completion.get();
+        lock.lock();
     }
 
-    /* Only the worker thread reaches this point */
-    bool done{false};
-
-    while (!done)
-    {
-        fd_set fds;
-        FD_ZERO(&fds);
-        FD_SET(drm_fd, &fds);
-
-        /*
-         * Wait for a page flip event. When we get a page flip event,
-         * page_flip_handler(), called through drmHandleEvent(), will update
-         * the pending_page_flips map.
-         */
-        auto ret = select(drm_fd + 1, &fds, nullptr, nullptr, nullptr);
-
-        {
-            std::unique_lock<std::mutex> lock{pf_mutex};
-
-            if (ret > 0)
-            {
-                drmHandleEvent(drm_fd, &evctx);
-            }
-            else if (ret < 0 && errno != EINTR)
-            {
-                std::string const msg("Error while waiting for page-flip event");
-                BOOST_THROW_EXCEPTION(
-                    boost::enable_error_info(
-                        std::runtime_error(msg)) << boost::errinfo_errno(errno));
-            }
-
-            done = page_flip_is_done(crtc_id);
-            /* Give up loop control if we are done */
-            if (done)
-                worker_tid = invalid_tid;
-        }
-
-        /*
-         * Wake up other (non-worker) threads, so they can check whether
-         * their page-flip events have arrived, or whether they can become
-         * the worker (see pf_cv.wait(lock) above).
-         */
-        pf_cv.notify_all();
-    }
     return completed_page_flips[crtc_id];
 }
 
-std::thread::id mgg::KMSPageFlipper::debug_get_worker_tid()
+void mgg::KMSPageFlipper::notify_page_flip(uint32_t crtc_id, uint32_t connector_id,
+                                           int64_t msc, std::chrono::nanoseconds ust)
 {
-    std::unique_lock<std::mutex> lock{pf_mutex};
-
-    return worker_tid;
-}
-
-/* This method should be called with the 'pf_mutex' locked */
-bool mgg::KMSPageFlipper::page_flip_is_done(uint32_t crtc_id)
-{
-    return pending_page_flips.find(crtc_id) == pending_page_flips.end();
-}
-
-void mgg::KMSPageFlipper::notify_page_flip(uint32_t crtc_id, int64_t msc,
-                                           std::chrono::nanoseconds ust)
-{
-    auto pending = pending_page_flips.find(crtc_id);
-    if (pending != pending_page_flips.end())
+    Frame frame;
     {
-        auto& frame = completed_page_flips[crtc_id];
-        frame.msc = msc;
-        frame.ust = {clock_id, ust};
-        report->report_vsync(pending->second.connector_id, frame);
-        pending_page_flips.erase(pending);
+        std::lock_guard<std::mutex> lock{pf_mutex};
+        auto& completed = completed_page_flips[crtc_id];
+        completed.msc = msc;
+        completed.ust = {clock_id, ust};
+        frame = completed;
     }
+    report->report_vsync(connector_id, frame);
 }
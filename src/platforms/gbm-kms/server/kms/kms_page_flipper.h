@@ -20,14 +20,13 @@
 #define MIR_GRAPHICS_GBM_KMS_PAGE_FLIPPER_H_
 
 #include "page_flipper.h"
+#include "kms-utils/drm_event_dispatcher.h"
 
 #include <unordered_map>
 #include <chrono>
+#include <future>
 #include <mutex>
-#include <condition_variable>
-#include <thread>
 #include <ctime>
-#include <sys/time.h>
 
 namespace mir
 {
@@ -39,36 +38,28 @@ class DisplayReport;
 namespace gbm
 {
 
-class KMSPageFlipper;
-struct PageFlipEventData
-{
-    uint32_t crtc_id;
-    uint32_t connector_id;
-    KMSPageFlipper* flipper;
-};
-
 class KMSPageFlipper : public PageFlipper
 {
 public:
     KMSPageFlipper(int drm_fd, std::shared_ptr<DisplayReport> const& report);
 
     bool schedule_flip(uint32_t crtc_id, uint32_t fb_id, uint32_t connector_id) override;
+    bool schedule_async_flip(uint32_t crtc_id, uint32_t fb_id, uint32_t connector_id) override;
     Frame wait_for_flip(uint32_t crtc_id) override;
 
-    std::thread::id debug_get_worker_tid();
-
-    void notify_page_flip(uint32_t crtc_id, int64_t msc, std::chrono::nanoseconds ust);
 private:
-    bool page_flip_is_done(uint32_t crtc_id);
+    bool schedule_flip_with_flags(uint32_t crtc_id, uint32_t fb_id, uint32_t connector_id, uint32_t flags);
+    void notify_page_flip(uint32_t crtc_id, uint32_t connector_id, int64_t msc, std::chrono::nanoseconds ust);
 
     int const drm_fd;
     std::shared_ptr<DisplayReport> const report;
-    std::unordered_map<uint32_t,PageFlipEventData> pending_page_flips;
-    std::unordered_map<uint32_t,Frame> completed_page_flips;
+    clockid_t const clock_id;
+    bool const async_flip_supported;
     std::mutex pf_mutex;
-    std::condition_variable pf_cv;
-    std::thread::id worker_tid;
-    clockid_t clock_id;
+    std::unordered_map<uint32_t,std::future<void>> pending_page_flips;
+    std::unordered_map<uint32_t,Frame> completed_page_flips;
+    /* Last, so its dispatch thread stops before the state it updates is destroyed */
+    kms::DRMEventDispatcher event_dispatcher;
 };
 
 }
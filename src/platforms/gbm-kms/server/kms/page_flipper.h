@@ -35,6 +35,14 @@ public:
     virtual ~PageFlipper() {}
 
     virtual bool schedule_flip(uint32_t crtc_id, uint32_t fb_id, uint32_t connector_id) = 0;
+    /**
+     * Schedule a flip that takes effect as soon as possible rather than
+     * waiting for vblank, so the scanout may tear.
+     *
+     * \return False if async flips are unsupported or the flip failed; the
+     *         caller should fall back to schedule_flip().
+     */
+    virtual bool schedule_async_flip(uint32_t crtc_id, uint32_t fb_id, uint32_t connector_id) = 0;
     virtual Frame wait_for_flip(uint32_t crtc_id) = 0;
 
 protected:
@@ -19,10 +19,11 @@
 #include "real_kms_output.h"
 #include "mir/graphics/display_configuration.h"
 #include "page_flipper.h"
+#include "colour_management.h"
 #include "kms-utils/kms_connector.h"
 #include "mir/fatal.h"
 #include "mir/log.h"
-#include <string.h> // strcmp
+#include <string.h> // strcmp, memcmp
 #include <sys/stat.h>
 
 #include <boost/throw_exception.hpp>
@@ -34,6 +35,52 @@ namespace mgg = mg::gbm;
 namespace mgk = mg::kms;
 namespace geom = mir::geometry;
 
+namespace
+{
+bool connector_is_vrr_capable(int drm_fd, mgk::DRMModeConnectorUPtr const& connector)
+{
+    try
+    {
+        mgk::ObjectProperties connector_props{drm_fd, connector->connector_id, DRM_MODE_OBJECT_CONNECTOR};
+        return connector_props.has_property("vrr_capable") && connector_props["vrr_capable"];
+    }
+    catch (std::system_error const& error)
+    {
+        mir::log_debug(
+            "Failed to query variable refresh support of connector %u: %s",
+            connector->connector_id,
+            error.what());
+        return false;
+    }
+}
+
+#ifndef DRM_MODE_ROTATE_0
+#define DRM_MODE_ROTATE_0   (1<<0)
+#define DRM_MODE_ROTATE_90  (1<<1)
+#define DRM_MODE_ROTATE_180 (1<<2)
+#define DRM_MODE_ROTATE_270 (1<<3)
+#endif
+
+/*
+ * The DRM "rotation" property is counter-clockwise; mg::transformation()
+ * maps mir_orientation_left (90° counter-clockwise) to mat2(0,1,-1,0).
+ *
+ * \return the DRM_MODE_ROTATE_* bit, or 0 for a transformation KMS can't express
+ */
+auto drm_rotation_for(glm::mat2 const& transformation) -> uint64_t
+{
+    if (transformation == glm::mat2{1})
+        return DRM_MODE_ROTATE_0;
+    if (transformation == glm::mat2{0, 1, -1, 0})
+        return DRM_MODE_ROTATE_90;
+    if (transformation == glm::mat2{-1})
+        return DRM_MODE_ROTATE_180;
+    if (transformation == glm::mat2{0, -1, 1, 0})
+        return DRM_MODE_ROTATE_270;
+    return 0;
+}
+}
+
 class mgg::FBHandle
 {
 public:
@@ -71,7 +118,10 @@ mgg::RealKMSOutput::RealKMSOutput(
       saved_crtc(),
       using_saved_crtc{true},
       has_cursor_{false},
-      power_mode(mir_power_mode_on)
+      power_mode(mir_power_mode_on),
+      vrr_capable{false},
+      vrr_enabled{false},
+      vrr_change_failed{false}
 {
     reset();
 
@@ -126,8 +176,14 @@ void mgg::RealKMSOutput::reset()
         }
     }
 
+    vrr_capable = connector_is_vrr_capable(drm_fd_, connector);
+
     /* Discard previously current crtc */
     current_crtc = nullptr;
+    vrr_enabled = false;
+    vrr_change_failed = false;
+    plane_rotation = {};
+    colour_pipeline.programmed = false;
 }
 
 geom::Size mgg::RealKMSOutput::size() const
@@ -149,6 +205,9 @@ void mgg::RealKMSOutput::configure(geom::Displacement offset, size_t kms_mode_in
 {
     fb_offset = offset;
     mode_index = kms_mode_index;
+
+    // Give variable refresh another chance if the driver refused it for the old configuration
+    vrr_change_failed = false;
 }
 
 bool mgg::RealKMSOutput::set_crtc(FBHandle const& fb)
@@ -167,6 +226,10 @@ bool mgg::RealKMSOutput::set_crtc(FBHandle const& fb)
     if (ret)
     {
         current_crtc = nullptr;
+        vrr_enabled = false;
+        vrr_change_failed = false;
+        plane_rotation = {};
+        colour_pipeline.programmed = false;
         return false;
     }
 
@@ -191,6 +254,9 @@ void mgg::RealKMSOutput::clear_crtc()
         return;
     }
 
+    vrr_change_failed = false;
+    set_vrr_enabled(false);
+
     auto result = drmModeSetCrtc(drm_fd_, current_crtc->crtc_id,
                                  0, 0, 0, nullptr, 0, nullptr);
     if (result)
@@ -217,6 +283,10 @@ void mgg::RealKMSOutput::clear_crtc()
     }
 
     current_crtc = nullptr;
+    vrr_enabled = false;
+    vrr_change_failed = false;
+    plane_rotation = {};
+    colour_pipeline.programmed = false;
 }
 
 bool mgg::RealKMSOutput::schedule_page_flip(FBHandle const& fb)
@@ -236,6 +306,19 @@ bool mgg::RealKMSOutput::schedule_page_flip(FBHandle const& fb)
         connector->connector_id);
 }
 
+bool mgg::RealKMSOutput::schedule_async_page_flip(FBHandle const& fb)
+{
+    std::unique_lock<std::mutex> lg(power_mutex);
+    if (power_mode != mir_power_mode_on)
+        return true;
+    if (!current_crtc)
+        return false;
+    return page_flipper->schedule_async_flip(
+        current_crtc->crtc_id,
+        fb.get_drm_fb_id(),
+        connector->connector_id);
+}
+
 void mgg::RealKMSOutput::wait_for_page_flip()
 {
     std::unique_lock<std::mutex> lg(power_mutex);
@@ -323,7 +406,7 @@ bool mgg::RealKMSOutput::ensure_crtc()
         return false;
 
     current_crtc = mgk::find_crtc_for_connector(drm_fd_, connector);
-
+    find_primary_plane_rotation();
 
     return (current_crtc != nullptr);
 }
@@ -332,6 +415,9 @@ void mgg::RealKMSOutput::restore_saved_crtc()
 {
     if (!using_saved_crtc)
     {
+        vrr_change_failed = false;
+        set_vrr_enabled(false);
+
         drmModeSetCrtc(drm_fd_, saved_crtc.crtc_id, saved_crtc.buffer_id,
                        saved_crtc.x, saved_crtc.y,
                        &connector->connector_id, 1, &saved_crtc.mode);
@@ -340,6 +426,167 @@ void mgg::RealKMSOutput::restore_saved_crtc()
     }
 }
 
+bool mgg::RealKMSOutput::set_vrr_enabled(bool enabled)
+{
+    /*
+     * This is called every frame, so only touch the property when the state
+     * changes. After the driver refuses a change, stick with what we have
+     * until the output is reconfigured.
+     */
+    if (enabled == vrr_enabled || vrr_change_failed)
+        return vrr_enabled;
+
+    if (!current_crtc || (enabled && !vrr_capable))
+        return vrr_enabled;
+
+    uint32_t vrr_property{0};
+    try
+    {
+        mgk::ObjectProperties crtc_props{drm_fd_, current_crtc->crtc_id, DRM_MODE_OBJECT_CRTC};
+        if (crtc_props.has_property("VRR_ENABLED"))
+            vrr_property = crtc_props.id_for("VRR_ENABLED");
+    }
+    catch (std::system_error const&)
+    {
+    }
+
+    int const result = vrr_property ?
+        drmModeObjectSetProperty(
+            drm_fd_,
+            current_crtc->crtc_id,
+            DRM_MODE_OBJECT_CRTC,
+            vrr_property,
+            enabled) :
+        -ENOTSUP;
+
+    if (result)
+    {
+        mir::log_warning(
+            "Failed to %s variable refresh on output %s: %s",
+            enabled ? "enable" : "disable",
+            mgk::connector_name(connector).c_str(),
+            strerror(-result));
+
+        vrr_change_failed = true;
+        return vrr_enabled;
+    }
+
+    vrr_enabled = enabled;
+    mir::log_debug(
+        "Variable refresh %s on output %s",
+        enabled ? "enabled" : "disabled",
+        mgk::connector_name(connector).c_str());
+    return vrr_enabled;
+}
+
+void mgg::RealKMSOutput::find_primary_plane_rotation()
+{
+    plane_rotation = {};
+    if (!current_crtc)
+        return;
+
+    try
+    {
+        // Without this the primary plane is hidden from us, like the cursor plane
+        drmSetClientCap(drm_fd_, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1);
+
+        kms::DRMModeResources resources{drm_fd_};
+        int crtc_index{0};
+        for (auto const& crtc : resources.crtcs())
+        {
+            if (crtc->crtc_id == current_crtc->crtc_id)
+                break;
+            ++crtc_index;
+        }
+
+        mgk::PlaneResources plane_res{drm_fd_};
+        for (auto const& plane : plane_res.planes())
+        {
+            if (!(plane->possible_crtcs & (1 << crtc_index)))
+                continue;
+
+            mgk::ObjectProperties plane_props{drm_fd_, plane->plane_id, DRM_MODE_OBJECT_PLANE};
+            if (plane_props["type"] != DRM_PLANE_TYPE_PRIMARY)
+                continue;
+
+            if (!plane_props.has_property("rotation"))
+                return;
+
+            plane_rotation.plane_id = plane->plane_id;
+            plane_rotation.property_id = plane_props.id_for("rotation");
+            plane_rotation.current = plane_props["rotation"];
+
+            auto const property = drmModeGetProperty(drm_fd_, plane_rotation.property_id);
+            if (property)
+            {
+                for (int i = 0; i < property->count_enums; ++i)
+                    plane_rotation.supported |= 1ull << property->enums[i].value;
+                drmModeFreeProperty(property);
+            }
+            return;
+        }
+    }
+    catch (std::exception const& error)
+    {
+        mir::log_debug(
+            "Failed to query scanout rotation support of output %s: %s",
+            mgk::connector_name(connector).c_str(),
+            error.what());
+        plane_rotation = {};
+    }
+}
+
+bool mgg::RealKMSOutput::supports_scanout_transformation(glm::mat2 const& transformation) const
+{
+    auto const rotation = drm_rotation_for(transformation);
+    if (rotation == DRM_MODE_ROTATE_0)
+        return true;
+
+    /*
+     * A 90° or 270° rotation needs a framebuffer the other way round from the
+     * mode, which legacy page flips (unlike atomic commits) can't describe.
+     */
+    if (rotation != DRM_MODE_ROTATE_180)
+        return false;
+
+    return plane_rotation.plane_id && (plane_rotation.supported & rotation);
+}
+
+bool mgg::RealKMSOutput::set_scanout_transformation(glm::mat2 const& transformation)
+{
+    auto const rotation = drm_rotation_for(transformation);
+    if (!rotation || !ensure_crtc())
+        return false;
+
+    if (!plane_rotation.plane_id)
+        return rotation == DRM_MODE_ROTATE_0;
+
+    if ((rotation & plane_rotation.current) == rotation)
+        return true;
+
+    if (!supports_scanout_transformation(transformation))
+        return false;
+
+    auto const result = drmModeObjectSetProperty(
+        drm_fd_,
+        plane_rotation.plane_id,
+        DRM_MODE_OBJECT_PLANE,
+        plane_rotation.property_id,
+        rotation);
+
+    if (result)
+    {
+        mir::log_warning(
+            "Failed to set scanout rotation on output %s: %s",
+            mgk::connector_name(connector).c_str(),
+            strerror(-result));
+        return false;
+    }
+
+    plane_rotation.current = rotation;
+    return true;
+}
+
 void mgg::RealKMSOutput::set_power_mode(MirPowerMode mode)
 {
     std::lock_guard<std::mutex> lg(power_mutex);
@@ -356,6 +603,11 @@ void mgg::RealKMSOutput::set_power_mode(MirPowerMode mode)
 }
 
 void mgg::RealKMSOutput::set_gamma(mg::GammaCurves const& gamma)
+{
+    set_colour_pipeline(gamma, glm::mat3{1});
+}
+
+void mgg::RealKMSOutput::set_colour_pipeline(mg::GammaCurves const& gamma, glm::mat3 const& colour_transform)
 {
     if (!ensure_crtc())
     {
@@ -371,6 +623,87 @@ void mgg::RealKMSOutput::set_gamma(mg::GammaCurves const& gamma)
             std::invalid_argument("set_gamma: mismatch gamma LUT sizes"));
     }
 
+    if (colour_pipeline.programmed &&
+        colour_pipeline.transform == colour_transform &&
+        colour_pipeline.gamma.red == gamma.red &&
+        colour_pipeline.gamma.green == gamma.green &&
+        colour_pipeline.gamma.blue == gamma.blue)
+    {
+        return;
+    }
+
+    uint32_t ctm_property{0}, degamma_property{0}, gamma_lut_property{0};
+    uint64_t degamma_size{0}, gamma_lut_size{0};
+    try
+    {
+        mgk::ObjectProperties crtc_props{drm_fd_, current_crtc->crtc_id, DRM_MODE_OBJECT_CRTC};
+        if (crtc_props.has_property("CTM"))
+            ctm_property = crtc_props.id_for("CTM");
+        if (crtc_props.has_property("DEGAMMA_LUT") && crtc_props.has_property("DEGAMMA_LUT_SIZE"))
+        {
+            degamma_property = crtc_props.id_for("DEGAMMA_LUT");
+            degamma_size = crtc_props["DEGAMMA_LUT_SIZE"];
+        }
+        if (crtc_props.has_property("GAMMA_LUT") && crtc_props.has_property("GAMMA_LUT_SIZE"))
+        {
+            gamma_lut_property = crtc_props.id_for("GAMMA_LUT");
+            gamma_lut_size = crtc_props["GAMMA_LUT_SIZE"];
+        }
+    }
+    catch (std::system_error const&)
+    {
+        // No colour management properties; only the legacy gamma ramp is available
+    }
+
+    if (colour_transform == glm::mat3{1})
+    {
+        // Undo any transformation we applied previously
+        if (ctm_property)
+            set_crtc_blob_property(ctm_property, nullptr, 0);
+        if (degamma_property)
+            set_crtc_blob_property(degamma_property, nullptr, 0);
+        set_legacy_gamma(gamma);
+    }
+    else if (ctm_property)
+    {
+        auto const ctm = colour::drm_ctm_for(colour_transform);
+        if (set_crtc_blob_property(ctm_property, &ctm, sizeof ctm))
+        {
+            if (degamma_size && gamma_lut_size)
+            {
+                // Apply the transformation to linear light, rather than to sRGB-encoded values
+                auto const degamma = colour::srgb_degamma_lut(degamma_size);
+                auto const lut = colour::drm_gamma_lut_for(gamma, gamma_lut_size, true);
+                if (set_crtc_blob_property(degamma_property, degamma.data(), degamma.size() * sizeof degamma[0]))
+                    set_crtc_blob_property(gamma_lut_property, lut.data(), lut.size() * sizeof lut[0]);
+            }
+            else
+            {
+                set_legacy_gamma(gamma);
+            }
+        }
+    }
+    else if (colour::is_diagonal(colour_transform) && !gamma.red.empty())
+    {
+        // Without a CTM a per-channel scale (e.g. a colour temperature) can still go into the gamma ramp
+        set_legacy_gamma(colour::tinted(gamma, colour_transform));
+    }
+    else
+    {
+        mir::log_warning(
+            "Output %s can not apply the requested colour transformation in hardware",
+            mgk::connector_name(connector).c_str());
+        set_legacy_gamma(gamma);
+    }
+
+    // Any failure has been logged; don't retry (and log it again) until the settings or the CRTC change
+    colour_pipeline.programmed = true;
+    colour_pipeline.gamma = gamma;
+    colour_pipeline.transform = colour_transform;
+}
+
+bool mgg::RealKMSOutput::set_legacy_gamma(mg::GammaCurves const& gamma)
+{
     int ret = drmModeCrtcSetGamma(
         drm_fd_,
         current_crtc->crtc_id,
@@ -383,13 +716,113 @@ void mgg::RealKMSOutput::set_gamma(mg::GammaCurves const& gamma)
     if (err)
         mir::log_warning("drmModeCrtcSetGamma failed: %s", strerror(err));
 
-    // TODO: return bool in future? Then do what with it?
+    return !err;
+}
+
+bool mgg::RealKMSOutput::set_crtc_blob_property(uint32_t property_id, void const* data, size_t size)
+{
+    uint32_t blob_id{0};
+    if (data)
+    {
+        if (auto const err = -drmModeCreatePropertyBlob(drm_fd_, data, size, &blob_id))
+        {
+            mir::log_warning("Failed to create DRM property blob: %s", strerror(err));
+            return false;
+        }
+    }
+
+    auto const err = -drmModeObjectSetProperty(
+        drm_fd_,
+        current_crtc->crtc_id,
+        DRM_MODE_OBJECT_CRTC,
+        property_id,
+        blob_id);
+
+    // The CRTC holds its own reference to the blob
+    if (blob_id)
+        drmModeDestroyPropertyBlob(drm_fd_, blob_id);
+
+    if (err)
+    {
+        mir::log_warning(
+            "Failed to set colour management property on output %s: %s",
+            mgk::connector_name(connector).c_str(),
+            strerror(err));
+    }
+    return !err;
+}
+
+void mgg::RealKMSOutput::set_hdr_metadata(optional_value<HdrOutputMetadata> const& metadata)
+{
+    optional_value<hdr_output_metadata> wanted;
+    if (metadata.is_set())
+        wanted = colour::drm_hdr_metadata_for(metadata.value());
+
+    if (wanted.is_set() == hdr_metadata.is_set() &&
+        (!wanted.is_set() || memcmp(&wanted.value(), &hdr_metadata.value(), sizeof(hdr_output_metadata)) == 0))
+    {
+        return;
+    }
+
+    // As with the colour pipeline, any failure is logged once rather than retried with each configuration
+    hdr_metadata = wanted;
+
+    uint32_t property{0};
+    try
+    {
+        mgk::ObjectProperties connector_props{drm_fd_, connector->connector_id, DRM_MODE_OBJECT_CONNECTOR};
+        if (connector_props.has_property("HDR_OUTPUT_METADATA"))
+            property = connector_props.id_for("HDR_OUTPUT_METADATA");
+    }
+    catch (std::system_error const&)
+    {
+    }
+
+    if (!property)
+    {
+        if (wanted.is_set())
+            mir::log_warning("Output %s does not support HDR metadata", mgk::connector_name(connector).c_str());
+        return;
+    }
+
+    uint32_t blob_id{0};
+    if (wanted.is_set())
+    {
+        if (auto const err = -drmModeCreatePropertyBlob(drm_fd_, &wanted.value(), sizeof(hdr_output_metadata), &blob_id))
+        {
+            mir::log_warning("Failed to create DRM property blob: %s", strerror(err));
+            return;
+        }
+    }
+
+    auto const err = -drmModeObjectSetProperty(
+        drm_fd_,
+        connector->connector_id,
+        DRM_MODE_OBJECT_CONNECTOR,
+        property,
+        blob_id);
+
+    if (blob_id)
+        drmModeDestroyPropertyBlob(drm_fd_, blob_id);
+
+    if (err)
+    {
+        mir::log_warning(
+            "Failed to set HDR metadata on output %s: %s",
+            mgk::connector_name(connector).c_str(),
+            strerror(err));
+    }
 }
 
 void mgg::RealKMSOutput::refresh_hardware_state()
 {
     connector = kms::get_connector(drm_fd_, connector->connector_id);
+    vrr_capable = connector_is_vrr_capable(drm_fd_, connector);
     current_crtc = nullptr;
+    vrr_enabled = false;
+    vrr_change_failed = false;
+    plane_rotation = {};
+    colour_pipeline.programmed = false;
 
     if (connector->encoder_id)
     {
@@ -398,6 +831,7 @@ void mgg::RealKMSOutput::refresh_hardware_state()
         if (encoder->crtc_id)
         {
             current_crtc = kms::get_crtc(drm_fd_, encoder->crtc_id);
+            find_primary_plane_rotation();
         }
     }
 }
@@ -611,6 +1045,7 @@ void mgg::RealKMSOutput::update_from_hardware_state(
     output.subpixel_arrangement = kms_subpixel_to_mir_subpixel(connector->subpixel);
     output.gamma = gamma;
     output.edid = edid;
+    output.vrr_capable = vrr_capable;
 }
 
 namespace
@@ -632,14 +1067,58 @@ auto mgg::RealKMSOutput::FBRegistry::lookup_or_create(int const drm_fd, gbm_bo*
      * Check if we have already set up this gbm_bo (the gbm-kms implementation is
      * free to reuse gbm_bos). If so, return the associated FBHandle.
      */
-    auto bufobj = static_cast<std::shared_ptr<FBHandle const>*>(gbm_bo_get_user_data(bo));
-    if (bufobj)
+    if (auto const bufobj = static_cast<std::shared_ptr<FBHandle const>*>(gbm_bo_get_user_data(bo)))
+    {
+        return *bufobj;
+    }
+
+    return create_fb(drm_fd, bo, gbm_bo_get_handle(bo).u32);
+}
+
+auto mgg::RealKMSOutput::FBRegistry::lookup_or_import(int const drm_fd, gbm_bo* bo)
+    -> std::shared_ptr<FBHandle const>
+{
+    if (!bo)
+        return nullptr;
+
+    if (auto const bufobj = static_cast<std::shared_ptr<FBHandle const>*>(gbm_bo_get_user_data(bo)))
     {
         return *bufobj;
     }
 
+    /*
+     * The bo belongs to another GPU, so its GEM handle means nothing to our
+     * device. Share it through a dma-buf instead; whether the display engine
+     * can scan out of the exporter's memory is only known once AddFB2 succeeds.
+     */
+    mir::Fd const dma_buf{gbm_bo_get_fd(bo)};
+    if (dma_buf < 0)
+        return nullptr;
+
+    uint32_t gem_handle;
+    if (drmPrimeFDToHandle(drm_fd, dma_buf, &gem_handle))
+    {
+        mir::log_debug(
+            "Failed to import rendering GPU buffer into display device: %s",
+            std::system_category().message(errno).c_str());
+        return nullptr;
+    }
+
+    auto fb = create_fb(drm_fd, bo, gem_handle);
+
+    /* The FB holds its own reference to the buffer, so we needn't keep the handle */
+    struct drm_gem_close close_request{};
+    close_request.handle = gem_handle;
+    drmIoctl(drm_fd, DRM_IOCTL_GEM_CLOSE, &close_request);
+
+    return fb;
+}
+
+auto mgg::RealKMSOutput::FBRegistry::create_fb(int const drm_fd, gbm_bo* bo, uint32_t gem_handle)
+    -> std::shared_ptr<FBHandle const>
+{
     uint32_t fb_id{0};
-    uint32_t handles[4] = {gbm_bo_get_handle(bo).u32, 0, 0, 0};
+    uint32_t handles[4] = {gem_handle, 0, 0, 0};
     uint32_t strides[4] = {gbm_bo_get_stride(bo), 0, 0, 0};
     uint32_t offsets[4] = {0, 0, 0, 0};
 
@@ -664,7 +1143,7 @@ auto mgg::RealKMSOutput::FBRegistry::lookup_or_create(int const drm_fd, gbm_bo*
 
     /* Create a FBHandle and associate it with the gbm_bo */
 
-    bufobj = new std::shared_ptr<FBHandle const>(new FBHandle{drm_fd, fb_id});
+    auto const bufobj = new std::shared_ptr<FBHandle const>(new FBHandle{drm_fd, fb_id});
     gbm_bo_set_user_data(bo, bufobj, bo_user_data_destroy);
 
     return *bufobj;
@@ -675,6 +1154,11 @@ auto mgg::RealKMSOutput::fb_for(gbm_bo* bo) const -> std::shared_ptr<FBHandle co
     return framebuffers.lookup_or_create(drm_fd(), bo);
 }
 
+auto mgg::RealKMSOutput::prime_fb_for(gbm_bo* bo) const -> std::shared_ptr<FBHandle const>
+{
+    return framebuffers.lookup_or_import(drm_fd(), bo);
+}
+
 struct mgg::RealKMSOutput::FBRegistry::DMABufFB
 {
     std::array<Fd, 4> const fds;
@@ -54,6 +54,7 @@ public:
     bool set_crtc(FBHandle const& fb) override;
     void clear_crtc() override;
     bool schedule_page_flip(FBHandle const& fb) override;
+    bool schedule_async_page_flip(FBHandle const& fb) override;
     void wait_for_page_flip() override;
 
     bool set_cursor(gbm_bo* buffer) override;
@@ -61,8 +62,14 @@ public:
     bool clear_cursor() override;
     bool has_cursor() const override;
 
+    bool set_vrr_enabled(bool enabled) override;
+    bool supports_scanout_transformation(glm::mat2 const& transformation) const override;
+    bool set_scanout_transformation(glm::mat2 const& transformation) override;
+
     void set_power_mode(MirPowerMode mode) override;
     void set_gamma(GammaCurves const& gamma) override;
+    void set_colour_pipeline(GammaCurves const& gamma, glm::mat3 const& colour_transform) override;
+    void set_hdr_metadata(optional_value<HdrOutputMetadata> const& metadata) override;
 
     Frame last_frame() const override;
 
@@ -70,6 +77,7 @@ public:
     void update_from_hardware_state(DisplayConfigurationOutput& output) const override;
 
     auto fb_for(gbm_bo* bo) const -> std::shared_ptr<FBHandle const> override;
+    auto prime_fb_for(gbm_bo* bo) const -> std::shared_ptr<FBHandle const> override;
     auto fb_for(DMABufBuffer const& image) const -> std::shared_ptr<FBHandle const> override;
 
     bool buffer_requires_migration(gbm_bo* bo) const override;
@@ -78,6 +86,9 @@ public:
 private:
     bool ensure_crtc();
     void restore_saved_crtc();
+    void find_primary_plane_rotation();
+    bool set_legacy_gamma(GammaCurves const& gamma);
+    bool set_crtc_blob_property(uint32_t property_id, void const* data, size_t size);
 
     int const drm_fd_;
     std::shared_ptr<PageFlipper> const page_flipper;
@@ -90,9 +101,12 @@ private:
     public:
         auto lookup_or_create(int const drm_fd, gbm_bo* bo) -> std::shared_ptr<FBHandle const>;
         auto lookup_or_create(int const drm_fd, DMABufBuffer const& image) -> std::shared_ptr<FBHandle const>;
+        auto lookup_or_import(int const drm_fd, gbm_bo* bo) -> std::shared_ptr<FBHandle const>;
 
         struct DMABufFB;
     private:
+        auto create_fb(int const drm_fd, gbm_bo* bo, uint32_t gem_handle) -> std::shared_ptr<FBHandle const>;
+
         std::vector<std::shared_ptr<DMABufFB>> dmabuf_fbs;
     };
     FBRegistry mutable framebuffers;
@@ -108,6 +122,28 @@ private:
     MirPowerMode power_mode;
     int dpms_enum_id;
 
+    bool vrr_capable;
+    bool vrr_enabled;
+    bool vrr_change_failed; ///< The driver refused to change vrr_enabled since the last configure()
+
+    /// The primary plane's "rotation" property, if the driver has one
+    struct PlaneRotation
+    {
+        uint32_t plane_id{0};
+        uint32_t property_id{0};
+        uint64_t supported{0};  ///< DRM_MODE_ROTATE_* bits
+        uint64_t current{0};    ///< Zero if unknown
+    } plane_rotation;
+
+    /// What the CRTC's colour pipeline was last programmed with, so unchanged settings can be skipped
+    struct ColourPipeline
+    {
+        bool programmed{false};  ///< Whether the CRTC has been given these, whether or not it took them
+        GammaCurves gamma;
+        glm::mat3 transform{1};
+    } colour_pipeline;
+    optional_value<hdr_output_metadata> hdr_metadata;
+
     std::mutex power_mutex;
 
     AtomicFrame last_frame_;
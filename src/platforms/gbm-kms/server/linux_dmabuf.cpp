@@ -943,6 +943,19 @@ auto mgg::LinuxDmaBufUnstable::buffer_from_resource(
     return nullptr;
 }
 
+auto mgg::LinuxDmaBufUnstable::fences_for_resource(wl_resource* buffer) -> std::vector<Fd>
+{
+    std::vector<Fd> fences;
+    if (auto dmabuf = WlDmaBufBuffer::maybe_dmabuf_from_wl_buffer(buffer))
+    {
+        for (auto const& plane : dmabuf->planes())
+        {
+            fences.push_back(plane.dma_buf);
+        }
+    }
+    return fences;
+}
+
 void mgg::LinuxDmaBufUnstable::bind(wl_resource* new_resource)
 {
     new LinuxDmaBufUnstable::Instance{new_resource, dpy, egl_extensions, *formats};
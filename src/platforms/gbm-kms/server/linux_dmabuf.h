@@ -25,6 +25,7 @@
 
 #include "mir/graphics/buffer.h"
 #include "mir/graphics/egl_extensions.h"
+#include "mir/fd.h"
 
 
 namespace mir
@@ -62,6 +63,13 @@ public:
         std::function<void()>&& on_release,
         std::shared_ptr<Executor> wayland_executor);
 
+    /**
+     * The dma-bufs backing buffer, if it is a dma-buf buffer
+     *
+     * A dma-buf polls readable once all writes to it (its implicit fence) have completed.
+     */
+    auto fences_for_resource(wl_resource* buffer) -> std::vector<Fd>;
+
 private:
     class Instance;
     void bind(wl_resource* new_resource) override;
@@ -0,0 +1,293 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define MIR_LOG_COMPONENT "headless"
+
+#include "display.h"
+#include "display_buffer.h"
+#include "display_configuration.h"
+#include "platform.h"
+#include "mir/graphics/atomic_frame.h"
+#include "mir/graphics/display_configuration_policy.h"
+#include "mir/graphics/display_report.h"
+#include "mir/graphics/egl_error.h"
+#include "mir/graphics/egl_extensions.h"
+#include "mir/graphics/gl_config.h"
+#include "mir/graphics/virtual_output.h"
+#include "mir/renderer/gl/context.h"
+#include "mir/log.h"
+
+#include <boost/throw_exception.hpp>
+#include <EGL/eglext.h>
+
+#include <cstring>
+#include <stdexcept>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+namespace mg = mir::graphics;
+namespace mgh = mg::headless;
+namespace geom = mir::geometry;
+
+namespace
+{
+bool has_extension(char const* extensions, char const* extension)
+{
+    if (!extensions)
+        return false;
+
+    auto const length = strlen(extension);
+    for (auto found = strstr(extensions, extension); found; found = strstr(found + length, extension))
+    {
+        if ((found == extensions || found[-1] == ' ') && (found[length] == '\0' || found[length] == ' '))
+            return true;
+    }
+    return false;
+}
+
+auto create_egl_display() -> EGLDisplay
+{
+    mg::EGLExtensions::PlatformBaseEXT const platform_base;
+
+    if (!has_extension(eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS), "EGL_MESA_platform_surfaceless"))
+        BOOST_THROW_EXCEPTION(std::runtime_error("EGL implementation doesn't support EGL_MESA_platform_surfaceless"));
+
+    auto const display = platform_base.eglGetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display == EGL_NO_DISPLAY)
+        BOOST_THROW_EXCEPTION(mg::egl_error("Failed to get surfaceless EGL display"));
+
+    EGLint major, minor;
+    if (eglInitialize(display, &major, &minor) != EGL_TRUE)
+        BOOST_THROW_EXCEPTION(mg::egl_error("Failed to initialize EGL"));
+
+    mir::log_info("Surfaceless EGL %d.%d: %s", major, minor, eglQueryString(display, EGL_VENDOR));
+
+    if (!has_extension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+    {
+        eglTerminate(display);
+        BOOST_THROW_EXCEPTION(std::runtime_error("EGL implementation doesn't support EGL_KHR_surfaceless_context"));
+    }
+
+    return display;
+}
+
+auto choose_config(EGLDisplay display) -> EGLConfig
+{
+    // We only ever render into framebuffer objects, so don't care which surfaces the config supports
+    static EGLint const config_attr[] = {
+        EGL_SURFACE_TYPE, 0,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 0,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+        EGL_NONE
+    };
+
+    EGLConfig config;
+    EGLint num_configs;
+    if (eglChooseConfig(display, config_attr, &config, 1, &num_configs) != EGL_TRUE || num_configs != 1)
+        BOOST_THROW_EXCEPTION(mg::egl_error("Failed to choose EGL config"));
+
+    return config;
+}
+
+class SurfacelessGLContext : public mir::renderer::gl::Context
+{
+public:
+    SurfacelessGLContext(EGLDisplay display, EGLConfig config, EGLContext shared_context)
+        : display{display},
+          context{mgh::detail::create_context(display, config, shared_context)}
+    {
+    }
+
+    ~SurfacelessGLContext()
+    {
+        eglDestroyContext(display, context);
+    }
+
+    void make_current() const override
+    {
+        if (eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context) != EGL_TRUE)
+            BOOST_THROW_EXCEPTION(mg::egl_error("Failed to make EGL context current"));
+    }
+
+    void release_current() const override
+    {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+
+private:
+    EGLDisplay const display;
+    EGLContext const context;
+};
+}
+
+mgh::Display::Display(
+    std::vector<OutputSpec> const& output_specs,
+    std::string const& dump_directory,
+    std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
+    std::shared_ptr<GLConfig> const& gl_config,
+    std::shared_ptr<DisplayReport> const& report)
+    : egl_display{create_egl_display()},
+      egl_config{choose_config(egl_display)},
+      shared_context{detail::create_context(egl_display, egl_config, EGL_NO_CONTEXT)},
+      report{report}
+{
+    report->report_egl_configuration(egl_display, egl_config);
+
+    geom::Point top_left{0, 0};
+
+    for (auto const& spec : output_specs)
+    {
+        auto configuration = DisplayConfiguration::build_output(spec.size, spec.refresh_hz, top_left);
+        auto last_frame = std::make_shared<AtomicFrame>();
+        auto display_buffer = std::make_unique<mgh::DisplayBuffer>(
+            egl_display,
+            egl_config,
+            shared_context,
+            gl_config->depth_buffer_bits() > 0,
+            configuration->id,
+            spec.size,
+            configuration->extents(),
+            spec.refresh_hz,
+            last_frame,
+            report,
+            dump_directory);
+        outputs.push_back(std::make_unique<OutputInfo>(
+            OutputInfo{move(display_buffer), move(last_frame), configuration}));
+        top_left.x += as_delta(configuration->extents().size.width);
+    }
+
+    auto const display_config = configuration();
+    initial_conf_policy->apply_to(*display_config);
+    configure(*display_config);
+    report->report_successful_display_construction();
+}
+
+mgh::Display::~Display() noexcept
+{
+    outputs.clear();
+    eglDestroyContext(egl_display, shared_context);
+    eglTerminate(egl_display);
+}
+
+void mgh::Display::for_each_display_sync_group(std::function<void(mg::DisplaySyncGroup&)> const& f)
+{
+    for (auto const& output : outputs)
+    {
+        if (output->configuration->used && output->configuration->power_mode == mir_power_mode_on)
+            f(*output->display_buffer);
+    }
+}
+
+std::unique_ptr<mg::DisplayConfiguration> mgh::Display::configuration() const
+{
+    std::vector<DisplayConfigurationOutput> output_configurations;
+    for (auto const& output : outputs)
+    {
+        output_configurations.push_back(*output->configuration);
+    }
+    return std::make_unique<mgh::DisplayConfiguration>(output_configurations);
+}
+
+void mgh::Display::configure(mg::DisplayConfiguration const& new_configuration)
+{
+    if (!new_configuration.valid())
+    {
+        BOOST_THROW_EXCEPTION(
+            std::logic_error("Invalid or inconsistent display configuration"));
+    }
+
+    new_configuration.for_each_output([&](DisplayConfigurationOutput const& conf_output)
+    {
+        bool found_info = false;
+
+        for (auto& output : outputs)
+        {
+            if (output->configuration->id == conf_output.id)
+            {
+                *output->configuration = conf_output;
+                output->display_buffer->set_view_area(output->configuration->extents());
+                output->display_buffer->set_transformation(output->configuration->transformation());
+                if (conf_output.current_mode_index < conf_output.modes.size())
+                    output->display_buffer->set_pixel_size(conf_output.modes[conf_output.current_mode_index].size);
+                found_info = true;
+                break;
+            }
+        }
+
+        if (!found_info)
+            mir::log_error("Could not find info for output %d", conf_output.id.as_value());
+    });
+}
+
+bool mgh::Display::apply_if_configuration_preserves_display_buffers(
+    mg::DisplayConfiguration const& /*conf*/)
+{
+    // The compositor uses the display buffers' view areas, transformations and framebuffers
+    // without any locking, so they can only be changed with it stopped (by configure())
+    return false;
+}
+
+void mgh::Display::register_configuration_change_handler(
+    EventHandlerRegister& /*handlers*/,
+    DisplayConfigurationChangeHandler const& /*change_handler*/)
+{
+}
+
+void mgh::Display::register_pause_resume_handlers(
+    EventHandlerRegister& /*handlers*/,
+    DisplayPauseHandler const& /*pause_handler*/,
+    DisplayResumeHandler const& /*resume_handler*/)
+{
+}
+
+void mgh::Display::pause()
+{
+}
+
+void mgh::Display::resume()
+{
+}
+
+auto mgh::Display::create_hardware_cursor() -> std::shared_ptr<Cursor>
+{
+    return nullptr;
+}
+
+std::unique_ptr<mg::VirtualOutput> mgh::Display::create_virtual_output(int /*width*/, int /*height*/)
+{
+    return nullptr;
+}
+
+std::unique_ptr<mir::renderer::gl::Context> mgh::Display::create_gl_context() const
+{
+    return std::make_unique<SurfacelessGLContext>(egl_display, egl_config, shared_context);
+}
+
+mg::Frame mgh::Display::last_frame_on(unsigned output_id) const
+{
+    for (auto const& output : outputs)
+    {
+        if (output->configuration->id.as_value() == static_cast<int>(output_id))
+            return output->last_frame->load();
+    }
+
+    return {};
+}
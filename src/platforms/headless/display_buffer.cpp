@@ -0,0 +1,326 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define MIR_LOG_COMPONENT "headless"
+
+#include "display_buffer.h"
+#include "mir/graphics/atomic_frame.h"
+#include "mir/graphics/display_report.h"
+#include "mir/graphics/egl_error.h"
+#include "mir/graphics/gl_extensions_base.h"
+#include "mir/fatal.h"
+#include "mir/log.h"
+
+#include <boost/throw_exception.hpp>
+#include <GLES2/gl2ext.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace mg = mir::graphics;
+namespace mgh = mg::headless;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+namespace
+{
+class GLExtensions : public mg::GLExtensionsBase
+{
+public:
+    GLExtensions() :
+        mg::GLExtensionsBase{
+            reinterpret_cast<char const*>(glGetString(GL_EXTENSIONS))}
+    {
+    }
+};
+
+class VectorMapping : public mrs::Mapping<unsigned char>
+{
+public:
+    VectorMapping(std::vector<uint32_t>& pixels, geom::Size size)
+        : pixels{pixels},
+          size_{size}
+    {
+    }
+
+    auto format() const -> MirPixelFormat override { return mir_pixel_format_xrgb_8888; }
+    auto stride() const -> geom::Stride override { return geom::Stride{4 * size_.width.as_int()}; }
+    auto size() const -> geom::Size override { return size_; }
+    auto data() -> unsigned char* override { return reinterpret_cast<unsigned char*>(pixels.data()); }
+    auto len() const -> size_t override { return pixels.size() * sizeof(uint32_t); }
+
+private:
+    std::vector<uint32_t>& pixels;
+    geom::Size const size_;
+};
+}
+
+auto mgh::detail::create_context(EGLDisplay display, EGLConfig config, EGLContext share_with) -> EGLContext
+{
+    static EGLint const context_attr[] = {
+        EGL_CONTEXT_CLIENT_VERSION, 2,
+        EGL_NONE
+    };
+
+    eglBindAPI(EGL_OPENGL_ES_API);
+    auto const context = eglCreateContext(display, config, share_with, context_attr);
+    if (context == EGL_NO_CONTEXT)
+        BOOST_THROW_EXCEPTION(mg::egl_error("Failed to create EGL context"));
+    return context;
+}
+
+mgh::detail::Framebuffer::Framebuffer(geom::Size const& size, bool with_depth)
+    : size{size}
+{
+    GLExtensions const extensions;
+
+    // Frames are read back as 8 bits per channel, so anything less would silently lose colour
+    if (!extensions.support("GL_ARM_rgba8") && !extensions.support("GL_OES_rgb8_rgba8"))
+        BOOST_THROW_EXCEPTION(std::runtime_error("GL implementation doesn't support 8 bit per channel renderbuffers"));
+
+    glGenRenderbuffers(1, &colour_renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colour_renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8_OES, size.width.as_int(), size.height.as_int());
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colour_renderbuffer);
+
+    if (with_depth)
+    {
+        glGenRenderbuffers(1, &depth_renderbuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, depth_renderbuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, size.width.as_int(), size.height.as_int());
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_renderbuffer);
+    }
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Failed to set up headless output framebuffer"));
+}
+
+mgh::detail::Framebuffer::~Framebuffer()
+{
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &colour_renderbuffer);
+    if (depth_renderbuffer)
+        glDeleteRenderbuffers(1, &depth_renderbuffer);
+}
+
+void mgh::detail::Framebuffer::bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, size.width.as_int(), size.height.as_int());
+}
+
+mgh::DisplayBuffer::DisplayBuffer(
+    EGLDisplay egl_display,
+    EGLConfig egl_config,
+    EGLContext shared_context,
+    bool with_depth,
+    DisplayConfigurationOutputId output_id,
+    geom::Size const& pixel_size,
+    geom::Rectangle const& view_area,
+    double refresh_hz,
+    std::shared_ptr<AtomicFrame> const& last_frame,
+    std::shared_ptr<DisplayReport> const& report,
+    std::string const& dump_directory)
+    : egl_display{egl_display},
+      egl_context{detail::create_context(egl_display, egl_config, shared_context)},
+      with_depth{with_depth},
+      output_id{output_id},
+      pixel_size{pixel_size},
+      area{view_area},
+      transform(1),
+      vsync{refresh_hz},
+      last_frame{last_frame},
+      report{report},
+      dump_directory{dump_directory}
+{
+}
+
+mgh::DisplayBuffer::~DisplayBuffer()
+{
+    if (framebuffer)
+    {
+        eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, egl_context);
+        framebuffer.reset();
+        eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+    eglDestroyContext(egl_display, egl_context);
+}
+
+geom::Rectangle mgh::DisplayBuffer::view_area() const
+{
+    return area;
+}
+
+bool mgh::DisplayBuffer::overlay(RenderableList const& /*renderlist*/)
+{
+    return false;
+}
+
+glm::mat2 mgh::DisplayBuffer::transformation() const
+{
+    return transform;
+}
+
+mg::NativeDisplayBuffer* mgh::DisplayBuffer::native_display_buffer()
+{
+    return this;
+}
+
+void mgh::DisplayBuffer::set_view_area(geom::Rectangle const& a)
+{
+    area = a;
+}
+
+void mgh::DisplayBuffer::set_transformation(glm::mat2 const& t)
+{
+    transform = t;
+}
+
+void mgh::DisplayBuffer::set_pixel_size(geom::Size const& size)
+{
+    pixel_size = size;
+}
+
+void mgh::DisplayBuffer::for_each_display_buffer(
+    std::function<void(graphics::DisplayBuffer&)> const& f)
+{
+    f(*this);
+}
+
+void mgh::DisplayBuffer::post()
+{
+    /*
+     * There's no hardware to wait on, so we sleep until the simulated vblank
+     * instead. That keeps the compositor (and, through last_frame, clients)
+     * paced exactly as they would be on a real output of this refresh rate.
+     */
+    auto const frame = vsync.flip();
+    last_frame->store(frame);
+    report->report_vsync(output_id.as_value(), frame);
+
+    if (!dump_directory.empty())
+        dump_frame(frame);
+}
+
+std::chrono::milliseconds mgh::DisplayBuffer::recommended_sleep() const
+{
+    return std::chrono::milliseconds::zero();
+}
+
+void mgh::DisplayBuffer::make_current()
+{
+    if (eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, egl_context) != EGL_TRUE)
+        fatal_error("Failed to make EGL context current");
+
+    if (!framebuffer || framebuffer->size_in_pixels() != pixel_size)
+    {
+        // The old framebuffer has to go first, while its context is current
+        framebuffer.reset();
+        framebuffer = std::make_unique<detail::Framebuffer>(pixel_size, with_depth);
+    }
+}
+
+void mgh::DisplayBuffer::release_current()
+{
+    eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+void mgh::DisplayBuffer::bind()
+{
+    framebuffer->bind();
+}
+
+void mgh::DisplayBuffer::swap_buffers()
+{
+    if (dump_directory.empty())
+    {
+        glFinish();
+        return;
+    }
+
+    // glReadPixels() waits for rendering to finish, so glFinish() isn't needed too
+    front.resize(pixel_size.width.as_int() * pixel_size.height.as_int());
+    glReadPixels(
+        0, 0, pixel_size.width.as_int(), pixel_size.height.as_int(),
+        GL_RGBA, GL_UNSIGNED_BYTE, front.data());
+    front_is_gl = true;
+}
+
+auto mgh::DisplayBuffer::map_back_buffer() -> std::unique_ptr<mrs::Mapping<unsigned char>>
+{
+    back.resize(pixel_size.width.as_int() * pixel_size.height.as_int());
+    return std::make_unique<VectorMapping>(back, pixel_size);
+}
+
+void mgh::DisplayBuffer::present_back_buffer()
+{
+    std::swap(back, front);
+    front_is_gl = false;
+}
+
+void mgh::DisplayBuffer::dump_frame(Frame const& frame)
+{
+    if (front.empty())
+        return;
+
+    char name[64];
+    snprintf(name, sizeof name, "output-%d-%08lld.ppm",
+             output_id.as_value(), static_cast<long long>(frame.msc));
+    auto const path = dump_directory + "/" + name;
+
+    std::ofstream out{path, std::ios::binary};
+    if (!out)
+    {
+        mir::log_error("Failed to open %s, not dumping any more frames", path.c_str());
+        dump_directory.clear();
+        return;
+    }
+
+    auto const width = pixel_size.width.as_int();
+    auto const height = pixel_size.height.as_int();
+    out << "P6\n" << width << " " << height << "\n255\n";
+
+    std::vector<char> row(3 * width);
+    for (auto y = 0; y != height; ++y)
+    {
+        if (front_is_gl)
+        {
+            // GL rows are bottom-up, and each pixel is R, G, B, A bytes in memory
+            auto const source = reinterpret_cast<unsigned char const*>(front.data() + (height - 1 - y) * width);
+            for (auto x = 0; x != width; ++x)
+            {
+                row[3 * x + 0] = source[4 * x + 0];
+                row[3 * x + 1] = source[4 * x + 1];
+                row[3 * x + 2] = source[4 * x + 2];
+            }
+        }
+        else
+        {
+            auto const source = front.data() + y * width;
+            for (auto x = 0; x != width; ++x)
+            {
+                row[3 * x + 0] = (source[x] >> 16) & 0xff;
+                row[3 * x + 1] = (source[x] >> 8) & 0xff;
+                row[3 * x + 2] = source[x] & 0xff;
+            }
+        }
+        out.write(row.data(), row.size());
+    }
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_HEADLESS_DISPLAY_BUFFER_H_
+#define MIR_GRAPHICS_HEADLESS_DISPLAY_BUFFER_H_
+
+#include "mir/graphics/display_buffer.h"
+#include "mir/graphics/display_configuration.h"
+#include "mir/graphics/display.h"
+#include "mir/renderer/gl/render_target.h"
+#include "mir/renderer/sw/render_target.h"
+#include "simulated_vsync.h"
+
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+
+class AtomicFrame;
+class DisplayReport;
+
+namespace headless
+{
+
+namespace detail
+{
+/// Creates a GLES 2 context that can only be made current without a surface
+auto create_context(EGLDisplay display, EGLConfig config, EGLContext share_with) -> EGLContext;
+
+class Framebuffer
+{
+public:
+    /// \note This must be called with a current GL context
+    Framebuffer(geometry::Size const& size, bool with_depth);
+    ~Framebuffer();
+
+    void bind() const;
+    auto size_in_pixels() const -> geometry::Size { return size; }
+
+private:
+    geometry::Size const size;
+    GLuint colour_renderbuffer{0};
+    GLuint depth_renderbuffer{0};
+    GLuint fbo{0};
+};
+}
+
+/**
+ * An output that is never shown anywhere.
+ *
+ * It can be drawn to either with GL (into a framebuffer object, with a
+ * surfaceless EGL context) or with the CPU, and its "page flips" complete
+ * on a simulated vblank.
+ */
+class DisplayBuffer : public graphics::DisplayBuffer,
+                      public graphics::DisplaySyncGroup,
+                      public graphics::NativeDisplayBuffer,
+                      public renderer::gl::RenderTarget,
+                      public renderer::software::RenderTarget
+{
+public:
+    DisplayBuffer(
+        EGLDisplay egl_display,
+        EGLConfig egl_config,
+        EGLContext shared_context,
+        bool with_depth,
+        DisplayConfigurationOutputId output_id,
+        geometry::Size const& pixel_size,
+        geometry::Rectangle const& view_area,
+        double refresh_hz,
+        std::shared_ptr<AtomicFrame> const& last_frame,
+        std::shared_ptr<DisplayReport> const& report,
+        std::string const& dump_directory);
+    ~DisplayBuffer();
+
+    geometry::Rectangle view_area() const override;
+    bool overlay(RenderableList const& renderlist) override;
+    glm::mat2 transformation() const override;
+    NativeDisplayBuffer* native_display_buffer() override;
+    void set_view_area(geometry::Rectangle const& a);
+    void set_transformation(glm::mat2 const& t);
+    /// The framebuffer is recreated at the new size the next time the buffer is made current
+    /// \note Only call this while the buffer isn't being composited
+    void set_pixel_size(geometry::Size const& size);
+
+    void for_each_display_buffer(
+        std::function<void(graphics::DisplayBuffer&)> const& f) override;
+    void post() override;
+    std::chrono::milliseconds recommended_sleep() const override;
+
+    /* From gl::RenderTarget */
+    void make_current() override;
+    void release_current() override;
+    void swap_buffers() override;
+    void bind() override;
+
+    /* From software::RenderTarget */
+    auto map_back_buffer() -> std::unique_ptr<renderer::software::Mapping<unsigned char>> override;
+    void present_back_buffer() override;
+
+private:
+    void dump_frame(Frame const& frame);
+
+    EGLDisplay const egl_display;
+    EGLContext const egl_context;
+    bool const with_depth;
+    DisplayConfigurationOutputId const output_id;
+    geometry::Size pixel_size;
+    geometry::Rectangle area;
+    glm::mat2 transform;
+    std::unique_ptr<detail::Framebuffer> framebuffer;
+
+    // The CPU renderer draws into "back"; "front" also receives GL frames read back for dumping
+    std::vector<uint32_t> back;
+    std::vector<uint32_t> front;
+    bool front_is_gl{false};
+
+    SimulatedVsync vsync;
+    std::shared_ptr<AtomicFrame> const last_frame;
+    std::shared_ptr<DisplayReport> const report;
+    std::string dump_directory;
+};
+
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_HEADLESS_DISPLAY_BUFFER_H_ */
@@ -0,0 +1,99 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "display_configuration.h"
+
+namespace mg = mir::graphics;
+namespace mgh = mg::headless;
+namespace geom = mir::geometry;
+
+int mgh::DisplayConfiguration::last_output_id{0};
+
+std::shared_ptr<mg::DisplayConfigurationOutput> mgh::DisplayConfiguration::build_output(
+    geom::Size const pixels,
+    double refresh_hz,
+    geom::Point const top_left)
+{
+    auto const pf = mir_pixel_format_xrgb_8888;
+    // Pretend to be a 96dpi monitor
+    geom::Size const physical_size_mm{pixels.width.as_int() * 254 / 960, pixels.height.as_int() * 254 / 960};
+
+    last_output_id++;
+    return std::shared_ptr<DisplayConfigurationOutput>(
+        new DisplayConfigurationOutput{
+            mg::DisplayConfigurationOutputId{last_output_id},
+            mg::DisplayConfigurationCardId{0},
+            mg::DisplayConfigurationLogicalGroupId{0},
+            mg::DisplayConfigurationOutputType::virt,
+            {pf},
+            {mg::DisplayConfigurationMode{pixels, refresh_hz}},
+            0,
+            physical_size_mm,
+            true,
+            true,
+            top_left,
+            0,
+            pf,
+            mir_power_mode_on,
+            mir_orientation_normal,
+            1.0f,
+            mir_form_factor_monitor,
+            mir_subpixel_arrangement_unknown,
+            {},
+            mir_output_gamma_unsupported,
+            {},
+            {}});
+}
+
+mgh::DisplayConfiguration::DisplayConfiguration(std::vector<mg::DisplayConfigurationOutput> const& configuration)
+    : configuration{configuration},
+      card{mg::DisplayConfigurationCardId{0}, configuration.size()}
+{
+}
+
+mgh::DisplayConfiguration::DisplayConfiguration(DisplayConfiguration const& other)
+    : mg::DisplayConfiguration(),
+      configuration(other.configuration),
+      card(other.card)
+{
+}
+
+void mgh::DisplayConfiguration::for_each_card(std::function<void(mg::DisplayConfigurationCard const&)> f) const
+{
+    f(card);
+}
+
+void mgh::DisplayConfiguration::for_each_output(std::function<void(mg::DisplayConfigurationOutput const&)> f) const
+{
+    for (auto const& output : configuration)
+    {
+        f(output);
+    }
+}
+
+void mgh::DisplayConfiguration::for_each_output(std::function<void(mg::UserDisplayConfigurationOutput&)> f)
+{
+    for (auto& output : configuration)
+    {
+        mg::UserDisplayConfigurationOutput user(output);
+        f(user);
+    }
+}
+
+std::unique_ptr<mg::DisplayConfiguration> mgh::DisplayConfiguration::clone() const
+{
+    return std::make_unique<mgh::DisplayConfiguration>(*this);
+}
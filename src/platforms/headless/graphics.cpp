@@ -0,0 +1,119 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "platform.h"
+#include "mir/graphics/display_report.h"
+#include "mir/graphics/egl_logger.h"
+#include "mir/options/option.h"
+#include "mir/options/configuration.h"
+#include "mir/module_deleter.h"
+#include "mir/assert_module_entry_point.h"
+#include "mir/libname.h"
+
+#include <boost/throw_exception.hpp>
+#include <EGL/egl.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace mo = mir::options;
+namespace mg = mir::graphics;
+namespace mgh = mg::headless;
+
+namespace
+{
+char const* headless_outputs_option_name{"headless-output"};
+char const* headless_dump_option_name{"headless-dump-dir"};
+}
+
+mir::UniqueModulePtr<mg::Platform> create_host_platform(
+    std::shared_ptr<mo::Option> const& options,
+    std::shared_ptr<mir::EmergencyCleanupRegistry> const&,
+    std::shared_ptr<mir::ConsoleServices> const&,
+    std::shared_ptr<mg::DisplayReport> const& report,
+    std::shared_ptr<mir::logging::Logger> const& logger)
+{
+    mir::assert_entry_point_signature<mg::CreateHostPlatform>(&create_host_platform);
+
+    if (options->is_set(mir::options::debug_opt))
+    {
+        mg::initialise_egl_logger(logger);
+    }
+
+    auto outputs = mgh::Platform::parse_outputs(options->get<std::string>(headless_outputs_option_name));
+
+    std::string dump_directory;
+    if (options->is_set(headless_dump_option_name))
+    {
+        dump_directory = options->get<std::string>(headless_dump_option_name);
+        if (access(dump_directory.c_str(), W_OK) != 0)
+        {
+            BOOST_THROW_EXCEPTION(std::runtime_error(
+                "Cannot write frame dumps to \"" + dump_directory + "\": " + strerror(errno)));
+        }
+    }
+
+    return mir::make_module_ptr<mgh::Platform>(move(outputs), move(dump_directory), report);
+}
+
+void add_graphics_platform_options(boost::program_options::options_description& config)
+{
+    mir::assert_entry_point_signature<mg::AddPlatformOptions>(&add_graphics_platform_options);
+    config.add_options()
+        (headless_outputs_option_name,
+         boost::program_options::value<std::string>()->default_value("1280x1024@60"),
+         "[mir-headless specific] Colon separated list of WIDTHxHEIGHT@HZ modes for virtual outputs."
+         " A refresh rate of 0 posts frames without waiting for a simulated vblank")
+        (headless_dump_option_name,
+         boost::program_options::value<std::string>(),
+         "[mir-headless specific] Directory to write every posted frame to, as PPM images");
+}
+
+mg::PlatformPriority probe_graphics_platform(
+    std::shared_ptr<mir::ConsoleServices> const&,
+    mo::ProgramOption const& /*options*/)
+{
+    mir::assert_entry_point_signature<mg::PlatformProbe>(&probe_graphics_platform);
+
+    /*
+     * We work anywhere Mesa does, but are never what anyone wants by default;
+     * select us with --platform-graphics-lib.
+     */
+    auto const client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (client_extensions && strstr(client_extensions, "EGL_MESA_platform_surfaceless"))
+        return mg::PlatformPriority::dummy;
+
+    return mg::PlatformPriority::unsupported;
+}
+
+namespace
+{
+mir::ModuleProperties const description = {
+    "mir:headless",
+    MIR_VERSION_MAJOR,
+    MIR_VERSION_MINOR,
+    MIR_VERSION_MICRO,
+    mir::libname()
+};
+}
+
+mir::ModuleProperties const* describe_graphics_module()
+{
+    mir::assert_entry_point_signature<mg::DescribeModule>(&describe_graphics_module);
+    return &description;
+}
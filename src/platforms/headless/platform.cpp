@@ -0,0 +1,135 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "platform.h"
+#include "display.h"
+#include "buffer_allocator.h"
+
+#include <boost/throw_exception.hpp>
+#include <cmath>
+#include <stdexcept>
+
+namespace mg = mir::graphics;
+namespace mgh = mg::headless;
+namespace geom = mir::geometry;
+
+namespace
+{
+// Slow enough for any test, while keeping the frame interval representable in nanoseconds
+double const min_refresh_hz = 1e-3;
+
+auto parse_size_dimension(std::string const& str) -> int
+{
+    try
+    {
+        size_t num_end = 0;
+        int const value = std::stoi(str, &num_end);
+        if (num_end != str.size())
+            BOOST_THROW_EXCEPTION(std::runtime_error("Output dimension \"" + str + "\" is not a valid number"));
+        if (value <= 0)
+            BOOST_THROW_EXCEPTION(std::runtime_error("Output dimensions must be greater than zero"));
+        return value;
+    }
+    catch (std::invalid_argument const&)
+    {
+        BOOST_THROW_EXCEPTION(std::runtime_error("Output dimension \"" + str + "\" is not a valid number"));
+    }
+    catch (std::out_of_range const&)
+    {
+        BOOST_THROW_EXCEPTION(std::runtime_error("Output dimension \"" + str + "\" is not a valid number"));
+    }
+}
+
+auto parse_refresh(std::string const& str) -> double
+{
+    try
+    {
+        size_t num_end = 0;
+        double const value = std::stod(str, &num_end);
+        // Zero is allowed, and means frames are posted without waiting for a simulated vblank
+        auto const valid_rate = std::isfinite(value) && (value == 0 || value >= min_refresh_hz);
+        if (num_end != str.size() || !valid_rate)
+            BOOST_THROW_EXCEPTION(std::runtime_error("Refresh rate \"" + str + "\" is not a valid number"));
+        return value;
+    }
+    catch (std::invalid_argument const&)
+    {
+        BOOST_THROW_EXCEPTION(std::runtime_error("Refresh rate \"" + str + "\" is not a valid number"));
+    }
+    catch (std::out_of_range const&)
+    {
+        BOOST_THROW_EXCEPTION(std::runtime_error("Refresh rate \"" + str + "\" is not a valid number"));
+    }
+}
+
+auto parse_output(std::string const& str) -> mgh::OutputSpec
+{
+    auto const x = str.find('x'); // "x" between width and height
+    if (x == std::string::npos || x == 0 || x >= str.size() - 1)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Output mode \"" + str + "\" does not have two dimensions"));
+    auto const refresh_start = str.find('@');
+    double refresh = 60.0;
+    if (refresh_start != std::string::npos)
+    {
+        if (refresh_start >= str.size() - 1)
+            BOOST_THROW_EXCEPTION(std::runtime_error("In \"" + str + "\", '@' is not followed by a refresh rate"));
+        refresh = parse_refresh(str.substr(refresh_start + 1));
+    }
+    return mgh::OutputSpec{
+        geom::Size{
+            parse_size_dimension(str.substr(0, x)),
+            parse_size_dimension(str.substr(x + 1, refresh_start - x - 1))},
+        refresh};
+}
+}
+
+auto mgh::Platform::parse_outputs(std::string const& outputs) -> std::vector<OutputSpec>
+{
+    std::vector<OutputSpec> result;
+    std::string::size_type start = 0;
+    for (;;)
+    {
+        auto const end = outputs.find(':', start);
+        result.push_back(parse_output(outputs.substr(start, end == std::string::npos ? end : end - start)));
+        if (end == std::string::npos)
+            break;
+        start = end + 1;
+    }
+    return result;
+}
+
+mgh::Platform::Platform(
+    std::vector<OutputSpec> outputs,
+    std::string dump_directory,
+    std::shared_ptr<mg::DisplayReport> const& report)
+    : outputs{std::move(outputs)},
+      dump_directory{std::move(dump_directory)},
+      report{report}
+{
+}
+
+mir::UniqueModulePtr<mg::GraphicBufferAllocator> mgh::Platform::create_buffer_allocator(
+    mg::Display const& output)
+{
+    return make_module_ptr<mgh::BufferAllocator>(output);
+}
+
+mir::UniqueModulePtr<mg::Display> mgh::Platform::create_display(
+    std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
+    std::shared_ptr<GLConfig> const& gl_config)
+{
+    return make_module_ptr<mgh::Display>(outputs, dump_directory, initial_conf_policy, gl_config, report);
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_HEADLESS_PLATFORM_H_
+#define MIR_GRAPHICS_HEADLESS_PLATFORM_H_
+
+#include "mir/graphics/platform.h"
+#include "mir/geometry/size.h"
+
+#include <string>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+class DisplayReport;
+
+namespace headless
+{
+struct OutputSpec
+{
+    geometry::Size size;
+    /// Simulated refresh rate; zero means frames are posted without waiting for a "vblank"
+    double refresh_hz;
+};
+
+class Platform : public graphics::Platform
+{
+public:
+    // Parses colon separated list of modes in the form WIDTHxHEIGHT@HZ (@HZ is optional, and defaults to 60)
+    static auto parse_outputs(std::string const& outputs) -> std::vector<OutputSpec>;
+
+    Platform(
+        std::vector<OutputSpec> outputs,
+        std::string dump_directory,
+        std::shared_ptr<DisplayReport> const& report);
+    ~Platform() = default;
+
+    /* From Platform */
+    UniqueModulePtr<GraphicBufferAllocator>
+        create_buffer_allocator(graphics::Display const& output) override;
+
+    UniqueModulePtr<graphics::Display> create_display(
+        std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
+        std::shared_ptr<GLConfig> const& gl_config) override;
+
+private:
+    std::vector<OutputSpec> const outputs;
+    std::string const dump_directory;
+    std::shared_ptr<DisplayReport> const report;
+};
+
+}
+}
+}
+#endif /* MIR_GRAPHICS_HEADLESS_PLATFORM_H_ */
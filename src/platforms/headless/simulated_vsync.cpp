@@ -0,0 +1,71 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "simulated_vsync.h"
+
+namespace mg = mir::graphics;
+namespace mgh = mg::headless;
+
+namespace
+{
+auto interval_for(double refresh_hz) -> std::chrono::nanoseconds
+{
+    if (refresh_hz <= 0)
+        return std::chrono::nanoseconds::zero();
+
+    return std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(1e9 / refresh_hz)};
+}
+}
+
+mgh::SimulatedVsync::SimulatedVsync(double refresh_hz)
+    : refresh_interval{interval_for(refresh_hz)}
+{
+}
+
+auto mgh::SimulatedVsync::next_flip(Frame::Timestamp const& now) const -> Frame
+{
+    Frame next;
+    next.msc = last.msc + 1;
+    next.ust = now;
+
+    // The first flip, or an unthrottled output, completes immediately
+    if (last.msc == 0 || refresh_interval == std::chrono::nanoseconds::zero())
+        return next;
+
+    auto const elapsed = now > last.ust ? now - last.ust : std::chrono::nanoseconds::zero();
+    auto const vblanks_since = elapsed / refresh_interval + 1;
+    next.msc = last.msc + vblanks_since;
+    next.ust = last.ust + vblanks_since * refresh_interval;
+    return next;
+}
+
+auto mgh::SimulatedVsync::flip() -> Frame
+{
+    auto const next = next_flip(Frame::Timestamp::now(CLOCK_MONOTONIC));
+    mir::time::sleep_until(next.ust);
+    last = next;
+    return next;
+}
+
+auto mgh::SimulatedVsync::last_flip() const -> Frame
+{
+    return last;
+}
+
+auto mgh::SimulatedVsync::interval() const -> std::chrono::nanoseconds
+{
+    return refresh_interval;
+}
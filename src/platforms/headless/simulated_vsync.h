@@ -0,0 +1,59 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_HEADLESS_SIMULATED_VSYNC_H_
+#define MIR_GRAPHICS_HEADLESS_SIMULATED_VSYNC_H_
+
+#include "mir/graphics/frame.h"
+
+#include <chrono>
+
+namespace mir
+{
+namespace graphics
+{
+namespace headless
+{
+/**
+ * A vblank clock for an output that doesn't exist.
+ *
+ * Vblanks are a fixed interval apart, phase-locked to the first flip, so a
+ * compositor that misses a vblank waits for the next one just as it would
+ * on hardware. A refresh rate of zero disables the wait.
+ */
+class SimulatedVsync
+{
+public:
+    explicit SimulatedVsync(double refresh_hz);
+
+    /// The frame a flip requested at "now" would complete on
+    auto next_flip(Frame::Timestamp const& now) const -> Frame;
+
+    /// Wait for the next vblank and record it as the latest frame
+    auto flip() -> Frame;
+
+    auto last_flip() const -> Frame;
+    auto interval() const -> std::chrono::nanoseconds;
+
+private:
+    std::chrono::nanoseconds const refresh_interval;
+    Frame last;
+};
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_HEADLESS_SIMULATED_VSYNC_H_ */
@@ -18,6 +18,7 @@
 
 #include "buffer_allocator.h"
 #include "shm_buffer.h"
+#include "shm_buffer_pool.h"
 #include "display.h"
 #include "egl_context_executor.h"
 #include "buffer_from_wl_shm.h"
@@ -73,7 +74,8 @@ std::unique_ptr<mir::renderer::gl::Context> context_for_output(mg::Display const
 mgw::BufferAllocator::BufferAllocator(graphics::Display const& output) :
     egl_extensions(std::make_shared<mg::EGLExtensions>()),
     ctx{context_for_output(output)},
-    egl_delegate{std::make_shared<mgc::EGLContextExecutor>(context_for_output(output))}
+    egl_delegate{std::make_shared<mgc::EGLContextExecutor>(context_for_output(output))},
+    software_buffers{std::make_shared<mgc::ShmBufferPool>(egl_delegate)}
 {
 }
 
@@ -86,7 +88,7 @@ std::shared_ptr<mg::Buffer> mgw::BufferAllocator::alloc_software_buffer(geom::Si
                 "Trying to create SHM buffer with unsupported pixel format"));
     }
 
-    return std::make_shared<mgc::MemoryBackedShmBuffer>(size, format, egl_delegate);
+    return software_buffers->alloc(size, format);
 }
 
 std::vector<MirPixelFormat> mgw::BufferAllocator::supported_pixel_formats()
@@ -34,6 +34,7 @@ class Display;
 namespace common
 {
 class EGLContextExecutor;
+class ShmBufferPool;
 }
 
 namespace wayland
@@ -65,6 +66,7 @@ private:
     std::shared_ptr<EGLExtensions> const egl_extensions;
     std::shared_ptr<renderer::gl::Context> const ctx;
     std::shared_ptr<common::EGLContextExecutor> const egl_delegate;
+    std::shared_ptr<common::ShmBufferPool> const software_buffers;
     bool egl_display_bound{false};
 };
 }
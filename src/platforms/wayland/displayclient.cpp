@@ -16,11 +16,18 @@
  */
 
 #include "displayclient.h"
+#include "passthrough_selection.h"
 #include "mir/graphics/egl_error.h"
 #include <mir/graphics/pixel_format_utils.h>
+#include <mir/graphics/renderable.h>
+#include <mir/graphics/buffer.h>
+#include <mir/renderer/sw/pixel_source.h>
+#include <mir/renderer/sw/render_target.h>
+#include <mir/anonymous_shm_file.h>
 
 #include <wayland-client.h>
 #include <wayland-egl.h>
+#include <GLES2/gl2.h>
 
 #include <fcntl.h>
 #include <sys/mman.h>
@@ -29,16 +36,162 @@
 #include <boost/throw_exception.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <cstring>
 #include <stdlib.h>
 #include <system_error>
 
 namespace mgw = mir::graphics::wayland;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+namespace
+{
+class FrameSync
+{
+public:
+    explicit FrameSync(wl_surface* surface) :
+        callback{wl_surface_frame(surface)}
+    {
+        static struct wl_callback_listener const frame_listener =
+            {
+                [](void* data, auto... args)
+                    { static_cast<FrameSync*>(data)->frame_done(args...); },
+            };
+
+        wl_callback_add_listener(callback, &frame_listener, this);
+    }
+
+    ~FrameSync()
+    {
+        wl_callback_destroy(callback);
+    }
+
+    void wait_for_done()
+    {
+        std::unique_lock<decltype(mutex)> lock{mutex};
+        cv.wait(lock, [this]{ return posted; });
+    }
+
+private:
+    void frame_done(wl_callback*, uint32_t)
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        posted = true;
+        cv.notify_all();
+    }
+
+    std::mutex mutex;
+    bool posted = false;
+    std::condition_variable cv;
+
+    wl_callback* const callback;
+};
+
+/// A host wl_buffer that client pixels are copied into. The host owns it from attach until release.
+class HostShmBuffer
+{
+public:
+    HostShmBuffer(wl_shm* shm, geom::Size size, uint32_t format) :
+        size{size},
+        format{format},
+        stride{4 * size.width.as_int()},
+        shm_file{static_cast<size_t>(stride * size.height.as_int())},
+        buffer{make_buffer(shm)}
+    {
+        static wl_buffer_listener const buffer_listener{
+            [](void* data, wl_buffer*) { static_cast<HostShmBuffer*>(data)->busy = false; }
+        };
+        wl_buffer_add_listener(buffer, &buffer_listener, this);
+    }
+
+    ~HostShmBuffer()
+    {
+        wl_buffer_destroy(buffer);
+    }
+
+    HostShmBuffer(HostShmBuffer const&) = delete;
+    HostShmBuffer& operator=(HostShmBuffer const&) = delete;
+
+    void copy_from(mrs::Mapping<unsigned char const>& source)
+    {
+        auto const row_bytes = std::min(stride, source.stride().as_int());
+        auto const dest = static_cast<unsigned char*>(shm_file.base_ptr());
+        for (auto y = 0; y < size.height.as_int(); ++y)
+        {
+            memcpy(dest + y * stride, source.data() + y * source.stride().as_int(), row_bytes);
+        }
+    }
+
+    geom::Size const size;
+    uint32_t const format;
+    int const stride;
+    mir::AnonymousShmFile const shm_file;
+    wl_buffer* const buffer;
+    std::atomic<bool> busy{false};
+
+private:
+    auto make_buffer(wl_shm* shm) -> wl_buffer*
+    {
+        auto const pool = wl_shm_create_pool(shm, shm_file.fd(), stride * size.height.as_int());
+        auto const result = wl_shm_pool_create_buffer(
+            pool, 0, size.width.as_int(), size.height.as_int(), stride, format);
+        wl_shm_pool_destroy(pool);
+        return result;
+    }
+};
+
+/// A CPU-writable view of a HostShmBuffer, for the software renderer to draw into
+class HostShmMapping : public mrs::Mapping<unsigned char>
+{
+public:
+    explicit HostShmMapping(HostShmBuffer& buffer) :
+        buffer{buffer}
+    {
+    }
+
+    auto format() const -> MirPixelFormat override
+    {
+        return mir_pixel_format_xrgb_8888;
+    }
+
+    auto stride() const -> geom::Stride override
+    {
+        return geom::Stride{buffer.stride};
+    }
+
+    auto size() const -> geom::Size override
+    {
+        return buffer.size;
+    }
+
+    auto data() -> unsigned char* override
+    {
+        return static_cast<unsigned char*>(buffer.shm_file.base_ptr());
+    }
+
+    auto len() const -> size_t override
+    {
+        return buffer.stride * buffer.size.height.as_int();
+    }
+
+private:
+    HostShmBuffer& buffer;
+};
+
+auto host_shm_format_for(MirPixelFormat format) -> uint32_t
+{
+    // select_passthrough() only selects formats every wl_shm supports
+    return format == mir_pixel_format_argb_8888 ? WL_SHM_FORMAT_ARGB8888 : WL_SHM_FORMAT_XRGB8888;
+}
+}
 
 class mgw::DisplayClient::Output  :
     public DisplaySyncGroup,
     public renderer::gl::RenderTarget,
+    public renderer::software::RenderTarget,
     public NativeDisplayBuffer,
     public DisplayBuffer
 {
@@ -111,6 +264,43 @@ public:
     void release_current() override;
     void swap_buffers() override;
     void bind() override;
+
+    // software::RenderTarget implementation
+    auto map_back_buffer() -> std::unique_ptr<mrs::Mapping<unsigned char>> override;
+    void present_back_buffer() override;
+
+private:
+    /// A subsurface of the output's surface showing one client buffer
+    class Passthrough
+    {
+    public:
+        Passthrough(DisplayClient const* owner, wl_surface* parent);
+        ~Passthrough();
+
+        void show(mrs::ReadMappableBuffer& source, uint32_t format, geometry::Rectangle const& position);
+        void hide();
+
+    private:
+        wl_shm* const shm;
+        wl_surface* const surface;
+        wl_subsurface* const subsurface;
+        std::vector<std::unique_ptr<HostShmBuffer>> buffers;
+        bool visible{false};
+    };
+
+    // Bottom to top; slots beyond the current frame's renderables are hidden
+    std::vector<std::unique_ptr<Passthrough>> passthroughs;
+    bool passthrough_frame{false};
+    // The output's own buffer still shows a composited frame, which would show around and under the subsurfaces
+    bool needs_clear{true};
+
+    void hide_passthroughs(size_t from);
+
+    // Only used if the software renderer draws into this output instead of GL
+    std::vector<std::unique_ptr<HostShmBuffer>> software_buffers;
+    HostShmBuffer* software_back{nullptr};
+
+    void commit_software_back_buffer();
 };
 
 namespace
@@ -259,6 +449,8 @@ mgw::DisplayClient::Output::Output(
 
 mgw::DisplayClient::Output::~Output()
 {
+    passthroughs.clear();
+
     if (output)
         wl_output_destroy(output);
 
@@ -316,6 +508,39 @@ void mgw::DisplayClient::Output::for_each_display_buffer(std::function<void(Disp
 
 void mgw::DisplayClient::Output::post()
 {
+    if (!passthrough_frame)
+        return;
+
+    if (needs_clear && software_back)
+    {
+        // Replace the last composited frame under the subsurfaces with black, like the background of composited frames
+        {
+            auto const mapping = map_back_buffer();
+            memset(mapping->data(), 0, mapping->len());
+        }
+        commit_software_back_buffer();
+        needs_clear = false;
+    }
+    else if (needs_clear)
+    {
+        // Replace the last GL frame under the subsurfaces with black, like the background of composited frames
+        make_current();
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        swap_buffers();
+        release_current();
+        needs_clear = false;
+    }
+    else
+    {
+        // The parent's commit applies the subsurfaces' (synchronized) state; pace ourselves by the host
+        FrameSync frame_sync{surface};
+        wl_surface_commit(surface);
+        wl_display_flush(owner->display);
+        frame_sync.wait_for_done();
+    }
+
+    passthrough_frame = false;
 }
 
 auto mgw::DisplayClient::Output::recommended_sleep() const -> std::chrono::milliseconds
@@ -328,9 +553,107 @@ auto mgw::DisplayClient::Output::view_area() const -> geometry::Rectangle
     return dcout.extents();
 }
 
-bool mgw::DisplayClient::Output::overlay(mir::graphics::RenderableList const&)
+bool mgw::DisplayClient::Output::overlay(mir::graphics::RenderableList const& renderlist)
+{
+    passthrough_frame = false;
+
+    /*
+     * Hand the client buffers to the host as subsurfaces, so the host can
+     * composite them directly instead of us compositing with GL only for
+     * the host to composite our output again.
+     *
+     * This is copy-based: the host connection has no linux-dmabuf, so each
+     * frame's client pixels are copied once into host wl_shm buffers. It
+     * saves our GL composite, not a copy.
+     */
+    if (!owner->subcompositor || !owner->shm)
+        return false;
+
+    auto const sources = select_passthrough(renderlist, view_area(), dcout.scale);
+    if (!sources)
+        return false;
+
+    for (auto i = 0u; i != sources->size(); ++i)
+    {
+        auto const& source = (*sources)[i];
+
+        if (i == passthroughs.size())
+            passthroughs.push_back(std::make_unique<Passthrough>(owner, surface));
+
+        passthroughs[i]->show(*source.buffer, host_shm_format_for(source.format), source.position);
+    }
+
+    hide_passthroughs(sources->size());
+    passthrough_frame = true;
+    return true;
+}
+
+void mgw::DisplayClient::Output::hide_passthroughs(size_t from)
+{
+    for (auto i = from; i < passthroughs.size(); ++i)
+        passthroughs[i]->hide();
+}
+
+mgw::DisplayClient::Output::Passthrough::Passthrough(DisplayClient const* owner, wl_surface* parent) :
+    shm{owner->shm},
+    surface{wl_compositor_create_surface(owner->compositor)},
+    subsurface{wl_subcompositor_get_subsurface(owner->subcompositor, surface, parent)}
+{
+    // Left synchronized (the default) so a frame's subsurfaces all change with the parent's commit.
+    // Input should still go to the output's surface, which the input code knows about.
+    auto const no_input = wl_compositor_create_region(owner->compositor);
+    wl_surface_set_input_region(surface, no_input);
+    wl_region_destroy(no_input);
+}
+
+mgw::DisplayClient::Output::Passthrough::~Passthrough()
+{
+    wl_subsurface_destroy(subsurface);
+    wl_surface_destroy(surface);
+}
+
+void mgw::DisplayClient::Output::Passthrough::show(
+    mrs::ReadMappableBuffer& source,
+    uint32_t format,
+    geometry::Rectangle const& position)
+{
+    auto const free_buffer = std::find_if(begin(buffers), end(buffers), [&](auto const& buffer)
+        { return !buffer->busy && buffer->size == position.size && buffer->format == format; });
+
+    HostShmBuffer* host_buffer;
+    if (free_buffer != end(buffers))
+    {
+        host_buffer = free_buffer->get();
+    }
+    else
+    {
+        // Buffers of a stale size or format won't be used again
+        buffers.erase(
+            std::remove_if(begin(buffers), end(buffers), [&](auto const& buffer)
+                { return !buffer->busy && (buffer->size != position.size || buffer->format != format); }),
+            end(buffers));
+        buffers.push_back(std::make_unique<HostShmBuffer>(shm, position.size, format));
+        host_buffer = buffers.back().get();
+    }
+
+    host_buffer->copy_from(*source.map_readable());
+    host_buffer->busy = true;
+
+    wl_subsurface_set_position(subsurface, position.top_left.x.as_int(), position.top_left.y.as_int());
+    wl_surface_attach(surface, host_buffer->buffer, 0, 0);
+    wl_surface_damage(surface, 0, 0, position.size.width.as_int(), position.size.height.as_int());
+    wl_surface_commit(surface);
+    visible = true;
+}
+
+void mgw::DisplayClient::Output::Passthrough::hide()
 {
-    return false;
+    if (visible)
+    {
+        wl_surface_attach(surface, nullptr, 0, 0);
+        wl_surface_commit(surface);
+        visible = false;
+    }
 }
 
 auto mgw::DisplayClient::Output::transformation() const -> glm::mat2
@@ -359,44 +682,14 @@ void mgw::DisplayClient::Output::release_current()
 
 void mgw::DisplayClient::Output::swap_buffers()
 {
-    struct FrameSync
+    if (!passthrough_frame)
     {
-        explicit FrameSync(wl_surface* surface) :
-            callback{wl_surface_frame(surface)}
-        {
-            static struct wl_callback_listener const frame_listener =
-                {
-                    [](void* data, auto... args)
-                        { static_cast<FrameSync*>(data)->frame_done(args...); },
-                };
-
-            wl_callback_add_listener(callback, &frame_listener, this);
-        }
-
-        ~FrameSync()
-        {
-            wl_callback_destroy(callback);
-        }
-
-        void frame_done(wl_callback*, uint32_t)
-        {
-            std::lock_guard<decltype(mutex)> lock{mutex};
-            posted = true;
-            cv.notify_all();
-        }
-
-        void wait_for_done()
-        {
-            std::unique_lock<decltype(mutex)> lock{mutex};
-            cv.wait(lock, [this]{ return posted; });
-        }
-
-        std::mutex mutex;
-        bool posted = false;
-        std::condition_variable cv;
+        // A composited frame: the subsurfaces go with the same commit as our new buffer
+        hide_passthroughs(0);
+        needs_clear = true;
+    }
 
-        wl_callback* const callback;
-    } frame_sync{surface};
+    FrameSync frame_sync{surface};
 
     // Avoid throttling compositing by blocking in eglSwapBuffers().
     // Instead we use the frame "done" notification.
@@ -412,6 +705,57 @@ void mgw::DisplayClient::Output::bind()
 {
 }
 
+auto mgw::DisplayClient::Output::map_back_buffer() -> std::unique_ptr<mrs::Mapping<unsigned char>>
+{
+    if (!owner->shm)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Host compositor does not support wl_shm"));
+
+    auto const& size = dcout.modes[dcout.current_mode_index].size;
+    auto const free_buffer = std::find_if(begin(software_buffers), end(software_buffers), [&](auto const& buffer)
+        { return !buffer->busy && buffer->size == size; });
+
+    if (free_buffer != end(software_buffers))
+    {
+        software_back = free_buffer->get();
+    }
+    else
+    {
+        // Buffers of a stale size won't be used again
+        software_buffers.erase(
+            std::remove_if(begin(software_buffers), end(software_buffers), [&](auto const& buffer)
+                { return !buffer->busy && buffer->size != size; }),
+            end(software_buffers));
+        software_buffers.push_back(std::make_unique<HostShmBuffer>(owner->shm, size, WL_SHM_FORMAT_XRGB8888));
+        software_back = software_buffers.back().get();
+    }
+
+    return std::make_unique<HostShmMapping>(*software_back);
+}
+
+void mgw::DisplayClient::Output::present_back_buffer()
+{
+    if (!passthrough_frame)
+    {
+        // A composited frame: the subsurfaces go with the same commit as our new buffer
+        hide_passthroughs(0);
+        needs_clear = true;
+    }
+
+    commit_software_back_buffer();
+}
+
+void mgw::DisplayClient::Output::commit_software_back_buffer()
+{
+    software_back->busy = true;
+
+    FrameSync frame_sync{surface};
+    wl_surface_attach(surface, software_back->buffer, 0, 0);
+    wl_surface_damage(surface, 0, 0, INT32_MAX, INT32_MAX);
+    wl_surface_commit(surface);
+    wl_display_flush(owner->display);
+    frame_sync.wait_for_done();
+}
+
 mgw::DisplayClient::DisplayClient(
     wl_display* display,
     std::shared_ptr<GLConfig> const& gl_config) :
@@ -512,6 +856,11 @@ void mgw::DisplayClient::new_global(
         self->compositor =
             static_cast<decltype(self->compositor)>(wl_registry_bind(registry, id, &wl_compositor_interface, std::min(version, 3u)));
     }
+    else if (strcmp(interface, "wl_subcompositor") == 0)
+    {
+        self->subcompositor =
+            static_cast<decltype(self->subcompositor)>(wl_registry_bind(registry, id, &wl_subcompositor_interface, 1));
+    }
     else if (strcmp(interface, "wl_shm") == 0)
     {
         self->shm = static_cast<decltype(self->shm)>(wl_registry_bind(registry, id, &wl_shm_interface, std::min(version, 1u)));
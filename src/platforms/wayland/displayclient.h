@@ -129,6 +129,7 @@ protected:
     void on_output_gone(Output const*);
 
     wl_compositor* compositor = nullptr;
+    wl_subcompositor* subcompositor = nullptr;
     wl_shell* shell = nullptr;
     wl_seat* seat = nullptr;
     wl_shm* shm = nullptr;
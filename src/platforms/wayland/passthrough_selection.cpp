@@ -0,0 +1,71 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "passthrough_selection.h"
+
+#include <mir/geometry/displacement.h>
+#include <mir/graphics/buffer.h>
+#include <mir/renderer/sw/pixel_source.h>
+
+namespace mgw = mir::graphics::wayland;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+namespace
+{
+// The formats wl_shm requires every host to support
+bool host_supports(MirPixelFormat format)
+{
+    return format == mir_pixel_format_argb_8888 || format == mir_pixel_format_xrgb_8888;
+}
+}
+
+auto mgw::select_passthrough(
+    RenderableList const& renderlist,
+    geom::Rectangle const& output_area,
+    float output_scale) -> std::experimental::optional<std::vector<PassthroughSource>>
+{
+    if (output_scale != 1.0f || renderlist.empty())
+        return std::experimental::nullopt;
+
+    std::vector<PassthroughSource> sources;
+
+    for (auto const& renderable : renderlist)
+    {
+        auto position = renderable->screen_position();
+        auto const buffer = renderable->buffer();
+
+        if (renderable->alpha() != 1.0f ||
+            renderable->transformation() != glm::mat4{1} ||
+            renderable->clip_area() ||
+            renderable->src_bounds() ||
+            !output_area.contains(position) ||
+            buffer->size() != position.size)
+        {
+            return std::experimental::nullopt;
+        }
+
+        // Hardware buffers reach us through EGL, so only buffers we can read (i.e. shm) qualify
+        auto const mappable = dynamic_cast<mrs::ReadMappableBuffer*>(buffer->native_buffer_base());
+        if (!mappable || !host_supports(buffer->pixel_format()))
+            return std::experimental::nullopt;
+
+        position.top_left = position.top_left - as_displacement(output_area.top_left);
+        sources.push_back({mappable, buffer->pixel_format(), position});
+    }
+
+    return sources;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_PLATFORM_WAYLAND_PASSTHROUGH_SELECTION_H_
+#define MIR_PLATFORM_WAYLAND_PASSTHROUGH_SELECTION_H_
+
+#include <mir/geometry/rectangle.h>
+#include <mir/graphics/renderable.h>
+#include <mir_toolkit/common.h>
+
+#include <experimental/optional>
+#include <vector>
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+class ReadMappableBuffer;
+}
+}
+namespace graphics
+{
+namespace wayland
+{
+
+/// A client buffer the host can show on a subsurface of an output, unchanged
+struct PassthroughSource
+{
+    renderer::software::ReadMappableBuffer* buffer;
+    MirPixelFormat format;
+    /// Relative to the output
+    geometry::Rectangle position;
+};
+
+/**
+ * Choose whether the host can show a frame's client buffers itself, instead of us compositing them.
+ *
+ * The host can only be given buffers we can read the pixels of, in a format every wl_shm supports,
+ * and only reproduces them without transforms, alpha, cropping, scaling or parts outside the output.
+ *
+ * \return  The sources, bottom to top; or nothing if the frame has to be composited
+ */
+auto select_passthrough(
+    RenderableList const& renderlist,
+    geometry::Rectangle const& output_area,
+    float output_scale) -> std::experimental::optional<std::vector<PassthroughSource>>;
+}
+}
+}
+
+#endif // MIR_PLATFORM_WAYLAND_PASSTHROUGH_SELECTION_H_
@@ -20,6 +20,7 @@
 #include "buffer_allocator.h"
 #include "egl_context_executor.h"
 #include "shm_buffer.h"
+#include "shm_buffer_pool.h"
 #include "mir/graphics/egl_extensions.h"
 #include "mir/raii.h"
 #include "mir/graphics/display.h"
@@ -89,6 +90,7 @@ mgx::BufferAllocator::BufferAllocator(mg::Display const& output)
     : ctx{context_for_output(output)},
       egl_delegate{
           std::make_shared<mgc::EGLContextExecutor>(context_for_output(output))},
+      software_buffers{std::make_shared<mgc::ShmBufferPool>(egl_delegate)},
       egl_extensions(std::make_shared<mg::EGLExtensions>())
 {
 }
@@ -103,7 +105,7 @@ std::shared_ptr<mg::Buffer> mgx::BufferAllocator::alloc_software_buffer(
                 "Trying to create SHM buffer with unsupported pixel format"));
     }
 
-    return std::make_shared<mgc::MemoryBackedShmBuffer>(size, format, egl_delegate);
+    return software_buffers->alloc(size, format);
 }
 
 std::vector<MirPixelFormat> mgx::BufferAllocator::supported_pixel_formats()
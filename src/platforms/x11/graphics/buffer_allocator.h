@@ -46,6 +46,7 @@ struct EGLExtensions;
 namespace common
 {
 class EGLContextExecutor;
+class ShmBufferPool;
 }
 
 namespace X
@@ -73,6 +74,7 @@ public:
 private:
     std::shared_ptr<renderer::gl::Context> const ctx;
     std::shared_ptr<common::EGLContextExecutor> const egl_delegate;
+    std::shared_ptr<common::ShmBufferPool> const software_buffers;
     std::shared_ptr<Executor> wayland_executor;
     std::shared_ptr<EGLExtensions> const egl_extensions;
     bool egl_display_bound{false};
@@ -245,8 +245,7 @@ mgx::Display::Display(::Display* x_dpy,
       gl_config{gl_config},
       pixel_width{get_pixel_width(x_dpy)},
       pixel_height{get_pixel_height(x_dpy)},
-      report{report},
-      last_frame{std::make_shared<AtomicFrame>()}
+      report{report}
 {
     shared_egl.setup(x_dpy);
 
@@ -267,6 +266,7 @@ mgx::Display::Display(::Display* x_dpy,
             geom::Size{actual_size.width * pixel_width, actual_size.height * pixel_height},
             requested_size.scale,
             mir_orientation_normal);
+        auto last_frame = std::make_shared<AtomicFrame>();
         auto display_buffer = std::make_unique<mgx::DisplayBuffer>(
             x_dpy,
             configuration->id,
@@ -276,7 +276,8 @@ mgx::Display::Display(::Display* x_dpy,
             last_frame,
             report,
             *gl_config);
-        outputs.push_back(std::make_unique<OutputInfo>(move(window), move(display_buffer), configuration));
+        outputs.push_back(std::make_unique<OutputInfo>(
+            move(window), move(display_buffer), move(last_frame), configuration));
         top_left.x += as_delta(configuration->extents().size.width);
     }
 
@@ -383,17 +384,25 @@ bool mgx::Display::apply_if_configuration_preserves_display_buffers(
     return false;
 }
 
-mg::Frame mgx::Display::last_frame_on(unsigned) const
+mg::Frame mgx::Display::last_frame_on(unsigned output_id) const
 {
-    return last_frame->load();
+    for (auto const& output : outputs)
+    {
+        if (output->configuration->id.as_value() == static_cast<int>(output_id))
+            return output->last_frame->load();
+    }
+
+    return {};
 }
 
 mgx::Display::OutputInfo::OutputInfo(
     std::unique_ptr<X11Window> window,
     std::unique_ptr<DisplayBuffer> display_buffer,
+    std::shared_ptr<AtomicFrame> last_frame,
     std::shared_ptr<DisplayConfigurationOutput> configuration)
     : window{move(window)},
       display_buffer{move(display_buffer)},
+      last_frame{move(last_frame)},
       configuration{configuration}
 {
     mx::X11Resources::instance.set_output_config_for_win(*this->window, this->configuration);
@@ -109,11 +109,13 @@ private:
         OutputInfo(
             std::unique_ptr<X11Window> window,
             std::unique_ptr<DisplayBuffer> display_buffer,
+            std::shared_ptr<AtomicFrame> last_frame,
             std::shared_ptr<DisplayConfigurationOutput> configuration);
         ~OutputInfo();
 
         std::unique_ptr<X11Window> window;
         std::unique_ptr<DisplayBuffer> display_buffer;
+        std::shared_ptr<AtomicFrame> last_frame;
         std::shared_ptr<DisplayConfigurationOutput> configuration;
     };
 
@@ -124,7 +126,6 @@ private:
     float pixel_width;
     float pixel_height;
     std::shared_ptr<DisplayReport> const report;
-    std::shared_ptr<AtomicFrame> last_frame;
 };
 
 }
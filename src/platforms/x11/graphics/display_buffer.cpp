@@ -43,6 +43,7 @@ mgx::DisplayBuffer::DisplayBuffer(::Display* const x_dpy,
                                     egl{gl_config},
                                     last_frame{f},
                                     output_id{output_id},
+                                    present{x_dpy, win},
                                     eglGetSyncValues{nullptr}
 {
     egl.setup(x_dpy, win, shared_context);
@@ -109,6 +110,18 @@ void mgx::DisplayBuffer::swap_buffers()
     if (!egl.swap_buffers())
         fatal_error("Failed to perform buffer swap");
 
+    update_last_frame();
+
+    /*
+     * Admittedly we are not a real display and will miss some real vsyncs
+     * but this is best-effort. And besides, we don't want Mir reporting all
+     * real vsyncs because that would mean the compositor never sleeps.
+     */
+    report->report_vsync(output_id.as_value(), last_frame->load());
+}
+
+void mgx::DisplayBuffer::update_last_frame()
+{
     /*
      * It would be nice to call this on demand as required. However the
      * implementation requires an EGL context. So for simplicity we call it here
@@ -118,6 +131,26 @@ void mgx::DisplayBuffer::swap_buffers()
      * the consequence of that would be the client scheduling the next frame
      * immediately without waiting, which is probably ideal anyway.
      */
+    if (present.active())
+    {
+        /*
+         * The host tells us when each frame actually completed, but only
+         * some time after we've swapped it; so this lags a frame behind
+         * in the same way as the sync values below.
+         */
+        if (auto const completed = present.latest_completion())
+        {
+            auto const previous = last_frame->load();
+            if (previous.msc > 0 && completed->msc > previous.msc)
+            {
+                refresh_interval =
+                    (completed->ust - previous.ust) / (completed->msc - previous.msc);
+            }
+            last_frame->store(*completed);
+        }
+        return;
+    }
+
     int64_t ust_us, msc, sbc;
     if (eglGetSyncValues &&
         eglGetSyncValues(egl.display(), egl.surface(), &ust_us, &msc, &sbc))
@@ -133,13 +166,6 @@ void mgx::DisplayBuffer::swap_buffers()
     {
         last_frame->increment_now();
     }
-
-    /*
-     * Admittedly we are not a real display and will miss some real vsyncs
-     * but this is best-effort. And besides, we don't want Mir reporting all
-     * real vsyncs because that would mean the compositor never sleeps.
-     */
-    report->report_vsync(output_id.as_value(), last_frame->load());
 }
 
 void mgx::DisplayBuffer::bind()
@@ -174,9 +200,29 @@ void mgx::DisplayBuffer::for_each_display_buffer(
 
 void mgx::DisplayBuffer::post()
 {
+    using namespace std::chrono;
+
+    /*
+     * Mesa queues our frames on the host rather than blocking until each
+     * one is displayed, so left alone we'd composite as soon as there is
+     * new damage and the frame would then wait in the queue. If we know
+     * the host's refresh timing we can instead sleep until just enough
+     * time remains before the next vblank to render, which shows clients'
+     * content sooner.
+     */
+    recommend_sleep = milliseconds::zero();
+    if (refresh_interval > nanoseconds::zero())
+    {
+        auto const frame = last_frame->load();
+        auto const now = mir::time::PosixTimestamp::now(frame.ust.clock_id);
+        auto const until_vblank = refresh_interval - (now - frame.ust) % refresh_interval;
+        auto const render_budget = refresh_interval / 2;
+        if (until_vblank > render_budget)
+            recommend_sleep = duration_cast<milliseconds>(until_vblank - render_budget);
+    }
 }
 
 std::chrono::milliseconds mgx::DisplayBuffer::recommended_sleep() const
 {
-    return std::chrono::milliseconds::zero();
+    return recommend_sleep;
 }
@@ -25,8 +25,10 @@
 #include "mir/graphics/display.h"
 #include "mir/renderer/gl/render_target.h"
 #include "egl_helper.h"
+#include "present_feedback.h"
 
 #include <EGL/egl.h>
+#include <chrono>
 #include <memory>
 
 namespace mir
@@ -75,12 +77,17 @@ public:
     NativeDisplayBuffer* native_display_buffer() override;
 
 private:
+    void update_last_frame();
+
     std::shared_ptr<DisplayReport> const report;
     geometry::Rectangle area;
     glm::mat2 transform;
     helpers::EGLHelper egl;
     std::shared_ptr<AtomicFrame> const last_frame;
     DisplayConfigurationOutputId output_id;
+    PresentFeedback present;
+    std::chrono::nanoseconds refresh_interval{0};
+    std::chrono::milliseconds recommend_sleep{0};
 
     typedef EGLBoolean (EGLAPIENTRY EglGetSyncValuesCHROMIUM)
         (EGLDisplay dpy, EGLSurface surface, int64_t *ust,
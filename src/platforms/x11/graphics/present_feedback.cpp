@@ -0,0 +1,99 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "present_feedback.h"
+#include "mir/log.h"
+
+#include <X11/Xlib-xcb.h>
+#include <xcb/xcb.h>
+#include <xcb/present.h>
+
+#include <cstdlib>
+
+namespace mg=mir::graphics;
+namespace mgx=mg::X;
+
+mgx::PresentFeedback::PresentFeedback(::Display* x_dpy, Window win)
+    : connection{XGetXCBConnection(x_dpy)},
+      event_id{0},
+      events{nullptr}
+{
+    if (!connection)
+        return;
+
+    auto const present = xcb_get_extension_data(connection, &xcb_present_id);
+    if (!present || !present->present)
+    {
+        mir::log_info("X server does not support Present; using estimated frame timing");
+        return;
+    }
+
+    event_id = xcb_generate_id(connection);
+    events = xcb_register_for_special_xge(connection, &xcb_present_id, event_id, nullptr);
+    auto const cookie = xcb_present_select_input_checked(
+        connection,
+        event_id,
+        win,
+        XCB_PRESENT_EVENT_MASK_COMPLETE_NOTIFY);
+
+    if (auto const error = xcb_request_check(connection, cookie))
+    {
+        mir::log_warning("Failed to select Present events (error %d)", error->error_code);
+        free(error);
+        xcb_unregister_for_special_event(connection, events);
+        events = nullptr;
+    }
+}
+
+mgx::PresentFeedback::~PresentFeedback()
+{
+    if (events)
+        xcb_unregister_for_special_event(connection, events);
+}
+
+bool mgx::PresentFeedback::active() const
+{
+    return events != nullptr;
+}
+
+auto mgx::PresentFeedback::latest_completion() -> std::experimental::optional<Frame>
+{
+    std::experimental::optional<Frame> latest;
+
+    if (!events)
+        return latest;
+
+    while (auto const event = xcb_poll_for_special_event(connection, events))
+    {
+        auto const generic = reinterpret_cast<xcb_present_generic_event_t*>(event);
+        if (generic->evtype == XCB_PRESENT_EVENT_COMPLETE_NOTIFY)
+        {
+            auto const complete = reinterpret_cast<xcb_present_complete_notify_event_t*>(event);
+            if (complete->kind == XCB_PRESENT_COMPLETE_KIND_PIXMAP &&
+                complete->mode != XCB_PRESENT_COMPLETE_MODE_SKIP)
+            {
+                // Present reports UST in microseconds of CLOCK_MONOTONIC
+                Frame frame;
+                frame.msc = complete->msc;
+                frame.ust = {CLOCK_MONOTONIC, std::chrono::microseconds{complete->ust}};
+                latest = frame;
+            }
+        }
+        free(event);
+    }
+
+    return latest;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_X_PRESENT_FEEDBACK_H_
+#define MIR_GRAPHICS_X_PRESENT_FEEDBACK_H_
+
+#include "mir/graphics/frame.h"
+
+#include <X11/Xlib.h>
+#include <experimental/optional>
+#include <cstdint>
+
+struct xcb_connection_t;
+struct xcb_special_event;
+
+namespace mir
+{
+namespace graphics
+{
+namespace X
+{
+
+/**
+ * Listens for Present CompleteNotify events on a window.
+ *
+ * Mesa presents EGL window surfaces on X11 through DRI3/Present, so the
+ * host X server tells us exactly when each of our frames reached the
+ * screen. This is more accurate than sampling EGL_CHROMIUM_sync_control
+ * after each swap, and also tells us the host's refresh interval.
+ */
+class PresentFeedback
+{
+public:
+    PresentFeedback(::Display* x_dpy, Window win);
+    ~PresentFeedback();
+
+    PresentFeedback(PresentFeedback const&) = delete;
+    PresentFeedback& operator=(PresentFeedback const&) = delete;
+
+    /// Whether the host supports Present and we are subscribed to it
+    bool active() const;
+
+    /**
+     * Drain any pending completion events without blocking.
+     * \returns the most recently completed frame, if any completed since
+     *          the last call
+     */
+    std::experimental::optional<Frame> latest_completion();
+
+private:
+    xcb_connection_t* const connection;
+    uint32_t event_id;
+    xcb_special_event* events;
+};
+
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_X_PRESENT_FEEDBACK_H_ */
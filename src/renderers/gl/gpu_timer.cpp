@@ -0,0 +1,128 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define MIR_LOG_COMPONENT "GLRenderer"
+
+#include "gpu_timer.h"
+#include "mir/log.h"
+
+#include <EGL/egl.h>
+#include <boost/throw_exception.hpp>
+#include <stdexcept>
+#include <cstring>
+
+namespace mrg = mir::renderer::gl;
+
+mrg::GPUTimer::TimerQueryEXT::TimerQueryEXT() :
+    glGenQueriesEXT{
+        reinterpret_cast<PFNGLGENQUERIESEXTPROC>(eglGetProcAddress("glGenQueriesEXT"))},
+    glDeleteQueriesEXT{
+        reinterpret_cast<PFNGLDELETEQUERIESEXTPROC>(eglGetProcAddress("glDeleteQueriesEXT"))},
+    glBeginQueryEXT{
+        reinterpret_cast<PFNGLBEGINQUERYEXTPROC>(eglGetProcAddress("glBeginQueryEXT"))},
+    glEndQueryEXT{
+        reinterpret_cast<PFNGLENDQUERYEXTPROC>(eglGetProcAddress("glEndQueryEXT"))},
+    glGetQueryObjectivEXT{
+        reinterpret_cast<PFNGLGETQUERYOBJECTIVEXTPROC>(eglGetProcAddress("glGetQueryObjectivEXT"))},
+    glGetQueryObjectui64vEXT{
+        reinterpret_cast<PFNGLGETQUERYOBJECTUI64VEXTPROC>(eglGetProcAddress("glGetQueryObjectui64vEXT"))}
+{
+    auto const gl_extensions = reinterpret_cast<char const*>(glGetString(GL_EXTENSIONS));
+    if (!gl_extensions || !strstr(gl_extensions, "GL_EXT_disjoint_timer_query"))
+    {
+        BOOST_THROW_EXCEPTION(std::runtime_error("GL implementation doesn't support GL_EXT_disjoint_timer_query"));
+    }
+
+    if (!glGenQueriesEXT || !glDeleteQueriesEXT || !glBeginQueryEXT || !glEndQueryEXT ||
+        !glGetQueryObjectivEXT || !glGetQueryObjectui64vEXT)
+    {
+        BOOST_THROW_EXCEPTION(std::runtime_error("GL_EXT_disjoint_timer_query functions are null"));
+    }
+}
+
+mrg::GPUTimer::GPUTimer() :
+    ext{[]() -> std::optional<TimerQueryEXT>
+        {
+            try
+            {
+                return TimerQueryEXT{};
+            }
+            catch (std::runtime_error const& error)
+            {
+                mir::log_debug("GPU timing unavailable: %s", error.what());
+                return {};
+            }
+        }()}
+{
+    if (ext)
+        ext->glGenQueriesEXT(queries.size(), queries.data());
+}
+
+mrg::GPUTimer::~GPUTimer()
+{
+    if (ext)
+        ext->glDeleteQueriesEXT(queries.size(), queries.data());
+}
+
+void mrg::GPUTimer::begin()
+{
+    // If every query is still awaiting its result we skip measuring this frame
+    if (!ext || active || in_flight == queries.size())
+        return;
+
+    ext->glBeginQueryEXT(GL_TIME_ELAPSED_EXT, queries[(oldest + in_flight) % queries.size()]);
+    active = true;
+}
+
+void mrg::GPUTimer::end()
+{
+    if (!active)
+        return;
+
+    ext->glEndQueryEXT(GL_TIME_ELAPSED_EXT);
+    active = false;
+    ++in_flight;
+}
+
+auto mrg::GPUTimer::collect() -> optional_value<std::chrono::nanoseconds>
+{
+    optional_value<std::chrono::nanoseconds> result;
+    if (!ext)
+        return result;
+
+    // Reading GL_GPU_DISJOINT_EXT also clears it. If it was set then something
+    // (e.g. a power state change) invalidated the results still in flight.
+    GLint disjoint = GL_FALSE;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+    while (in_flight > 0)
+    {
+        GLint available = GL_FALSE;
+        ext->glGetQueryObjectivEXT(queries[oldest], GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+        if (!available)
+            break;
+
+        GLuint64 elapsed = 0;
+        ext->glGetQueryObjectui64vEXT(queries[oldest], GL_QUERY_RESULT_EXT, &elapsed);
+        oldest = (oldest + 1) % queries.size();
+        --in_flight;
+
+        if (!disjoint)
+            result = std::chrono::nanoseconds{elapsed};
+    }
+
+    return result;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_GL_GPU_TIMER_H_
+#define MIR_RENDERER_GL_GPU_TIMER_H_
+
+#include "mir/optional_value.h"
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+#include <array>
+#include <chrono>
+#include <optional>
+
+namespace mir
+{
+namespace renderer
+{
+namespace gl
+{
+
+/**
+ * Measures how long the GPU spends executing the commands between begin()
+ * and end(), using GL_EXT_disjoint_timer_query where the driver supports it.
+ *
+ * Results are polled rather than waited for, so measuring never stalls the
+ * pipeline; a result typically becomes available a frame or two later.
+ * Where the extension is absent every call is a no-op.
+ *
+ * All calls must be made with the same GL context current.
+ */
+class GPUTimer
+{
+public:
+    GPUTimer();
+    ~GPUTimer();
+
+    void begin();
+    void end();
+
+    /// The most recent measurement to complete since the last call, if any
+    auto collect() -> optional_value<std::chrono::nanoseconds>;
+
+private:
+    struct TimerQueryEXT
+    {
+        TimerQueryEXT();
+
+        PFNGLGENQUERIESEXTPROC const glGenQueriesEXT;
+        PFNGLDELETEQUERIESEXTPROC const glDeleteQueriesEXT;
+        PFNGLBEGINQUERYEXTPROC const glBeginQueryEXT;
+        PFNGLENDQUERYEXTPROC const glEndQueryEXT;
+        PFNGLGETQUERYOBJECTIVEXTPROC const glGetQueryObjectivEXT;
+        PFNGLGETQUERYOBJECTUI64VEXTPROC const glGetQueryObjectui64vEXT;
+    };
+
+    std::optional<TimerQueryEXT> const ext;
+
+    // A small ring of queries, so we can keep measuring while earlier results are in flight
+    std::array<GLuint, 4> queries{};
+    size_t oldest{0};
+    size_t in_flight{0};
+    bool active{false};
+
+    GPUTimer(GPUTimer const&) = delete;
+    GPUTimer& operator=(GPUTimer const&) = delete;
+};
+
+}
+}
+}
+
+#endif // MIR_RENDERER_GL_GPU_TIMER_H_
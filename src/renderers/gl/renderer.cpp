@@ -33,6 +33,7 @@
 #include "mir/graphics/texture.h"
 #include "mir/graphics/program_factory.h"
 #include "mir/graphics/program.h"
+#include "mir/graphics/solid_color_buffer.h"
 
 #define GLM_FORCE_RADIANS
 #include <glm/gtc/matrix_transform.hpp>
@@ -41,7 +42,9 @@
 
 #include <boost/throw_exception.hpp>
 #include <stdexcept>
+#include <chrono>
 #include <cmath>
+#include <cstdlib>
 #include <sstream>
 
 namespace mg = mir::graphics;
@@ -123,6 +126,18 @@ const GLchar* const mrg::Renderer::default_fshader =
     "}\n"
 };
 
+const GLchar* const mrg::Renderer::solid_color_fshader =
+{   // For mg::SolidColorBuffer, which has no texture to sample
+    "#ifdef GL_ES\n"
+    "precision mediump float;\n"
+    "#endif\n"
+    "uniform vec4 color;\n"
+    "uniform float alpha;\n"
+    "void main() {\n"
+    "   gl_FragColor = alpha*color;\n"
+    "}\n"
+};
+
 namespace
 {
 template<void (* deleter)(GLuint)>
@@ -347,16 +362,28 @@ mrg::Renderer::Program::Program(GLuint program_id)
     transform_uniform = glGetUniformLocation(id, "transform");
     screen_to_gl_coords_uniform = glGetUniformLocation(id, "screen_to_gl_coords");
     alpha_uniform = glGetUniformLocation(id, "alpha");
+    color_uniform = glGetUniformLocation(id, "color");
 }
 
 mrg::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
+    : Renderer(display_buffer, mgl::default_texture_cache_budget, std::make_shared<mgl::TextureCacheCounters>())
+{
+}
+
+mrg::Renderer::Renderer(
+    graphics::DisplayBuffer& display_buffer,
+    size_t texture_cache_budget,
+    std::shared_ptr<mgl::TextureCacheCounters> const& texture_cache_counters)
     : render_target(&display_buffer),
       clear_color{0.0f, 0.0f, 0.0f, 0.0f},
       default_program(family.add_program(vshader, default_fshader)),
       alpha_program(family.add_program(vshader, alpha_fshader)),
+      solid_color_program(family.add_program(vshader, solid_color_fshader)),
       program_factory{std::make_unique<ProgramFactory>()},
-      texture_cache(mgl::DefaultProgramFactory().create_texture_cache()),
-      display_transform(1)
+      texture_cache(mgl::DefaultProgramFactory(texture_cache_budget, texture_cache_counters).create_texture_cache()),
+      display_transform(1),
+      gpu_timer{std::make_unique<GPUTimer>()},
+      check_gl_errors{getenv("MIR_GL_CHECK_ERRORS") != nullptr}
 {
     eglBindAPI(EGL_OPENGL_ES_API);
     EGLDisplay disp = eglGetCurrentDisplay();
@@ -424,26 +451,47 @@ void mrg::Renderer::tessellate(std::vector<mgl::Primitive>& primitives,
 
 void mrg::Renderer::render(mg::RenderableList const& renderables) const
 {
+    using clock = std::chrono::steady_clock;
+
     render_target.bind();
 
+    timing = FrameTiming{};
+    timing.gpu = gpu_timer->collect();
+    gpu_timer->begin();
+
     glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
     glClear(GL_COLOR_BUFFER_BIT);
 
     ++frameno;
+    auto const draw_start = clock::now();
     for (auto const& r : renderables)
     {
         draw(*r);
     }
+    // draw() accumulates the time it spends on textures separately
+    timing.draw = clock::now() - draw_start - timing.texture_upload;
 
+    gpu_timer->end();
+
+    auto const swap_start = clock::now();
     render_target.swap_buffers();
+    timing.swap = clock::now() - swap_start;
 
     // Deleting unused textures only requires the GL context. This clean-up
     // does not affect screen contents so can happen after swap_buffers...
     texture_cache->drop_unused();
 
-    while (auto const gl_error = glGetError())
-        mir::log_debug("GL error: %d", gl_error);
+    if (check_gl_errors)
+    {
+        while (auto const gl_error = glGetError())
+            mir::log_debug("GL error: %d", gl_error);
+    }
+}
+
+auto mrg::Renderer::last_frame_timing() const -> FrameTiming
+{
+    return timing;
 }
 
 void mrg::Renderer::draw(mg::Renderable const& renderable) const
@@ -464,9 +512,13 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
         );
     }
 
+    using clock = std::chrono::steady_clock;
+
+    auto const solid_color = std::dynamic_pointer_cast<mg::SolidColorBuffer>(renderable.buffer());
     auto const texture = std::dynamic_pointer_cast<mg::gl::Texture>(renderable.buffer());
+    auto const load_start = clock::now();
     auto const surface_tex =
-        [this, &renderable, need_fallback = !static_cast<bool>(texture)]() -> std::shared_ptr<mir::gl::Texture>
+        [this, &renderable, need_fallback = !texture && !solid_color]() -> std::shared_ptr<mir::gl::Texture>
         {
             if (need_fallback)
             {
@@ -481,11 +533,16 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
             }
             return {nullptr};
         }();
+    timing.texture_upload += clock::now() - load_start;
 
     auto const* maybe_prog =
-        [this, &texture, &surface_tex](bool alpha) -> Program const*
+        [this, &solid_color, &texture, &surface_tex](bool alpha) -> Program const*
         {
-            if (texture)
+            if (solid_color)
+            {
+                return &solid_color_program;
+            }
+            else if (texture)
             {
                 auto const& family = static_cast<::Program const&>(texture->shader(*program_factory));
                 if (alpha)
@@ -559,8 +616,17 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
     if (prog.alpha_uniform >= 0)
         glUniform1f(prog.alpha_uniform, renderable.alpha());
 
+    if (solid_color)
+    {
+        auto const argb = solid_color->color();
+        auto const channel = [argb](int shift) { return ((argb >> shift) & 0xff) / 255.0f; };
+        glUniform4f(prog.color_uniform, channel(16), channel(8), channel(0), channel(24));
+    }
+
+    // The solid colour shader doesn't sample, so may have no texcoord attribute
     glEnableVertexAttribArray(prog.position_attr);
-    glEnableVertexAttribArray(prog.texcoord_attr);
+    if (prog.texcoord_attr >= 0)
+        glEnableVertexAttribArray(prog.texcoord_attr);
 
     primitives.clear();
     tessellate(primitives, renderable);
@@ -576,7 +642,12 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
         BlendSeparate client_blend;
 
         // These renderable method names could be better (see LP: #1236224)
-        if (renderable.shaped())  // Client is RGBA:
+        if (solid_color && (solid_color->color() >> 24) == 0xff && renderable.alpha() == 1.0f)
+        {   // Opaque colour: nothing below shows through, so skip blending
+            client_blend = {GL_ONE,  GL_ZERO,
+                            GL_ZERO, GL_ONE};
+        }
+        else if (renderable.shaped())  // Client is RGBA:
         {
             client_blend = {GL_ONE, GL_ONE_MINUS_SRC_ALPHA,
                             GL_ONE, GL_ONE_MINUS_SRC_ALPHA};
@@ -600,21 +671,26 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
             BlendSeparate blend;
 
             blend = client_blend;
+            auto const bind_start = clock::now();
             if (surface_tex)
             {
                 surface_tex->bind();
             }
-            else
+            else if (texture)
             {
                 texture->bind();
             }
+            timing.texture_upload += clock::now() - bind_start;
 
             glVertexAttribPointer(prog.position_attr, 3, GL_FLOAT,
                                   GL_FALSE, sizeof(mgl::Vertex),
                                   &p.vertices[0].position);
-            glVertexAttribPointer(prog.texcoord_attr, 2, GL_FLOAT,
-                                  GL_FALSE, sizeof(mgl::Vertex),
-                                  &p.vertices[0].texcoord);
+            if (prog.texcoord_attr >= 0)
+            {
+                glVertexAttribPointer(prog.texcoord_attr, 2, GL_FLOAT,
+                                      GL_FALSE, sizeof(mgl::Vertex),
+                                      &p.vertices[0].texcoord);
+            }
 
             if (blend.dst_rgb == GL_ZERO)
             {
@@ -641,7 +717,8 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
         report_exception();
     }
 
-    glDisableVertexAttribArray(prog.texcoord_attr);
+    if (prog.texcoord_attr >= 0)
+        glDisableVertexAttribArray(prog.texcoord_attr);
     glDisableVertexAttribArray(prog.position_attr);
     if (renderable.clip_area())
     {
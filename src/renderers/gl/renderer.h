@@ -20,6 +20,7 @@
 #define MIR_RENDERER_GL_RENDERER_H_
 
 #include "program_family.h"
+#include "gpu_timer.h"
 
 #include <mir/renderer/renderer.h>
 #include <mir/geometry/rectangle.h>
@@ -35,7 +36,7 @@
 
 namespace mir
 {
-namespace gl { class TextureCache; }
+namespace gl { class TextureCache; struct TextureCacheCounters; }
 namespace graphics { class DisplayBuffer; }
 namespace renderer
 {
@@ -60,6 +61,12 @@ class Renderer : public renderer::Renderer
 {
 public:
     Renderer(graphics::DisplayBuffer& display_buffer);
+    /// \param texture_cache_budget    Bytes of textures to keep for renderables that go undrawn
+    /// \param texture_cache_counters  Where to count the texture cache's hits, misses and size
+    Renderer(
+        graphics::DisplayBuffer& display_buffer,
+        size_t texture_cache_budget,
+        std::shared_ptr<mir::gl::TextureCacheCounters> const& texture_cache_counters);
     virtual ~Renderer();
 
     // These are called with a valid GL context:
@@ -70,6 +77,8 @@ public:
     // This is called _without_ a GL context:
     void suspend() override;
 
+    auto last_frame_timing() const -> FrameTiming override;
+
     struct Program
     {
         GLuint id = 0;
@@ -85,6 +94,7 @@ public:
         GLint transform_uniform = -1;
         GLint screen_to_gl_coords_uniform = -1;
         GLint alpha_uniform = -1;
+        GLint color_uniform = -1;
         mutable long long last_used_frameno = 0;
 
         Program(GLuint program_id);
@@ -117,11 +127,12 @@ protected:
     mutable long long frameno = 0;
 
     ProgramFamily family;
-    Program default_program, alpha_program;
+    Program default_program, alpha_program, solid_color_program;
 
     static const GLchar* const vshader;
     static const GLchar* const default_fshader;
     static const GLchar* const alpha_fshader;
+    static const GLchar* const solid_color_fshader;
 
     virtual void draw(graphics::Renderable const& renderable) const;
 
@@ -135,6 +146,10 @@ private:
     glm::mat4 screen_to_gl_coords;
     glm::mat4 display_transform;
     std::vector<mir::gl::Primitive> mutable primitives;
+    std::unique_ptr<GPUTimer> const gpu_timer;
+    FrameTiming mutable timing;
+    // glGetError() can stall the pipeline, so is only checked when debugging
+    bool const check_gl_errors;
 };
 
 }
@@ -19,12 +19,29 @@
 #include "renderer_factory.h"
 #include "renderer.h"
 #include "mir/graphics/display_buffer.h"
+#include "mir/gl/default_program_factory.h"
 
 namespace mrg = mir::renderer::gl;
 
+mrg::RendererFactory::RendererFactory()
+    : RendererFactory(mir::gl::default_texture_cache_budget)
+{
+}
+
+mrg::RendererFactory::RendererFactory(size_t texture_cache_budget)
+    : texture_cache_budget{texture_cache_budget},
+      counters{std::make_shared<mir::gl::TextureCacheCounters>()}
+{
+}
+
 std::unique_ptr<mir::renderer::Renderer>
 mrg::RendererFactory::create_renderer_for(
     graphics::DisplayBuffer& display_buffer)
 {
-    return std::make_unique<Renderer>(display_buffer);
+    return std::make_unique<Renderer>(display_buffer, texture_cache_budget, counters);
+}
+
+auto mrg::RendererFactory::texture_cache_counters() const -> std::shared_ptr<mir::gl::TextureCacheCounters const>
+{
+    return counters;
 }
@@ -21,8 +21,12 @@
 
 #include "mir/renderer/renderer_factory.h"
 
+#include <cstddef>
+#include <memory>
+
 namespace mir
 {
+namespace gl { struct TextureCacheCounters; }
 namespace renderer
 {
 namespace gl
@@ -31,8 +35,19 @@ namespace gl
 class RendererFactory : public renderer::RendererFactory
 {
 public:
+    RendererFactory();
+    /// \param texture_cache_budget    Bytes of textures each renderer keeps for renderables that go undrawn
+    explicit RendererFactory(size_t texture_cache_budget);
+
     std::unique_ptr<renderer::Renderer> create_renderer_for(
         graphics::DisplayBuffer& display_buffer) override;
+
+    /// The texture cache totals of all the renderers created
+    auto texture_cache_counters() const -> std::shared_ptr<mir::gl::TextureCacheCounters const>;
+
+private:
+    size_t const texture_cache_budget;
+    std::shared_ptr<mir::gl::TextureCacheCounters> const counters;
 };
 
 }
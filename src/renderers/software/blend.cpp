@@ -0,0 +1,304 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/renderer/sw/blend.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace mrs = mir::renderer::software;
+
+namespace
+{
+/*
+ * The SIMD implementations below handle as many whole vectors as they can
+ * and return how many pixels they did; the scalar code does the remainder
+ * (and everything, on architectures we don't have a vector path for).
+ */
+using BlendSpan = size_t(*)(uint32_t* dst, uint32_t const* src, size_t count, uint8_t alpha);
+
+// x × a / 255, correctly rounded for all 8-bit x and a
+inline uint32_t mul_div255(uint32_t x, uint32_t a)
+{
+    auto const t = x * a + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+template<bool force_opaque>
+inline uint32_t blend_pixel(uint32_t dst, uint32_t src, uint32_t alpha)
+{
+    if (force_opaque)
+        src |= 0xff000000;
+
+    uint32_t s[4], result = 0;
+    for (auto c = 0; c != 4; ++c)
+        s[c] = mul_div255((src >> (8 * c)) & 0xff, alpha);
+
+    auto const inverse_alpha = 255 - s[3];
+    for (auto c = 0; c != 4; ++c)
+    {
+        auto const d = mul_div255((dst >> (8 * c)) & 0xff, inverse_alpha);
+        result |= std::min(s[c] + d, 255u) << (8 * c);
+    }
+    return result;
+}
+
+template<bool force_opaque>
+void blend_scalar(uint32_t* dst, uint32_t const* src, size_t count, uint8_t alpha)
+{
+    for (size_t i = 0; i != count; ++i)
+        dst[i] = blend_pixel<force_opaque>(dst[i], src[i], alpha);
+}
+
+#if defined(__SSE2__)
+// Two pixels, one 16-bit lane per channel
+inline __m128i mul_div255_epi16(__m128i x, __m128i a)
+{
+    auto const t = _mm_add_epi16(_mm_mullo_epi16(x, a), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+inline __m128i blend_two(__m128i src, __m128i dst, __m128i alpha)
+{
+    auto const s = mul_div255_epi16(src, alpha);
+    auto const s_alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    return _mm_add_epi16(s, mul_div255_epi16(dst, _mm_sub_epi16(_mm_set1_epi16(255), s_alpha)));
+}
+
+template<bool force_opaque>
+size_t blend_sse2(uint32_t* dst, uint32_t const* src, size_t count, uint8_t alpha)
+{
+    auto const zero = _mm_setzero_si128();
+    auto const alpha16 = _mm_set1_epi16(alpha);
+    auto const opaque = _mm_set1_epi32(static_cast<int>(0xff000000));
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        auto s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+        auto const d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dst + i));
+        if (force_opaque)
+            s = _mm_or_si128(s, opaque);
+
+        auto const lo = blend_two(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), alpha16);
+        auto const hi = blend_two(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), alpha16);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+size_t blend_coverage_sse2(uint32_t* dst, uint8_t const* coverage, size_t count, uint32_t color)
+{
+    auto const zero = _mm_setzero_si128();
+    auto const color16 = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(color)), zero);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32_t mask;
+        memcpy(&mask, coverage + i, sizeof mask);
+        if (!mask)
+            continue;   // Much of a glyph's bounding box is empty
+
+        // One coverage value per 16-bit lane, repeated for each channel of its pixel
+        auto const m = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(mask)), zero);
+        auto const m2 = _mm_unpacklo_epi16(m, m);
+        auto const d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dst + i));
+
+        auto const lo = blend_two(color16, _mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi32(m2, m2));
+        auto const hi = blend_two(color16, _mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi32(m2, m2));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    return i;
+}
+#endif
+
+#if defined(__x86_64__) && defined(__GNUC__)
+// The same as the SSE2 path, eight pixels at a time. Selected at runtime, as AVX2 isn't in the x86-64 baseline.
+__attribute__((target("avx2")))
+inline __m256i mul_div255_epi16_avx2(__m256i x, __m256i a)
+{
+    auto const t = _mm256_add_epi16(_mm256_mullo_epi16(x, a), _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+__attribute__((target("avx2")))
+inline __m256i blend_four_avx2(__m256i src, __m256i dst, __m256i alpha)
+{
+    auto const s = mul_div255_epi16_avx2(src, alpha);
+    auto const s_alpha =
+        _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    return _mm256_add_epi16(s, mul_div255_epi16_avx2(dst, _mm256_sub_epi16(_mm256_set1_epi16(255), s_alpha)));
+}
+
+template<bool force_opaque>
+__attribute__((target("avx2")))
+size_t blend_avx2(uint32_t* dst, uint32_t const* src, size_t count, uint8_t alpha)
+{
+    auto const zero = _mm256_setzero_si256();
+    auto const alpha16 = _mm256_set1_epi16(alpha);
+    auto const opaque = _mm256_set1_epi32(static_cast<int>(0xff000000));
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        auto s = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+        auto const d = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(dst + i));
+        if (force_opaque)
+            s = _mm256_or_si256(s, opaque);
+
+        // Unpack and pack both work within 128-bit lanes, so pixel order is preserved
+        auto const lo = blend_four_avx2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero), alpha16);
+        auto const hi = blend_four_avx2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero), alpha16);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    return i + blend_sse2<force_opaque>(dst + i, src + i, count - i, alpha);
+}
+#endif
+
+#if defined(__ARM_NEON)
+inline uint8x8_t mul_div255_u8(uint8x8_t x, uint8x8_t a)
+{
+    auto const t = vmull_u8(x, a);
+    return vrshrn_n_u16(vrsraq_n_u16(t, t, 8), 8);
+}
+
+template<bool force_opaque>
+size_t blend_neon(uint32_t* dst, uint32_t const* src, size_t count, uint8_t alpha)
+{
+    auto const alpha8 = vdup_n_u8(alpha);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        // De-interleaved into one vector per channel: B, G, R, A
+        auto s = vld4_u8(reinterpret_cast<uint8_t const*>(src + i));
+        auto d = vld4_u8(reinterpret_cast<uint8_t const*>(dst + i));
+        if (force_opaque)
+            s.val[3] = vdup_n_u8(255);
+
+        for (auto c = 0; c != 4; ++c)
+            s.val[c] = mul_div255_u8(s.val[c], alpha8);
+
+        auto const inverse_alpha = vmvn_u8(s.val[3]);
+        for (auto c = 0; c != 4; ++c)
+            d.val[c] = vqadd_u8(s.val[c], mul_div255_u8(d.val[c], inverse_alpha));
+
+        vst4_u8(reinterpret_cast<uint8_t*>(dst + i), d);
+    }
+    return i;
+}
+
+size_t blend_coverage_neon(uint32_t* dst, uint8_t const* coverage, size_t count, uint32_t color)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        auto const m = vld1_u8(coverage + i);
+        auto d = vld4_u8(reinterpret_cast<uint8_t const*>(dst + i));
+
+        uint8x8_t s[4];
+        for (auto c = 0; c != 4; ++c)
+            s[c] = mul_div255_u8(vdup_n_u8((color >> (8 * c)) & 0xff), m);
+
+        auto const inverse_alpha = vmvn_u8(s[3]);
+        for (auto c = 0; c != 4; ++c)
+            d.val[c] = vqadd_u8(s[c], mul_div255_u8(d.val[c], inverse_alpha));
+
+        vst4_u8(reinterpret_cast<uint8_t*>(dst + i), d);
+    }
+    return i;
+}
+#endif
+
+template<bool force_opaque>
+auto select_blend_span() -> BlendSpan
+{
+#if defined(__x86_64__) && defined(__GNUC__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return &blend_avx2<force_opaque>;
+#endif
+#if defined(__SSE2__)
+    return &blend_sse2<force_opaque>;
+#elif defined(__ARM_NEON)
+    return &blend_neon<force_opaque>;
+#else
+    return nullptr;
+#endif
+}
+
+template<bool force_opaque>
+void blend(uint32_t* dst, uint32_t const* src, size_t count, uint8_t alpha)
+{
+    static BlendSpan const simd = select_blend_span<force_opaque>();
+
+    auto const done = simd ? simd(dst, src, count, alpha) : 0;
+    blend_scalar<force_opaque>(dst + done, src + done, count - done, alpha);
+}
+}
+
+void mrs::blend_over(uint32_t* dst, uint32_t const* src, size_t count, uint8_t alpha)
+{
+    blend<false>(dst, src, count, alpha);
+}
+
+void mrs::blend_opaque(uint32_t* dst, uint32_t const* src, size_t count, uint8_t alpha)
+{
+    if (alpha == 255)
+    {
+        for (size_t i = 0; i != count; ++i)
+            dst[i] = src[i] | 0xff000000;
+    }
+    else
+    {
+        blend<true>(dst, src, count, alpha);
+    }
+}
+
+void mrs::blend_coverage(uint32_t* dst, uint8_t const* coverage, size_t count, uint32_t color)
+{
+    // Glyph rows are short, so it isn't worth dispatching to wider vectors at runtime
+#if defined(__SSE2__)
+    auto const done = blend_coverage_sse2(dst, coverage, count, color);
+#elif defined(__ARM_NEON)
+    auto const done = blend_coverage_neon(dst, coverage, count, color);
+#else
+    size_t const done = 0;
+#endif
+
+    for (auto i = done; i != count; ++i)
+    {
+        if (coverage[i])
+            dst[i] = blend_pixel<false>(dst[i], color, coverage[i]);
+    }
+}
+
+void mrs::swap_red_blue(uint32_t* dst, uint32_t const* src, size_t count)
+{
+    for (size_t i = 0; i != count; ++i)
+    {
+        auto const pixel = src[i];
+        dst[i] = (pixel & 0xff00ff00) | ((pixel >> 16) & 0xff) | ((pixel & 0xff) << 16);
+    }
+}
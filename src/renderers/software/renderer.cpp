@@ -0,0 +1,344 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define MIR_LOG_COMPONENT "SoftwareRenderer"
+
+#include "renderer.h"
+#include "mir/renderer/sw/blend.h"
+#include "mir/renderer/sw/render_target.h"
+#include "mir/renderer/sw/pixel_source.h"
+#include "mir/graphics/display_buffer.h"
+#include "mir/graphics/buffer.h"
+#include "mir/log.h"
+
+#include <boost/throw_exception.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+namespace
+{
+struct PixelLayout
+{
+    bool has_alpha;
+    bool red_blue_swapped;  // i.e. ABGR rather than ARGB
+};
+
+auto layout_of(MirPixelFormat format) -> PixelLayout const*
+{
+    static PixelLayout const argb{true, false}, xrgb{false, false}, abgr{true, true}, xbgr{false, true};
+
+    switch (format)
+    {
+    case mir_pixel_format_argb_8888: return &argb;
+    case mir_pixel_format_xrgb_8888: return &xrgb;
+    case mir_pixel_format_abgr_8888: return &abgr;
+    case mir_pixel_format_xbgr_8888: return &xbgr;
+    default: return nullptr;
+    }
+}
+
+auto row_of(mrs::Mapping<unsigned char const>& mapping, int y) -> uint32_t const*
+{
+    return reinterpret_cast<uint32_t const*>(mapping.data() + y * mapping.stride().as_int());
+}
+
+auto row_of(mrs::Mapping<unsigned char>& mapping, int y) -> uint32_t*
+{
+    return reinterpret_cast<uint32_t*>(mapping.data() + y * mapping.stride().as_int());
+}
+
+// Nearest source pixel for the centre of destination pixel i of n, when mapping n pixels onto m
+inline int nearest(int i, int n, int m)
+{
+    return static_cast<int>((2 * static_cast<int64_t>(i) + 1) * m / (2 * n));
+}
+}
+
+mrs::Renderer::Renderer(mg::DisplayBuffer& display_buffer)
+    : render_target{dynamic_cast<RenderTarget*>(display_buffer.native_display_buffer())},
+      viewport{display_buffer.view_area()},
+      output_transform{display_buffer.transformation()}
+{
+    if (!render_target)
+        BOOST_THROW_EXCEPTION(std::logic_error("DisplayBuffer does not support software rendering"));
+}
+
+mrs::Renderer::~Renderer() = default;
+
+void mrs::Renderer::set_viewport(geometry::Rectangle const& rect)
+{
+    viewport = rect;
+}
+
+void mrs::Renderer::set_output_transform(glm::mat2 const& t)
+{
+    output_transform = t;
+}
+
+void mrs::Renderer::suspend()
+{
+}
+
+void mrs::Renderer::render(mg::RenderableList const& renderables) const
+{
+    auto const pixels = viewport.size.width.as_int() * viewport.size.height.as_int();
+    canvas.assign(pixels, 0);
+
+    for (auto const& r : renderables)
+    {
+        draw(*r);
+    }
+
+    present();
+}
+
+void mrs::Renderer::draw(mg::Renderable const& renderable) const
+{
+    std::shared_ptr<ReadMappableBuffer> buffer;
+    try
+    {
+        buffer = as_read_mappable_buffer(renderable.buffer());
+    }
+    catch (std::exception const&)
+    {
+    }
+
+    if (!buffer)
+    {
+        mir::log_error("Buffer does not support software rendering!");
+        return;
+    }
+
+    auto const mapping = buffer->map_readable();
+    auto const layout = layout_of(mapping->format());
+    if (!layout)
+    {
+        mir::log_error("Unsupported pixel format for software rendering: %d", mapping->format());
+        return;
+    }
+
+    auto const alpha = static_cast<uint8_t>(std::round(std::clamp(renderable.alpha(), 0.0f, 1.0f) * 255));
+    if (alpha == 0)
+        return;
+
+    auto const blend = (layout->has_alpha && renderable.shaped()) ? &blend_over : &blend_opaque;
+
+    auto const dest = renderable.screen_position();
+    auto const src = renderable.src_bounds().value_or(geom::Rectangle{{0, 0}, mapping->size()})
+        .intersection_with({{0, 0}, mapping->size()});
+    if (dest.size.width.as_int() <= 0 || dest.size.height.as_int() <= 0 ||
+        src.size.width.as_int() <= 0 || src.size.height.as_int() <= 0)
+    {
+        return;
+    }
+
+    auto clip = viewport;
+    if (auto const clip_area = renderable.clip_area())
+        clip = clip.intersection_with(clip_area.value());
+
+    auto const canvas_width = viewport.size.width.as_int();
+    auto const canvas_row =
+        [&](int y) { return canvas.data() + (y - viewport.top().as_int()) * canvas_width - viewport.left().as_int(); };
+
+    auto const src_x = src.left().as_int(), src_y = src.top().as_int();
+    auto const src_width = src.size.width.as_int(), src_height = src.size.height.as_int();
+    auto const dest_x = dest.left().as_int(), dest_y = dest.top().as_int();
+    auto const dest_width = dest.size.width.as_int(), dest_height = dest.size.height.as_int();
+
+    glm::mat4 const transformation = renderable.transformation();
+    if (transformation == glm::mat4(1))
+    {
+        auto const visible = dest.intersection_with(clip);
+        auto const left = visible.left().as_int();
+        auto const width = visible.size.width.as_int();
+        if (width <= 0)
+            return;
+
+        bool const direct = src_width == dest_width && !layout->red_blue_swapped;
+        scratch.resize(width);
+
+        for (auto y = visible.top().as_int(); y != visible.bottom().as_int(); ++y)
+        {
+            auto const source_row = row_of(*mapping, src_y + nearest(y - dest_y, dest_height, src_height));
+            uint32_t const* source;
+
+            if (direct)
+            {
+                source = source_row + src_x + (left - dest_x);
+            }
+            else
+            {
+                for (auto x = 0; x != width; ++x)
+                    scratch[x] = source_row[src_x + nearest(left + x - dest_x, dest_width, src_width)];
+                if (layout->red_blue_swapped)
+                    swap_red_blue(scratch.data(), scratch.data(), width);
+                source = scratch.data();
+            }
+
+            blend(canvas_row(y) + left, source, width, alpha);
+        }
+        return;
+    }
+
+    /*
+     * As in the GL renderer the transformation is about the centre of the
+     * surface: screen = T × (p - centre) + centre. Invert it to find which
+     * surface pixel (if any) lands on each screen pixel.
+     */
+    glm::mat2 const linear{glm::vec2{transformation[0]}, glm::vec2{transformation[1]}};
+    glm::vec2 const translation{transformation[3]};
+    if (std::abs(glm::determinant(linear)) < 1e-6f)
+        return;
+
+    glm::mat2 const inverse = glm::inverse(linear);
+    glm::vec2 const centre{dest_x + dest_width / 2.0f, dest_y + dest_height / 2.0f};
+
+    glm::vec2 lo{std::numeric_limits<float>::max()}, hi{std::numeric_limits<float>::lowest()};
+    for (auto const& corner : {dest.top_left, dest.top_right(), dest.bottom_left(), dest.bottom_right()})
+    {
+        auto const p = linear * (glm::vec2(corner.x.as_int(), corner.y.as_int()) - centre) + translation + centre;
+        lo = glm::min(lo, p);
+        hi = glm::max(hi, p);
+    }
+
+    auto const bounds_x = static_cast<int>(std::floor(lo.x)), bounds_y = static_cast<int>(std::floor(lo.y));
+    auto const bounds = geom::Rectangle{
+        {bounds_x, bounds_y},
+        {static_cast<int>(std::ceil(hi.x)) - bounds_x, static_cast<int>(std::ceil(hi.y)) - bounds_y}}
+        .intersection_with(clip);
+    auto const left = bounds.left().as_int();
+    auto const width = bounds.size.width.as_int();
+    if (width <= 0)
+        return;
+
+    scratch.resize(width);
+
+    for (auto y = bounds.top().as_int(); y != bounds.bottom().as_int(); ++y)
+    {
+        auto const row = canvas_row(y);
+        int run_start = -1;
+
+        auto const flush = [&](int end)
+            {
+                if (run_start < 0)
+                    return;
+                if (layout->red_blue_swapped)
+                    swap_red_blue(scratch.data() + run_start, scratch.data() + run_start, end - run_start);
+                blend(row + left + run_start, scratch.data() + run_start, end - run_start, alpha);
+                run_start = -1;
+            };
+
+        for (auto x = 0; x != width; ++x)
+        {
+            auto const p = inverse * (glm::vec2{left + x + 0.5f, y + 0.5f} - centre - translation) + centre;
+            auto const u = static_cast<int>(std::floor((p.x - dest_x) * src_width / dest_width));
+            auto const v = static_cast<int>(std::floor((p.y - dest_y) * src_height / dest_height));
+
+            if (u < 0 || u >= src_width || v < 0 || v >= src_height)
+            {
+                flush(x);
+                continue;
+            }
+
+            if (run_start < 0)
+                run_start = x;
+            scratch[x] = row_of(*mapping, src_y + v)[src_x + u];
+        }
+        flush(width);
+    }
+}
+
+void mrs::Renderer::present() const
+{
+    {
+        auto const target = render_target->map_back_buffer();
+        auto const layout = layout_of(target->format());
+        if (!layout)
+        {
+            BOOST_THROW_EXCEPTION(std::runtime_error(
+                "Unsupported render target format for software rendering: " +
+                std::to_string(target->format())));
+        }
+
+        auto const target_width = target->size().width.as_int();
+        auto const target_height = target->size().height.as_int();
+        auto const canvas_width = viewport.size.width.as_int();
+        auto const canvas_height = viewport.size.height.as_int();
+
+        if (output_transform == glm::mat2(1) && target_width == canvas_width && target_height == canvas_height)
+        {
+            for (auto y = 0; y != target_height; ++y)
+            {
+                auto const source = canvas.data() + y * canvas_width;
+                if (layout->red_blue_swapped)
+                    swap_red_blue(row_of(*target, y), source, target_width);
+                else
+                    memcpy(row_of(*target, y), source, target_width * sizeof(uint32_t));
+            }
+        }
+        else
+        {
+            /*
+             * Letterbox the (transformed) viewport into the target and keep
+             * pixels square, like the GL renderer. The output transformation
+             * is in GL's normalized, y-up coordinates, so flip y around it.
+             */
+            auto const transformed = output_transform * glm::vec2(canvas_width, canvas_height);
+            auto const viewport_width = std::abs(transformed.x);
+            auto const viewport_height = std::abs(transformed.y);
+
+            auto reduced_width = target_width, reduced_height = target_height;
+            if (viewport_width * target_height >= target_width * viewport_height)
+                reduced_height = static_cast<int>(target_width * viewport_height / viewport_width);
+            else
+                reduced_width = static_cast<int>(target_height * viewport_width / viewport_height);
+
+            auto const offset_x = (target_width - reduced_width) / 2;
+            auto const offset_y = (target_height - reduced_height) / 2;
+            auto const inverse = glm::inverse(output_transform);
+
+            for (auto y = 0; y != target_height; ++y)
+            {
+                auto const dest = row_of(*target, y);
+                for (auto x = 0; x != target_width; ++x)
+                {
+                    glm::vec2 const n{
+                        (x - offset_x + 0.5f) / reduced_width - 0.5f,
+                        -((y - offset_y + 0.5f) / reduced_height - 0.5f)};
+                    auto const c = inverse * n;
+                    auto const cx = static_cast<int>(std::floor((c.x + 0.5f) * canvas_width));
+                    auto const cy = static_cast<int>(std::floor((0.5f - c.y) * canvas_height));
+
+                    if (cx < 0 || cx >= canvas_width || cy < 0 || cy >= canvas_height)
+                        dest[x] = 0;
+                    else
+                        dest[x] = canvas[cy * canvas_width + cx];
+                }
+                if (layout->red_blue_swapped)
+                    swap_red_blue(dest, dest, target_width);
+            }
+        }
+    }
+
+    render_target->present_back_buffer();
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SOFTWARE_RENDERER_H_
+#define MIR_RENDERER_SOFTWARE_RENDERER_H_
+
+#include <mir/renderer/renderer.h>
+#include <mir/geometry/rectangle.h>
+#include <mir/graphics/renderable.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace mir
+{
+namespace graphics { class DisplayBuffer; }
+namespace renderer
+{
+namespace software
+{
+class RenderTarget;
+
+/**
+ * Composites with the CPU from buffers that can be mapped for reading
+ * (e.g. shm buffers) into a DisplayBuffer that is a software::RenderTarget.
+ *
+ * Sampling is nearest-neighbour and renderable transformations are treated
+ * as 2D affine transformations; there's no perspective.
+ */
+class Renderer : public renderer::Renderer
+{
+public:
+    Renderer(graphics::DisplayBuffer& display_buffer);
+    ~Renderer();
+
+    void set_viewport(geometry::Rectangle const& rect) override;
+    void set_output_transform(glm::mat2 const&) override;
+    void render(graphics::RenderableList const&) const override;
+    void suspend() override;
+
+private:
+    void draw(graphics::Renderable const& renderable) const;
+    void present() const;
+
+    RenderTarget* const render_target;
+    geometry::Rectangle viewport;
+    glm::mat2 output_transform;
+
+    // The frame being composited, in viewport coordinates, as premultiplied ARGB
+    std::vector<uint32_t> mutable canvas;
+    // A row of source pixels that need sampling or converting before blending
+    std::vector<uint32_t> mutable scratch;
+};
+
+}
+}
+}
+
+#endif // MIR_RENDERER_SOFTWARE_RENDERER_H_
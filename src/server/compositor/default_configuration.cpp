@@ -23,11 +23,14 @@
 #include "default_display_buffer_compositor_factory.h"
 #include "multi_threaded_compositor.h"
 #include "gl/renderer_factory.h"
+#include "software/renderer_factory.h"
 #include "mir/main_loop.h"
 
 #include "mir/options/configuration.h"
 
 #include <boost/throw_exception.hpp>
+#include <algorithm>
+#include <stdexcept>
 
 namespace mc = mir::compositor;
 namespace ms = mir::scene;
@@ -84,8 +87,16 @@ mir::DefaultServerConfiguration::the_compositor()
 std::shared_ptr<mir::renderer::RendererFactory> mir::DefaultServerConfiguration::the_renderer_factory()
 {
     return renderer_factory(
-        []()
+        [this]() -> std::shared_ptr<mir::renderer::RendererFactory>
         {
-            return std::make_shared<mir::renderer::gl::RendererFactory>();
+            auto const renderer = the_options()->get<std::string>(options::renderer_opt);
+
+            if (renderer == "software")
+                return std::make_shared<mir::renderer::software::RendererFactory>();
+            else if (renderer != "gl")
+                BOOST_THROW_EXCEPTION(std::runtime_error("Unknown renderer: " + renderer));
+
+            auto const texture_cache_mib = the_options()->get<int>(options::texture_cache_budget_opt);
+            return std::make_shared<mir::renderer::gl::RendererFactory>(size_t(std::max(texture_cache_mib, 0)) << 20);
         });
 }
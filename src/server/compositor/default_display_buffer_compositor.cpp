@@ -28,6 +28,7 @@
 #include "mir/renderer/renderer.h"
 #include "occlusion.h"
 #include <mutex>
+#include <chrono>
 #include <cstdlib>
 #include <algorithm>
 
@@ -46,10 +47,15 @@ mc::DefaultDisplayBufferCompositor::DefaultDisplayBufferCompositor(
 
 void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& scene_elements)
 {
+    using clock = std::chrono::steady_clock;
+    using FrameStage = CompositorReport::FrameStage;
+
     report->began_frame(this);
 
     auto const& view_area = display_buffer.view_area();
+    auto const occlusion_start = clock::now();
     auto const& occlusions = mc::filter_occlusions_from(scene_elements, view_area);
+    report->frame_stage_timing(this, FrameStage::occlusion, clock::now() - occlusion_start);
 
     for (auto const& element : occlusions)
         element->occluded();
@@ -86,6 +92,13 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
         report->renderables_in_frame(this, renderable_list);
         report->rendered_frame(this);
 
+        auto const timing = renderer->last_frame_timing();
+        report->frame_stage_timing(this, FrameStage::texture_upload, timing.texture_upload);
+        report->frame_stage_timing(this, FrameStage::draw, timing.draw);
+        report->frame_stage_timing(this, FrameStage::swap, timing.swap);
+        if (timing.gpu.is_set())
+            report->frame_stage_timing(this, FrameStage::gpu, timing.gpu.value());
+
         /*
          * This is used for the 'early release' optimization to release buffers
          * we did use back to clients before starting on the potentially slow
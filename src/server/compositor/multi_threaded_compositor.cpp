@@ -135,12 +135,25 @@ public:
                     not_posted_yet = false;
                     lock.unlock();
 
+                    using clock = std::chrono::steady_clock;
+                    using FrameStage = CompositorReport::FrameStage;
+
                     for (auto& tuple : compositors)
                     {
                         auto& compositor = std::get<1>(tuple);
-                        compositor->composite(scene->scene_elements_for(compositor.get()));
+                        auto const snapshot_start = clock::now();
+                        auto scene_elements = scene->scene_elements_for(compositor.get());
+                        report->frame_stage_timing(
+                            compositor.get(), FrameStage::scene_snapshot, clock::now() - snapshot_start);
+                        compositor->composite(std::move(scene_elements));
                     }
+
+                    // Posting waits for any outstanding page flips, so this includes that wait
+                    auto const post_start = clock::now();
                     group.post();
+                    auto const post_time = clock::now() - post_start;
+                    for (auto& tuple : compositors)
+                        report->frame_stage_timing(std::get<1>(tuple).get(), FrameStage::post, post_time);
 
                     /*
                      * "Predictive bypass" optimization: If the last frame was
@@ -118,6 +118,16 @@ bool mc::Stream::framedropping() const
     return schedule_mode == ScheduleMode::Dropping;
 }
 
+void mc::Stream::set_tearing_allowed(bool allowed)
+{
+    tearing_allowed_ = allowed;
+}
+
+bool mc::Stream::tearing_allowed() const
+{
+    return tearing_allowed_;
+}
+
 void mc::Stream::transition_schedule(
     std::shared_ptr<mc::Schedule>&& new_schedule, std::lock_guard<std::mutex> const&)
 {
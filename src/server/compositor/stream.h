@@ -26,6 +26,7 @@
 #include "mir/lockable_callback.h"
 #include "mir/geometry/size.h"
 #include "multi_monitor_arbiter.h"
+#include <atomic>
 #include <mutex>
 #include <memory>
 #include <set>
@@ -52,6 +53,8 @@ public:
     geometry::Size stream_size() override;
     void allow_framedropping(bool) override;
     bool framedropping() const override;
+    void set_tearing_allowed(bool allowed) override;
+    bool tearing_allowed() const override;
     int buffers_ready_for_compositor(void const* user_id) const override;
     void drop_old_buffers() override;
     bool has_submitted_buffer() const override;
@@ -69,6 +72,7 @@ private:
     float scale_{1.0f};
     MirPixelFormat pf;
     bool first_frame_posted;
+    std::atomic<bool> tearing_allowed_{false};
 
     std::mutex callback_mutex;
     std::function<void(geometry::Size const&)> frame_callback;
@@ -27,6 +27,7 @@
 #include "mir/cookie/authority.h"
 #include "mir/frontend/wayland.h"
 
+#include "mir/logging/async_logger.h"
 #include "mir/logging/dumb_console_logger.h"
 #include "mir/options/program_option.h"
 #include "mir/frontend/session_credentials.h"
@@ -228,6 +229,12 @@ auto mir::DefaultServerConfiguration::the_logger()
     return logger(
         []() -> std::shared_ptr<ml::Logger>
         {
-            return std::make_shared<ml::DumbConsoleLogger>();
+            // Write to the console from a background thread, so logging (including
+            // the debug reports) doesn't block the compositor and input threads
+            auto const logger = std::make_shared<ml::AsyncLogger>(std::make_shared<ml::DumbConsoleLogger>());
+
+            // Don't lose whatever led up to a fatal error
+            mir::fatal_error_flush = &ml::AsyncLogger::flush_all;
+            return logger;
         });
 }
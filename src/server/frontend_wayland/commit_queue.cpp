@@ -0,0 +1,166 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "commit_queue.h"
+#include "deleted_for_resource.h"
+
+#include "mir/wayland/wayland_base.h"
+
+#include <algorithm>
+#include <poll.h>
+
+namespace mf = mir::frontend;
+namespace mw = mir::wayland;
+
+namespace
+{
+auto has_signalled(mir::Fd const& fence) -> bool
+{
+    pollfd pfd{fence, POLLIN, 0};
+    if (poll(&pfd, 1, 0) < 0)
+    {
+        // We can't wait on a fence we can't poll, so don't hold the commit up forever
+        return true;
+    }
+    return pfd.revents != 0;
+}
+}
+
+mf::CommitQueue::CommitQueue(wl_event_loop* loop, wl_client* client)
+    : loop{loop},
+      client{client}
+{
+}
+
+mf::CommitQueue::~CommitQueue()
+{
+    stop_watching();
+}
+
+void mf::CommitQueue::push(std::vector<Fd> fences, std::function<void()> apply)
+{
+    commits.push_back({std::move(fences), std::move(apply)});
+    ++pushed_count;
+
+    if (commits.size() == 1)
+    {
+        flush();
+    }
+}
+
+void mf::CommitQueue::push(
+    std::vector<Fd> fences,
+    wl_resource* buffer,
+    std::function<void(std::experimental::optional<wl_resource*>)> apply)
+{
+    push(
+        std::move(fences),
+        [buffer, destroyed = deleted_flag_for_resource(buffer), apply = std::move(apply)]()
+        {
+            if (*destroyed)
+            {
+                apply(std::experimental::nullopt);
+            }
+            else
+            {
+                apply(buffer);
+            }
+        });
+}
+
+void mf::CommitQueue::flush()
+{
+    flush_pushed_before(pushed_count);
+}
+
+void mf::CommitQueue::flush_pushed_before(uint64_t count)
+{
+    stop_watching();
+
+    while (!commits.empty())
+    {
+        auto& fences = commits.front().fences;
+        fences.erase(std::remove_if(begin(fences), end(fences), has_signalled), end(fences));
+
+        if (!fences.empty())
+        {
+            watch(fences);
+            return;
+        }
+
+        // The front commit was pushed after pushed() returned pushed_count - commits.size()
+        if (pushed_count - commits.size() >= count)
+        {
+            return;
+        }
+
+        // Remove the commit before applying it, in case applying it throws
+        auto const apply = std::move(commits.front().apply);
+        commits.pop_front();
+        apply();
+    }
+}
+
+auto mf::CommitQueue::fences() const -> std::vector<Fd>
+{
+    std::vector<Fd> result;
+    for (auto const& commit : commits)
+    {
+        result.insert(end(result), begin(commit.fences), end(commit.fences));
+    }
+    return result;
+}
+
+int mf::CommitQueue::on_fence_signalled(int /*fd*/, uint32_t /*mask*/, void* data)
+{
+    auto const self = static_cast<CommitQueue*>(data);
+
+    try
+    {
+        self->flush();
+    }
+    catch (mw::ProtocolError const& err)
+    {
+        wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
+    }
+    catch (...)
+    {
+        // As if the commit request had failed (e.g. the client is over its buffer memory quota)
+        mw::internal_error_processing_request(self->client, "Surface::commit()");
+    }
+
+    return 0;
+}
+
+void mf::CommitQueue::watch(std::vector<Fd> const& fences)
+{
+    for (auto const& fence : fences)
+    {
+        fence_sources.push_back(wl_event_loop_add_fd(loop, fence, WL_EVENT_READABLE, &on_fence_signalled, this));
+    }
+}
+
+void mf::CommitQueue::stop_watching()
+{
+    for (auto const source : fence_sources)
+    {
+        if (source)
+        {
+            wl_event_source_remove(source);
+        }
+    }
+    fence_sources.clear();
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_COMMIT_QUEUE_H
+#define MIR_FRONTEND_COMMIT_QUEUE_H
+
+#include "mir/fd.h"
+
+#include <wayland-server-core.h>
+
+#include <cstdint>
+#include <deque>
+#include <experimental/optional>
+#include <functional>
+#include <vector>
+
+namespace mir
+{
+namespace frontend
+{
+/**
+ * Applies commits in the order they were made, holding each one until the fences it depends on have signalled
+ *
+ * A fence is a file descriptor that becomes readable once it has signalled, such as a dma-buf the client is still
+ * rendering into. Holding commits until then means the compositor only ever picks up state that is ready to draw.
+ *
+ * \note This is not threadsafe, and should only be accessed on the Wayland thread
+ */
+class CommitQueue
+{
+public:
+    /// \param client  The client whose commits these are, which is disconnected if applying a held commit fails
+    CommitQueue(wl_event_loop* loop, wl_client* client);
+    ~CommitQueue();
+
+    /// If nothing is queued ahead of it and its fences have already signalled, apply is called immediately
+    void push(std::vector<Fd> fences, std::function<void()> apply);
+
+    /**
+     * As push(), for a commit that attaches \p buffer
+     *
+     * The client may destroy the buffer while the commit is queued, so apply is passed the buffer, or nothing if it
+     * has been destroyed (so the commit leaves the current buffer in place, rather than attaching a null one).
+     */
+    void push(
+        std::vector<Fd> fences,
+        wl_resource* buffer,
+        std::function<void(std::experimental::optional<wl_resource*> buffer)> apply);
+
+    /// Applies queued commits up to the first one that is still waiting on a fence
+    void flush();
+
+    /// Counts the commits pushed so far, to flush_pushed_before() only those made before some point
+    auto pushed() const -> uint64_t { return pushed_count; }
+
+    /**
+     * As flush(), but stops at the first commit that was pushed after pushed() returned \p count
+     *
+     * A later commit left in the queue, though it isn't waiting on anything, is applied by the next flush().
+     */
+    void flush_pushed_before(uint64_t count);
+
+    auto empty() const -> bool { return commits.empty(); }
+
+    /// The fences all queued commits are waiting on
+    auto fences() const -> std::vector<Fd>;
+
+private:
+    struct Commit
+    {
+        std::vector<Fd> fences;
+        std::function<void()> apply;
+    };
+
+    static int on_fence_signalled(int fd, uint32_t mask, void* data);
+    void watch(std::vector<Fd> const& fences);
+    void stop_watching();
+
+    wl_event_loop* const loop;
+    wl_client* const client;
+    std::deque<Commit> commits;
+    uint64_t pushed_count{0};
+    std::vector<wl_event_source*> fence_sources;
+};
+}
+}
+
+#endif // MIR_FRONTEND_COMMIT_QUEUE_H
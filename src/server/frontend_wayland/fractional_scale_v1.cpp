@@ -0,0 +1,342 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fractional_scale_v1.h"
+
+#include "preferred_scale.h"
+#include "wl_surface.h"
+#include "output_manager.h"
+#include "fractional-scale-v1_wrapper.h"
+
+#include "mir/executor.h"
+#include "mir/scene/null_surface_observer.h"
+#include "mir/scene/surface.h"
+#include "mir/graphics/display_configuration.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+
+namespace mf = mir::frontend;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+namespace mw = mir::wayland;
+
+namespace mir
+{
+namespace frontend
+{
+class FractionalScaleV1;
+
+/// Keeps track of the scale of each output and tells fractional scale objects when it changes.
+/// Apart from configuration change notifications, only used on the Wayland thread.
+class OutputScales : public OutputObserver, public std::enable_shared_from_this<OutputScales>
+{
+public:
+    OutputScales(std::shared_ptr<Executor> const& wayland_executor, MirDisplay& display);
+
+    /// The scale, in 120ths, for a surface occupying area (see preferred_scale())
+    auto scale_for(std::experimental::optional<geometry::Rectangle> const& area) const -> uint32_t;
+
+    /// Raises fractional_scale_exists if the surface already has a fractional scale object
+    void add(FractionalScaleV1* fractional_scale, WlSurface* surface);
+
+    std::shared_ptr<Executor> const wayland_executor;
+
+private:
+    void handle_configuration_change(graphics::DisplayConfiguration const& config) override;
+    void update_outputs(graphics::DisplayConfiguration const& config);
+    void add_output(graphics::DisplayConfigurationOutput const& output);
+
+    std::vector<OutputScale> outputs;
+    std::vector<wayland::Weak<FractionalScaleV1>> fractional_scales;
+};
+
+class FractionalScaleManagerV1 : public wayland::FractionalScaleManagerV1::Global
+{
+public:
+    FractionalScaleManagerV1(
+        struct wl_display* display,
+        std::shared_ptr<Executor> const& wayland_executor,
+        std::shared_ptr<MirDisplay> const& mir_display);
+    ~FractionalScaleManagerV1();
+
+private:
+    class Instance : public wayland::FractionalScaleManagerV1
+    {
+    public:
+        Instance(wl_resource* new_resource, std::shared_ptr<OutputScales> const& output_scales);
+
+    private:
+        void destroy() override;
+        void get_fractional_scale(wl_resource* id, wl_resource* surface) override;
+
+        std::shared_ptr<OutputScales> const output_scales;
+    };
+
+    void bind(wl_resource* new_resource) override;
+
+    std::shared_ptr<MirDisplay> const mir_display;
+    std::shared_ptr<OutputScales> const output_scales;
+};
+
+class FractionalScaleV1 : public wayland::FractionalScaleV1
+{
+public:
+    FractionalScaleV1(wl_resource* new_resource, WlSurface* surface, std::shared_ptr<OutputScales> const& output_scales);
+    ~FractionalScaleV1();
+
+    auto is_for(WlSurface const& surface) const -> bool { return this->surface == surface; }
+
+    /// Sends preferred_scale if the scale of the outputs the surface is on has changed
+    void update_preferred_scale();
+
+private:
+    class SurfaceObserver;
+
+    void destroy() override;
+    void stop_observing();
+
+    wayland::Weak<WlSurface> const surface;
+    std::weak_ptr<OutputScales> const output_scales;
+    std::shared_ptr<Executor> const wayland_executor;
+    std::experimental::optional<uint32_t> sent_scale;
+
+    std::weak_ptr<scene::Surface> observed_surface;
+    std::shared_ptr<SurfaceObserver> observer;
+};
+
+/// Has the fractional scale object re-check the surface's outputs when the shell moves or resizes it
+class FractionalScaleV1::SurfaceObserver : public scene::NullSurfaceObserver
+{
+public:
+    SurfaceObserver(std::shared_ptr<Executor> const& wayland_executor, wayland::Weak<FractionalScaleV1> fractional_scale)
+        : wayland_executor{wayland_executor},
+          fractional_scale{fractional_scale}
+    {
+    }
+
+    void moved_to(scene::Surface const*, geometry::Point const&) override
+    {
+        update_preferred_scale();
+    }
+
+    void window_resized_to(scene::Surface const*, geometry::Size const&) override
+    {
+        update_preferred_scale();
+    }
+
+private:
+    void update_preferred_scale()
+    {
+        wayland_executor->spawn([fractional_scale = fractional_scale]()
+            {
+                if (fractional_scale)
+                {
+                    fractional_scale.value().update_preferred_scale();
+                }
+            });
+    }
+
+    std::shared_ptr<Executor> const wayland_executor;
+    wayland::Weak<FractionalScaleV1> const fractional_scale;
+};
+}
+}
+
+auto mf::create_fractional_scale_manager_v1(
+    struct wl_display* display,
+    std::shared_ptr<Executor> const& wayland_executor,
+    OutputManager* const output_manager)
+    -> std::shared_ptr<FractionalScaleManagerV1>
+{
+    return std::make_shared<FractionalScaleManagerV1>(display, wayland_executor, output_manager->display_config());
+}
+
+mf::OutputScales::OutputScales(std::shared_ptr<Executor> const& wayland_executor, MirDisplay& display)
+    : wayland_executor{wayland_executor}
+{
+    display.for_each_output([this](mg::DisplayConfigurationOutput const& output) { add_output(output); });
+}
+
+auto mf::OutputScales::scale_for(std::experimental::optional<geom::Rectangle> const& area) const -> uint32_t
+{
+    return preferred_scale(outputs, area);
+}
+
+void mf::OutputScales::add(FractionalScaleV1* fractional_scale, WlSurface* surface)
+{
+    fractional_scales.erase(
+        std::remove_if(
+            begin(fractional_scales),
+            end(fractional_scales),
+            [](auto const& existing) { return !existing; }),
+        end(fractional_scales));
+
+    for (auto const& existing : fractional_scales)
+    {
+        if (existing.value().is_for(*surface))
+        {
+            BOOST_THROW_EXCEPTION(mw::ProtocolError(
+                fractional_scale->resource,
+                mw::FractionalScaleManagerV1::Error::fractional_scale_exists,
+                "Surface already has a fractional scale object"));
+        }
+    }
+
+    fractional_scales.push_back(mw::make_weak(fractional_scale));
+}
+
+void mf::OutputScales::handle_configuration_change(mg::DisplayConfiguration const& config)
+{
+    std::shared_ptr<mg::DisplayConfiguration> pconfig{config.clone()};
+    wayland_executor->spawn([config = std::move(pconfig), weak_self = weak_from_this()]
+        {
+            if (auto const self = weak_self.lock())
+            {
+                self->update_outputs(*config);
+            }
+        });
+}
+
+void mf::OutputScales::update_outputs(mg::DisplayConfiguration const& config)
+{
+    outputs.clear();
+    config.for_each_output([this](mg::DisplayConfigurationOutput const& output) { add_output(output); });
+
+    for (auto const& fractional_scale : fractional_scales)
+    {
+        if (fractional_scale)
+        {
+            fractional_scale.value().update_preferred_scale();
+        }
+    }
+}
+
+void mf::OutputScales::add_output(mg::DisplayConfigurationOutput const& output)
+{
+    if (output.used)
+    {
+        outputs.push_back({output.extents(), output.scale});
+    }
+}
+
+mf::FractionalScaleManagerV1::FractionalScaleManagerV1(
+    struct wl_display* display,
+    std::shared_ptr<Executor> const& wayland_executor,
+    std::shared_ptr<MirDisplay> const& mir_display)
+    : Global(display, Version<1>()),
+      mir_display{mir_display},
+      output_scales{std::make_shared<OutputScales>(wayland_executor, *mir_display)}
+{
+    mir_display->register_interest(output_scales.get());
+}
+
+mf::FractionalScaleManagerV1::~FractionalScaleManagerV1()
+{
+    mir_display->unregister_interest(output_scales.get());
+}
+
+void mf::FractionalScaleManagerV1::bind(wl_resource* new_resource)
+{
+    new Instance{new_resource, output_scales};
+}
+
+mf::FractionalScaleManagerV1::Instance::Instance(
+    wl_resource* new_resource,
+    std::shared_ptr<OutputScales> const& output_scales)
+    : wayland::FractionalScaleManagerV1{new_resource, Version<1>()},
+      output_scales{output_scales}
+{
+}
+
+void mf::FractionalScaleManagerV1::Instance::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::FractionalScaleManagerV1::Instance::get_fractional_scale(wl_resource* id, wl_resource* surface)
+{
+    new FractionalScaleV1{id, WlSurface::from(surface), output_scales};
+}
+
+mf::FractionalScaleV1::FractionalScaleV1(
+    wl_resource* new_resource,
+    WlSurface* surface,
+    std::shared_ptr<OutputScales> const& output_scales)
+    : wayland::FractionalScaleV1{new_resource, Version<1>()},
+      surface{mw::make_weak(surface)},
+      output_scales{output_scales},
+      wayland_executor{output_scales->wayland_executor}
+{
+    output_scales->add(this, surface);
+    surface->add_commit_listener(this, [this]() { update_preferred_scale(); });
+    update_preferred_scale();
+}
+
+mf::FractionalScaleV1::~FractionalScaleV1()
+{
+    if (surface)
+    {
+        surface.value().remove_commit_listener(this);
+    }
+    stop_observing();
+}
+
+void mf::FractionalScaleV1::update_preferred_scale()
+{
+    auto const scales = output_scales.lock();
+    if (!scales || !surface)
+    {
+        return;
+    }
+
+    std::experimental::optional<geom::Rectangle> area;
+    if (auto const scene_surface = surface.value().scene_surface())
+    {
+        area = geom::Rectangle{scene_surface.value()->top_left(), scene_surface.value()->window_size()};
+
+        if (observed_surface.lock() != scene_surface.value())
+        {
+            stop_observing();
+            observer = std::make_shared<SurfaceObserver>(wayland_executor, mw::make_weak(this));
+            scene_surface.value()->add_observer(observer);
+            observed_surface = scene_surface.value();
+        }
+    }
+
+    auto const scale = scales->scale_for(area);
+    if (scale != sent_scale)
+    {
+        send_preferred_scale_event(scale);
+        sent_scale = scale;
+    }
+}
+
+void mf::FractionalScaleV1::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::FractionalScaleV1::stop_observing()
+{
+    if (auto const scene_surface = observed_surface.lock())
+    {
+        scene_surface->remove_observer(observer);
+    }
+    observed_surface.reset();
+    observer.reset();
+}
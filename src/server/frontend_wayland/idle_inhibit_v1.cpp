@@ -0,0 +1,258 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "idle_inhibit_v1.h"
+
+#include "wl_surface.h"
+#include "idle-inhibit-unstable-v1_wrapper.h"
+
+#include "mir/executor.h"
+#include "mir/scene/idle_hub.h"
+#include "mir/scene/null_surface_observer.h"
+#include "mir/scene/surface.h"
+
+namespace mf = mir::frontend;
+namespace ms = mir::scene;
+namespace mw = mir::wayland;
+
+namespace mir
+{
+namespace frontend
+{
+class IdleInhibitManagerV1 : public wayland::IdleInhibitManagerV1::Global
+{
+public:
+    IdleInhibitManagerV1(
+        struct wl_display* display,
+        std::shared_ptr<Executor> const& wayland_executor,
+        std::shared_ptr<scene::IdleHub> const& idle_hub);
+
+private:
+    class Instance : public wayland::IdleInhibitManagerV1
+    {
+    public:
+        Instance(
+            wl_resource* new_resource,
+            std::shared_ptr<Executor> const& wayland_executor,
+            std::shared_ptr<scene::IdleHub> const& idle_hub);
+
+    private:
+        void destroy() override;
+        void create_inhibitor(wl_resource* id, wl_resource* surface) override;
+
+        std::shared_ptr<Executor> const wayland_executor;
+        std::shared_ptr<scene::IdleHub> const idle_hub;
+    };
+
+    void bind(wl_resource* new_resource) override;
+
+    std::shared_ptr<Executor> const wayland_executor;
+    std::shared_ptr<scene::IdleHub> const idle_hub;
+};
+
+/// Keeps the outputs from idling while its surface is shown (not hidden or minimized)
+class IdleInhibitorV1 : public wayland::IdleInhibitorV1
+{
+public:
+    IdleInhibitorV1(
+        wl_resource* new_resource,
+        WlSurface* surface,
+        std::shared_ptr<Executor> const& wayland_executor,
+        std::shared_ptr<scene::IdleHub> const& idle_hub);
+    ~IdleInhibitorV1();
+
+private:
+    class SurfaceObserver;
+
+    void destroy() override;
+
+    /// Takes or releases the inhibition to match whether the surface is shown. Only called on the Wayland thread.
+    void update();
+    void stop_observing();
+
+    wayland::Weak<WlSurface> const surface;
+    std::shared_ptr<Executor> const wayland_executor;
+    std::shared_ptr<scene::IdleHub> const idle_hub;
+
+    std::weak_ptr<scene::Surface> observed_surface;
+    std::shared_ptr<SurfaceObserver> observer;
+    std::shared_ptr<void> inhibition;
+};
+
+/// Has the inhibitor re-check the surface when it is hidden, shown, minimized or restored
+class IdleInhibitorV1::SurfaceObserver : public scene::NullSurfaceObserver
+{
+public:
+    SurfaceObserver(std::shared_ptr<Executor> const& wayland_executor, wayland::Weak<IdleInhibitorV1> inhibitor)
+        : wayland_executor{wayland_executor},
+          inhibitor{inhibitor}
+    {
+    }
+
+    void attrib_changed(scene::Surface const*, MirWindowAttrib attrib, int) override
+    {
+        if (attrib == mir_window_attrib_state)
+        {
+            update_inhibitor();
+        }
+    }
+
+    void hidden_set_to(scene::Surface const*, bool) override
+    {
+        update_inhibitor();
+    }
+
+private:
+    void update_inhibitor()
+    {
+        wayland_executor->spawn([inhibitor = inhibitor]()
+            {
+                if (inhibitor)
+                {
+                    inhibitor.value().update();
+                }
+            });
+    }
+
+    std::shared_ptr<Executor> const wayland_executor;
+    wayland::Weak<IdleInhibitorV1> const inhibitor;
+};
+}
+}
+
+auto mf::create_idle_inhibit_manager_v1(
+    struct wl_display* display,
+    std::shared_ptr<Executor> const& wayland_executor,
+    std::shared_ptr<ms::IdleHub> const& idle_hub)
+    -> std::shared_ptr<IdleInhibitManagerV1>
+{
+    return std::make_shared<IdleInhibitManagerV1>(display, wayland_executor, idle_hub);
+}
+
+mf::IdleInhibitManagerV1::IdleInhibitManagerV1(
+    struct wl_display* display,
+    std::shared_ptr<Executor> const& wayland_executor,
+    std::shared_ptr<ms::IdleHub> const& idle_hub)
+    : Global(display, Version<1>()),
+      wayland_executor{wayland_executor},
+      idle_hub{idle_hub}
+{
+}
+
+void mf::IdleInhibitManagerV1::bind(wl_resource* new_resource)
+{
+    new Instance{new_resource, wayland_executor, idle_hub};
+}
+
+mf::IdleInhibitManagerV1::Instance::Instance(
+    wl_resource* new_resource,
+    std::shared_ptr<Executor> const& wayland_executor,
+    std::shared_ptr<ms::IdleHub> const& idle_hub)
+    : wayland::IdleInhibitManagerV1{new_resource, Version<1>()},
+      wayland_executor{wayland_executor},
+      idle_hub{idle_hub}
+{
+}
+
+void mf::IdleInhibitManagerV1::Instance::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::IdleInhibitManagerV1::Instance::create_inhibitor(wl_resource* id, wl_resource* surface)
+{
+    new IdleInhibitorV1{id, WlSurface::from(surface), wayland_executor, idle_hub};
+}
+
+mf::IdleInhibitorV1::IdleInhibitorV1(
+    wl_resource* new_resource,
+    WlSurface* surface,
+    std::shared_ptr<Executor> const& wayland_executor,
+    std::shared_ptr<ms::IdleHub> const& idle_hub)
+    : wayland::IdleInhibitorV1{new_resource, Version<1>()},
+      surface{mw::make_weak(surface)},
+      wayland_executor{wayland_executor},
+      idle_hub{idle_hub}
+{
+    // The surface may not have a role (and so a scene surface) or any content yet
+    surface->add_commit_listener(this, [this]() { update(); });
+    surface->add_destroy_listener(this, [this]()
+        {
+            stop_observing();
+            inhibition.reset();
+        });
+    update();
+}
+
+mf::IdleInhibitorV1::~IdleInhibitorV1()
+{
+    if (surface)
+    {
+        surface.value().remove_commit_listener(this);
+        surface.value().remove_destroy_listener(this);
+    }
+    stop_observing();
+}
+
+void mf::IdleInhibitorV1::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::IdleInhibitorV1::update()
+{
+    auto const scene_surface = surface ? surface.value().scene_surface() : std::experimental::nullopt;
+
+    if (!scene_surface)
+    {
+        stop_observing();
+        inhibition.reset();
+        return;
+    }
+
+    if (observed_surface.lock() != *scene_surface)
+    {
+        stop_observing();
+        observer = std::make_shared<SurfaceObserver>(wayland_executor, mw::make_weak(this));
+        (*scene_surface)->add_observer(observer);
+        observed_surface = *scene_surface;
+    }
+
+    auto const state = (*scene_surface)->state();
+    bool const shown =
+        (*scene_surface)->visible() &&
+        state != mir_window_state_minimized &&
+        state != mir_window_state_hidden;
+
+    if (!shown)
+    {
+        inhibition.reset();
+    }
+    else if (!inhibition)
+    {
+        inhibition = idle_hub->inhibit_idle();
+    }
+}
+
+void mf::IdleInhibitorV1::stop_observing()
+{
+    if (auto const scene_surface = observed_surface.lock())
+    {
+        scene_surface->remove_observer(observer);
+    }
+    observed_surface.reset();
+    observer.reset();
+}
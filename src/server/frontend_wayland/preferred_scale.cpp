@@ -0,0 +1,40 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "preferred_scale.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mf = mir::frontend;
+namespace geom = mir::geometry;
+
+auto mf::preferred_scale(
+    std::vector<OutputScale> const& outputs,
+    std::experimental::optional<geom::Rectangle> const& area) -> uint32_t
+{
+    float result{0.0f};
+
+    for (auto const& output : outputs)
+    {
+        if (!area || output.extents.overlaps(*area))
+        {
+            result = std::max(result, output.scale);
+        }
+    }
+
+    return static_cast<uint32_t>(std::lround((result > 0.0f ? result : 1.0f) * 120));
+}
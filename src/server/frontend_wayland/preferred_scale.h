@@ -0,0 +1,50 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_PREFERRED_SCALE_H
+#define MIR_FRONTEND_PREFERRED_SCALE_H
+
+#include "mir/geometry/rectangle.h"
+
+#include <cstdint>
+#include <experimental/optional>
+#include <vector>
+
+namespace mir
+{
+namespace frontend
+{
+struct OutputScale
+{
+    geometry::Rectangle extents;
+    float scale;
+};
+
+/**
+ * The scale a surface should be drawn at: the largest scale of the outputs it overlaps
+ *
+ * Until a surface is placed (area is empty) we don't know which outputs it will be on, so this is
+ * the largest scale of any output. With no outputs it is 1.
+ *
+ * \return  The scale as a fraction with a denominator of 120, as fractional-scale-v1 expresses it
+ */
+auto preferred_scale(
+    std::vector<OutputScale> const& outputs,
+    std::experimental::optional<geometry::Rectangle> const& area) -> uint32_t;
+}
+}
+
+#endif // MIR_FRONTEND_PREFERRED_SCALE_H
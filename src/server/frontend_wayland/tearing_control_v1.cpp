@@ -0,0 +1,140 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tearing_control_v1.h"
+
+#include "wl_surface.h"
+#include "tearing-control-v1_wrapper.h"
+
+#include <boost/throw_exception.hpp>
+#include <wayland-server-protocol.h>
+
+namespace mf = mir::frontend;
+namespace mw = mir::wayland;
+
+namespace mir
+{
+namespace frontend
+{
+
+class TearingControlManagerV1 : public wayland::TearingControlManagerV1::Global
+{
+public:
+    TearingControlManagerV1(struct wl_display* display);
+
+private:
+    class Instance : public wayland::TearingControlManagerV1
+    {
+    public:
+        Instance(wl_resource* new_resource);
+
+    private:
+        void destroy() override;
+        void get_tearing_control(wl_resource* id, wl_resource* surface) override;
+    };
+
+    void bind(wl_resource* new_resource) override;
+};
+
+class TearingControlV1 : public wayland::TearingControlV1
+{
+public:
+    TearingControlV1(wl_resource* new_resource, WlSurface* surface);
+    ~TearingControlV1();
+
+private:
+    void set_presentation_hint(uint32_t hint) override;
+    void destroy() override;
+
+    wayland::Weak<WlSurface> const surface;
+};
+
+}
+}
+
+auto mf::create_tearing_control_manager_v1(struct wl_display* display)
+-> std::shared_ptr<TearingControlManagerV1>
+{
+    return std::make_shared<TearingControlManagerV1>(display);
+}
+
+mf::TearingControlManagerV1::TearingControlManagerV1(struct wl_display* display)
+    : Global(display, Version<1>())
+{
+}
+
+void mf::TearingControlManagerV1::bind(wl_resource* new_resource)
+{
+    new Instance{new_resource};
+}
+
+mf::TearingControlManagerV1::Instance::Instance(wl_resource* new_resource)
+    : wayland::TearingControlManagerV1{new_resource, Version<1>()}
+{
+}
+
+void mf::TearingControlManagerV1::Instance::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::TearingControlManagerV1::Instance::get_tearing_control(wl_resource* id, wl_resource* surface)
+{
+    new TearingControlV1{id, WlSurface::from(surface)};
+}
+
+mf::TearingControlV1::TearingControlV1(wl_resource* new_resource, WlSurface* surface)
+    : wayland::TearingControlV1{new_resource, Version<1>()},
+      surface{mw::make_weak(surface)}
+{
+    surface->set_tearing_control(this);
+}
+
+mf::TearingControlV1::~TearingControlV1()
+{
+    // The surface goes back to vsync presentation on its next commit
+    if (surface)
+    {
+        surface.value().set_pending_async_presentation(false);
+    }
+}
+
+void mf::TearingControlV1::set_presentation_hint(uint32_t hint)
+{
+    switch (hint)
+    {
+    case PresentationHint::vsync:
+    case PresentationHint::async:
+        break;
+
+    default:
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            WL_DISPLAY_ERROR_INVALID_METHOD,
+            "Invalid presentation hint %u", hint));
+    }
+
+    // The hint is double-buffered, and ignored if the surface has already been destroyed
+    if (surface)
+    {
+        surface.value().set_pending_async_presentation(hint == PresentationHint::async);
+    }
+}
+
+void mf::TearingControlV1::destroy()
+{
+    destroy_wayland_object();
+}
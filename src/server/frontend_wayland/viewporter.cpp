@@ -0,0 +1,176 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "viewporter.h"
+
+#include "wl_surface.h"
+#include "viewporter_wrapper.h"
+
+#include <boost/throw_exception.hpp>
+
+namespace mf = mir::frontend;
+namespace geom = mir::geometry;
+namespace mw = mir::wayland;
+
+namespace mir
+{
+namespace frontend
+{
+
+class Viewporter : public wayland::Viewporter::Global
+{
+public:
+    Viewporter(struct wl_display* display);
+
+private:
+    class Instance : public wayland::Viewporter
+    {
+    public:
+        Instance(wl_resource* new_resource);
+
+    private:
+        void destroy() override;
+        void get_viewport(wl_resource* id, wl_resource* surface) override;
+    };
+
+    void bind(wl_resource* new_resource) override;
+};
+
+class Viewport : public wayland::Viewport
+{
+public:
+    Viewport(wl_resource* new_resource, WlSurface* surface);
+    ~Viewport();
+
+private:
+    void destroy() override;
+    void set_source(double x, double y, double width, double height) override;
+    void set_destination(int32_t width, int32_t height) override;
+
+    auto require_surface() const -> WlSurface&;
+
+    wayland::Weak<WlSurface> const surface;
+};
+
+}
+}
+
+auto mf::create_viewporter(struct wl_display* display) -> std::shared_ptr<Viewporter>
+{
+    return std::make_shared<Viewporter>(display);
+}
+
+mf::Viewporter::Viewporter(struct wl_display* display)
+    : Global(display, Version<1>())
+{
+}
+
+void mf::Viewporter::bind(wl_resource* new_resource)
+{
+    new Instance{new_resource};
+}
+
+mf::Viewporter::Instance::Instance(wl_resource* new_resource)
+    : wayland::Viewporter{new_resource, Version<1>()}
+{
+}
+
+void mf::Viewporter::Instance::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::Viewporter::Instance::get_viewport(wl_resource* id, wl_resource* surface)
+{
+    new Viewport{id, WlSurface::from(surface)};
+}
+
+mf::Viewport::Viewport(wl_resource* new_resource, WlSurface* surface)
+    : wayland::Viewport{new_resource, Version<1>()},
+      surface{mw::make_weak(surface)}
+{
+    surface->set_viewport(this);
+}
+
+mf::Viewport::~Viewport()
+{
+    // The crop and scale state is removed from the surface on the next commit
+    if (surface)
+    {
+        surface.value().set_pending_viewport_source(std::experimental::nullopt);
+        surface.value().set_pending_viewport_destination(std::experimental::nullopt);
+    }
+}
+
+void mf::Viewport::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::Viewport::set_source(double x, double y, double width, double height)
+{
+    auto& wl_surface = require_surface();
+
+    if (x == -1 && y == -1 && width == -1 && height == -1)
+    {
+        wl_surface.set_pending_viewport_source(std::experimental::nullopt);
+    }
+    else if (x < 0 || y < 0 || width <= 0 || height <= 0)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::bad_value,
+            "Invalid source rectangle %gx%g+%g+%g", width, height, x, y));
+    }
+    else
+    {
+        wl_surface.set_pending_viewport_source(WlSurfaceState::ViewportSource{x, y, width, height});
+    }
+}
+
+void mf::Viewport::set_destination(int32_t width, int32_t height)
+{
+    auto& wl_surface = require_surface();
+
+    if (width == -1 && height == -1)
+    {
+        wl_surface.set_pending_viewport_destination(std::experimental::nullopt);
+    }
+    else if (width <= 0 || height <= 0)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::bad_value,
+            "Invalid destination size %dx%d", width, height));
+    }
+    else
+    {
+        wl_surface.set_pending_viewport_destination(geom::Size{width, height});
+    }
+}
+
+auto mf::Viewport::require_surface() const -> WlSurface&
+{
+    if (!surface)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::no_surface,
+            "The wl_surface associated with this wp_viewport has been destroyed"));
+    }
+
+    return surface.value();
+}
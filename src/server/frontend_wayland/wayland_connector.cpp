@@ -614,6 +614,7 @@ mf::WaylandConnector::WaylandConnector(
     std::shared_ptr<mg::GraphicBufferAllocator> const& allocator,
     std::shared_ptr<mf::SessionAuthorizer> const& session_authorizer,
     std::shared_ptr<SurfaceStack> const& surface_stack,
+    std::shared_ptr<ms::IdleHub> const& idle_hub,
     bool arw_socket,
     std::unique_ptr<WaylandExtensions> extensions_,
     WaylandProtocolExtensionFilter const& extension_filter)
@@ -679,7 +680,8 @@ mf::WaylandConnector::WaylandConnector(
         shell,
         seat_global.get(),
         output_manager.get(),
-        surface_stack});
+        surface_stack,
+        idle_hub});
 
     wl_display_init_shm(display.get());
 
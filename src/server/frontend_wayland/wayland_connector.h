@@ -53,6 +53,7 @@ class Shell;
 namespace scene
 {
 class Surface;
+class IdleHub;
 }
 namespace frontend
 {
@@ -79,6 +80,7 @@ public:
         WlSeat* seat;
         OutputManager* output_manager;
         std::shared_ptr<SurfaceStack> surface_stack;
+        std::shared_ptr<scene::IdleHub> idle_hub;
     };
 
     WaylandExtensions() = default;
@@ -114,6 +116,7 @@ public:
         std::shared_ptr<graphics::GraphicBufferAllocator> const& allocator,
         std::shared_ptr<SessionAuthorizer> const& session_authorizer,
         std::shared_ptr<SurfaceStack> const& surface_stack,
+        std::shared_ptr<scene::IdleHub> const& idle_hub,
         bool arw_socket,
         std::unique_ptr<WaylandExtensions> extensions,
         WaylandProtocolExtensionFilter const& extension_filter);
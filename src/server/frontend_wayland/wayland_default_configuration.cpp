@@ -30,6 +30,14 @@
 #include "xdg-output-unstable-v1_wrapper.h"
 #include "foreign_toplevel_manager_v1.h"
 #include "wlr-foreign-toplevel-management-unstable-v1_wrapper.h"
+#include "viewporter.h"
+#include "viewporter_wrapper.h"
+#include "tearing_control_v1.h"
+#include "tearing-control-v1_wrapper.h"
+#include "fractional_scale_v1.h"
+#include "fractional-scale-v1_wrapper.h"
+#include "idle_inhibit_v1.h"
+#include "idle-inhibit-unstable-v1_wrapper.h"
 
 #include "mir/graphics/platform.h"
 #include "mir/options/default_configuration.h"
@@ -65,6 +73,22 @@ std::vector<ExtensionBuilder> const internal_extension_builders = {
         mw::XdgWmBase::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
             { return std::make_shared<mf::XdgShellStable>(ctx.display, ctx.shell, *ctx.seat, ctx.output_manager); }
     },
+    {
+        mw::Viewporter::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            { return mf::create_viewporter(ctx.display); }
+    },
+    {
+        mw::TearingControlManagerV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            { return mf::create_tearing_control_manager_v1(ctx.display); }
+    },
+    {
+        mw::FractionalScaleManagerV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            { return mf::create_fractional_scale_manager_v1(ctx.display, ctx.wayland_executor, ctx.output_manager); }
+    },
+    {
+        mw::IdleInhibitManagerV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            { return mf::create_idle_inhibit_manager_v1(ctx.display, ctx.wayland_executor, ctx.idle_hub); }
+    },
     {
         mw::LayerShellV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
             { return std::make_shared<mf::LayerShellV1>(ctx.display, ctx.shell, *ctx.seat, ctx.output_manager); }
@@ -169,7 +193,11 @@ auto mf::get_standard_extensions() -> std::vector<std::string>
     return std::vector<std::string>{
         mw::Shell::interface_name,
         mw::XdgWmBase::interface_name,
-        mw::XdgShellV6::interface_name};
+        mw::XdgShellV6::interface_name,
+        mw::Viewporter::interface_name,
+        mw::TearingControlManagerV1::interface_name,
+        mw::FractionalScaleManagerV1::interface_name,
+        mw::IdleInhibitManagerV1::interface_name};
 }
 
 auto mf::get_supported_extensions() -> std::vector<std::string>
@@ -207,6 +235,7 @@ std::shared_ptr<mf::Connector>
                 the_buffer_allocator(),
                 the_session_authorizer(),
                 the_frontend_surface_stack(),
+                the_idle_hub(),
                 arw_socket,
                 configure_wayland_extensions(
                     wayland_extensions,
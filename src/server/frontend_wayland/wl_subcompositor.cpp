@@ -132,6 +132,26 @@ void mf::WlSubsurface::parent_has_committed()
     }
 }
 
+auto mf::WlSubsurface::queued_fences() const -> std::vector<Fd>
+{
+    return surface->queued_fences();
+}
+
+void mf::WlSubsurface::flush_queued_commits()
+{
+    surface->flush_queued_commits();
+}
+
+auto mf::WlSubsurface::pushed_commits() const -> uint64_t
+{
+    return surface->pushed_commits();
+}
+
+void mf::WlSubsurface::flush_queued_commits(uint64_t pushed_before)
+{
+    surface->flush_queued_commits(pushed_before);
+}
+
 auto mf::WlSubsurface::subsurface_at(geom::Point point) -> std::experimental::optional<WlSurface*>
 {
     return surface->subsurface_at(point);
@@ -63,6 +63,10 @@ public:
     auto scene_surface() const -> std::experimental::optional<std::shared_ptr<scene::Surface>> override;
 
     void parent_has_committed();
+    auto queued_fences() const -> std::vector<Fd>;
+    void flush_queued_commits();
+    auto pushed_commits() const -> uint64_t;
+    void flush_queued_commits(uint64_t pushed_before);
 
     auto subsurface_at(geometry::Point point) -> std::experimental::optional<WlSurface*>;
 
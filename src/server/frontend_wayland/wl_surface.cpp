@@ -25,11 +25,14 @@
 #include "deleted_for_resource.h"
 
 #include "wayland_wrapper.h"
+#include "viewporter_wrapper.h"
+#include "tearing-control-v1_wrapper.h"
 
 #include "wayland_frontend.tp.h"
 
 #include "mir/graphics/buffer_properties.h"
 #include "mir/scene/session.h"
+#include "mir/scene/surface.h"
 #include "mir/frontend/wayland.h"
 #include "mir/compositor/buffer_stream.h"
 #include "mir/executor.h"
@@ -38,6 +41,7 @@
 #include "mir/log.h"
 
 #include <algorithm>
+#include <cmath>
 #include <boost/throw_exception.hpp>
 #include <wayland-server-protocol.h>
 
@@ -66,6 +70,15 @@ void mf::WlSurfaceState::update_from(WlSurfaceState const& source)
     if (source.input_shape)
         input_shape = source.input_shape;
 
+    if (source.viewport_source)
+        viewport_source = source.viewport_source;
+
+    if (source.viewport_destination)
+        viewport_destination = source.viewport_destination;
+
+    if (source.async_presentation)
+        async_presentation = source.async_presentation;
+
     frame_callbacks.insert(end(frame_callbacks),
                            begin(source.frame_callbacks),
                            end(source.frame_callbacks));
@@ -78,6 +91,8 @@ bool mf::WlSurfaceState::surface_data_needs_refresh() const
 {
     return offset ||
            input_shape ||
+           viewport_source ||
+           viewport_destination ||
            surface_data_invalidated;
 }
 
@@ -91,7 +106,8 @@ mf::WlSurface::WlSurface(
         allocator{allocator},
         executor{executor},
         null_role{this},
-        role{&null_role}
+        role{&null_role},
+        commit_queue{wl_display_get_event_loop(wl_client_get_display(client)), client}
 {
     // wl_surface is specified to act in mailbox mode
     stream->allow_framedropping(true);
@@ -161,6 +177,48 @@ void mf::WlSurface::set_pending_offset(std::experimental::optional<geom::Displac
     pending.offset = offset;
 }
 
+void mf::WlSurface::set_viewport(mw::Viewport* viewport)
+{
+    if (this->viewport)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            viewport->resource,
+            mw::Viewporter::Error::viewport_exists,
+            "Surface already has a viewport"));
+    }
+
+    this->viewport = mw::make_weak(viewport);
+}
+
+void mf::WlSurface::set_pending_viewport_source(
+    std::experimental::optional<WlSurfaceState::ViewportSource> const& source)
+{
+    pending.viewport_source = source;
+}
+
+void mf::WlSurface::set_pending_viewport_destination(std::experimental::optional<geom::Size> const& size)
+{
+    pending.viewport_destination = size;
+}
+
+void mf::WlSurface::set_tearing_control(mw::TearingControlV1* tearing_control)
+{
+    if (this->tearing_control)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            tearing_control->resource,
+            mw::TearingControlManagerV1::Error::tearing_control_exists,
+            "Surface already has a tearing control object"));
+    }
+
+    this->tearing_control = mw::make_weak(tearing_control);
+}
+
+void mf::WlSurface::set_pending_async_presentation(bool async)
+{
+    pending.async_presentation = async;
+}
+
 void mf::WlSurface::add_subsurface(WlSubsurface* child)
 {
     if (std::find(children.begin(), children.end(), child) != children.end())
@@ -193,7 +251,20 @@ void mf::WlSurface::populate_surface_data(std::vector<shell::StreamSpecification
 {
     geometry::Displacement offset = parent_offset + offset_;
 
-    buffer_streams.push_back(msh::StreamSpecification{stream, offset, {}});
+    msh::StreamSpecification spec{stream, offset, {}};
+    if (buffer_size_ && (viewport_source || viewport_destination))
+    {
+        spec.size = buffer_size_.value();
+    }
+    if (viewport_source)
+    {
+        // src_bounds are in buffer pixels, the viewport source is in (post buffer_scale) surface coordinates
+        auto const& source = viewport_source.value();
+        spec.src_bounds = geom::Rectangle{
+            {std::lround(source.x * scale), std::lround(source.y * scale)},
+            {std::lround(source.width * scale), std::lround(source.height * scale)}};
+    }
+    buffer_streams.push_back(spec);
     geom::Rectangle surface_rect = {geom::Point{} + offset, buffer_size_.value_or(geom::Size{})};
     if (input_shape)
     {
@@ -234,6 +305,16 @@ void mf::WlSurface::remove_destroy_listener(void const* key)
     destroy_listeners.erase(key);
 }
 
+void mf::WlSurface::add_commit_listener(void const* key, std::function<void()> listener)
+{
+    commit_listeners[key] = listener;
+}
+
+void mf::WlSurface::remove_commit_listener(void const* key)
+{
+    commit_listeners.erase(key);
+}
+
 mf::WlSurface* mf::WlSurface::from(wl_resource* resource)
 {
     void* raw_surface = wl_resource_get_user_data(resource);
@@ -254,6 +335,56 @@ void mf::WlSurface::send_frame_callbacks()
     frame_callbacks.clear();
 }
 
+void mf::WlSurface::update_buffer_size(geom::Size const& content_size, WlSurfaceState const& state)
+{
+    auto const new_buffer_size = size_after_viewport(content_size);
+
+    if (!input_shape && std::experimental::make_optional(new_buffer_size) != buffer_size_)
+    {
+        state.invalidate_surface_data(); // input shape needs to be recalculated for the new size
+    }
+
+    buffer_size_ = new_buffer_size;
+}
+
+auto mf::WlSurface::size_after_viewport(geom::Size const& content_size) const -> geom::Size
+{
+    if (viewport_source && viewport)
+    {
+        auto const& source = viewport_source.value();
+        if (source.x + source.width > content_size.width.as_int() ||
+            source.y + source.height > content_size.height.as_int())
+        {
+            BOOST_THROW_EXCEPTION(mw::ProtocolError(
+                viewport.value().resource,
+                mw::Viewport::Error::out_of_buffer,
+                "Source rectangle %gx%g+%g+%g extends outside of the %dx%d buffer",
+                source.width, source.height, source.x, source.y,
+                content_size.width.as_int(), content_size.height.as_int()));
+        }
+    }
+
+    if (viewport_destination)
+    {
+        return viewport_destination.value();
+    }
+    else if (viewport_source)
+    {
+        auto const& source = viewport_source.value();
+        if (viewport && (source.width != std::trunc(source.width) || source.height != std::trunc(source.height)))
+        {
+            BOOST_THROW_EXCEPTION(mw::ProtocolError(
+                viewport.value().resource,
+                mw::Viewport::Error::bad_size,
+                "Source size %gx%g is not integer and no destination size is set",
+                source.width, source.height));
+        }
+        return geom::Size{source.width, source.height};
+    }
+
+    return content_size;
+}
+
 void mf::WlSurface::destroy()
 {
     destroy_wayland_object();
@@ -357,7 +488,23 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
         input_shape = state.input_shape.value();
 
     if (state.scale)
-        stream->set_scale(state.scale.value());
+    {
+        scale = state.scale.value();
+        stream->set_scale(scale);
+    }
+
+    if (state.viewport_source)
+        viewport_source = state.viewport_source.value();
+
+    if (state.viewport_destination)
+        viewport_destination = state.viewport_destination.value();
+
+    if (state.async_presentation && state.async_presentation.value() != async_presentation)
+    {
+        // The stream outlives any scene surface, so the hint is held there rather than as a window attribute
+        async_presentation = state.async_presentation.value();
+        stream->set_tearing_allowed(async_presentation);
+    }
 
     if (state.buffer)
     {
@@ -433,42 +580,140 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
             }
 
             stream->submit_buffer(mir_buffer);
-            auto const new_buffer_size = stream->stream_size();
-
-            if (!input_shape && std::experimental::make_optional(new_buffer_size) != buffer_size_)
-            {
-                state.invalidate_surface_data(); // input shape needs to be recalculated for the new size
-            }
-
-            buffer_size_ = new_buffer_size;
+            update_buffer_size(stream->stream_size(), state);
         }
     }
     else
     {
         send_frame_callbacks();
+
+        if (buffer_size_ && (state.viewport_source || state.viewport_destination))
+        {
+            update_buffer_size(stream->stream_size(), state);
+        }
     }
 
     for (WlSubsurface* child: children)
     {
         child->parent_has_committed();
     }
+
+    // copied so that listeners can safely add or remove commit listeners
+    auto const listeners = commit_listeners;
+    for (auto const& listener: listeners)
+    {
+        listener.second();
+    }
 }
 
 void mf::WlSurface::commit()
 {
-    if (pending.offset && *pending.offset == offset_)
-        pending.offset = std::experimental::nullopt;
+    // order is important
+    auto state = std::move(pending);
+    pending = WlSurfaceState();
+
+    std::vector<Fd> fences;
+    auto const buffer = state.buffer ? *state.buffer : nullptr;
+    if (buffer && !wl_shm_buffer_get(buffer))
+    {
+        fences = allocator->fences_for_resource(buffer);
+    }
+
+    // A synchronized subsurface's state is applied as part of its parent's commit, so the parent must also
+    // wait for any commits its synchronized subsurfaces are holding back (but not for those they make later)
+    ChildCommits child_commits;
+    for (WlSubsurface* child: children)
+    {
+        if (child->synchronized())
+        {
+            auto const child_fences = child->queued_fences();
+            fences.insert(end(fences), begin(child_fences), end(child_fences));
+            child_commits.emplace_back(child, child->pushed_commits());
+        }
+    }
+
+    if (buffer)
+    {
+        // If the buffer is destroyed while the commit waits for it, keep showing the current one
+        commit_queue.push(
+            std::move(fences),
+            buffer,
+            [this, state = std::move(state), child_commits = std::move(child_commits)](
+                std::experimental::optional<wl_resource*> attached) mutable
+            {
+                state.buffer = attached;
+                apply_commit(state, child_commits);
+            });
+    }
+    else
+    {
+        commit_queue.push(
+            std::move(fences),
+            [this, state = std::move(state), child_commits = std::move(child_commits)]() mutable
+            {
+                apply_commit(state, child_commits);
+            });
+    }
+}
+
+void mf::WlSurface::apply_commit(WlSurfaceState& state, ChildCommits const& child_commits)
+{
+    // Bring the synchronized subsurfaces' cached state up to this commit, so the whole tree is applied together.
+    // (Subsurfaces that have gone since aren't looked up, so a pointer to one is never followed.)
+    for (WlSubsurface* child: children)
+    {
+        for (auto const& child_commit : child_commits)
+        {
+            if (child_commit.first == child && child->synchronized())
+            {
+                child->flush_queued_commits(child_commit.second);
+            }
+        }
+    }
+
+    if (state.offset && *state.offset == offset_)
+        state.offset = std::experimental::nullopt;
 
     // The same input shape could be represented by the same rectangles in a different order, or even
     // different rectangles. We don't check for that, however, because it would only cause an unnecessary
     // update and not do any real harm. Checking for identical vectors should cover most cases.
-    if (pending.input_shape && *pending.input_shape == input_shape)
-        pending.input_shape = std::experimental::nullopt;
+    if (state.input_shape && *state.input_shape == input_shape)
+        state.input_shape = std::experimental::nullopt;
 
-    // order is important
-    auto const state = std::move(pending);
-    pending = WlSurfaceState();
     role->commit(state);
+
+    // Later subsurface commits can now be cached for our next commit
+    for (WlSubsurface* child: children)
+    {
+        if (child->synchronized())
+        {
+            child->flush_queued_commits();
+        }
+    }
+}
+
+auto mf::WlSurface::queued_fences() const -> std::vector<Fd>
+{
+    auto fences = commit_queue.fences();
+    for (WlSubsurface* child: children)
+    {
+        if (child->synchronized())
+        {
+            auto const child_fences = child->queued_fences();
+            fences.insert(end(fences), begin(child_fences), end(child_fences));
+        }
+    }
+    return fences;
+}
+
+void mf::WlSurface::flush_queued_commits()
+{
+    commit_queue.flush();
+}
+
+void mf::WlSurface::flush_queued_commits(uint64_t pushed_before)
+{
+    commit_queue.flush_pushed_before(pushed_before);
 }
 
 void mf::WlSurface::set_buffer_transform(int32_t transform)
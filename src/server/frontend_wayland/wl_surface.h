@@ -22,6 +22,7 @@
 #include "wayland_wrapper.h"
 
 #include "wl_surface_role.h"
+#include "commit_queue.h"
 
 #include "mir/geometry/displacement.h"
 #include "mir/geometry/size.h"
@@ -54,6 +55,11 @@ namespace compositor
 {
 class BufferStream;
 }
+namespace wayland
+{
+class Viewport;
+class TearingControlV1;
+}
 namespace frontend
 {
 class WlSurface;
@@ -68,6 +74,12 @@ struct WlSurfaceState
         std::shared_ptr<bool> destroyed;
     };
 
+    /// wp_viewport source rectangle, in surface coordinates before cropping and scaling
+    struct ViewportSource
+    {
+        double x, y, width, height;
+    };
+
     // if you add variables, don't forget to update this
     void update_from(WlSurfaceState const& source);
 
@@ -83,6 +95,11 @@ struct WlSurfaceState
     std::experimental::optional<int> scale;
     std::experimental::optional<geometry::Displacement> offset;
     std::experimental::optional<std::experimental::optional<std::vector<geometry::Rectangle>>> input_shape;
+    // the outer optional is set if the wp_viewport state changed, the inner optional is empty if it was unset
+    std::experimental::optional<std::experimental::optional<ViewportSource>> viewport_source;
+    std::experimental::optional<std::experimental::optional<geometry::Size>> viewport_destination;
+    // wp_tearing_control_v1 presentation hint, true if the client prefers async (tearing) presentation
+    std::experimental::optional<bool> async_presentation;
     std::vector<std::shared_ptr<Callback>> frame_callbacks;
 
 private:
@@ -126,6 +143,21 @@ public:
     void set_role(WlSurfaceRole* role_);
     void clear_role();
     void set_pending_offset(std::experimental::optional<geometry::Displacement> const& offset);
+    /// Associates a wp_viewport with this surface, raises viewport_exists if it already has one
+    void set_viewport(wayland::Viewport* viewport);
+    void set_pending_viewport_source(std::experimental::optional<WlSurfaceState::ViewportSource> const& source);
+    void set_pending_viewport_destination(std::experimental::optional<geometry::Size> const& size);
+    /// Associates a wp_tearing_control_v1 with this surface, raises tearing_control_exists if it already has one
+    void set_tearing_control(wayland::TearingControlV1* tearing_control);
+    void set_pending_async_presentation(bool async);
+    /// The fences that commits queued on this surface and its synchronized subsurfaces are waiting on
+    auto queued_fences() const -> std::vector<Fd>;
+    /// Applies queued commits that are no longer waiting on fences
+    void flush_queued_commits();
+    /// Counts the commits made so far, for flush_queued_commits(pushed_before)
+    auto pushed_commits() const -> uint64_t { return commit_queue.pushed(); }
+    /// Applies queued commits, made before pushed_commits() returned \p pushed_before, that are no longer waiting
+    void flush_queued_commits(uint64_t pushed_before);
     void add_subsurface(WlSubsurface* child);
     void remove_subsurface(WlSubsurface* child);
     void refresh_surface_data_now();
@@ -136,6 +168,9 @@ public:
     void commit(WlSurfaceState const& state);
     void add_destroy_listener(void const* key, std::function<void()> listener);
     void remove_destroy_listener(void const* key);
+    /// Listeners are called on the Wayland thread after each commit has been applied
+    void add_commit_listener(void const* key, std::function<void()> listener);
+    void remove_commit_listener(void const* key);
 
     std::shared_ptr<scene::Session> const session;
     std::shared_ptr<compositor::BufferStream> const stream;
@@ -151,13 +186,26 @@ private:
     std::vector<WlSubsurface*> children; // ordering is from bottom to top
 
     WlSurfaceState pending;
+    CommitQueue commit_queue;
     geometry::Displacement offset_;
     std::experimental::optional<geometry::Size> buffer_size_;
+    int scale{1};
+    wayland::Weak<wayland::Viewport> viewport;
+    std::experimental::optional<WlSurfaceState::ViewportSource> viewport_source;
+    std::experimental::optional<geometry::Size> viewport_destination;
+    wayland::Weak<wayland::TearingControlV1> tearing_control;
+    bool async_presentation{false};
     std::vector<std::shared_ptr<WlSurfaceState::Callback>> frame_callbacks;
     std::experimental::optional<std::vector<mir::geometry::Rectangle>> input_shape;
     std::map<void const*, std::function<void()>> destroy_listeners;
+    std::map<void const*, std::function<void()>> commit_listeners;
 
     void send_frame_callbacks();
+    /// The synchronized subsurfaces a commit was made over, and how many commits each had made at the time
+    using ChildCommits = std::vector<std::pair<WlSubsurface*, uint64_t>>;
+    void apply_commit(WlSurfaceState& state, ChildCommits const& child_commits);
+    void update_buffer_size(geometry::Size const& content_size, WlSurfaceState const& state);
+    auto size_after_viewport(geometry::Size const& content_size) const -> geometry::Size;
 
     void destroy() override;
     void attach(std::experimental::optional<wl_resource*> const& buffer, int32_t x, int32_t y) override;
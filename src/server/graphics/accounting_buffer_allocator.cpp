@@ -0,0 +1,201 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "accounting_buffer_allocator.h"
+#include "mir/graphics/memory_accounting.h"
+
+#include <wayland-server-core.h>
+
+#include <type_traits>
+
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+namespace
+{
+/**
+ * The account of a client connection, held until the client is destroyed
+ *
+ * This is per connection rather than per process, as clients the server connects over a socketpair
+ * (such as Xwayland) share the server's pid.
+ */
+class ClientAccount
+{
+public:
+    static auto of(mg::MemoryAccounting& accounting, wl_client* client) -> mg::MemoryClient
+    {
+        if (auto const listener = wl_client_get_destroy_listener(client, &on_destroyed))
+        {
+            ClientAccount* self;
+            self = wl_container_of(listener, self, destruction_listener);
+            return self->client;
+        }
+
+        pid_t pid;
+        wl_client_get_credentials(client, &pid, nullptr, nullptr);
+        return (new ClientAccount{accounting, client, pid})->client;
+    }
+
+private:
+    ClientAccount(mg::MemoryAccounting& accounting, wl_client* client, pid_t pid)
+        : accounting{accounting.shared_from_this()},
+          client{accounting.new_client(pid)}
+    {
+        destruction_listener.notify = &on_destroyed;
+        wl_client_add_destroy_listener(client, &destruction_listener);
+    }
+
+    static void on_destroyed(wl_listener* listener, void*)
+    {
+        ClientAccount* self;
+        self = wl_container_of(listener, self, destruction_listener);
+        if (auto const live = self->accounting.lock())
+            live->remove_client(self->client);
+        delete self;
+    }
+
+    std::weak_ptr<mg::MemoryAccounting> const accounting;
+    mg::MemoryClient const client;
+    wl_listener destruction_listener;
+};
+static_assert(
+    std::is_standard_layout<ClientAccount>::value,
+    "ClientAccount must be Standard Layout for wl_container_of to be defined behaviour");
+
+/**
+ * The charge for a client buffer, held until its wl_resource is destroyed
+ *
+ * Each commit of a wl_buffer imports a new mg::Buffer, and these share the one charge.
+ */
+class ResourceCharge
+{
+public:
+    /// The charge already made for resource, if any
+    static auto find(wl_resource* resource) -> std::shared_ptr<void>
+    {
+        if (auto const listener = wl_resource_get_destroy_listener(resource, &on_destroyed))
+        {
+            ResourceCharge* self;
+            self = wl_container_of(listener, self, destruction_listener);
+            return self->charge;
+        }
+        return {};
+    }
+
+    static void hold(wl_resource* resource, std::shared_ptr<void> const& charge)
+    {
+        new ResourceCharge{resource, charge};
+    }
+
+private:
+    ResourceCharge(wl_resource* resource, std::shared_ptr<void> const& charge)
+        : charge{charge}
+    {
+        destruction_listener.notify = &on_destroyed;
+        wl_resource_add_destroy_listener(resource, &destruction_listener);
+    }
+
+    static void on_destroyed(wl_listener* listener, void*)
+    {
+        ResourceCharge* self;
+        self = wl_container_of(listener, self, destruction_listener);
+        delete self;
+    }
+
+    std::shared_ptr<void> const charge;
+    wl_listener destruction_listener;
+};
+static_assert(
+    std::is_standard_layout<ResourceCharge>::value,
+    "ResourceCharge must be Standard Layout for wl_container_of to be defined behaviour");
+
+/// Charge buffer, imported from resource, unless resource has been charged already
+auto charge_resource(
+    mg::MemoryAccounting& accounting,
+    wl_resource* resource,
+    std::shared_ptr<mg::Buffer> const& buffer,
+    mg::MemoryKind kind) -> std::shared_ptr<mg::Buffer>
+{
+    auto charge = ResourceCharge::find(resource);
+    if (!charge)
+    {
+        auto const client = ClientAccount::of(accounting, wl_resource_get_client(resource));
+        charge = accounting.charge_for(*buffer, client, kind);
+        ResourceCharge::hold(resource, charge);
+    }
+    return mg::with_charge(buffer, charge);
+}
+}
+
+mg::AccountingBufferAllocator::AccountingBufferAllocator(
+    std::shared_ptr<GraphicBufferAllocator> const& wrapped,
+    std::shared_ptr<MemoryAccounting> const& accounting)
+    : wrapped{wrapped},
+      accounting{accounting}
+{
+}
+
+auto mg::AccountingBufferAllocator::supported_pixel_formats() -> std::vector<MirPixelFormat>
+{
+    return wrapped->supported_pixel_formats();
+}
+
+auto mg::AccountingBufferAllocator::alloc_software_buffer(
+    geom::Size size,
+    MirPixelFormat format) -> std::shared_ptr<Buffer>
+{
+    return accounting->charge(wrapped->alloc_software_buffer(size, format), accounting->server(), MemoryKind::internal);
+}
+
+void mg::AccountingBufferAllocator::bind_display(wl_display* display, std::shared_ptr<Executor> wayland_executor)
+{
+    wrapped->bind_display(display, std::move(wayland_executor));
+}
+
+void mg::AccountingBufferAllocator::unbind_display(wl_display* display)
+{
+    wrapped->unbind_display(display);
+}
+
+auto mg::AccountingBufferAllocator::buffer_from_resource(
+    wl_resource* buffer,
+    std::function<void()>&& on_consumed,
+    std::function<void()>&& on_release) -> std::shared_ptr<Buffer>
+{
+    return charge_resource(
+        *accounting,
+        buffer,
+        wrapped->buffer_from_resource(buffer, std::move(on_consumed), std::move(on_release)),
+        MemoryKind::hardware);
+}
+
+auto mg::AccountingBufferAllocator::buffer_from_shm(
+    wl_resource* buffer,
+    std::shared_ptr<Executor> wayland_executor,
+    std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer>
+{
+    return charge_resource(
+        *accounting,
+        buffer,
+        wrapped->buffer_from_shm(buffer, std::move(wayland_executor), std::move(on_consumed)),
+        MemoryKind::shm);
+}
+
+auto mg::AccountingBufferAllocator::fences_for_resource(wl_resource* buffer) -> std::vector<Fd>
+{
+    return wrapped->fences_for_resource(buffer);
+}
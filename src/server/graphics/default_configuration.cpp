@@ -27,10 +27,12 @@
 #include "offscreen/display.h"
 #include "software_cursor.h"
 #include "platform_probe.h"
+#include "accounting_buffer_allocator.h"
 
 #include "mir/graphics/gl_config.h"
 #include "mir/graphics/platform.h"
 #include "mir/graphics/cursor.h"
+#include "mir/graphics/memory_accounting.h"
 #include "display_configuration_observer_multiplexer.h"
 
 #include "mir/shared_library.h"
@@ -45,6 +47,7 @@
 
 #include <boost/throw_exception.hpp>
 
+#include <algorithm>
 #include <map>
 #include <sstream>
 
@@ -143,7 +146,19 @@ mir::DefaultServerConfiguration::the_buffer_allocator()
     return buffer_allocator(
         [&]()
         {
-            return the_graphics_platform()->create_buffer_allocator(*the_display());
+            return std::make_shared<mg::AccountingBufferAllocator>(
+                the_graphics_platform()->create_buffer_allocator(*the_display()),
+                the_memory_accounting());
+        });
+}
+
+auto mir::DefaultServerConfiguration::the_memory_accounting() -> std::shared_ptr<mg::MemoryAccounting>
+{
+    return memory_accounting(
+        [this]()
+        {
+            auto const quota_mib = the_options()->get<int>(options::client_buffer_quota_opt);
+            return std::make_shared<mg::MemoryAccounting>(size_t(std::max(quota_mib, 0)) << 20);
         });
 }
 
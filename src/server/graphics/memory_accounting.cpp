@@ -0,0 +1,194 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mir/graphics/memory_accounting.h"
+#include "mir/graphics/buffer.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <unistd.h>
+
+namespace mg = mir::graphics;
+
+namespace
+{
+auto bytes_in(mg::Buffer const& buffer) -> size_t
+{
+    auto const size = buffer.size();
+    // Formats we don't know (e.g. multi-planar dmabufs) are assumed to be 32bpp
+    auto const bpp = MIR_BYTES_PER_PIXEL(buffer.pixel_format());
+    return size_t(size.width.as_uint32_t()) * size.height.as_uint32_t() * (bpp ? bpp : 4);
+}
+}
+
+struct mg::MemoryAccounting::Charge
+{
+    Charge(
+        std::weak_ptr<MemoryAccounting> const& accounting,
+        uint64_t client_id,
+        MemoryKind kind,
+        size_t bytes)
+        : accounting{accounting},
+          client_id{client_id},
+          kind{kind},
+          bytes{bytes}
+    {
+    }
+
+    ~Charge()
+    {
+        if (auto const live = accounting.lock())
+            live->credit(client_id, kind, bytes);
+    }
+
+    std::weak_ptr<MemoryAccounting> const accounting;
+    uint64_t const client_id;
+    MemoryKind const kind;
+    size_t const bytes;
+};
+
+mg::MemoryAccounting::MemoryAccounting(size_t client_quota_bytes)
+    : client_quota_bytes{client_quota_bytes},
+      server_pid{getpid()}
+{
+}
+
+auto mg::MemoryAccounting::server() const -> MemoryClient
+{
+    return {0, server_pid};
+}
+
+auto mg::MemoryAccounting::new_client(pid_t pid) -> MemoryClient
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    return {next_client_id++, pid};
+}
+
+void mg::MemoryAccounting::remove_client(MemoryClient const& client)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    quotas.erase(client.id);
+}
+
+auto mg::MemoryAccounting::charge(
+    std::shared_ptr<Buffer> const& buffer,
+    MemoryClient const& client,
+    MemoryKind kind) -> std::shared_ptr<Buffer>
+{
+    return with_charge(buffer, charge_for(*buffer, client, kind));
+}
+
+auto mg::MemoryAccounting::charge_for(
+    Buffer const& buffer,
+    MemoryClient const& client,
+    MemoryKind kind) -> std::shared_ptr<void>
+{
+    auto const bytes = bytes_in(buffer);
+
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+
+        auto const quota = quotas.find(client.id);
+        auto const limit =
+            client.id == server().id ? 0 :
+            quota != quotas.end() ? quota->second :
+            client_quota_bytes;
+
+        auto const account = accounts.emplace(client.id, ClientMemoryAccount{client.pid, {}}).first;
+        auto const held = total_bytes(account->second.usage);
+        if (limit && held + bytes > limit)
+        {
+            if (held == 0)
+                accounts.erase(account);
+
+            BOOST_THROW_EXCEPTION(MemoryQuotaExceeded{
+                "Client " + std::to_string(client.id) + " (pid " + std::to_string(client.pid) + ") holds " +
+                std::to_string(held) + " bytes of buffers and may not add " + std::to_string(bytes) +
+                " more (quota " + std::to_string(limit) + ")"});
+        }
+
+        auto& usage = account->second.usage[kind];
+        usage.buffers++;
+        usage.bytes += bytes;
+    }
+
+    return std::make_shared<Charge>(shared_from_this(), client.id, kind, bytes);
+}
+
+void mg::MemoryAccounting::set_quota(MemoryClient const& client, size_t bytes)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    quotas[client.id] = bytes;
+}
+
+auto mg::MemoryAccounting::usage() const -> std::map<uint64_t, ClientMemoryAccount>
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    return accounts;
+}
+
+void mg::MemoryAccounting::credit(uint64_t client_id, MemoryKind kind, size_t bytes)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto const account = accounts.find(client_id);
+    if (account == accounts.end())
+        return;
+
+    auto& kinds = account->second.usage;
+    auto& usage = kinds[kind];
+    usage.buffers--;
+    usage.bytes -= bytes;
+
+    if (usage.buffers == 0)
+        kinds.erase(kind);
+    if (kinds.empty())
+        accounts.erase(account);
+}
+
+auto mg::with_charge(
+    std::shared_ptr<Buffer> const& buffer,
+    std::shared_ptr<void> const& charge) -> std::shared_ptr<Buffer>
+{
+    struct Charged
+    {
+        std::shared_ptr<Buffer> const buffer;
+        std::shared_ptr<void> const charge;
+    };
+
+    auto const charged = std::make_shared<Charged>(Charged{buffer, charge});
+    return {charged, charged->buffer.get()};
+}
+
+auto mg::total_bytes(ClientMemoryUsage const& usage) -> size_t
+{
+    size_t total = 0;
+    for (auto const& kind : usage)
+        total += kind.second.bytes;
+    return total;
+}
+
+auto mg::to_string(MemoryKind kind) -> char const*
+{
+    switch (kind)
+    {
+    case MemoryKind::shm:       return "shm";
+    case MemoryKind::hardware:  return "hardware";
+    case MemoryKind::internal:  return "internal";
+    }
+    return "unknown";
+}
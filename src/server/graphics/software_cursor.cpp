@@ -72,6 +72,11 @@ public:
         return 1;
     }
 
+    bool tearing_allowed() const override
+    {
+        return false;
+    }
+
     mg::Renderable::ID id() const override
     {
         return this;
@@ -93,6 +98,11 @@ public:
         return std::experimental::optional<geometry::Rectangle>();
     }
 
+    std::experimental::optional<geometry::Rectangle> src_bounds() const override
+    {
+        return std::experimental::optional<geometry::Rectangle>();
+    }
+
     float alpha() const override
     {
         return 1.0;
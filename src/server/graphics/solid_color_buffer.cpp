@@ -0,0 +1,101 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mir/graphics/solid_color_buffer.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <stdexcept>
+
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+namespace
+{
+class PixelMapping : public mrs::Mapping<unsigned char const>
+{
+public:
+    explicit PixelMapping(uint32_t argb)
+        : argb{argb}
+    {
+    }
+
+    auto format() const -> MirPixelFormat override
+    {
+        return mir_pixel_format_argb_8888;
+    }
+
+    auto stride() const -> geom::Stride override
+    {
+        return geom::Stride{sizeof argb};
+    }
+
+    auto size() const -> geom::Size override
+    {
+        return {1, 1};
+    }
+
+    auto data() -> unsigned char const* override
+    {
+        return reinterpret_cast<unsigned char const*>(&argb);
+    }
+
+    auto len() const -> size_t override
+    {
+        return sizeof argb;
+    }
+
+private:
+    uint32_t const argb;
+};
+}
+
+mg::SolidColorBuffer::SolidColorBuffer(uint32_t argb)
+    : argb{argb}
+{
+}
+
+auto mg::SolidColorBuffer::color() const -> uint32_t
+{
+    return argb;
+}
+
+auto mg::SolidColorBuffer::native_buffer_handle() const -> std::shared_ptr<NativeBuffer>
+{
+    BOOST_THROW_EXCEPTION((std::runtime_error{"SolidColorBuffer does not support mirclient APIs"}));
+}
+
+auto mg::SolidColorBuffer::size() const -> geom::Size
+{
+    return {1, 1};
+}
+
+auto mg::SolidColorBuffer::pixel_format() const -> MirPixelFormat
+{
+    return mir_pixel_format_argb_8888;
+}
+
+auto mg::SolidColorBuffer::native_buffer_base() -> NativeBufferBase*
+{
+    return this;
+}
+
+auto mg::SolidColorBuffer::map_readable() -> std::unique_ptr<mrs::Mapping<unsigned char const>>
+{
+    return std::make_unique<PixelMapping>(argb);
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "idle_poking_dispatcher.h"
+#include "mir/scene/idle_hub.h"
+
+namespace mi = mir::input;
+
+mi::IdlePokingDispatcher::IdlePokingDispatcher(
+    std::shared_ptr<InputDispatcher> const& next_dispatcher,
+    std::shared_ptr<scene::IdleHub> const& idle_hub)
+    : next_dispatcher{next_dispatcher},
+      idle_hub{idle_hub}
+{
+}
+
+bool mi::IdlePokingDispatcher::dispatch(std::shared_ptr<MirEvent const> const& event)
+{
+    idle_hub->poke();
+    return next_dispatcher->dispatch(event);
+}
+
+void mi::IdlePokingDispatcher::start()
+{
+    next_dispatcher->start();
+}
+
+void mi::IdlePokingDispatcher::stop()
+{
+    next_dispatcher->stop();
+}
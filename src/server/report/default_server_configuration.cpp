@@ -23,8 +23,16 @@
 #include "lttng_report_factory.h"
 #include "logging_report_factory.h"
 #include "null_report_factory.h"
+#include "metrics_report_factory.h"
+#include "metrics/endpoint.h"
+#include "metrics/registry.h"
 
 #include "mir/abnormal_exit.h"
+#include "mir/graphics/memory_accounting.h"
+#include "mir/gl/texture_cache.h"
+#include "gl/renderer_factory.h"
+
+#include <cstdlib>
 
 namespace mg = mir::graphics;
 namespace mf = mir::frontend;
@@ -32,6 +40,43 @@ namespace mc = mir::compositor;
 namespace mi = mir::input;
 namespace ms = mir::scene;
 
+namespace
+{
+void write_memory_usage(std::ostream& out, std::map<uint64_t, mg::ClientMemoryAccount> const& usage)
+{
+    auto const write_family =
+        [&](char const* name, char const* help, size_t mg::MemoryUsage::* value)
+        {
+            out << "# HELP " << name << ' ' << help << '\n';
+            out << "# TYPE " << name << " gauge\n";
+            for (auto const& client : usage)
+            {
+                for (auto const& kind : client.second.usage)
+                {
+                    out << name << "{client=\"" << client.first << "\",pid=\"" << client.second.pid
+                        << "\",kind=\"" << mg::to_string(kind.first) << "\"} " << kind.second.*value << '\n';
+                }
+            }
+        };
+
+    write_family("mir_client_buffers", "Buffers held on behalf of a client", &mg::MemoryUsage::buffers);
+    write_family("mir_client_buffer_bytes", "Bytes of buffers held on behalf of a client", &mg::MemoryUsage::bytes);
+}
+
+void write_texture_cache_counters(std::ostream& out, mir::gl::TextureCacheCounters const& counters)
+{
+    out << "# HELP mir_texture_cache_hits_total Client buffers drawn from a texture the GL renderer already had\n";
+    out << "# TYPE mir_texture_cache_hits_total counter\n";
+    out << "mir_texture_cache_hits_total " << counters.hits.load() << '\n';
+    out << "# HELP mir_texture_cache_misses_total Client buffers the GL renderer had to bind or upload\n";
+    out << "# TYPE mir_texture_cache_misses_total counter\n";
+    out << "mir_texture_cache_misses_total " << counters.misses.load() << '\n';
+    out << "# HELP mir_texture_cache_bytes Approximate size of the GL renderers' cached textures\n";
+    out << "# TYPE mir_texture_cache_bytes gauge\n";
+    out << "mir_texture_cache_bytes " << counters.cached_bytes.load() << '\n';
+}
+}
+
 std::unique_ptr<mir::report::ReportFactory> mir::DefaultServerConfiguration::report_factory(char const* report_opt)
 {
     auto opt = the_options()->get<std::string>(report_opt);
@@ -44,6 +89,10 @@ std::unique_ptr<mir::report::ReportFactory> mir::DefaultServerConfiguration::rep
     {
         return std::make_unique<report::LttngReportFactory>();
     }
+    else if (opt == options::metrics_opt_value)
+    {
+        return std::make_unique<report::MetricsReportFactory>(the_metrics_registry());
+    }
     else if (opt == options::off_opt_value)
     {
         return std::make_unique<report::NullReportFactory>();
@@ -52,10 +101,48 @@ std::unique_ptr<mir::report::ReportFactory> mir::DefaultServerConfiguration::rep
     {
         throw AbnormalExit(std::string("Invalid ") + report_opt + " option: " + opt + " (valid options are: \"" +
             options::off_opt_value + "\" and \"" + options::log_opt_value +
-                           "\" and \"" + options::lttng_opt_value + "\")");
+                           "\" and \"" + options::lttng_opt_value +
+                           "\" and \"" + options::metrics_opt_value + "\")");
     }
 }
 
+auto mir::DefaultServerConfiguration::the_metrics_registry() -> std::shared_ptr<report::metrics::Registry>
+{
+    return metrics_registry(
+        [this]()->std::shared_ptr<report::metrics::Registry>
+        {
+            std::string socket_path;
+            if (the_options()->is_set(options::metrics_socket_opt))
+            {
+                socket_path = the_options()->get<std::string>(options::metrics_socket_opt);
+            }
+            else
+            {
+                auto const runtime_dir = getenv("XDG_RUNTIME_DIR");
+                socket_path = std::string{runtime_dir ? runtime_dir : "/tmp"} + "/mir_metrics";
+            }
+
+            auto const registry = std::make_shared<report::metrics::Registry>();
+            registry->add_collector(
+                [accounting = the_memory_accounting()](std::ostream& out)
+                {
+                    write_memory_usage(out, accounting->usage());
+                });
+            if (auto const gl = std::dynamic_pointer_cast<renderer::gl::RendererFactory>(the_renderer_factory()))
+            {
+                registry->add_collector(
+                    [counters = gl->texture_cache_counters()](std::ostream& out)
+                    {
+                        write_texture_cache_counters(out, *counters);
+                    });
+            }
+            auto endpoint = std::make_shared<report::metrics::Endpoint>(socket_path, registry);
+
+            // Serve the metrics for as long as any report is updating them
+            return {registry.get(), [endpoint](report::metrics::Registry*) mutable { endpoint.reset(); }};
+        });
+}
+
 std::shared_ptr<void> mir::DefaultServerConfiguration::default_reports()
 {
     return std::make_unique<report::Reports>(*this, *the_options());
@@ -19,6 +19,8 @@
 #include "compositor_report.h"
 #include "mir/logging/logger.h"
 
+#include <string>
+
 using namespace mir::time;
 namespace ml = mir::logging;
 namespace mrl = mir::report::logging;
@@ -27,6 +29,10 @@ namespace
 {
     const char * const component = "compositor";
     const auto min_report_interval = std::chrono::seconds(1);
+
+    // Indexed by CompositorReport::FrameStage
+    const char * const stage_names[] =
+        {"snapshot", "occlusion", "upload", "draw", "gpu", "swap", "post"};
 }
 
 mrl::CompositorReport::CompositorReport(
@@ -74,6 +80,15 @@ void mrl::CompositorReport::rendered_frame(SubCompositorId id)
     inst.bypassed = false;
 }
 
+void mrl::CompositorReport::frame_stage_timing(
+    SubCompositorId id, FrameStage stage, std::chrono::nanoseconds duration)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& timing = instance[id].stages[static_cast<size_t>(stage)];
+    timing.sum += duration;
+    timing.nsamples++;
+}
+
 void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id)
 {
     // The first report is a valid sample, but don't log anything because
@@ -123,8 +138,35 @@ void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id
                  );
 
         logger.log(ml::Severity::informational, msg, component);
+
+        // Only renderers and compositors that measure their stages report them
+        std::string stage_msg;
+        for (size_t s = 0; s != stages.size(); ++s)
+        {
+            auto const ds = stages[s].nsamples - last_reported_stages[s].nsamples;
+            if (!ds)
+                continue;
+
+            long long const avg_usec =
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    stages[s].sum - last_reported_stages[s].sum
+                ).count() / ds;
+
+            char stage[64];
+            snprintf(stage, sizeof stage, "%s%s %lld.%03lld ms",
+                     stage_msg.empty() ? "" : ", ",
+                     stage_names[s], avg_usec / 1000, avg_usec % 1000);
+            stage_msg += stage;
+        }
+
+        if (!stage_msg.empty())
+        {
+            snprintf(msg, sizeof msg, "Display %p average stage times: ", id);
+            logger.log(ml::Severity::informational, msg + stage_msg, component);
+        }
     }
 
+    last_reported_stages = stages;
     last_reported_total_time_sum = total_time_sum;
     last_reported_render_time_sum = render_time_sum;
     last_reported_latency_sum = latency_sum;
@@ -25,6 +25,7 @@
 #include <mutex>
 #include <unordered_map>
 #include <chrono>
+#include <array>
 
 namespace mir
 {
@@ -47,6 +48,7 @@ public:
     void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) override;
     void rendered_frame(SubCompositorId id) override;
     void finished_frame(SubCompositorId id) override;
+    void frame_stage_timing(SubCompositorId id, FrameStage stage, std::chrono::nanoseconds duration) override;
     void started() override;
     void stopped() override;
     void scheduled() override;
@@ -58,6 +60,13 @@ private:
     typedef time::Timestamp TimePoint;
     TimePoint now() const;
 
+    struct StageTiming
+    {
+        std::chrono::nanoseconds sum{0};
+        long nsamples = 0;
+    };
+    static constexpr size_t nstages = static_cast<size_t>(FrameStage::post) + 1;
+
     struct Instance
     {
         TimePoint start_of_frame;
@@ -76,6 +85,9 @@ private:
         long last_reported_nframes = 0;
         long last_reported_bypassed = 0;
 
+        std::array<StageTiming, nstages> stages;
+        std::array<StageTiming, nstages> last_reported_stages;
+
         void log(mir::logging::Logger& logger, SubCompositorId id);
     };
 
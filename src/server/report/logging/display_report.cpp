@@ -88,6 +88,12 @@ void mrl::DisplayReport::report_vt_switch_back_failure()
     logger->log(ml::Severity::warning, "Failed to switch back to Mir VT.", component());
 }
 
+void mrl::DisplayReport::report_bypass_failure(unsigned int output_id, char const* reason)
+{
+    logger->log(component(), ml::Severity::informational,
+        "Compositing output %u instead of scanning out a client buffer: %s", output_id, reason);
+}
+
 void mrl::DisplayReport::report_egl_configuration(EGLDisplay disp, EGLConfig config)
 {
     auto ext = eglQueryString(disp, EGL_EXTENSIONS);
@@ -25,6 +25,25 @@
 #define TRACEPOINT_PROBE_DYNAMIC_LINKAGE
 #include "compositor_report_tp.h"
 
+namespace
+{
+char const* name_of(mir::compositor::CompositorReport::FrameStage stage)
+{
+    using FrameStage = mir::compositor::CompositorReport::FrameStage;
+    switch (stage)
+    {
+    case FrameStage::scene_snapshot: return "scene_snapshot";
+    case FrameStage::occlusion: return "occlusion";
+    case FrameStage::texture_upload: return "texture_upload";
+    case FrameStage::draw: return "draw";
+    case FrameStage::gpu: return "gpu";
+    case FrameStage::swap: return "swap";
+    case FrameStage::post: return "post";
+    }
+    return "unknown";
+}
+}
+
 #define COMPOSITOR_TRACE_CALL(name) MIR_LTTNG_VOID_TRACE_CALL(CompositorReport, mir_server_compositor, name)
 
 COMPOSITOR_TRACE_CALL(started)
@@ -62,3 +81,9 @@ void mir::report::lttng::CompositorReport::finished_frame(SubCompositorId id)
 {
     mir_tracepoint(mir_server_compositor, finished_frame, id);
 }
+
+void mir::report::lttng::CompositorReport::frame_stage_timing(
+    SubCompositorId id, FrameStage stage, std::chrono::nanoseconds duration)
+{
+    mir_tracepoint(mir_server_compositor, frame_stage_timing, id, name_of(stage), duration.count());
+}
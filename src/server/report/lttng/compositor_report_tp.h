@@ -90,6 +90,17 @@ TRACEPOINT_EVENT(
     )
 )
 
+TRACEPOINT_EVENT(
+    mir_server_compositor,
+    frame_stage_timing,
+    TP_ARGS(void const*, id, char const*, stage, int64_t, duration_ns),
+    TP_FIELDS(
+        ctf_integer_hex(uintptr_t, id, (uintptr_t)(id))
+        ctf_string(stage, stage)
+        ctf_integer(int64_t, duration_ns, duration_ns)
+    )
+)
+
 #endif /* MIR_LTTNG_COMPOSITOR_REPORT_TP_H_ */
 
 #include <lttng/tracepoint-event.h>
@@ -47,6 +47,11 @@ void mir::report::lttng::DisplayReport::report_drm_master_failure(int error)
     mir_tracepoint(mir_server_display, report_drm_master_failure, strerror(error));
 }
 
+void mir::report::lttng::DisplayReport::report_bypass_failure(unsigned int output_id, char const* reason)
+{
+    mir_tracepoint(mir_server_display, report_bypass_failure, output_id, reason);
+}
+
 void mir::report::lttng::DisplayReport::report_vsync(unsigned int output_id,
                                                      mir::graphics::Frame const&)
 {
@@ -71,6 +71,16 @@ TRACEPOINT_EVENT(
      )
 )
 
+TRACEPOINT_EVENT(
+    mir_server_display,
+    report_bypass_failure,
+    TP_ARGS(int, id, char const*, reason),
+    TP_FIELDS(
+        ctf_integer(int, id, id)
+        ctf_string(reason, reason)
+     )
+)
+
 #endif /* MIR_LTTNG_DISPLAY_REPORT_TP_H_ */
 
 #include <lttng/tracepoint-event.h>
@@ -0,0 +1,178 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "compositor_report.h"
+#include "registry.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace mrm = mir::report::metrics;
+
+namespace
+{
+using FrameStage = mir::compositor::CompositorReport::FrameStage;
+
+// Half a millisecond to a quarter of a second
+auto const frame_buckets = mrm::exponential_buckets(0.0005, 2, 10);
+
+auto name_of(FrameStage stage) -> char const*
+{
+    switch (stage)
+    {
+    case FrameStage::scene_snapshot: return "scene_snapshot";
+    case FrameStage::occlusion: return "occlusion";
+    case FrameStage::texture_upload: return "texture_upload";
+    case FrameStage::draw: return "draw";
+    case FrameStage::gpu: return "gpu";
+    case FrameStage::swap: return "swap";
+    case FrameStage::post: return "post";
+    }
+    return "unknown";
+}
+
+auto seconds(std::chrono::steady_clock::duration duration) -> double
+{
+    return std::chrono::duration<double>(duration).count();
+}
+
+std::atomic<uint64_t> next_generation{0};
+
+auto new_generation() -> uint64_t
+{
+    return ++next_generation;
+}
+}
+
+mrm::CompositorReport::Instance::Instance(Registry& registry, std::string const& display) :
+    frames{registry.counter(
+        "mir_compositor_frames_total", "Frames composited or bypassed", {{"display", display}})},
+    bypassed_frames{registry.counter(
+        "mir_compositor_bypassed_frames_total", "Frames scanned out directly from a client buffer",
+        {{"display", display}})},
+    frame_time{registry.histogram(
+        "mir_compositor_frame_seconds", "Time taken to produce a frame", frame_buckets, {{"display", display}})},
+    renderables{registry.gauge(
+        "mir_compositor_renderables", "Buffers in the most recent frame", {{"display", display}})}
+{
+    for (size_t stage = 0; stage != nstages; ++stage)
+    {
+        stage_time[stage] = &registry.histogram(
+            "mir_compositor_frame_stage_seconds",
+            "Time taken by each stage of producing a frame",
+            frame_buckets,
+            {{"display", display}, {"stage", name_of(static_cast<FrameStage>(stage))}});
+    }
+}
+
+mrm::CompositorReport::CompositorReport(std::shared_ptr<Registry> const& registry) :
+    registry{registry},
+    schedules{registry->counter("mir_compositor_schedules_total", "Requests to composite a new frame")},
+    generation{new_generation()}
+{
+}
+
+auto mrm::CompositorReport::instance_for(SubCompositorId id) -> Instance&
+{
+    struct Cached
+    {
+        uint64_t generation;
+        SubCompositorId id;
+        Instance* instance;
+    };
+    thread_local std::vector<Cached> cache;
+
+    auto const current = generation.load(std::memory_order_acquire);
+    for (auto const& entry : cache)
+    {
+        if (entry.generation == current && entry.id == id)
+            return *entry.instance;
+    }
+
+    std::lock_guard<std::mutex> lock{mutex};
+    auto& instance = instances[id];
+    if (!instance)
+        instance = std::make_unique<Instance>(*registry, "unknown");
+
+    cache.erase(
+        std::remove_if(cache.begin(), cache.end(), [id](Cached const& entry) { return entry.id == id; }),
+        cache.end());
+    cache.push_back({current, id, instance.get()});
+    return *instance;
+}
+
+void mrm::CompositorReport::added_display(int width, int height, int x, int y, SubCompositorId id)
+{
+    auto const display =
+        std::to_string(width) + 'x' + std::to_string(height) +
+        (x < 0 ? "" : "+") + std::to_string(x) +
+        (y < 0 ? "" : "+") + std::to_string(y);
+
+    std::lock_guard<std::mutex> lock{mutex};
+    instances[id] = std::make_unique<Instance>(*registry, display);
+    generation = new_generation();
+}
+
+void mrm::CompositorReport::began_frame(SubCompositorId id)
+{
+    auto& instance = instance_for(id);
+    instance.start_of_frame = std::chrono::steady_clock::now();
+    instance.rendered = false;
+}
+
+void mrm::CompositorReport::renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables)
+{
+    instance_for(id).renderables.set(renderables.size());
+}
+
+void mrm::CompositorReport::rendered_frame(SubCompositorId id)
+{
+    instance_for(id).rendered = true;
+}
+
+void mrm::CompositorReport::finished_frame(SubCompositorId id)
+{
+    auto const now = std::chrono::steady_clock::now();
+
+    auto& instance = instance_for(id);
+    instance.frames.increment();
+    if (!instance.rendered)
+        instance.bypassed_frames.increment();
+    instance.frame_time.observe(seconds(now - instance.start_of_frame));
+}
+
+void mrm::CompositorReport::frame_stage_timing(SubCompositorId id, FrameStage stage, std::chrono::nanoseconds duration)
+{
+    instance_for(id).stage_time[static_cast<size_t>(stage)]->observe(seconds(duration));
+}
+
+void mrm::CompositorReport::started()
+{
+}
+
+void mrm::CompositorReport::stopped()
+{
+    // The compositing threads are gone, and the next start creates new compositors
+    std::lock_guard<std::mutex> lock{mutex};
+    instances.clear();
+    generation = new_generation();
+}
+
+void mrm::CompositorReport::scheduled()
+{
+    schedules.increment();
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_METRICS_COMPOSITOR_REPORT_H_
+#define MIR_REPORT_METRICS_COMPOSITOR_REPORT_H_
+
+#include "mir/compositor/compositor_report.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace mir
+{
+namespace report
+{
+namespace metrics
+{
+class Registry;
+class Counter;
+class Gauge;
+class Histogram;
+
+class CompositorReport : public compositor::CompositorReport
+{
+public:
+    explicit CompositorReport(std::shared_ptr<Registry> const& registry);
+
+    void added_display(int width, int height, int x, int y, SubCompositorId id) override;
+    void began_frame(SubCompositorId id) override;
+    void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) override;
+    void rendered_frame(SubCompositorId id) override;
+    void finished_frame(SubCompositorId id) override;
+    void frame_stage_timing(SubCompositorId id, FrameStage stage, std::chrono::nanoseconds duration) override;
+    void started() override;
+    void stopped() override;
+    void scheduled() override;
+
+private:
+    static constexpr size_t nstages = static_cast<size_t>(FrameStage::post) + 1;
+
+    // The metrics for one display, labelled with its geometry
+    struct Instance
+    {
+        Instance(Registry& registry, std::string const& display);
+
+        Counter& frames;
+        Counter& bypassed_frames;
+        Histogram& frame_time;
+        Gauge& renderables;
+        std::array<Histogram*, nstages> stage_time;
+
+        std::chrono::steady_clock::time_point start_of_frame;
+        bool rendered{false};
+    };
+
+    /// Each compositor thread caches the instances it has looked up, so that
+    /// per-frame updates don't contend on the mutex
+    auto instance_for(SubCompositorId id) -> Instance&;
+
+    std::shared_ptr<Registry> const registry;
+    Counter& schedules;
+
+    std::mutex mutex;
+    std::unordered_map<SubCompositorId, std::unique_ptr<Instance>> instances;
+
+    /// Changes whenever instances are replaced or erased, invalidating the cached lookups.
+    /// Drawn from a process-wide sequence, so it is never reused by another report either.
+    std::atomic<uint64_t> generation;
+};
+}
+}
+}
+
+#endif /* MIR_REPORT_METRICS_COMPOSITOR_REPORT_H_ */
@@ -0,0 +1,115 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "display_report.h"
+#include "registry.h"
+
+#include <string>
+
+namespace mrm = mir::report::metrics;
+
+namespace
+{
+// A millisecond to a quarter of a second
+auto const interval_buckets = mrm::exponential_buckets(0.001, 2, 9);
+}
+
+mrm::DisplayReport::Output::Output(Registry& registry, unsigned int output_id) :
+    vsyncs{registry.counter(
+        "mir_display_vsyncs_total", "Frames presented", {{"output", std::to_string(output_id)}})},
+    missed_vblanks{registry.counter(
+        "mir_display_missed_vblanks_total", "Vblanks that passed without a new frame being presented",
+        {{"output", std::to_string(output_id)}})},
+    frame_interval{registry.histogram(
+        "mir_display_frame_interval_seconds", "Time between successive frames being presented",
+        interval_buckets, {{"output", std::to_string(output_id)}})}
+{
+}
+
+mrm::DisplayReport::DisplayReport(std::shared_ptr<Registry> const& registry) :
+    registry{registry},
+    drm_master_failures{registry->counter(
+        "mir_display_drm_master_failures_total", "Failures to acquire or drop DRM master")},
+    vt_switch_failures{registry->counter(
+        "mir_display_vt_switch_failures_total", "Failures to switch VT")}
+{
+}
+
+void mrm::DisplayReport::report_successful_setup_of_native_resources()
+{
+}
+
+void mrm::DisplayReport::report_successful_egl_make_current_on_construction()
+{
+}
+
+void mrm::DisplayReport::report_successful_egl_buffer_swap_on_construction()
+{
+}
+
+void mrm::DisplayReport::report_successful_display_construction()
+{
+}
+
+void mrm::DisplayReport::report_egl_configuration(EGLDisplay, EGLConfig)
+{
+}
+
+void mrm::DisplayReport::report_vsync(unsigned int output_id, graphics::Frame const& frame)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto& output = outputs[output_id];
+    if (!output)
+        output = std::make_unique<Output>(*registry, output_id);
+
+    output->vsyncs.increment();
+    if (output->has_previous && output->previous.msc < frame.msc)
+    {
+        output->missed_vblanks.increment(frame.msc - output->previous.msc - 1);
+        output->frame_interval.observe(
+            std::chrono::duration<double>(frame.ust.nanoseconds - output->previous.ust.nanoseconds).count());
+    }
+
+    output->has_previous = true;
+    output->previous = frame;
+}
+
+void mrm::DisplayReport::report_successful_drm_mode_set_crtc_on_construction()
+{
+}
+
+void mrm::DisplayReport::report_drm_master_failure(int)
+{
+    drm_master_failures.increment();
+}
+
+void mrm::DisplayReport::report_vt_switch_away_failure()
+{
+    vt_switch_failures.increment();
+}
+
+void mrm::DisplayReport::report_vt_switch_back_failure()
+{
+    vt_switch_failures.increment();
+}
+
+void mrm::DisplayReport::report_bypass_failure(unsigned int output_id, char const* reason)
+{
+    registry->counter(
+        "mir_display_bypass_failures_total", "Frames composited because they could not be scanned out directly",
+        {{"output", std::to_string(output_id)}, {"reason", reason}}).increment();
+}
@@ -0,0 +1,195 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "endpoint.h"
+#include "registry.h"
+
+#define MIR_LOG_COMPONENT "metrics"
+#include "mir/log.h"
+#include "mir/thread_name.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <cstring>
+#include <system_error>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace mrm = mir::report::metrics;
+
+namespace
+{
+// Don't let a client that never sends a request tie up the endpoint
+timeval const request_timeout{0, 200000};
+
+// ...nor one that stops reading the response; the next scrape will get fresh values anyway
+timeval const response_timeout{1, 0};
+
+auto address_for(std::string const& path) -> sockaddr_un
+{
+    sockaddr_un address{};
+    if (path.size() >= sizeof address.sun_path)
+        BOOST_THROW_EXCEPTION(std::invalid_argument("Metrics socket path too long: " + path));
+
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path.c_str(), sizeof address.sun_path - 1);
+    return address;
+}
+
+auto unix_socket() -> mir::Fd
+{
+    mir::Fd fd{socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+    if (fd < 0)
+        BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to create metrics socket"));
+    return fd;
+}
+
+auto listening_socket(std::string const& path) -> mir::Fd
+{
+    auto const address = address_for(path);
+    auto const bind_to = [&](mir::Fd const& fd)
+        {
+            return bind(fd, reinterpret_cast<sockaddr const*>(&address), sizeof address) == 0;
+        };
+
+    auto fd = unix_socket();
+    if (!bind_to(fd))
+    {
+        if (errno != EADDRINUSE)
+            BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to bind " + path));
+
+        // Only replace a socket that nobody is listening on (left behind by a crash)
+        auto const probe = unix_socket();
+        if (connect(probe, reinterpret_cast<sockaddr const*>(&address), sizeof address) == 0)
+            BOOST_THROW_EXCEPTION(std::runtime_error("Metrics socket " + path + " is already in use"));
+
+        unlink(path.c_str());
+        if (!bind_to(fd))
+            BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to bind " + path));
+    }
+
+    if (listen(fd, SOMAXCONN) != 0)
+        BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to listen on " + path));
+
+    return fd;
+}
+
+void write_all(int fd, std::string const& data)
+{
+    for (size_t written = 0; written < data.size();)
+    {
+        auto const result = send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+        if (result < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        written += result;
+    }
+}
+}
+
+mrm::Endpoint::Endpoint(std::string const& socket_path, std::shared_ptr<Registry> const& registry) :
+    socket_path{socket_path},
+    registry{registry},
+    listener{listening_socket(socket_path)},
+    shutdown{eventfd(0, EFD_CLOEXEC)},
+    server{[this] { serve(); }}
+{
+    mir::log_info("Serving metrics on %s", socket_path.c_str());
+}
+
+mrm::Endpoint::~Endpoint()
+{
+    uint64_t const one = 1;
+    if (write(shutdown, &one, sizeof one) != sizeof one)
+        mir::log_warning("Failed to stop metrics endpoint");
+    server.join();
+    unlink(socket_path.c_str());
+}
+
+void mrm::Endpoint::serve()
+{
+    mir::set_thread_name("Mir/Metrics");
+
+    pollfd fds[] = {{listener, POLLIN, 0}, {shutdown, POLLIN, 0}};
+
+    for (;;)
+    {
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            mir::log_error("Metrics endpoint failed: %s", strerror(errno));
+            return;
+        }
+
+        if (fds[1].revents)
+            return;
+
+        if (fds[0].revents & POLLIN)
+        {
+            Fd const client{accept4(listener, nullptr, nullptr, SOCK_CLOEXEC)};
+            if (client >= 0)
+                respond(client);
+        }
+    }
+}
+
+void mrm::Endpoint::respond(Fd const& client)
+{
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &request_timeout, sizeof request_timeout);
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &response_timeout, sizeof response_timeout);
+
+    // Read until the end of the request headers; we don't need anything beyond the method
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8 * sizeof buffer)
+    {
+        auto const received = recv(client, buffer, sizeof buffer, 0);
+        if (received <= 0)
+            break;
+        request.append(buffer, received);
+    }
+
+    auto const body = registry->render();
+
+    if (request.compare(0, 4, "GET ") == 0)
+    {
+        write_all(client,
+            "HTTP/1.0 200 OK\r\n"
+            "Content-Type: text/plain; version=0.0.4\r\n"
+            "Content-Length: " + std::to_string(body.size()) + "\r\n"
+            "Connection: close\r\n"
+            "\r\n");
+    }
+    else if (!request.empty())
+    {
+        write_all(client,
+            "HTTP/1.0 405 Method Not Allowed\r\n"
+            "Content-Length: 0\r\n"
+            "Connection: close\r\n"
+            "\r\n");
+        return;
+    }
+
+    write_all(client, body);
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_METRICS_ENDPOINT_H_
+#define MIR_REPORT_METRICS_ENDPOINT_H_
+
+#include "mir/fd.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace mir
+{
+namespace report
+{
+namespace metrics
+{
+class Registry;
+
+/**
+ * Serves the registry's metrics on a local Unix socket.
+ *
+ * HTTP GET requests (e.g. "curl --unix-socket <path> http://localhost/metrics")
+ * get an HTTP response, so the socket can be scraped by a Prometheus agent
+ * through a local proxy. A client that sends nothing (e.g. "socat - UNIX:<path>")
+ * just gets the text.
+ */
+class Endpoint
+{
+public:
+    Endpoint(std::string const& socket_path, std::shared_ptr<Registry> const& registry);
+    ~Endpoint();
+
+    Endpoint(Endpoint const&) = delete;
+    Endpoint& operator=(Endpoint const&) = delete;
+
+private:
+    void serve();
+    void respond(Fd const& client);
+
+    std::string const socket_path;
+    std::shared_ptr<Registry> const registry;
+    Fd const listener;
+    Fd const shutdown;
+    std::thread server;
+};
+}
+}
+}
+
+#endif /* MIR_REPORT_METRICS_ENDPOINT_H_ */
@@ -0,0 +1,82 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "input_report.h"
+#include "registry.h"
+
+#include <chrono>
+
+namespace mrm = mir::report::metrics;
+
+namespace
+{
+// A tenth of a millisecond to a fifth of a second
+auto const latency_buckets = mrm::exponential_buckets(0.0001, 2, 12);
+
+// Event times are CLOCK_MONOTONIC, as is steady_clock on Linux
+auto seconds_since(int64_t event_time) -> double
+{
+    auto const now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double>(now - std::chrono::nanoseconds{event_time}).count();
+}
+}
+
+mrm::InputReport::InputReport(std::shared_ptr<Registry> const& registry) :
+    registry{registry},
+    kernel_events{registry->counter("mir_input_kernel_events_total", "Input events read from the kernel")},
+    kernel_latency{registry->histogram(
+        "mir_input_kernel_latency_seconds", "Time from the kernel timestamping an input event to Mir reading it",
+        latency_buckets)},
+    published_key_events{registry->counter(
+        "mir_input_published_events_total", "Input events sent to clients", {{"type", "key"}})},
+    published_motion_events{registry->counter(
+        "mir_input_published_events_total", "Input events sent to clients", {{"type", "motion"}})},
+    publish_latency{registry->histogram(
+        "mir_input_publish_latency_seconds", "Time from the kernel timestamping an input event to it being sent",
+        latency_buckets)}
+{
+}
+
+void mrm::InputReport::received_event_from_kernel(int64_t when, int, int, int)
+{
+    kernel_events.increment();
+    kernel_latency.observe(seconds_since(when));
+}
+
+void mrm::InputReport::published_key_event(int, uint32_t, int64_t event_time)
+{
+    published_key_events.increment();
+    publish_latency.observe(seconds_since(event_time));
+}
+
+void mrm::InputReport::published_motion_event(int, uint32_t, int64_t event_time)
+{
+    published_motion_events.increment();
+    publish_latency.observe(seconds_since(event_time));
+}
+
+void mrm::InputReport::opened_input_device(char const*, char const* input_platform)
+{
+    registry->counter(
+        "mir_input_devices_opened_total", "Input devices opened", {{"platform", input_platform}}).increment();
+}
+
+void mrm::InputReport::failed_to_open_input_device(char const*, char const* input_platform)
+{
+    registry->counter(
+        "mir_input_device_failures_total", "Input devices that could not be opened",
+        {{"platform", input_platform}}).increment();
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "message_processor_report.h"
+#include "registry.h"
+
+namespace mrm = mir::report::metrics;
+
+mrm::MessageProcessorReport::MessageProcessorReport(std::shared_ptr<Registry> const& registry) :
+    registry{registry},
+    invocations{registry->counter("mir_frontend_invocations_total", "Client requests received")},
+    unknown_methods{registry->counter("mir_frontend_unknown_methods_total", "Client requests for unknown methods")},
+    exceptions{registry->counter("mir_frontend_exceptions_total", "Client requests that failed with an exception")}
+{
+}
+
+void mrm::MessageProcessorReport::received_invocation(void const*, int, std::string const&)
+{
+    invocations.increment();
+}
+
+void mrm::MessageProcessorReport::completed_invocation(void const*, int, bool)
+{
+}
+
+void mrm::MessageProcessorReport::unknown_method(void const*, int, std::string const&)
+{
+    unknown_methods.increment();
+}
+
+void mrm::MessageProcessorReport::exception_handled(void const*, int, std::exception const&)
+{
+    exceptions.increment();
+}
+
+void mrm::MessageProcessorReport::exception_handled(void const*, std::exception const&)
+{
+    exceptions.increment();
+}
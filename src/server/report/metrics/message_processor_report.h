@@ -0,0 +1,54 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_METRICS_MESSAGE_PROCESSOR_REPORT_H_
+#define MIR_REPORT_METRICS_MESSAGE_PROCESSOR_REPORT_H_
+
+#include "mir/frontend/message_processor_report.h"
+
+#include <memory>
+
+namespace mir
+{
+namespace report
+{
+namespace metrics
+{
+class Registry;
+class Counter;
+
+class MessageProcessorReport : public frontend::MessageProcessorReport
+{
+public:
+    explicit MessageProcessorReport(std::shared_ptr<Registry> const& registry);
+
+    void received_invocation(void const* mediator, int id, std::string const& method) override;
+    void completed_invocation(void const* mediator, int id, bool result) override;
+    void unknown_method(void const* mediator, int id, std::string const& method) override;
+    void exception_handled(void const* mediator, int id, std::exception const& error) override;
+    void exception_handled(void const* mediator, std::exception const& error) override;
+
+private:
+    std::shared_ptr<Registry> const registry;
+    Counter& invocations;
+    Counter& unknown_methods;
+    Counter& exceptions;
+};
+}
+}
+}
+
+#endif /* MIR_REPORT_METRICS_MESSAGE_PROCESSOR_REPORT_H_ */
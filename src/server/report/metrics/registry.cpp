@@ -0,0 +1,283 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "registry.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+
+namespace mrm = mir::report::metrics;
+
+namespace
+{
+std::atomic<size_t> next_shard{0};
+
+// Threads are assigned shards round-robin as they first update a metric
+auto this_thread_shard() -> size_t
+{
+    thread_local size_t const shard = next_shard++ % mrm::shard_count;
+    return shard;
+}
+
+auto escaped(std::string const& value) -> std::string
+{
+    std::string result;
+    result.reserve(value.size());
+    for (auto const c : value)
+    {
+        switch (c)
+        {
+        case '\\': result += "\\\\"; break;
+        case '"':  result += "\\\""; break;
+        case '\n': result += "\\n"; break;
+        default:   result += c;
+        }
+    }
+    return result;
+}
+
+auto label_string(mrm::Labels const& labels) -> std::string
+{
+    std::string result;
+    for (auto const& label : labels)
+    {
+        if (!result.empty())
+            result += ',';
+        result += label.first + "=\"" + escaped(label.second) + '"';
+    }
+    return result;
+}
+
+void write_sample(std::ostream& out, std::string const& name, std::string const& labels)
+{
+    out << name;
+    if (!labels.empty())
+        out << '{' << labels << '}';
+    out << ' ';
+}
+
+void add(std::atomic<double>& total, double value)
+{
+    auto expected = total.load(std::memory_order_relaxed);
+    while (!total.compare_exchange_weak(expected, expected + value, std::memory_order_relaxed))
+        ;
+}
+}
+
+struct mrm::Registry::Family
+{
+    std::string help;
+    std::string type;
+    std::map<std::string, std::unique_ptr<Metric>> series;
+};
+
+void mrm::Counter::increment(uint64_t by)
+{
+    shards[this_thread_shard()].value.fetch_add(by, std::memory_order_relaxed);
+}
+
+auto mrm::Counter::value() const -> uint64_t
+{
+    uint64_t result = 0;
+    for (auto const& shard : shards)
+        result += shard.value.load(std::memory_order_relaxed);
+    return result;
+}
+
+void mrm::Counter::render(std::ostream& out, std::string const& name, std::string const& labels) const
+{
+    write_sample(out, name, labels);
+    out << value() << '\n';
+}
+
+void mrm::Gauge::set(int64_t value)
+{
+    current.store(value, std::memory_order_relaxed);
+}
+
+void mrm::Gauge::increment(int64_t by)
+{
+    current.fetch_add(by, std::memory_order_relaxed);
+}
+
+void mrm::Gauge::decrement(int64_t by)
+{
+    current.fetch_sub(by, std::memory_order_relaxed);
+}
+
+auto mrm::Gauge::value() const -> int64_t
+{
+    return current.load(std::memory_order_relaxed);
+}
+
+void mrm::Gauge::render(std::ostream& out, std::string const& name, std::string const& labels) const
+{
+    write_sample(out, name, labels);
+    out << value() << '\n';
+}
+
+mrm::Histogram::Histogram(std::vector<double> const& upper_bounds) :
+    upper_bounds{upper_bounds},
+    shards{std::make_unique<Shard[]>(shard_count)}
+{
+    if (!std::is_sorted(upper_bounds.begin(), upper_bounds.end()))
+        BOOST_THROW_EXCEPTION(std::invalid_argument("Histogram bucket bounds must be in increasing order"));
+
+    // The extra bucket counts observations above the largest bound
+    for (size_t i = 0; i != shard_count; ++i)
+        shards[i].buckets = std::make_unique<std::atomic<uint64_t>[]>(upper_bounds.size() + 1);
+}
+
+void mrm::Histogram::observe(double value)
+{
+    auto const bucket = std::lower_bound(upper_bounds.begin(), upper_bounds.end(), value) - upper_bounds.begin();
+    auto& shard = shards[this_thread_shard()];
+    shard.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    add(shard.sum, value);
+}
+
+auto mrm::Histogram::count() const -> uint64_t
+{
+    uint64_t result = 0;
+    for (size_t i = 0; i != shard_count; ++i)
+        for (size_t bucket = 0; bucket != upper_bounds.size() + 1; ++bucket)
+            result += shards[i].buckets[bucket].load(std::memory_order_relaxed);
+    return result;
+}
+
+auto mrm::Histogram::sum() const -> double
+{
+    double result = 0;
+    for (size_t i = 0; i != shard_count; ++i)
+        result += shards[i].sum.load(std::memory_order_relaxed);
+    return result;
+}
+
+void mrm::Histogram::render(std::ostream& out, std::string const& name, std::string const& labels) const
+{
+    auto const bucket_labels = [&](std::string const& bound)
+        {
+            return (labels.empty() ? labels : labels + ',') + "le=\"" + bound + '"';
+        };
+
+    uint64_t cumulative = 0;
+    for (size_t bucket = 0; bucket != upper_bounds.size() + 1; ++bucket)
+    {
+        for (size_t i = 0; i != shard_count; ++i)
+            cumulative += shards[i].buckets[bucket].load(std::memory_order_relaxed);
+
+        std::ostringstream bound;
+        bound.imbue(std::locale::classic());
+        if (bucket == upper_bounds.size())
+            bound << "+Inf";
+        else
+            bound << upper_bounds[bucket];
+
+        write_sample(out, name + "_bucket", bucket_labels(bound.str()));
+        out << cumulative << '\n';
+    }
+
+    // Sampled separately from the buckets, so may be slightly out of step under load
+    write_sample(out, name + "_sum", labels);
+    out << sum() << '\n';
+    write_sample(out, name + "_count", labels);
+    out << cumulative << '\n';
+}
+
+auto mrm::exponential_buckets(double start, double factor, size_t count) -> std::vector<double>
+{
+    std::vector<double> result;
+    for (auto bound = start; result.size() != count; bound *= factor)
+        result.push_back(bound);
+    return result;
+}
+
+mrm::Registry::Registry() = default;
+mrm::Registry::~Registry() = default;
+
+template<typename Type, typename... Args>
+auto mrm::Registry::find_or_create(
+    std::string const& name,
+    std::string const& help,
+    char const* type,
+    Labels const& labels,
+    Args const&... args) -> Type&
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto& family = families[name];
+    if (!family)
+        family = std::make_unique<Family>(Family{help, type, {}});
+    else if (family->type != type)
+        BOOST_THROW_EXCEPTION(std::logic_error("Metric \"" + name + "\" registered with conflicting types"));
+
+    auto& metric = family->series[label_string(labels)];
+    if (!metric)
+        metric = std::make_unique<Type>(args...);
+
+    return static_cast<Type&>(*metric);
+}
+
+auto mrm::Registry::counter(std::string const& name, std::string const& help, Labels const& labels) -> Counter&
+{
+    return find_or_create<Counter>(name, help, "counter", labels);
+}
+
+auto mrm::Registry::gauge(std::string const& name, std::string const& help, Labels const& labels) -> Gauge&
+{
+    return find_or_create<Gauge>(name, help, "gauge", labels);
+}
+
+auto mrm::Registry::histogram(
+    std::string const& name,
+    std::string const& help,
+    std::vector<double> const& upper_bounds,
+    Labels const& labels) -> Histogram&
+{
+    return find_or_create<Histogram>(name, help, "histogram", labels, upper_bounds);
+}
+
+void mrm::Registry::add_collector(std::function<void(std::ostream& out)> const& collector)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    collectors.push_back(collector);
+}
+
+auto mrm::Registry::render() const -> std::string
+{
+    std::ostringstream out;
+    out.imbue(std::locale::classic());
+
+    std::lock_guard<std::mutex> lock{mutex};
+    for (auto const& family : families)
+    {
+        auto const& name = family.first;
+        out << "# HELP " << name << ' ' << family.second->help << '\n';
+        out << "# TYPE " << name << ' ' << family.second->type << '\n';
+
+        for (auto const& series : family.second->series)
+            series.second->render(out, name, series.first);
+    }
+
+    for (auto const& collector : collectors)
+        collector(out);
+
+    return out.str();
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_METRICS_REGISTRY_H_
+#define MIR_REPORT_METRICS_REGISTRY_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mir
+{
+namespace report
+{
+namespace metrics
+{
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+/// Updates from different threads go to different shards, so that hot
+/// metrics are not a point of cache-line contention between threads
+size_t const shard_count = 16;
+
+class Metric
+{
+public:
+    virtual ~Metric() = default;
+
+    /// Writes the metric's samples in the Prometheus text format
+    virtual void render(std::ostream& out, std::string const& name, std::string const& labels) const = 0;
+
+protected:
+    Metric() = default;
+    Metric(Metric const&) = delete;
+    Metric& operator=(Metric const&) = delete;
+};
+
+/// A monotonically increasing count
+class Counter : public Metric
+{
+public:
+    void increment(uint64_t by = 1);
+    auto value() const -> uint64_t;
+
+    void render(std::ostream& out, std::string const& name, std::string const& labels) const override;
+
+private:
+    struct alignas(64) Shard
+    {
+        std::atomic<uint64_t> value{0};
+    };
+    Shard shards[shard_count];
+};
+
+/// A value that can go up and down (e.g. the number of connected clients)
+class Gauge : public Metric
+{
+public:
+    void set(int64_t value);
+    void increment(int64_t by = 1);
+    void decrement(int64_t by = 1);
+    auto value() const -> int64_t;
+
+    void render(std::ostream& out, std::string const& name, std::string const& labels) const override;
+
+private:
+    std::atomic<int64_t> current{0};
+};
+
+/// Counts observations into buckets with fixed upper bounds
+class Histogram : public Metric
+{
+public:
+    explicit Histogram(std::vector<double> const& upper_bounds);
+
+    void observe(double value);
+    auto count() const -> uint64_t;
+    auto sum() const -> double;
+
+    void render(std::ostream& out, std::string const& name, std::string const& labels) const override;
+
+private:
+    struct alignas(64) Shard
+    {
+        std::unique_ptr<std::atomic<uint64_t>[]> buckets;
+        std::atomic<double> sum{0};
+    };
+
+    std::vector<double> const upper_bounds;
+    std::unique_ptr<Shard[]> const shards;
+};
+
+/// Upper bounds starting at start and growing by factor
+auto exponential_buckets(double start, double factor, size_t count) -> std::vector<double>;
+
+/**
+ * The set of metrics exposed by the server.
+ *
+ * Metrics are created on first use of a name and label set and live as long
+ * as the registry, so reports look them up once and then update them without
+ * further locking.
+ */
+class Registry
+{
+public:
+    Registry();
+    ~Registry();
+
+    auto counter(std::string const& name, std::string const& help, Labels const& labels = {}) -> Counter&;
+    auto gauge(std::string const& name, std::string const& help, Labels const& labels = {}) -> Gauge&;
+    auto histogram(
+        std::string const& name,
+        std::string const& help,
+        std::vector<double> const& upper_bounds,
+        Labels const& labels = {}) -> Histogram&;
+
+    /// Writes whole metric families (with their HELP and TYPE lines) each time the registry is
+    /// rendered, for values that are read on demand rather than updated as they change
+    void add_collector(std::function<void(std::ostream& out)> const& collector);
+
+    /// All the metrics in the Prometheus text exposition format (version 0.0.4)
+    auto render() const -> std::string;
+
+private:
+    struct Family;
+
+    template<typename Type, typename... Args>
+    auto find_or_create(
+        std::string const& name,
+        std::string const& help,
+        char const* type,
+        Labels const& labels,
+        Args const&... args) -> Type&;
+
+    std::mutex mutable mutex;
+    std::map<std::string, std::unique_ptr<Family>> families;
+    std::vector<std::function<void(std::ostream& out)>> collectors;
+};
+}
+}
+}
+
+#endif /* MIR_REPORT_METRICS_REGISTRY_H_ */
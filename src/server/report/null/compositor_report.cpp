@@ -40,6 +40,10 @@ void mrn::CompositorReport::finished_frame(SubCompositorId)
 {
 }
 
+void mrn::CompositorReport::frame_stage_timing(SubCompositorId, FrameStage, std::chrono::nanoseconds)
+{
+}
+
 void mrn::CompositorReport::started()
 {
 }
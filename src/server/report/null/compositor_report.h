@@ -36,6 +36,7 @@ public:
     void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) override;
     void rendered_frame(SubCompositorId id) override;
     void finished_frame(SubCompositorId id) override;
+    void frame_stage_timing(SubCompositorId id, FrameStage stage, std::chrono::nanoseconds duration) override;
     void started() override;
     void stopped() override;
     void scheduled() override;
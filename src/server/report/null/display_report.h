@@ -42,6 +42,7 @@ public:
     void report_drm_master_failure(int error) override;
     void report_vt_switch_away_failure() override;
     void report_vt_switch_back_failure() override;
+    void report_bypass_failure(unsigned int output_id, char const* reason) override;
     void report_egl_configuration(EGLDisplay disp, EGLConfig cfg) override;
     void report_vsync(unsigned int output_id, graphics::Frame const&) override;
 };
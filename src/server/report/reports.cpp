@@ -29,6 +29,7 @@
 #include "lttng_report_factory.h"
 #include "logging_report_factory.h"
 #include "null_report_factory.h"
+#include "metrics_report_factory.h"
 
 #include <string>
 
@@ -41,7 +42,8 @@ enum class ReportOutput
 {
     Discarded,
     Log,
-    LTTNG
+    LTTNG,
+    Metrics
 };
 
 std::unique_ptr<mr::ReportFactory> factory_for_type(
@@ -56,6 +58,8 @@ std::unique_ptr<mr::ReportFactory> factory_for_type(
         return std::make_unique<mr::LoggingReportFactory>(config.the_logger(), config.the_clock());
     case ReportOutput::LTTNG:
         return std::make_unique<mr::LttngReportFactory>();
+    case ReportOutput::Metrics:
+        return std::make_unique<mr::MetricsReportFactory>(config.the_metrics_registry());
     }
 #ifndef __clang__
     /*
@@ -80,6 +84,10 @@ ReportOutput parse_report_option(std::string const& opt)
     {
         return ReportOutput::LTTNG;
     }
+    else if (opt == mo::metrics_opt_value)
+    {
+        return ReportOutput::Metrics;
+    }
     else if (opt == mo::off_opt_value)
     {
         return ReportOutput::Discarded;
@@ -89,7 +97,8 @@ ReportOutput parse_report_option(std::string const& opt)
         throw mir::AbnormalExit(
             std::string("Invalid report option: ") + opt + " (valid options are: \"" +
             mo::off_opt_value + "\" and \"" + mo::log_opt_value +
-            "\" and \"" + mo::lttng_opt_value + "\")");
+            "\" and \"" + mo::lttng_opt_value +
+            "\" and \"" + mo::metrics_opt_value + "\")");
     }
 }
 
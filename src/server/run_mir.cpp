@@ -25,6 +25,7 @@
 #include "mir/frontend/connector.h"
 #include "mir/raii.h"
 #include "mir/emergency_cleanup.h"
+#include "mir/graphics/sigbus_guard.h"
 
 #include <atomic>
 #include <exception>
@@ -107,8 +108,23 @@ void mir::run_mir(
     static std::atomic<unsigned int> concurrent_calls{0};
 
     auto const raii = raii::paired_calls(
-        [&]{ if (!concurrent_calls++) for (auto sig : intercepted) old_handler[sig] = signal(sig, fatal_signal_cleanup); },
-        [&]{ if (!--concurrent_calls) for (auto sig : intercepted) signal(sig, old_handler[sig]); });
+        [&]
+        {
+            if (!concurrent_calls++)
+            {
+                for (auto sig : intercepted) old_handler[sig] = signal(sig, fatal_signal_cleanup);
+                // Lets platforms survive clients truncating shared memory; chains to fatal_signal_cleanup
+                graphics::install_sigbus_guard_handler();
+            }
+        },
+        [&]
+        {
+            if (!--concurrent_calls)
+            {
+                graphics::remove_sigbus_guard_handler();
+                for (auto sig : intercepted) signal(sig, old_handler[sig]);
+            }
+        });
 
     init(server);
     server.run();
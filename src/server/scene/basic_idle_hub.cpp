@@ -0,0 +1,174 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "basic_idle_hub.h"
+
+#include "mir/time/alarm.h"
+#include "mir/time/alarm_factory.h"
+
+#include <algorithm>
+
+namespace ms = mir::scene;
+
+struct ms::BasicIdleHub::Registration
+{
+    std::weak_ptr<IdleStateObserver> const observer;
+    IdleStateObserver const* const key;
+    std::chrono::milliseconds const timeout;
+    std::unique_ptr<time::Alarm> alarm;
+    bool idle;
+};
+
+class ms::BasicIdleHub::Inhibitor
+{
+public:
+    Inhibitor(std::weak_ptr<BasicIdleHub> const& hub)
+        : hub{hub}
+    {
+    }
+
+    ~Inhibitor()
+    {
+        if (auto const live_hub = hub.lock())
+        {
+            live_hub->uninhibit();
+        }
+    }
+
+private:
+    std::weak_ptr<BasicIdleHub> const hub;
+};
+
+ms::BasicIdleHub::BasicIdleHub(time::AlarmFactory& alarm_factory)
+    : alarm_factory{alarm_factory}
+{
+}
+
+ms::BasicIdleHub::~BasicIdleHub() = default;
+
+void ms::BasicIdleHub::poke()
+{
+    std::vector<std::shared_ptr<IdleStateObserver>> now_active;
+
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        for (auto const& registration : registrations)
+        {
+            if (registration->idle)
+            {
+                registration->idle = false;
+                if (auto const observer = registration->observer.lock())
+                {
+                    now_active.push_back(observer);
+                }
+            }
+
+            if (!inhibitors)
+            {
+                registration->alarm->reschedule_in(registration->timeout);
+            }
+        }
+    }
+
+    for (auto const& observer : now_active)
+    {
+        observer->active();
+    }
+}
+
+void ms::BasicIdleHub::register_interest(
+    std::weak_ptr<IdleStateObserver> const& observer,
+    std::chrono::milliseconds timeout)
+{
+    auto registration = std::make_unique<Registration>(Registration{observer, observer.lock().get(), timeout, {}, false});
+    registration->alarm = alarm_factory.create_alarm(
+        [this, registration = registration.get()]() { timed_out(registration); });
+
+    std::lock_guard<std::mutex> lock{mutex};
+    if (!inhibitors)
+    {
+        registration->alarm->reschedule_in(timeout);
+    }
+    registrations.push_back(std::move(registration));
+}
+
+void ms::BasicIdleHub::unregister_interest(IdleStateObserver const& observer)
+{
+    std::vector<std::unique_ptr<Registration>> removed;
+
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        auto const first_removed = std::stable_partition(
+            begin(registrations),
+            end(registrations),
+            [&observer](auto const& registration) { return registration->key != &observer; });
+        std::move(first_removed, end(registrations), back_inserter(removed));
+        registrations.erase(first_removed, end(registrations));
+    }
+
+    // The alarms are destroyed without the lock held, as their callbacks may be waiting on it
+}
+
+auto ms::BasicIdleHub::inhibit_idle() -> std::shared_ptr<void>
+{
+    // Inhibiting idle wakes anything that has already gone idle
+    poke();
+
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (!inhibitors++)
+        {
+            for (auto const& registration : registrations)
+            {
+                registration->alarm->cancel();
+            }
+        }
+    }
+
+    return std::make_shared<Inhibitor>(shared_from_this());
+}
+
+void ms::BasicIdleHub::timed_out(Registration* registration)
+{
+    std::shared_ptr<IdleStateObserver> observer;
+
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (inhibitors || registration->idle)
+        {
+            return;
+        }
+        registration->idle = true;
+        observer = registration->observer.lock();
+    }
+
+    if (observer)
+    {
+        observer->idle();
+    }
+}
+
+void ms::BasicIdleHub::uninhibit()
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    if (!--inhibitors)
+    {
+        for (auto const& registration : registrations)
+        {
+            registration->alarm->reschedule_in(registration->timeout);
+        }
+    }
+}
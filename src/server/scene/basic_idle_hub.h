@@ -0,0 +1,65 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SCENE_BASIC_IDLE_HUB_H_
+#define MIR_SCENE_BASIC_IDLE_HUB_H_
+
+#include "mir/scene/idle_hub.h"
+
+#include <mutex>
+#include <vector>
+
+namespace mir
+{
+namespace time
+{
+class Alarm;
+class AlarmFactory;
+}
+
+namespace scene
+{
+/// An IdleHub that uses an alarm per registered timeout, so nothing is polled
+class BasicIdleHub : public IdleHub, public std::enable_shared_from_this<BasicIdleHub>
+{
+public:
+    explicit BasicIdleHub(time::AlarmFactory& alarm_factory);
+    ~BasicIdleHub();
+
+    void poke() override;
+    void register_interest(
+        std::weak_ptr<IdleStateObserver> const& observer,
+        std::chrono::milliseconds timeout) override;
+    void unregister_interest(IdleStateObserver const& observer) override;
+    auto inhibit_idle() -> std::shared_ptr<void> override;
+
+private:
+    struct Registration;
+    class Inhibitor;
+
+    void timed_out(Registration* registration);
+    void uninhibit();
+
+    time::AlarmFactory& alarm_factory;
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Registration>> registrations;
+    int inhibitors{0};
+};
+}
+}
+
+#endif // MIR_SCENE_BASIC_IDLE_HUB_H_
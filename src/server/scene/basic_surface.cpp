@@ -806,6 +806,7 @@ public:
         void const* compositor_id,
         geom::Rectangle const& position,
         std::experimental::optional<geom::Rectangle> const& clip_area,
+        std::experimental::optional<geom::Rectangle> const& src_bounds,
         glm::mat4 const& transform,
         float alpha,
         mg::Renderable::ID id)
@@ -814,6 +815,7 @@ public:
       alpha_{alpha},
       screen_position_(position),
       clip_area_(clip_area),
+      src_bounds_(src_bounds),
       transformation_(transform),
       id_(id)
     {
@@ -828,6 +830,11 @@ public:
         return underlying_buffer_stream->framedropping() ? 0 : 1;
     }
 
+    bool tearing_allowed() const override
+    {
+        return underlying_buffer_stream->tearing_allowed();
+    }
+
     std::shared_ptr<mg::Buffer> buffer() const override
     {
         if (!compositor_buffer)
@@ -841,6 +848,9 @@ public:
     std::experimental::optional<geom::Rectangle> clip_area() const override
     { return clip_area_; }
 
+    std::experimental::optional<geom::Rectangle> src_bounds() const override
+    { return src_bounds_; }
+
     float alpha() const override
     { return alpha_; }
 
@@ -859,6 +869,7 @@ private:
     float const alpha_;
     geom::Rectangle const screen_position_;
     std::experimental::optional<geom::Rectangle> const clip_area_;
+    std::experimental::optional<geom::Rectangle> const src_bounds_;
     glm::mat4 const transformation_;
     mg::Renderable::ID const id_;
 };
@@ -941,10 +952,15 @@ mg::RenderableList ms::BasicSurface::generate_renderables(mc::CompositorID id) c
             else
                 size = info.stream->stream_size();
 
+            std::experimental::optional<geom::Rectangle> src_bounds;
+            if (info.src_bounds.is_set())
+                src_bounds = info.src_bounds.value();
+
             list.emplace_back(std::make_shared<SurfaceSnapshot>(
                 info.stream, id,
                 geom::Rectangle{content_top_left_ + info.displacement, std::move(size)},
                 clip_area_,
+                src_bounds,
                 transformation_matrix, surface_alpha, info.stream.get()));
         }
     }
@@ -40,6 +40,7 @@
 #include "default_coordinate_translator.h"
 #include "unsupported_coordinate_translator.h"
 #include "timeout_application_not_responding_detector.h"
+#include "basic_idle_hub.h"
 #include "mir/options/program_option.h"
 #include "mir/options/default_configuration.h"
 #include "mir/graphics/display_configuration.h"
@@ -254,6 +255,15 @@ auto mir::DefaultServerConfiguration::the_application_not_responding_detector()
         });
 }
 
+auto mir::DefaultServerConfiguration::the_idle_hub() -> std::shared_ptr<ms::IdleHub>
+{
+    return idle_hub(
+        [this]()
+        {
+            return std::make_shared<ms::BasicIdleHub>(*the_main_loop());
+        });
+}
+
 auto mir::DefaultServerConfiguration::wrap_application_not_responding_detector(
     std::shared_ptr<scene::ApplicationNotRespondingDetector> const& wrapped)
         -> std::shared_ptr<scene::ApplicationNotRespondingDetector>
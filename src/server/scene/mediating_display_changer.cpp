@@ -182,6 +182,8 @@ ms::MediatingDisplayChanger::MediatingDisplayChanger(
       observer{observer},
       base_configuration_{display->configuration()},
       base_configuration_applied{true},
+      applied_configuration{base_configuration_},
+      outputs_off{false},
       alarm_factory{alarm_factory},
       session_observer{std::make_unique<SessionObserver>(this)}
 {
@@ -463,24 +465,41 @@ bool configuration_has_new_outputs_enabled(
         });
     return has_new_output;
 }
+
+auto with_outputs_off(mg::DisplayConfiguration const& conf) -> std::shared_ptr<mg::DisplayConfiguration>
+{
+    std::shared_ptr<mg::DisplayConfiguration> const result{conf.clone()};
+    result->for_each_output(
+        [](mg::UserDisplayConfigurationOutput& output)
+        {
+            if (output.used)
+            {
+                output.power_mode = mir_power_mode_off;
+            }
+        });
+    return result;
+}
 }
 
 void ms::MediatingDisplayChanger::apply_config(
     std::shared_ptr<graphics::DisplayConfiguration> const& conf)
 {
+    auto const to_apply = outputs_off ? with_outputs_off(*conf) : conf;
+
     auto existing_configuration = display->configuration();
     try
     {
-        if (configuration_has_new_outputs_enabled(*display->configuration(), *conf) ||
-            !display->apply_if_configuration_preserves_display_buffers(*conf))
+        if (configuration_has_new_outputs_enabled(*display->configuration(), *to_apply) ||
+            !display->apply_if_configuration_preserves_display_buffers(*to_apply))
         {
             ApplyNowAndRevertOnScopeExit comp{
                 [this] { compositor->stop(); },
                 [this] { compositor->start(); }};
-            display->configure(*conf);
+            display->configure(*to_apply);
         }
 
-        observer->configuration_applied(conf);
+        observer->configuration_applied(to_apply);
+        applied_configuration = conf;
         base_configuration_applied = false;
     }
     catch (std::exception const& e)
@@ -597,3 +616,27 @@ void ms::MediatingDisplayChanger::set_base_configuration(std::shared_ptr<mg::Dis
         });
 }
 
+bool ms::MediatingDisplayChanger::set_outputs_off(bool off)
+{
+    std::lock_guard<std::mutex> lg{configuration_mutex};
+
+    if (off == outputs_off)
+    {
+        return true;
+    }
+
+    outputs_off = off;
+    try
+    {
+        if (base_configuration_applied)
+            apply_base_config();
+        else
+            apply_config(applied_configuration);
+    }
+    catch (std::exception const&)
+    {
+        outputs_off = !off;
+        return false;
+    }
+    return true;
+}
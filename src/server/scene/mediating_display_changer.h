@@ -92,6 +92,7 @@ public:
 
     /* From shell::DisplayConfigurationController */
     void set_base_configuration(std::shared_ptr<graphics::DisplayConfiguration> const &conf) override;
+    bool set_outputs_off(bool off) override;
 
 private:
     void focus_change_handler(std::shared_ptr<Session> const& session);
@@ -117,6 +118,9 @@ private:
     std::weak_ptr<scene::Session> focused_session;
     std::shared_ptr<graphics::DisplayConfiguration> base_configuration_;
     bool base_configuration_applied;
+    /// The configuration last applied, as it was asked for (i.e. before turning the outputs off)
+    std::shared_ptr<graphics::DisplayConfiguration> applied_configuration;
+    bool outputs_off;
     std::shared_ptr<time::AlarmFactory> const alarm_factory;
     std::unique_ptr<time::Alarm> preview_configuration_timeout;
     std::weak_ptr<scene::Session> currently_previewing_session;
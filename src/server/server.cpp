@@ -402,6 +402,9 @@ void mir::Server::run()
         // keep the default_reports alive while the server is running
         auto const default_reports = self->server_config->default_reports();
 
+        // and the idle handler (created once the display server exists)
+        std::shared_ptr<void> idle_handler;
+
         self->temporary_event_filter->move_filters(composite_event_filter);
 
         if (self->emergency_cleanup_handler)
@@ -412,7 +415,10 @@ void mir::Server::run()
         run_mir(
             *self->server_config,
             [&](DisplayServer&)
-                { self->init_callback(); self->init_callback = []{}; },
+                {
+                    idle_handler = self->server_config->the_idle_handler();
+                    self->init_callback(); self->init_callback = []{};
+                },
             self->terminator);
 
         self->exit_status = true;
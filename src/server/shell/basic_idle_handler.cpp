@@ -0,0 +1,293 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "basic_idle_handler.h"
+
+#include "mir/compositor/compositor.h"
+#include "mir/geometry/rectangles.h"
+#include "mir/graphics/buffer.h"
+#include "mir/graphics/display_configuration.h"
+#include "mir/graphics/graphic_buffer_allocator.h"
+#include "mir/graphics/renderable.h"
+#include "mir/input/scene.h"
+#include "mir/renderer/sw/pixel_source.h"
+#include "mir/scene/idle_hub.h"
+#include "mir/server_action_queue.h"
+#include "mir/shell/display_configuration_controller.h"
+
+#include <mutex>
+
+namespace msh = mir::shell;
+namespace ms = mir::scene;
+namespace mg = mir::graphics;
+namespace mi = mir::input;
+namespace mc = mir::compositor;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+using namespace std::chrono_literals;
+
+namespace
+{
+/// How long before the outputs are turned off that they are dimmed
+auto const dim_period = 10s;
+float const dim_alpha = 0.5f;
+
+/// A translucent black renderable covering the whole desktop
+class DimmingRenderable : public mg::Renderable
+{
+public:
+    DimmingRenderable(std::shared_ptr<mg::Buffer> const& buffer, geom::Rectangle const& area)
+        : buffer_{buffer},
+          area{area}
+    {
+    }
+
+    unsigned int swap_interval() const override
+    {
+        return 1;
+    }
+
+    bool tearing_allowed() const override
+    {
+        return false;
+    }
+
+    mg::Renderable::ID id() const override
+    {
+        return this;
+    }
+
+    std::shared_ptr<mg::Buffer> buffer() const override
+    {
+        return buffer_;
+    }
+
+    geom::Rectangle screen_position() const override
+    {
+        return area;
+    }
+
+    std::experimental::optional<geom::Rectangle> clip_area() const override
+    {
+        return std::experimental::optional<geom::Rectangle>();
+    }
+
+    std::experimental::optional<geom::Rectangle> src_bounds() const override
+    {
+        return std::experimental::optional<geom::Rectangle>();
+    }
+
+    float alpha() const override
+    {
+        return dim_alpha;
+    }
+
+    glm::mat4 transformation() const override
+    {
+        return glm::mat4();
+    }
+
+    bool shaped() const override
+    {
+        return true;
+    }
+
+private:
+    std::shared_ptr<mg::Buffer> const buffer_;
+    geom::Rectangle const area;
+};
+
+class Dimmer : public ms::IdleStateObserver
+{
+public:
+    Dimmer(
+        std::shared_ptr<mi::Scene> const& input_scene,
+        std::shared_ptr<mg::GraphicBufferAllocator> const& allocator,
+        std::shared_ptr<msh::DisplayConfigurationController> const& display_config_controller)
+        : input_scene{input_scene},
+          allocator{allocator},
+          display_config_controller{display_config_controller}
+    {
+    }
+
+    ~Dimmer()
+    {
+        active();
+    }
+
+    void idle() override
+    {
+        geom::Rectangles outputs;
+        display_config_controller->base_configuration()->for_each_output(
+            [&](mg::DisplayConfigurationOutput const& output)
+            {
+                if (output.used)
+                {
+                    outputs.add(output.extents());
+                }
+            });
+
+        uint32_t const black{0xff000000};
+        auto const buffer = mrs::alloc_buffer_with_content(
+            *allocator,
+            reinterpret_cast<unsigned char const*>(&black),
+            geom::Size{1, 1},
+            geom::Stride{sizeof(black)},
+            mir_pixel_format_argb_8888);
+        auto const renderable = std::make_shared<DimmingRenderable>(buffer, outputs.bounding_rectangle());
+
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (overlay)
+            {
+                return;
+            }
+            overlay = renderable;
+        }
+
+        input_scene->add_input_visualization(renderable);
+        input_scene->emit_scene_changed();
+    }
+
+    void active() override
+    {
+        std::shared_ptr<mg::Renderable> removed;
+
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            std::swap(removed, overlay);
+        }
+
+        if (removed)
+        {
+            input_scene->remove_input_visualization(removed);
+            input_scene->emit_scene_changed();
+        }
+    }
+
+private:
+    std::shared_ptr<mi::Scene> const input_scene;
+    std::shared_ptr<mg::GraphicBufferAllocator> const allocator;
+    std::shared_ptr<msh::DisplayConfigurationController> const display_config_controller;
+
+    std::mutex mutex;
+    std::shared_ptr<mg::Renderable> overlay;
+};
+
+/// Turns the outputs off and stops compositing until there is activity again
+class PowerOff : public ms::IdleStateObserver
+{
+public:
+    PowerOff(
+        std::shared_ptr<msh::DisplayConfigurationController> const& display_config_controller,
+        std::shared_ptr<mc::Compositor> const& compositor,
+        std::shared_ptr<mir::ServerActionQueue> const& action_queue)
+        : display_config_controller{display_config_controller},
+          compositor{compositor},
+          action_queue{action_queue}
+    {
+    }
+
+    ~PowerOff()
+    {
+        action_queue->pause_processing_for(this);
+    }
+
+    void idle() override
+    {
+        action_queue->enqueue(this, [this]()
+            {
+                if (powered_off)
+                {
+                    return;
+                }
+
+                // This turns off whatever configuration is applied, which may be a client's
+                // rather than the base configuration
+                if (!display_config_controller->set_outputs_off(true))
+                {
+                    return;
+                }
+                powered_off = true;
+
+                // Nothing is visible, so there's no point in compositing
+                compositor->stop();
+            });
+    }
+
+    void active() override
+    {
+        action_queue->enqueue(this, [this]()
+            {
+                if (!powered_off)
+                {
+                    return;
+                }
+
+                // Start compositing first, so the outputs have something to show when they come on
+                compositor->start();
+                display_config_controller->set_outputs_off(false);
+                powered_off = false;
+            });
+    }
+
+private:
+    std::shared_ptr<msh::DisplayConfigurationController> const display_config_controller;
+    std::shared_ptr<mc::Compositor> const compositor;
+    std::shared_ptr<mir::ServerActionQueue> const action_queue;
+
+    /// Only accessed from the action queue
+    bool powered_off{false};
+};
+}
+
+msh::BasicIdleHandler::BasicIdleHandler(
+    std::shared_ptr<ms::IdleHub> const& idle_hub,
+    std::shared_ptr<mi::Scene> const& input_scene,
+    std::shared_ptr<mg::GraphicBufferAllocator> const& allocator,
+    std::shared_ptr<DisplayConfigurationController> const& display_config_controller,
+    std::shared_ptr<mc::Compositor> const& compositor,
+    std::shared_ptr<ServerActionQueue> const& action_queue,
+    std::chrono::milliseconds off_timeout)
+    : idle_hub{idle_hub}
+{
+    if (off_timeout <= off_timeout.zero())
+    {
+        return;
+    }
+
+    power_off = std::make_shared<PowerOff>(display_config_controller, compositor, action_queue);
+    idle_hub->register_interest(power_off, off_timeout);
+
+    if (off_timeout > dim_period)
+    {
+        dimmer = std::make_shared<Dimmer>(input_scene, allocator, display_config_controller);
+        idle_hub->register_interest(dimmer, off_timeout - dim_period);
+    }
+}
+
+msh::BasicIdleHandler::~BasicIdleHandler()
+{
+    if (dimmer)
+    {
+        idle_hub->unregister_interest(*dimmer);
+    }
+    if (power_off)
+    {
+        idle_hub->unregister_interest(*power_off);
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SHELL_BASIC_IDLE_HANDLER_H_
+#define MIR_SHELL_BASIC_IDLE_HANDLER_H_
+
+#include <chrono>
+#include <memory>
+
+namespace mir
+{
+class ServerActionQueue;
+namespace compositor
+{
+class Compositor;
+}
+namespace graphics
+{
+class GraphicBufferAllocator;
+}
+namespace input
+{
+class Scene;
+}
+namespace scene
+{
+class IdleHub;
+class IdleStateObserver;
+}
+namespace shell
+{
+class DisplayConfigurationController;
+
+/**
+ * Dims the outputs shortly before turning them off after off_timeout without user activity, and stops the
+ * compositor while they are off. A zero off_timeout disables this.
+ */
+class BasicIdleHandler
+{
+public:
+    BasicIdleHandler(
+        std::shared_ptr<scene::IdleHub> const& idle_hub,
+        std::shared_ptr<input::Scene> const& input_scene,
+        std::shared_ptr<graphics::GraphicBufferAllocator> const& allocator,
+        std::shared_ptr<DisplayConfigurationController> const& display_config_controller,
+        std::shared_ptr<compositor::Compositor> const& compositor,
+        std::shared_ptr<ServerActionQueue> const& action_queue,
+        std::chrono::milliseconds off_timeout);
+
+    ~BasicIdleHandler();
+
+private:
+    BasicIdleHandler(BasicIdleHandler const&) = delete;
+    BasicIdleHandler& operator=(BasicIdleHandler const&) = delete;
+
+    std::shared_ptr<scene::IdleHub> const idle_hub;
+    std::shared_ptr<scene::IdleStateObserver> dimmer;
+    std::shared_ptr<scene::IdleStateObserver> power_off;
+};
+}
+}
+
+#endif // MIR_SHELL_BASIC_IDLE_HANDLER_H_
@@ -0,0 +1,114 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "glyph_cache.h"
+
+#include "mir/log.h"
+
+#include <stdexcept>
+
+namespace geom = mir::geometry;
+namespace msd = mir::shell::decoration;
+
+namespace
+{
+char32_t const ellipsis_codepoint{U'\u2026'}; // …
+}
+
+msd::GlyphCache::GlyphCache(size_t capacity, Rasterize rasterize)
+    : capacity{capacity},
+      rasterize{std::move(rasterize)}
+{
+}
+
+auto msd::GlyphCache::glyph(char32_t codepoint, geom::Height height) -> std::shared_ptr<Glyph const>
+{
+    Key const key{codepoint, height.as_int()};
+
+    auto const existing = glyphs.find(key);
+    if (existing != glyphs.end())
+    {
+        lru.splice(lru.begin(), lru, existing->second.lru_position);
+        return existing->second.glyph;
+    }
+
+    auto result = rasterize(codepoint, height);
+
+    // Layouts keep the glyphs they use alive, so evicting one doesn't affect titles already laid out
+    if (glyphs.size() >= capacity && !lru.empty())
+    {
+        glyphs.erase(lru.back());
+        lru.pop_back();
+    }
+
+    lru.push_front(key);
+    glyphs[key] = Entry{result, lru.begin()};
+    return result;
+}
+
+auto msd::GlyphCache::size() const -> size_t
+{
+    return glyphs.size();
+}
+
+auto msd::lay_out_line(
+    GlyphCache& cache,
+    std::u32string const& text,
+    geom::Height height,
+    geom::Width max_width) -> std::vector<PlacedGlyph>
+{
+    auto const try_glyph = [&](char32_t codepoint) -> std::shared_ptr<Glyph const>
+        {
+            try
+            {
+                return cache.glyph(codepoint, height);
+            }
+            catch (std::runtime_error const& error)
+            {
+                log_warning("%s", error.what());
+                return nullptr;
+            }
+        };
+
+    std::vector<PlacedGlyph> result;
+    geom::Displacement pen;
+
+    for (char32_t const codepoint : text)
+    {
+        if (auto const glyph = try_glyph(codepoint))
+        {
+            result.push_back({glyph, pen + glyph->offset});
+            pen = pen + glyph->advance;
+        }
+    }
+
+    if (pen.dx <= as_delta(max_width))
+        return result;
+
+    auto const ellipsis = try_glyph(ellipsis_codepoint);
+    geom::DeltaX const ellipsis_width = ellipsis ? ellipsis->advance.dx : geom::DeltaX{};
+
+    while (!result.empty() && pen.dx + ellipsis_width > as_delta(max_width))
+    {
+        pen = result.back().top_left - result.back().glyph->offset;
+        result.pop_back();
+    }
+
+    if (ellipsis && pen.dx + ellipsis_width <= as_delta(max_width))
+        result.push_back({ellipsis, pen + ellipsis->offset});
+
+    return result;
+}
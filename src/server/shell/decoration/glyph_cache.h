@@ -0,0 +1,90 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SHELL_DECORATION_GLYPH_CACHE_H_
+#define MIR_SHELL_DECORATION_GLYPH_CACHE_H_
+
+#include "mir/geometry/displacement.h"
+#include "mir/geometry/size.h"
+
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mir
+{
+namespace shell
+{
+namespace decoration
+{
+/// A rasterized glyph; immutable once cached, so it can be drawn without holding the font lock
+struct Glyph
+{
+    geometry::Displacement offset;  ///< From the pen position to the top left of the coverage
+    geometry::Displacement advance;
+    geometry::Size size;
+    std::vector<unsigned char> coverage;  ///< size.width × size.height, rows tightly packed
+};
+
+struct PlacedGlyph
+{
+    std::shared_ptr<Glyph const> glyph;
+    geometry::Displacement top_left;    ///< Relative to the top left of the text
+};
+
+/// Rasterized glyphs keyed by codepoint and pixel height, evicting the least recently used once full
+/// \note Not threadsafe
+class GlyphCache
+{
+public:
+    /// Should throw a std::runtime_error if the glyph can't be rasterized
+    using Rasterize = std::function<std::shared_ptr<Glyph const>(char32_t codepoint, geometry::Height height)>;
+
+    GlyphCache(size_t capacity, Rasterize rasterize);
+
+    auto glyph(char32_t codepoint, geometry::Height height) -> std::shared_ptr<Glyph const>;
+    auto size() const -> size_t;
+
+private:
+    using Key = std::pair<char32_t, int>;
+
+    struct Entry
+    {
+        std::shared_ptr<Glyph const> glyph;
+        std::list<Key>::iterator lru_position;
+    };
+
+    size_t const capacity;
+    Rasterize const rasterize;
+    std::map<Key, Entry> glyphs;
+    std::list<Key> lru; ///< Most recently used first
+};
+
+/// Lays out a single line of text from the origin, skipping glyphs that can't be rasterized
+/// If the line is wider than max_width it is cut short and ends in an ellipsis
+auto lay_out_line(
+    GlyphCache& cache,
+    std::u32string const& text,
+    geometry::Height height,
+    geometry::Width max_width) -> std::vector<PlacedGlyph>;
+}
+}
+}
+
+#endif // MIR_SHELL_DECORATION_GLYPH_CACHE_H_
@@ -22,17 +22,22 @@
 #include "input.h"
 
 #include "mir/graphics/graphic_buffer_allocator.h"
+#include "mir/graphics/solid_color_buffer.h"
 #include "mir/renderer/sw/pixel_source.h"
 #include "mir/geometry/displacement.h"
 #include "mir/log.h"
 
+#include "mir/renderer/sw/blend.h"
+
 #include <boost/throw_exception.hpp>
 #include <boost/filesystem.hpp>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#include <algorithm>
 #include <locale>
 #include <codecvt>
+#include <map>
 
 namespace ms = mir::scene;
 namespace mg = mir::graphics;
@@ -88,6 +93,9 @@ char const* const font_path_search_paths[]{
     "/usr/share/fonts",             // Fedora/Arch
 };
 
+// Enough for a few sizes of several scripts; titles keep the glyphs they use alive past eviction
+size_t const max_cached_glyphs = 4096;
+
 inline auto area(geom::Size size) -> size_t
 {
     return (size.width > geom::Width{} && size.height > geom::Height{})
@@ -106,10 +114,10 @@ inline void render_row(
         return;
     geom::X const right = std::min(left.x + as_delta(length), as_x(buf_size.width));
     left.x = std::max(left.x, geom::X{});
+    if (right <= left.x)
+        return;
     uint32_t* const start = data + (left.y.as_int() * buf_size.width.as_int()) + left.x.as_int();
-    uint32_t* const end = start + right.as_int() - left.x.as_int();
-    for (uint32_t* i = start; i < end; i++)
-        *i = color;
+    std::fill_n(start, (right - left.x).as_int(), color);
 }
 
 inline void render_close_icon(
@@ -169,6 +177,12 @@ inline void render_minimize_icon(
 }
 }
 
+class msd::Renderer::Text::Layout
+{
+public:
+    std::vector<PlacedGlyph> glyphs;
+};
+
 class msd::Renderer::Text::Impl
     : public Text
 {
@@ -176,25 +190,35 @@ public:
     Impl();
     ~Impl();
 
+    auto layout(
+        std::string const& text,
+        geom::Height height_pixels,
+        geom::Width max_width) -> std::shared_ptr<Layout const> override;
+
     void render(
         Pixel* buf,
         geom::Size buf_size,
-        std::string const& text,
+        std::shared_ptr<Layout const> const& layout,
         geom::Point top_left,
-        geom::Height height_pixels,
         Pixel color) override;
 
 private:
     std::mutex mutex;
     FT_Library library;
     FT_Face face;
+    geom::Height char_size;
+
+    /// Shared by the decorations of every window
+    GlyphCache glyph_cache;
 
+    auto rasterize(char32_t glyph, geom::Height height) -> std::shared_ptr<Glyph const>;
     void set_char_size(geom::Height height);
     void rasterize_glyph(char32_t glyph);
-    void render_glyph(
+
+    static void render_glyph(
         Pixel* buf,
         geom::Size buf_size,
-        FT_Bitmap const* glyph,
+        Glyph const& glyph,
         geom::Point top_left,
         Pixel color);
 
@@ -206,12 +230,16 @@ class msd::Renderer::Text::Null
     : public Text
 {
 public:
+    auto layout(std::string const&, geom::Height, geom::Width) -> std::shared_ptr<Layout const> override
+    {
+        return nullptr;
+    }
+
     void render(
         Pixel*,
         geom::Size,
-        std::string const&,
+        std::shared_ptr<Layout const> const&,
         geom::Point,
-        geom::Height,
         Pixel) override
     {
     }
@@ -243,6 +271,9 @@ auto msd::Renderer::Text::instance() -> std::shared_ptr<Text>
 }
 
 msd::Renderer::Text::Impl::Impl()
+    : glyph_cache{
+        max_cached_glyphs,
+        [this](char32_t glyph, geom::Height height) { return rasterize(glyph, height); }}
 {
     if (auto const error = FT_Init_FreeType(&library))
         BOOST_THROW_EXCEPTION(std::runtime_error(
@@ -271,59 +302,68 @@ msd::Renderer::Text::Impl::~Impl()
     library = nullptr;
 }
 
-void msd::Renderer::Text::Impl::render(
-    Pixel* buf,
-    geom::Size buf_size,
+auto msd::Renderer::Text::Impl::layout(
     std::string const& text,
-    geom::Point top_left,
     geom::Height height_pixels,
-    Pixel color)
+    geom::Width max_width) -> std::shared_ptr<Layout const>
 {
-    if (!area(buf_size) || height_pixels <= geom::Height{})
-        return;
+    if (height_pixels <= geom::Height{})
+        return nullptr;
 
     std::lock_guard<std::mutex> lock{mutex};
 
     if (!library || !face)
     {
         log_warning("FreeType not initialized");
-        return;
+        return nullptr;
     }
 
-    try
-    {
-        set_char_size(height_pixels);
-    }
-    catch (std::runtime_error const& error)
-    {
-        log_warning("%s", error.what());
+    auto const result = std::make_shared<Layout>();
+    result->glyphs = lay_out_line(glyph_cache, utf8_to_utf32(text), height_pixels, max_width);
+    return result;
+}
+
+void msd::Renderer::Text::Impl::render(
+    Pixel* buf,
+    geom::Size buf_size,
+    std::shared_ptr<Layout const> const& layout,
+    geom::Point top_left,
+    Pixel color)
+{
+    if (!layout || !area(buf_size))
         return;
-    }
 
-    auto const utf32 = utf8_to_utf32(text);
+    for (auto const& placed : layout->glyphs)
+        render_glyph(buf, buf_size, *placed.glyph, top_left + placed.top_left, color);
+}
 
-    for (char32_t const glyph : utf32)
+auto msd::Renderer::Text::Impl::rasterize(
+    char32_t glyph,
+    geom::Height height) -> std::shared_ptr<Glyph const>
+{
+    if (height != char_size)
     {
-        try
-        {
-            rasterize_glyph(glyph);
-
-            geom::Point glyph_top_left =
-                top_left +
-                geom::Displacement{
-                    face->glyph->bitmap_left,
-                    height_pixels.as_int() - face->glyph->bitmap_top};
-            render_glyph(buf, buf_size, &face->glyph->bitmap, glyph_top_left, color);
-
-            top_left += geom::Displacement{
-                face->glyph->advance.x / 64,
-                face->glyph->advance.y / 64};
-        }
-        catch (std::runtime_error const& error)
-        {
-            log_warning("%s", error.what());
-        }
+        set_char_size(height);
+        char_size = height;
+    }
+    rasterize_glyph(glyph);
+
+    auto const slot = face->glyph;
+    auto const& bitmap = slot->bitmap;
+    auto result = std::make_shared<Glyph>();
+    result->offset = {slot->bitmap_left, height.as_int() - slot->bitmap_top};
+    result->advance = {slot->advance.x / 64, slot->advance.y / 64};
+    result->size = {bitmap.width, bitmap.rows};
+    result->coverage.resize(bitmap.width * bitmap.rows);
+    for (unsigned row = 0; row < bitmap.rows; row++)
+    {
+        std::copy_n(
+            bitmap.buffer + row * bitmap.pitch,
+            bitmap.width,
+            result->coverage.data() + row * bitmap.width);
     }
+
+    return result;
 }
 
 void msd::Renderer::Text::Impl::set_char_size(geom::Height height)
@@ -349,40 +389,31 @@ void msd::Renderer::Text::Impl::rasterize_glyph(char32_t glyph)
 void msd::Renderer::Text::Impl::render_glyph(
     Pixel* buf,
     geom::Size buf_size,
-    FT_Bitmap const* glyph,
+    Glyph const& glyph,
     geom::Point top_left,
     Pixel color)
 {
     geom::X const buffer_left = std::max(top_left.x, geom::X{});
-    geom::X const buffer_right = std::min(top_left.x + geom::DeltaX{glyph->width}, as_x(buf_size.width));
+    geom::X const buffer_right = std::min(top_left.x + as_delta(glyph.size.width), as_x(buf_size.width));
 
     geom::Y const buffer_top = std::max(top_left.y, geom::Y{});
-    geom::Y const buffer_bottom = std::min(top_left.y + geom::DeltaY{glyph->rows}, as_y(buf_size.height));
+    geom::Y const buffer_bottom = std::min(top_left.y + as_delta(glyph.size.height), as_y(buf_size.height));
 
-    geom::Displacement const glyph_offset = as_displacement(top_left);
+    if (buffer_right <= buffer_left)
+        return;
 
-    unsigned char* const color_pixels = (unsigned char *)&color;
-    unsigned char const color_alpha = color_pixels[3];
+    geom::Displacement const glyph_offset = as_displacement(top_left);
+    int const glyph_width = glyph.size.width.as_int();
+    geom::X const glyph_left = buffer_left - glyph_offset.dx;
 
     for (geom::Y buffer_y = buffer_top; buffer_y < buffer_bottom; buffer_y += geom::DeltaY{1})
     {
         geom::Y const glyph_y = buffer_y - glyph_offset.dy;
-        unsigned char* const glyph_row = glyph->buffer + glyph_y.as_int() * glyph->pitch;
-        Pixel* const buffer_row = buf + buffer_y.as_int() * buf_size.width.as_int();
-
-        for (geom::X buffer_x = buffer_left; buffer_x < buffer_right; buffer_x += geom::DeltaX{1})
-        {
-            geom::X const glyph_x = buffer_x - glyph_offset.dx;
-            unsigned char const glyph_alpha = ((int)glyph_row[glyph_x.as_int()] * color_alpha) / 255;
-            unsigned char* const buffer_pixels = (unsigned char *)(buffer_row + buffer_x.as_int());
-            for (int i = 0; i < 3; i++)
-            {
-                // Blend color with the previous buffer color based on the glyph's alpha
-                buffer_pixels[i] =
-                    ((int)buffer_pixels[i] * (255 - glyph_alpha)) / 255 +
-                    ((int)color_pixels[i] * glyph_alpha) / 255;
-            }
-        }
+        mrs::blend_coverage(
+            buf + buffer_y.as_int() * buf_size.width.as_int() + buffer_left.as_int(),
+            glyph.coverage.data() + glyph_y.as_int() * glyph_width + glyph_left.as_int(),
+            (buffer_right - buffer_left).as_int(),
+            color);
     }
 }
 
@@ -472,17 +503,6 @@ void msd::Renderer::update_state(WindowState const& window_state, InputState con
     right_border_size = window_state.right_border_rect().size;
     bottom_border_size = window_state.bottom_border_rect().size;
 
-    size_t length{0};
-    length = std::max(length, area(left_border_size));
-    length = std::max(length, area(right_border_size));
-    length = std::max(length, area(bottom_border_size));
-
-    if (length != solid_color_pixels_length)
-    {
-        solid_color_pixels_length = length;
-        solid_color_pixels.reset(); // force a reallocation next time it's needed
-    }
-
     if (window_state.titlebar_rect().size != titlebar_size)
     {
         titlebar_size = window_state.titlebar_rect().size;
@@ -497,12 +517,12 @@ void msd::Renderer::update_state(WindowState const& window_state, InputState con
     {
         current_theme = new_theme;
         needs_titlebar_redraw = true;
-        needs_solid_color_redraw = true;
     }
 
     if (window_state.window_name() != name)
     {
         name = window_state.window_name();
+        title_layout.reset(); // force a relayout next time it's needed
         needs_titlebar_redraw = true;
     }
 
@@ -525,6 +545,19 @@ void msd::Renderer::update_state(WindowState const& window_state, InputState con
         buttons = input_state.buttons();
         needs_titlebar_buttons_redraw = true;
     }
+
+    geom::X title_right = as_x(titlebar_size.width);
+    for (auto const& button : buttons)
+        title_right = std::min(title_right, button.rect.left());
+    auto const new_title_width =
+        as_width(std::max(title_right - static_geometry->title_font_top_left.x, geom::DeltaX{}));
+
+    if (new_title_width != title_width)
+    {
+        title_width = new_title_width;
+        title_layout.reset();
+        needs_titlebar_redraw = true;
+    }
 }
 
 auto msd::Renderer::render_titlebar() -> std::experimental::optional<std::shared_ptr<mg::Buffer>>
@@ -548,12 +581,14 @@ auto msd::Renderer::render_titlebar() -> std::experimental::optional<std::shared
                 current_theme->background_color);
         }
 
+        if (!title_layout)
+            title_layout = text->layout(name, static_geometry->title_font_height, title_width);
+
         text->render(
             titlebar_pixels.get(),
             titlebar_size,
-            name,
+            title_layout,
             static_geometry->title_font_top_left,
-            static_geometry->title_font_height,
             current_theme->text_color);
     }
 
@@ -602,45 +637,27 @@ auto msd::Renderer::render_titlebar() -> std::experimental::optional<std::shared
 
 auto msd::Renderer::render_left_border() -> std::experimental::optional<std::shared_ptr<mg::Buffer>>
 {
-    if (!area(left_border_size))
-        return std::experimental::nullopt;
-    update_solid_color_pixels();
-    return make_buffer(solid_color_pixels.get(), left_border_size);
+    return make_solid_color_buffer(left_border_size);
 }
 
 auto msd::Renderer::render_right_border() -> std::experimental::optional<std::shared_ptr<mg::Buffer>>
 {
-    if (!area(right_border_size))
-        return std::experimental::nullopt;
-    update_solid_color_pixels();
-    return make_buffer(solid_color_pixels.get(), right_border_size);
+    return make_solid_color_buffer(right_border_size);
 }
 
 auto msd::Renderer::render_bottom_border() -> std::experimental::optional<std::shared_ptr<mg::Buffer>>
 {
-    if (!area(bottom_border_size))
-        return std::experimental::nullopt;
-    update_solid_color_pixels();
-    return make_buffer(solid_color_pixels.get(), bottom_border_size);
+    return make_solid_color_buffer(bottom_border_size);
 }
 
-void msd::Renderer::update_solid_color_pixels()
+auto msd::Renderer::make_solid_color_buffer(
+    geometry::Size size) -> std::experimental::optional<std::shared_ptr<mg::Buffer>>
 {
-    if (!solid_color_pixels)
-    {
-        solid_color_pixels = alloc_pixels(geom::Size{solid_color_pixels_length, 1});
-        needs_solid_color_redraw = true;
-    }
-
-    if (needs_solid_color_redraw)
-    {
-        render_row(
-            solid_color_pixels.get(), geom::Size{solid_color_pixels_length, 1},
-            geom::Point{}, geom::Width{solid_color_pixels_length},
-            current_theme->background_color);
-    }
+    if (!area(size))
+        return std::experimental::nullopt;
 
-    needs_solid_color_redraw = false;
+    // The stream scales this to the border's size, so resizing needs no pixels drawn or uploaded
+    return std::make_shared<mg::SolidColorBuffer>(current_theme->background_color);
 }
 
 auto msd::Renderer::make_buffer(
@@ -22,6 +22,7 @@
 #include "mir/geometry/rectangle.h"
 
 #include "input.h"
+#include "glyph_cache.h"
 
 #include <memory>
 #include <map>
@@ -63,16 +64,25 @@ private:
     class Text
     {
     public:
+        /// Rasterized glyphs positioned relative to the top left of the text
+        class Layout;
+
         static auto instance() -> std::shared_ptr<Text>;
 
         virtual ~Text() = default;
 
+        /// May return nullptr if the text can't be rendered
+        /// Text wider than max_width is ellipsized
+        virtual auto layout(
+            std::string const& text,
+            geometry::Height height_pixels,
+            geometry::Width max_width) -> std::shared_ptr<Layout const> = 0;
+
         virtual void render(
             Pixel* buf,
             geometry::Size buf_size,
-            std::string const& text,
+            std::shared_ptr<Layout const> const& layout,
             geometry::Point top_left,
-            geometry::Height height_pixels,
             Pixel color) = 0;
 
     private:
@@ -112,12 +122,9 @@ private:
     std::map<ButtonFunction, Icon const> button_icons;
     std::shared_ptr<StaticGeometry const> const static_geometry;
 
-    bool needs_solid_color_redraw{true};
     geometry::Size left_border_size;
     geometry::Size right_border_size;
     geometry::Size bottom_border_size;
-    size_t solid_color_pixels_length{0};
-    std::unique_ptr<Pixel[]> solid_color_pixels; // can be nullptr
 
     geometry::Size titlebar_size{};
     std::unique_ptr<Pixel[]> titlebar_pixels; // can be nullptr
@@ -128,8 +135,11 @@ private:
     std::vector<ButtonInfo> buttons;
 
     std::shared_ptr<Text> const text;
+    std::shared_ptr<Text::Layout const> title_layout; // laid out on first use after the name or width changes
+    geometry::Width title_width{}; // space left of the buttons
 
-    void update_solid_color_pixels();
+    auto make_solid_color_buffer(
+        geometry::Size size) -> std::experimental::optional<std::shared_ptr<graphics::Buffer>>;
     auto make_buffer(
         Pixel const* pixels,
         geometry::Size size) -> std::experimental::optional<std::shared_ptr<graphics::Buffer>>;
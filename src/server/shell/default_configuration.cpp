@@ -28,6 +28,8 @@
 #include "graphics_display_layout.h"
 #include "decoration/basic_manager.h"
 #include "decoration/basic_decoration.h"
+#include "basic_idle_handler.h"
+#include "mir/options/configuration.h"
 
 namespace ms = mir::scene;
 namespace msh = mir::shell;
@@ -86,6 +88,24 @@ auto mir::DefaultServerConfiguration::the_decoration_manager() -> std::shared_pt
         });
 }
 
+auto mir::DefaultServerConfiguration::the_idle_handler() -> std::shared_ptr<msh::BasicIdleHandler>
+{
+    return idle_handler(
+        [this]()
+        {
+            std::chrono::seconds const off_timeout{the_options()->get<int>(options::idle_timeout_opt)};
+
+            return std::make_shared<msh::BasicIdleHandler>(
+                the_idle_hub(),
+                the_input_scene(),
+                the_buffer_allocator(),
+                the_display_configuration_controller(),
+                the_compositor(),
+                the_server_action_queue(),
+                off_timeout);
+        });
+}
+
 auto mir::DefaultServerConfiguration::wrap_shell(std::shared_ptr<msh::Shell> const& wrapped) -> std::shared_ptr<msh::Shell>
 {
     return wrapped;
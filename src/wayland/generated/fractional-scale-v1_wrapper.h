@@ -0,0 +1,100 @@
+/*
+ * AUTOGENERATED - DO NOT EDIT
+ *
+ * This file is generated from fractional-scale-v1.xml
+ * To regenerate, run the “refresh-wayland-wrapper” target.
+ */
+
+#ifndef MIR_FRONTEND_WAYLAND_FRACTIONAL_SCALE_V1_XML_WRAPPER
+#define MIR_FRONTEND_WAYLAND_FRACTIONAL_SCALE_V1_XML_WRAPPER
+
+#include <experimental/optional>
+
+#include "mir/fd.h"
+#include <wayland-server-core.h>
+
+#include "mir/wayland/wayland_base.h"
+
+namespace mir
+{
+namespace wayland
+{
+
+class FractionalScaleManagerV1;
+class FractionalScaleV1;
+
+class FractionalScaleManagerV1 : public Resource
+{
+public:
+    static char const constexpr* interface_name = "wp_fractional_scale_manager_v1";
+
+    static FractionalScaleManagerV1* from(struct wl_resource*);
+
+    FractionalScaleManagerV1(struct wl_resource* resource, Version<1>);
+    virtual ~FractionalScaleManagerV1();
+
+    void destroy_wayland_object() const;
+
+    struct wl_client* const client;
+    struct wl_resource* const resource;
+
+    struct Error
+    {
+        static uint32_t const fractional_scale_exists = 0;
+    };
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+    class Global : public wayland::Global
+    {
+    public:
+        Global(wl_display* display, Version<1>);
+
+        auto interface_name() const -> char const* override;
+
+    private:
+        virtual void bind(wl_resource* new_wp_fractional_scale_manager_v1) = 0;
+        friend FractionalScaleManagerV1::Thunks;
+    };
+
+private:
+    virtual void destroy() = 0;
+    virtual void get_fractional_scale(struct wl_resource* id, struct wl_resource* surface) = 0;
+};
+
+class FractionalScaleV1 : public Resource
+{
+public:
+    static char const constexpr* interface_name = "wp_fractional_scale_v1";
+
+    static FractionalScaleV1* from(struct wl_resource*);
+
+    FractionalScaleV1(struct wl_resource* resource, Version<1>);
+    virtual ~FractionalScaleV1();
+
+    void send_preferred_scale_event(uint32_t scale) const;
+
+    void destroy_wayland_object() const;
+
+    struct wl_client* const client;
+    struct wl_resource* const resource;
+
+    struct Opcode
+    {
+        static uint32_t const preferred_scale = 0;
+    };
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+private:
+    virtual void destroy() = 0;
+};
+
+}
+}
+
+#endif // MIR_FRONTEND_WAYLAND_FRACTIONAL_SCALE_V1_XML_WRAPPER
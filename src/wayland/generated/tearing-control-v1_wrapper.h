@@ -0,0 +1,100 @@
+/*
+ * AUTOGENERATED - DO NOT EDIT
+ *
+ * This file is generated from tearing-control-v1.xml
+ * To regenerate, run the “refresh-wayland-wrapper” target.
+ */
+
+#ifndef MIR_FRONTEND_WAYLAND_TEARING_CONTROL_V1_XML_WRAPPER
+#define MIR_FRONTEND_WAYLAND_TEARING_CONTROL_V1_XML_WRAPPER
+
+#include <experimental/optional>
+
+#include "mir/fd.h"
+#include <wayland-server-core.h>
+
+#include "mir/wayland/wayland_base.h"
+
+namespace mir
+{
+namespace wayland
+{
+
+class TearingControlManagerV1;
+class TearingControlV1;
+
+class TearingControlManagerV1 : public Resource
+{
+public:
+    static char const constexpr* interface_name = "wp_tearing_control_manager_v1";
+
+    static TearingControlManagerV1* from(struct wl_resource*);
+
+    TearingControlManagerV1(struct wl_resource* resource, Version<1>);
+    virtual ~TearingControlManagerV1();
+
+    void destroy_wayland_object() const;
+
+    struct wl_client* const client;
+    struct wl_resource* const resource;
+
+    struct Error
+    {
+        static uint32_t const tearing_control_exists = 0;
+    };
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+    class Global : public wayland::Global
+    {
+    public:
+        Global(wl_display* display, Version<1>);
+
+        auto interface_name() const -> char const* override;
+
+    private:
+        virtual void bind(wl_resource* new_wp_tearing_control_manager_v1) = 0;
+        friend TearingControlManagerV1::Thunks;
+    };
+
+private:
+    virtual void destroy() = 0;
+    virtual void get_tearing_control(struct wl_resource* id, struct wl_resource* surface) = 0;
+};
+
+class TearingControlV1 : public Resource
+{
+public:
+    static char const constexpr* interface_name = "wp_tearing_control_v1";
+
+    static TearingControlV1* from(struct wl_resource*);
+
+    TearingControlV1(struct wl_resource* resource, Version<1>);
+    virtual ~TearingControlV1();
+
+    void destroy_wayland_object() const;
+
+    struct wl_client* const client;
+    struct wl_resource* const resource;
+
+    struct PresentationHint
+    {
+        static uint32_t const vsync = 0;
+        static uint32_t const async = 1;
+    };
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+private:
+    virtual void set_presentation_hint(uint32_t hint) = 0;
+    virtual void destroy() = 0;
+};
+
+}
+}
+
+#endif // MIR_FRONTEND_WAYLAND_TEARING_CONTROL_V1_XML_WRAPPER
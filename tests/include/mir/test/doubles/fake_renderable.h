@@ -100,16 +100,38 @@ public:
         return std::experimental::optional<geometry::Rectangle>();
     }
 
+    void set_src_bounds(std::experimental::optional<geometry::Rectangle> const& bounds)
+    {
+        src = bounds;
+    }
+
+    std::experimental::optional<geometry::Rectangle> src_bounds() const override
+    {
+        return src;
+    }
+
     unsigned int swap_interval() const override
     {
         return 1u;
     }
 
+    void set_tearing_allowed(bool allowed)
+    {
+        tearing = allowed;
+    }
+
+    bool tearing_allowed() const override
+    {
+        return tearing;
+    }
+
 private:
     std::shared_ptr<graphics::Buffer> buf;
     mir::geometry::Rectangle rect;
+    std::experimental::optional<geometry::Rectangle> src;
     float opacity;
     bool rectangular;
+    bool tearing{false};
 };
 
 } // namespace doubles
@@ -66,6 +66,8 @@ struct MockBufferStream : public compositor::BufferStream
     MOCK_METHOD0(force_client_completion, void());
     MOCK_METHOD1(allow_framedropping, void(bool));
     MOCK_CONST_METHOD0(framedropping, bool());
+    MOCK_METHOD1(set_tearing_allowed, void(bool));
+    MOCK_CONST_METHOD0(tearing_allowed, bool());
 
     MOCK_CONST_METHOD1(buffers_ready_for_compositor, int(void const*));
     MOCK_METHOD0(drop_old_buffers, void());
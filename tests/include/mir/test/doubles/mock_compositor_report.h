@@ -43,6 +43,10 @@ public:
                  void(compositor::CompositorReport::SubCompositorId));
     MOCK_METHOD1(finished_frame,
                  void(compositor::CompositorReport::SubCompositorId));
+    MOCK_METHOD3(frame_stage_timing,
+                 void(compositor::CompositorReport::SubCompositorId,
+                      compositor::CompositorReport::FrameStage,
+                      std::chrono::nanoseconds));
     MOCK_METHOD0(started, void());
     MOCK_METHOD0(stopped, void());
     MOCK_METHOD0(scheduled, void());
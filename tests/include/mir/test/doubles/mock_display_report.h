@@ -41,6 +41,7 @@ public:
     MOCK_METHOD1(report_drm_master_failure, void(int));
     MOCK_METHOD0(report_vt_switch_away_failure, void());
     MOCK_METHOD0(report_vt_switch_back_failure, void());
+    MOCK_METHOD2(report_bypass_failure, void(unsigned int, char const*));
     MOCK_METHOD2(report_egl_configuration, void(EGLDisplay,EGLConfig));
     MOCK_METHOD2(report_vsync, void(unsigned int, graphics::Frame const&));
 };
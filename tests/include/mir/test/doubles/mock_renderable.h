@@ -37,6 +37,8 @@ struct MockRenderable : public graphics::Renderable
             .WillByDefault(testing::Return(geometry::Rectangle{{},{}}));
         ON_CALL(*this, clip_area())
             .WillByDefault(testing::Return(std::experimental::optional<geometry::Rectangle>()));
+        ON_CALL(*this, src_bounds())
+            .WillByDefault(testing::Return(std::experimental::optional<geometry::Rectangle>()));
         ON_CALL(*this, buffer())
             .WillByDefault(testing::Return(std::make_shared<StubBuffer>()));
         ON_CALL(*this, alpha())
@@ -51,11 +53,13 @@ struct MockRenderable : public graphics::Renderable
     MOCK_CONST_METHOD0(buffer, std::shared_ptr<graphics::Buffer>());
     MOCK_CONST_METHOD0(screen_position, geometry::Rectangle());
     MOCK_CONST_METHOD0(clip_area, std::experimental::optional<geometry::Rectangle>());
+    MOCK_CONST_METHOD0(src_bounds, std::experimental::optional<geometry::Rectangle>());
     MOCK_CONST_METHOD0(alpha, float());
     MOCK_CONST_METHOD0(transformation, glm::mat4());
     MOCK_CONST_METHOD0(visible, bool());
     MOCK_CONST_METHOD0(shaped, bool());
     MOCK_CONST_METHOD0(swap_interval, unsigned int());
+    MOCK_CONST_METHOD0(tearing_allowed, bool());
 };
 }
 }
@@ -23,6 +23,7 @@
 
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
+#include <X11/Xlib-xcb.h>
 
 namespace mir
 {
@@ -95,6 +96,7 @@ public:
     MOCK_METHOD9(XGetGeometry, Status(Display*, Drawable, Window*, int*, int*, unsigned int*, unsigned int*, unsigned int*, unsigned int*));
     MOCK_METHOD2(XFixesHideCursor, void(Display *dpy, Window win));
     MOCK_METHOD2(XFixesShowCursor, void(Display *dpy, Window win));
+    MOCK_METHOD1(XGetXCBConnection, xcb_connection_t*(Display*));
 
     FakeX11Resources fake_x11;
 };
@@ -58,6 +58,13 @@ public:
     {
         return false;
     }
+    void set_tearing_allowed(bool) override
+    {
+    }
+    bool tearing_allowed() const override
+    {
+        return false;
+    }
     int buffers_ready_for_compositor(void const*) const override { return nready; }
 
     void drop_old_buffers() override {}
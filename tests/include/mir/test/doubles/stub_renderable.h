@@ -78,6 +78,10 @@ public:
     {
         return std::experimental::optional<geometry::Rectangle>();
     }
+    std::experimental::optional<geometry::Rectangle> src_bounds() const override
+    {
+        return std::experimental::optional<geometry::Rectangle>();
+    }
     float alpha() const override
     {
         return 1.0f;
@@ -95,6 +99,11 @@ public:
         return 1;
     }
 
+    bool tearing_allowed() const override
+    {
+        return false;
+    }
+
 private:
     std::shared_ptr<graphics::Buffer> make_stub_buffer(geometry::Rectangle const& rect)
     {
@@ -169,6 +178,11 @@ struct IntervalZeroRenderable : StubRenderable
     {
         return 0;
     }
+
+    bool tearing_allowed() const override
+    {
+        return false;
+    }
 };
 
 }
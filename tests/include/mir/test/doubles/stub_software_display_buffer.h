@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_TEST_DOUBLES_STUB_SOFTWARE_DISPLAY_BUFFER_H_
+#define MIR_TEST_DOUBLES_STUB_SOFTWARE_DISPLAY_BUFFER_H_
+
+#include "mir/test/doubles/stub_display_buffer.h"
+#include "mir/renderer/sw/render_target.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace mir
+{
+namespace test
+{
+namespace doubles
+{
+
+/// A DisplayBuffer the software renderer can draw into; the last presented frame is in "pixels"
+class StubSoftwareDisplayBuffer : public StubDisplayBuffer,
+                                  public renderer::software::RenderTarget
+{
+public:
+    StubSoftwareDisplayBuffer(geometry::Rectangle const& view_area, MirPixelFormat format = mir_pixel_format_argb_8888)
+        : StubDisplayBuffer{view_area},
+          format{format},
+          back(view_area.size.width.as_int() * view_area.size.height.as_int()),
+          pixels(back.size())
+    {
+    }
+
+    auto map_back_buffer() -> std::unique_ptr<renderer::software::Mapping<unsigned char>> override
+    {
+        class VectorMapping : public renderer::software::Mapping<unsigned char>
+        {
+        public:
+            VectorMapping(std::vector<uint32_t>& pixels, geometry::Size size, MirPixelFormat format)
+                : pixels{pixels}, size_{size}, format_{format}
+            {
+            }
+
+            auto format() const -> MirPixelFormat override { return format_; }
+            auto stride() const -> geometry::Stride override { return geometry::Stride{4 * size_.width.as_int()}; }
+            auto size() const -> geometry::Size override { return size_; }
+            auto data() -> unsigned char* override { return reinterpret_cast<unsigned char*>(pixels.data()); }
+            auto len() const -> size_t override { return pixels.size() * sizeof(uint32_t); }
+
+        private:
+            std::vector<uint32_t>& pixels;
+            geometry::Size const size_;
+            MirPixelFormat const format_;
+        };
+
+        return std::make_unique<VectorMapping>(back, view_area().size, format);
+    }
+
+    void present_back_buffer() override
+    {
+        pixels = back;
+        ++frames_presented;
+    }
+
+    MirPixelFormat const format;
+    std::vector<uint32_t> back;
+    std::vector<uint32_t> pixels;
+    int frames_presented{0};
+};
+
+}
+}
+}
+
+#endif
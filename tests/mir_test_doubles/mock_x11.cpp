@@ -282,3 +282,8 @@ extern "C" void XFixesShowCursor(Display *dpy, Window win)
 {
     global_mock->XFixesShowCursor(dpy, win);
 }
+
+xcb_connection_t* XGetXCBConnection(Display* dpy)
+{
+    return global_mock->XGetXCBConnection(dpy);
+}
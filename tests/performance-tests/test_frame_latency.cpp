@@ -0,0 +1,446 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <miral/test_server.h>
+
+#include <mir/server.h>
+#include <mir/compositor/display_buffer_compositor_factory.h>
+#include <mir_test_framework/executable_path.h>
+#include <mir_test_framework/temporary_environment_value.h>
+
+#include <wayland-client.h>
+
+#include <boost/throw_exception.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace mtf = mir_test_framework;
+
+using namespace std::chrono_literals;
+using namespace testing;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+auto cpu_time(clockid_t clock) -> std::chrono::nanoseconds
+{
+    timespec now;
+    clock_gettime(clock, &now);
+    return std::chrono::seconds{now.tv_sec} + std::chrono::nanoseconds{now.tv_nsec};
+}
+
+enum class Damage
+{
+    full,       ///< Redraw and damage the whole buffer every frame
+    partial     ///< Redraw and damage a small square that moves each frame
+};
+
+struct ClientSpec
+{
+    int width;
+    int height;
+    int fps;    ///< 0 draws again as soon as the previous frame's callback arrives
+    Damage damage;
+};
+
+struct Scenario
+{
+    char const* name;
+    std::vector<ClientSpec> clients;
+};
+
+struct ClientResults
+{
+    std::vector<std::chrono::nanoseconds> latencies;
+    int committed{0};
+    int dropped{0};
+    std::chrono::nanoseconds cpu_time{0};
+};
+
+/**
+ * A wl_shm client that draws on a fixed schedule and times each commit until
+ * its frame callback, which Mir sends when the compositor consumes the buffer.
+ *
+ * A frame whose callback arrives together with a later frame's was replaced
+ * before it reached the screen, and is counted as dropped.
+ */
+class SyntheticClient
+{
+public:
+    SyntheticClient(int socket, ClientSpec const& spec) :
+        spec{spec},
+        display{wl_display_connect_to_fd(socket)}
+    {
+        if (!display)
+            BOOST_THROW_EXCEPTION(std::runtime_error{"Failed to connect to the server"});
+
+        auto const registry = wl_display_get_registry(display);
+        wl_registry_add_listener(registry, &registry_listener, this);
+        wl_display_roundtrip(display);
+        wl_registry_destroy(registry);
+
+        if (!compositor || !shm || !shell)
+            BOOST_THROW_EXCEPTION(std::runtime_error{"Server lacks wl_compositor, wl_shm or wl_shell"});
+
+        surface = wl_compositor_create_surface(compositor);
+        shell_surface = wl_shell_get_shell_surface(shell, surface);
+        wl_shell_surface_set_toplevel(shell_surface);
+
+        create_buffers();
+        wl_display_roundtrip(display);
+    }
+
+    ~SyntheticClient()
+    {
+        for (auto& frame : pending)
+            wl_callback_destroy(frame.callback);
+        for (auto& buffer : buffers)
+            wl_buffer_destroy(buffer.buffer);
+        munmap(pixels, pool_size);
+        wl_shell_surface_destroy(shell_surface);
+        wl_surface_destroy(surface);
+        wl_shell_destroy(shell);
+        wl_shm_destroy(shm);
+        wl_compositor_destroy(compositor);
+        wl_display_disconnect(display);
+    }
+
+    void run_until(Clock::time_point end)
+    {
+        auto const cpu_start = cpu_time(CLOCK_THREAD_CPUTIME_ID);
+        auto const interval = spec.fps ? std::chrono::nanoseconds{1s} / spec.fps : std::chrono::nanoseconds{0};
+        auto next_frame = Clock::now();
+
+        while (Clock::now() < end)
+        {
+            if (Clock::now() >= next_frame && (spec.fps || pending.empty()))
+            {
+                if (draw())
+                    next_frame += interval;
+            }
+
+            auto const wake = spec.fps ? std::min(next_frame, end) : std::min(Clock::now() + 100ms, end);
+            dispatch_until(wake);
+            account_for_presented_frames();
+        }
+
+        results.cpu_time = cpu_time(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+    }
+
+    ClientResults results;
+
+private:
+    struct Buffer
+    {
+        wl_buffer* buffer;
+        unsigned char* pixels;
+        bool busy;
+    };
+
+    struct Frame
+    {
+        wl_callback* callback;
+        Clock::time_point committed;
+        bool presented;
+        Clock::time_point presented_at;
+    };
+
+    auto draw() -> bool
+    {
+        auto const free_buffer = std::find_if(begin(buffers), end(buffers), [](auto& b) { return !b.busy; });
+        if (free_buffer == end(buffers))
+            return false;   // Wait for the server to release one
+
+        int const stride = spec.width * 4;
+        int x = 0, y = 0, width = spec.width, height = spec.height;
+        if (spec.damage == Damage::partial)
+        {
+            width = std::min(64, spec.width);
+            height = std::min(64, spec.height);
+            x = (results.committed * 8) % (spec.width - width + 1);
+            y = (results.committed * 8) % (spec.height - height + 1);
+        }
+
+        for (int row = y; row != y + height; ++row)
+            memset(free_buffer->pixels + row * stride + x * 4, results.committed & 0xff, width * 4);
+
+        Frame frame{wl_surface_frame(surface), Clock::now(), false, {}};
+        wl_callback_add_listener(frame.callback, &frame_listener, this);
+        pending.push_back(frame);
+
+        wl_surface_attach(surface, free_buffer->buffer, 0, 0);
+        wl_surface_damage(surface, x, y, width, height);
+        wl_surface_commit(surface);
+        free_buffer->busy = true;
+        ++results.committed;
+        return true;
+    }
+
+    void dispatch_until(Clock::time_point wake)
+    {
+        while (wl_display_prepare_read(display) != 0)
+            wl_display_dispatch_pending(display);
+
+        wl_display_flush(display);
+
+        auto const timeout = std::max(std::chrono::nanoseconds{0}, wake - Clock::now());
+        timespec const ts{
+            static_cast<time_t>(std::chrono::duration_cast<std::chrono::seconds>(timeout).count()),
+            static_cast<long>((timeout % 1s).count())};
+
+        pollfd fd{wl_display_get_fd(display), POLLIN, 0};
+        if (ppoll(&fd, 1, &ts, nullptr) > 0)
+            wl_display_read_events(display);
+        else
+            wl_display_cancel_read(display);
+
+        wl_display_dispatch_pending(display);
+    }
+
+    // Frame callbacks are sent in commit order, so the presented frames are a prefix of pending
+    void account_for_presented_frames()
+    {
+        auto presented = 0;
+        while (presented != static_cast<int>(pending.size()) && pending[presented].presented)
+            ++presented;
+
+        if (presented == 0)
+            return;
+
+        auto const& newest = pending[presented - 1];
+        results.latencies.push_back(newest.presented_at - newest.committed);
+        results.dropped += presented - 1;
+        pending.erase(begin(pending), begin(pending) + presented);
+    }
+
+    void create_buffers()
+    {
+        int const stride = spec.width * 4;
+        size_t const buffer_size = stride * spec.height;
+        pool_size = buffer_size * buffer_count;
+
+        int const fd = memfd_create("mir-frame-latency", MFD_CLOEXEC);
+        if (fd < 0 || ftruncate(fd, pool_size) != 0)
+            BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to create shm pool"));
+
+        pixels = static_cast<unsigned char*>(mmap(nullptr, pool_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+        if (pixels == MAP_FAILED)
+        {
+            close(fd);
+            BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to map shm pool"));
+        }
+
+        auto const pool = wl_shm_create_pool(shm, fd, pool_size);
+        for (size_t i = 0; i != buffer_count; ++i)
+        {
+            auto const buffer = wl_shm_pool_create_buffer(
+                pool, i * buffer_size, spec.width, spec.height, stride, WL_SHM_FORMAT_ARGB8888);
+            buffers.push_back({buffer, pixels + i * buffer_size, false});
+        }
+        for (auto& buffer : buffers)
+            wl_buffer_add_listener(buffer.buffer, &buffer_listener, &buffer);
+
+        wl_shm_pool_destroy(pool);
+        close(fd);
+    }
+
+    static void new_global(void* data, wl_registry* registry, uint32_t id, char const* interface, uint32_t)
+    {
+        auto const self = static_cast<SyntheticClient*>(data);
+
+        if (strcmp(interface, wl_compositor_interface.name) == 0)
+            self->compositor = static_cast<wl_compositor*>(wl_registry_bind(registry, id, &wl_compositor_interface, 1));
+        else if (strcmp(interface, wl_shm_interface.name) == 0)
+            self->shm = static_cast<wl_shm*>(wl_registry_bind(registry, id, &wl_shm_interface, 1));
+        else if (strcmp(interface, wl_shell_interface.name) == 0)
+            self->shell = static_cast<wl_shell*>(wl_registry_bind(registry, id, &wl_shell_interface, 1));
+    }
+
+    static void global_remove(void*, wl_registry*, uint32_t) {}
+
+    static void frame_done(void* data, wl_callback* callback, uint32_t)
+    {
+        auto const self = static_cast<SyntheticClient*>(data);
+        for (auto& frame : self->pending)
+        {
+            if (frame.callback == callback)
+            {
+                frame.presented = true;
+                frame.presented_at = Clock::now();
+            }
+        }
+        wl_callback_destroy(callback);
+    }
+
+    static void buffer_release(void* data, wl_buffer*)
+    {
+        static_cast<Buffer*>(data)->busy = false;
+    }
+
+    static wl_registry_listener const registry_listener;
+    static wl_callback_listener const frame_listener;
+    static wl_buffer_listener const buffer_listener;
+
+    static size_t const buffer_count = 3;
+
+    ClientSpec const spec;
+    wl_display* const display;
+    wl_compositor* compositor{nullptr};
+    wl_shm* shm{nullptr};
+    wl_shell* shell{nullptr};
+    wl_surface* surface{nullptr};
+    wl_shell_surface* shell_surface{nullptr};
+
+    size_t pool_size{0};
+    unsigned char* pixels{nullptr};
+    std::vector<Buffer> buffers;
+    std::deque<Frame> pending;
+};
+
+wl_registry_listener const SyntheticClient::registry_listener{&new_global, &global_remove};
+wl_callback_listener const SyntheticClient::frame_listener{&frame_done};
+wl_buffer_listener const SyntheticClient::buffer_listener{&buffer_release};
+
+auto percentile(std::vector<std::chrono::nanoseconds> const& sorted, double p) -> double
+{
+    if (sorted.empty())
+        return 0;
+    auto const index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return std::chrono::duration<double, std::milli>{sorted[index]}.count();
+}
+
+struct FrameLatency : miral::TestServer, WithParamInterface<Scenario>
+{
+    FrameLatency()
+    {
+        add_server_init([this](mir::Server& server)
+            {
+                this->server = &server;
+
+                // Composite with the real renderer, not the test framework's stand-in that only consumes buffers
+                server.override_the_display_buffer_compositor_factory(
+                    []() -> std::shared_ptr<mir::compositor::DisplayBufferCompositorFactory> { return nullptr; });
+            });
+    }
+
+    auto client_socket() -> int
+    {
+        return fcntl(server->open_wayland_client_socket(), F_DUPFD_CLOEXEC, 3);
+    }
+
+    /*
+     * The stub platform posts frames as fast as they are composited, so measure on
+     * the headless platform, which posts them on a simulated vblank like real hardware.
+     * (These are members so they're set after, and restored before, TestServer's defaults.)
+     */
+    mtf::TemporaryEnvironmentValue const graphics_platform{
+        "MIR_SERVER_PLATFORM_GRAPHICS_LIB", mtf::server_platform("server-headless").c_str()};
+    mtf::TemporaryEnvironmentValue const headless_output{"MIR_SERVER_HEADLESS_OUTPUT", "1920x1080@60"};
+
+    std::chrono::seconds const duration{5};
+    mir::Server* server{nullptr};
+};
+}
+
+TEST_P(FrameLatency, commit_to_present)
+{
+    auto const& scenario = GetParam();
+
+    std::vector<std::unique_ptr<SyntheticClient>> clients;
+    for (auto const& spec : scenario.clients)
+        clients.push_back(std::make_unique<SyntheticClient>(client_socket(), spec));
+
+    auto const process_cpu_start = cpu_time(CLOCK_PROCESS_CPUTIME_ID);
+    auto const deadline = Clock::now() + duration;
+    {
+        std::vector<std::thread> threads;
+        for (auto& client : clients)
+            threads.emplace_back([&client, deadline] { client->run_until(deadline); });
+        for (auto& thread : threads)
+            thread.join();
+    }
+    auto const process_cpu = cpu_time(CLOCK_PROCESS_CPUTIME_ID) - process_cpu_start;
+
+    std::vector<std::chrono::nanoseconds> latencies;
+    int committed = 0;
+    int dropped = 0;
+    auto client_cpu = std::chrono::nanoseconds{0};
+    for (auto const& client : clients)
+    {
+        auto const& results = client->results;
+        latencies.insert(end(latencies), begin(results.latencies), end(results.latencies));
+        committed += results.committed;
+        dropped += results.dropped;
+        client_cpu += results.cpu_time;
+    }
+    std::sort(begin(latencies), end(latencies));
+
+    int const presented = latencies.size();
+    auto const server_cpu_per_frame = presented ?
+        std::chrono::duration<double, std::milli>{process_cpu - client_cpu}.count() / presented : 0.0;
+
+    RecordProperty("committed", std::to_string(committed));
+    RecordProperty("presented", std::to_string(presented));
+    RecordProperty("dropped", std::to_string(dropped));
+    RecordProperty("latency_p50_ms", std::to_string(percentile(latencies, 0.5)));
+    RecordProperty("latency_p90_ms", std::to_string(percentile(latencies, 0.9)));
+    RecordProperty("latency_p99_ms", std::to_string(percentile(latencies, 0.99)));
+    RecordProperty("latency_max_ms", std::to_string(percentile(latencies, 1.0)));
+    RecordProperty("server_cpu_ms_per_frame", std::to_string(server_cpu_per_frame));
+
+    std::cout << scenario.name << ": "
+              << presented << "/" << committed << " frames presented, " << dropped << " dropped; "
+              << "commit to present p50 " << percentile(latencies, 0.5) << "ms, "
+              << "p90 " << percentile(latencies, 0.9) << "ms, "
+              << "p99 " << percentile(latencies, 0.99) << "ms, "
+              << "max " << percentile(latencies, 1.0) << "ms; "
+              << "server CPU " << server_cpu_per_frame << "ms/frame" << std::endl;
+
+    EXPECT_THAT(presented, Gt(0));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Scenarios,
+    FrameLatency,
+    Values(
+        Scenario{"one_fullscreen_client", {{1920, 1080, 60, Damage::full}}},
+        Scenario{"one_unthrottled_client", {{1920, 1080, 0, Damage::full}}},
+        Scenario{"many_small_clients", std::vector<ClientSpec>(8, {256, 256, 60, Damage::partial})},
+        Scenario{"mixed_clients", {
+            {1280, 720, 60, Damage::full},
+            {640, 480, 30, Damage::partial},
+            {800, 600, 0, Damage::partial},
+            {256, 256, 120, Damage::full}}}),
+    [](TestParamInfo<Scenario> const& info) { return info.param.name; });
@@ -487,11 +487,21 @@ void basic_software_buffer_drawing(
             return std::experimental::optional<mir::geometry::Rectangle>{};
         }
 
+        auto src_bounds() const -> std::experimental::optional<mir::geometry::Rectangle> override
+        {
+            return std::experimental::optional<mir::geometry::Rectangle>{};
+        }
+
         unsigned int swap_interval() const override
         {
             return 0;
         }
 
+        bool tearing_allowed() const override
+        {
+            return false;
+        }
+
         void set_position(mir::geometry::Point top_left)
         {
             this->top_left = top_left;
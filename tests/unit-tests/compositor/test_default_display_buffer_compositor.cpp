@@ -184,6 +184,52 @@ TEST_F(DefaultDisplayBufferCompositor, rendering_reports_everything)
     compositor.composite(make_scene_elements({}));
 }
 
+TEST_F(DefaultDisplayBufferCompositor, reports_stage_timing_from_renderer)
+{
+    using namespace testing;
+    using FrameStage = mc::CompositorReport::FrameStage;
+    auto report = std::make_shared<NiceMock<mtd::MockCompositorReport>>();
+
+    mir::renderer::Renderer::FrameTiming timing;
+    timing.texture_upload = std::chrono::microseconds{300};
+    timing.draw = std::chrono::microseconds{200};
+    timing.swap = std::chrono::microseconds{100};
+    timing.gpu = std::chrono::microseconds{1500};
+    ON_CALL(mock_renderer, last_frame_timing())
+        .WillByDefault(Return(timing));
+
+    EXPECT_CALL(*report, frame_stage_timing(_, FrameStage::occlusion, _));
+    EXPECT_CALL(*report, frame_stage_timing(_, FrameStage::texture_upload, timing.texture_upload));
+    EXPECT_CALL(*report, frame_stage_timing(_, FrameStage::draw, timing.draw));
+    EXPECT_CALL(*report, frame_stage_timing(_, FrameStage::swap, timing.swap));
+    EXPECT_CALL(*report, frame_stage_timing(_, FrameStage::gpu, timing.gpu.value()));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        report);
+    compositor.composite(make_scene_elements({small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, bypass_reports_no_render_stages)
+{
+    using namespace testing;
+    using FrameStage = mc::CompositorReport::FrameStage;
+    auto report = std::make_shared<NiceMock<mtd::MockCompositorReport>>();
+
+    EXPECT_CALL(display_buffer, overlay(_))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*report, frame_stage_timing(_, FrameStage::occlusion, _));
+    EXPECT_CALL(*report, frame_stage_timing(_, Ne(FrameStage::occlusion), _))
+        .Times(0);
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        report);
+    compositor.composite(make_scene_elements({fullscreen}));
+}
+
 TEST_F(DefaultDisplayBufferCompositor, calls_renderer_in_sequence)
 {
     using namespace testing;
@@ -241,3 +241,18 @@ TEST_F(Stream, stream_remembers_scale_when_buffer_added)
     stream.submit_buffer(buffers[0]);
     ASSERT_THAT(stream.stream_size(), Eq(initial_size / 2));
 }
+
+TEST_F(Stream, tearing_hint_is_independent_of_framedropping)
+{
+    EXPECT_FALSE(stream.tearing_allowed());
+
+    stream.allow_framedropping(true);
+    EXPECT_FALSE(stream.tearing_allowed());
+
+    stream.set_tearing_allowed(true);
+    EXPECT_TRUE(stream.tearing_allowed());
+    EXPECT_TRUE(stream.framedropping());
+
+    stream.set_tearing_allowed(false);
+    EXPECT_FALSE(stream.tearing_allowed());
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/gl/recently_used_cache.h"
+
+#include "mir/test/doubles/mock_gl.h"
+#include "mir/test/doubles/mock_gl_buffer.h"
+#include "mir/test/doubles/mock_renderable.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mg = mir::graphics;
+namespace mgl = mir::gl;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+using namespace testing;
+
+namespace
+{
+geom::Size const buffer_size{10, 10};
+size_t const buffer_bytes{10 * 10 * 4};
+
+struct Surface
+{
+    Surface(mg::BufferID buffer_id)
+    {
+        ON_CALL(renderable, id()).WillByDefault(Return(this));
+        ON_CALL(renderable, buffer()).WillByDefault(Invoke([this] { return buffer; }));
+        submit(buffer_id);
+    }
+
+    void submit(mg::BufferID buffer_id)
+    {
+        buffer = std::make_shared<NiceMock<mtd::MockGLBuffer>>(
+            buffer_size, geom::Stride{buffer_size.width.as_int() * 4}, mir_pixel_format_argb_8888);
+        ON_CALL(*buffer, id()).WillByDefault(Return(buffer_id));
+    }
+
+    NiceMock<mtd::MockRenderable> renderable;
+    std::shared_ptr<NiceMock<mtd::MockGLBuffer>> buffer;
+};
+
+struct RecentlyUsedCache : Test
+{
+    NiceMock<mtd::MockGL> mock_gl;
+    std::shared_ptr<mgl::TextureCacheCounters> const counters{std::make_shared<mgl::TextureCacheCounters>()};
+
+    Surface a{mg::BufferID{1}};
+    Surface b{mg::BufferID{2}};
+    Surface c{mg::BufferID{3}};
+};
+}
+
+TEST_F(RecentlyUsedCache, keeps_textures_not_drawn_in_the_last_frame)
+{
+    mgl::RecentlyUsedCache cache{buffer_bytes, counters};
+
+    EXPECT_CALL(*a.buffer, bind()).Times(1);
+
+    cache.load(a.renderable);
+    cache.drop_unused();
+    cache.drop_unused();
+    cache.drop_unused();
+    cache.load(a.renderable);
+
+    EXPECT_THAT(counters->hits.load(), Eq(1u));
+    EXPECT_THAT(counters->misses.load(), Eq(1u));
+}
+
+TEST_F(RecentlyUsedCache, evicts_least_recently_drawn_when_over_budget)
+{
+    mgl::RecentlyUsedCache cache{buffer_bytes, counters};
+
+    cache.load(a.renderable);
+    cache.drop_unused();
+    cache.load(b.renderable);
+    cache.drop_unused();
+    cache.load(c.renderable);
+    cache.drop_unused();
+
+    EXPECT_THAT(counters->cached_bytes.load(), Eq(2 * buffer_bytes));
+
+    EXPECT_CALL(*a.buffer, bind()).Times(1);
+    EXPECT_CALL(*b.buffer, bind()).Times(0);
+    cache.load(a.renderable);
+    cache.load(b.renderable);
+}
+
+TEST_F(RecentlyUsedCache, textures_drawn_this_frame_do_not_count_against_the_budget)
+{
+    mgl::RecentlyUsedCache cache{buffer_bytes, counters};
+
+    cache.load(a.renderable);
+    cache.drop_unused();
+    cache.load(b.renderable);
+    cache.load(c.renderable);
+    cache.drop_unused();
+
+    EXPECT_THAT(counters->cached_bytes.load(), Eq(3 * buffer_bytes));
+
+    EXPECT_CALL(*a.buffer, bind()).Times(0);
+    cache.load(a.renderable);
+}
+
+TEST_F(RecentlyUsedCache, never_evicts_textures_drawn_this_frame)
+{
+    mgl::RecentlyUsedCache cache{0, counters};
+
+    cache.load(a.renderable);
+    cache.load(b.renderable);
+    cache.drop_unused();
+
+    EXPECT_THAT(counters->cached_bytes.load(), Eq(2 * buffer_bytes));
+
+    EXPECT_CALL(*a.buffer, bind()).Times(0);
+    EXPECT_CALL(*b.buffer, bind()).Times(0);
+    cache.load(a.renderable);
+    cache.load(b.renderable);
+}
+
+TEST_F(RecentlyUsedCache, rebinds_when_the_buffer_changes)
+{
+    mgl::RecentlyUsedCache cache{buffer_bytes, counters};
+
+    cache.load(a.renderable);
+    cache.drop_unused();
+
+    a.submit(mg::BufferID{4});
+    EXPECT_CALL(*a.buffer, bind()).Times(1);
+    cache.load(a.renderable);
+
+    EXPECT_THAT(counters->misses.load(), Eq(2u));
+    EXPECT_THAT(counters->cached_bytes.load(), Eq(buffer_bytes));
+}
+
+TEST_F(RecentlyUsedCache, rebinds_after_invalidate)
+{
+    mgl::RecentlyUsedCache cache{buffer_bytes, counters};
+
+    cache.load(a.renderable);
+    cache.invalidate();
+
+    EXPECT_CALL(*a.buffer, bind()).Times(1);
+    cache.load(a.renderable);
+}
+
+TEST_F(RecentlyUsedCache, destroying_the_cache_removes_its_textures_from_the_counters)
+{
+    {
+        mgl::RecentlyUsedCache cache{buffer_bytes, counters};
+        cache.load(a.renderable);
+        cache.load(b.renderable);
+    }
+
+    EXPECT_THAT(counters->cached_bytes.load(), Eq(0));
+}
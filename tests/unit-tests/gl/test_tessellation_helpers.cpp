@@ -19,6 +19,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <mir/gl/tessellation_helpers.h>
 #include <mir/test/doubles/mock_renderable.h>
+#include <mir/test/doubles/stub_buffer.h>
 
 using namespace testing;
 
@@ -147,3 +148,21 @@ TEST_F(Tessellation, tex_coords_0_or_1_when_transformed)
     mgl::Primitive const primitive = mgl::tessellate_renderable_into_rectangle(renderable, {x, y});
     expect_tex_coords_1_or_0(primitive);
 }
+
+TEST_F(Tessellation, tex_coords_cover_src_bounds)
+{
+    ON_CALL(renderable, buffer())
+        .WillByDefault(Return(std::make_shared<mtd::StubBuffer>(geom::Size{200, 100})));
+    ON_CALL(renderable, src_bounds())
+        .WillByDefault(Return(std::experimental::make_optional(geom::Rectangle{{50, 25}, {100, 50}})));
+
+    mgl::Primitive const primitive = mgl::tessellate_renderable_into_rectangle(renderable, {});
+
+    auto const box = bounding_box(primitive);
+    EXPECT_THAT(box, Eq(BoundingBox::from(rect)));
+    for (int i = 0; i < primitive.nvertices; i++)
+    {
+        EXPECT_THAT(primitive.vertices[i].texcoord[0], AnyOf(Eq(0.25f), Eq(0.75f))) << "i=" << i;
+        EXPECT_THAT(primitive.vertices[i].texcoord[1], AnyOf(Eq(0.25f), Eq(0.75f))) << "i=" << i;
+    }
+}
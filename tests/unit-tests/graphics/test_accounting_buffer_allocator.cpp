@@ -0,0 +1,183 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/graphics/accounting_buffer_allocator.h"
+#include "mir/graphics/memory_accounting.h"
+
+#include "mir/test/doubles/stub_buffer_allocator.h"
+#include "mir/test/fd_utils.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <wayland-server.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <vector>
+
+namespace mg = mir::graphics;
+namespace mt = mir::test;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+using namespace testing;
+
+namespace
+{
+size_t const buffer_bytes{100 * 100 * 4};
+
+/// Imports every client buffer as a new 100x100 buffer
+struct ImportingBufferAllocator : mtd::StubBufferAllocator
+{
+    auto buffer_from_resource(wl_resource*, std::function<void()>&&, std::function<void()>&&)
+        -> std::shared_ptr<mg::Buffer> override
+    {
+        return std::make_shared<mtd::StubBuffer>(
+            mg::BufferProperties{geom::Size{100, 100}, mir_pixel_format_argb_8888, mg::BufferUsage::hardware});
+    }
+};
+
+struct AccountingBufferAllocator : Test
+{
+    AccountingBufferAllocator()
+        : display{wl_display_create()},
+          client{create_client()}
+    {
+    }
+
+    ~AccountingBufferAllocator()
+    {
+        for (auto const other : other_clients)
+            wl_client_destroy(other);
+        wl_client_destroy(client);
+        wl_display_destroy(display);
+    }
+
+    /// A client connected over a socketpair, so in the same process as the server
+    auto create_client() -> wl_client*
+    {
+        int fds[2];
+        EXPECT_TRUE(mt::std_call_succeeded(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds)));
+        client_ends.emplace_back(fds[1]);
+        return wl_client_create(display, fds[0]);
+    }
+
+    auto create_buffer(wl_client* owner) -> wl_resource*
+    {
+        return wl_resource_create(owner, &wl_buffer_interface, 1, 0);
+    }
+
+    auto create_buffer() -> wl_resource*
+    {
+        return create_buffer(client);
+    }
+
+    auto import(wl_resource* buffer) -> std::shared_ptr<mg::Buffer>
+    {
+        return allocator.buffer_from_resource(buffer, [](){}, [](){});
+    }
+
+    auto hardware_usage() -> mg::MemoryUsage
+    {
+        auto const usage = accounting->usage();
+        if (usage.size() != 1)
+            return {};
+        auto const& kinds = usage.begin()->second.usage;
+        auto const kind_usage = kinds.find(mg::MemoryKind::hardware);
+        return kind_usage == kinds.end() ? mg::MemoryUsage{} : kind_usage->second;
+    }
+
+    std::vector<mir::Fd> client_ends;
+    wl_display* const display;
+    wl_client* const client;
+    std::vector<wl_client*> other_clients;
+
+    std::shared_ptr<mg::MemoryAccounting> const accounting{std::make_shared<mg::MemoryAccounting>(0)};
+    mg::AccountingBufferAllocator allocator{std::make_shared<ImportingBufferAllocator>(), accounting};
+};
+}
+
+TEST_F(AccountingBufferAllocator, client_buffer_committed_repeatedly_is_charged_once)
+{
+    auto const buffer = create_buffer();
+
+    auto const first = import(buffer);
+    auto const second = import(buffer);
+    auto const third = import(buffer);
+
+    EXPECT_THAT(hardware_usage().buffers, Eq(1u));
+    EXPECT_THAT(hardware_usage().bytes, Eq(buffer_bytes));
+}
+
+TEST_F(AccountingBufferAllocator, each_client_buffer_is_charged)
+{
+    auto const first = import(create_buffer());
+    auto const second = import(create_buffer());
+
+    EXPECT_THAT(hardware_usage().buffers, Eq(2u));
+}
+
+TEST_F(AccountingBufferAllocator, charge_is_held_until_the_client_buffer_and_its_imports_are_gone)
+{
+    auto const buffer = create_buffer();
+    auto imported = import(buffer);
+
+    wl_resource_destroy(buffer);
+    EXPECT_THAT(hardware_usage().buffers, Eq(1u));
+
+    imported.reset();
+    EXPECT_THAT(accounting->usage(), IsEmpty());
+}
+
+TEST_F(AccountingBufferAllocator, charge_is_held_while_the_client_buffer_exists)
+{
+    auto const buffer = create_buffer();
+    import(buffer);
+
+    EXPECT_THAT(hardware_usage().buffers, Eq(1u));
+
+    wl_resource_destroy(buffer);
+    EXPECT_THAT(accounting->usage(), IsEmpty());
+}
+
+TEST_F(AccountingBufferAllocator, clients_from_the_same_process_are_charged_separately)
+{
+    other_clients.push_back(create_client());
+
+    auto const first = import(create_buffer());
+    auto const second = import(create_buffer(other_clients.back()));
+
+    auto const usage = accounting->usage();
+    ASSERT_THAT(usage.size(), Eq(2u));
+    for (auto const& account : usage)
+    {
+        EXPECT_THAT(account.second.pid, Eq(getpid()));
+        EXPECT_THAT(mg::total_bytes(account.second.usage), Eq(buffer_bytes));
+    }
+}
+
+TEST_F(AccountingBufferAllocator, clients_in_the_server_process_are_held_to_the_quota)
+{
+    auto const limited = std::make_shared<mg::MemoryAccounting>(buffer_bytes);
+    mg::AccountingBufferAllocator limited_allocator{std::make_shared<ImportingBufferAllocator>(), limited};
+
+    auto const first = limited_allocator.buffer_from_resource(create_buffer(), [](){}, [](){});
+
+    EXPECT_THROW(
+        limited_allocator.buffer_from_resource(create_buffer(), [](){}, [](){}),
+        mg::MemoryQuotaExceeded);
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/graphics/memory_accounting.h"
+
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <unistd.h>
+
+namespace mg = mir::graphics;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+using namespace testing;
+
+namespace
+{
+pid_t const client_pid{getpid() + 1};
+size_t const buffer_bytes{100 * 100 * 4};
+
+auto a_buffer() -> std::shared_ptr<mg::Buffer>
+{
+    return std::make_shared<mtd::StubBuffer>(
+        mg::BufferProperties{geom::Size{100, 100}, mir_pixel_format_argb_8888, mg::BufferUsage::software});
+}
+
+struct MemoryAccounting : Test
+{
+    auto usage_of(mg::MemoryClient const& client, mg::MemoryKind kind) -> mg::MemoryUsage
+    {
+        auto const usage = accounting->usage();
+        auto const account = usage.find(client.id);
+        if (account == usage.end())
+            return {};
+        auto const kind_usage = account->second.usage.find(kind);
+        return kind_usage == account->second.usage.end() ? mg::MemoryUsage{} : kind_usage->second;
+    }
+
+    std::shared_ptr<mg::MemoryAccounting> const accounting{std::make_shared<mg::MemoryAccounting>(2 * buffer_bytes)};
+    mg::MemoryClient const client{accounting->new_client(client_pid)};
+};
+}
+
+TEST_F(MemoryAccounting, charged_buffer_is_the_same_buffer)
+{
+    auto const buffer = a_buffer();
+    auto const charged = accounting->charge(buffer, client, mg::MemoryKind::shm);
+
+    EXPECT_THAT(charged.get(), Eq(buffer.get()));
+}
+
+TEST_F(MemoryAccounting, buffer_is_charged_until_destroyed)
+{
+    auto charged = accounting->charge(a_buffer(), client, mg::MemoryKind::shm);
+
+    EXPECT_THAT(usage_of(client, mg::MemoryKind::shm).buffers, Eq(1u));
+    EXPECT_THAT(usage_of(client, mg::MemoryKind::shm).bytes, Eq(buffer_bytes));
+
+    charged.reset();
+
+    EXPECT_THAT(accounting->usage(), IsEmpty());
+}
+
+TEST_F(MemoryAccounting, usage_is_split_by_kind)
+{
+    auto const shm = accounting->charge(a_buffer(), client, mg::MemoryKind::shm);
+    auto const hardware = accounting->charge(a_buffer(), client, mg::MemoryKind::hardware);
+
+    EXPECT_THAT(usage_of(client, mg::MemoryKind::shm).buffers, Eq(1u));
+    EXPECT_THAT(usage_of(client, mg::MemoryKind::hardware).buffers, Eq(1u));
+    EXPECT_THAT(mg::total_bytes(accounting->usage()[client.id].usage), Eq(2 * buffer_bytes));
+}
+
+TEST_F(MemoryAccounting, charge_over_quota_throws_and_is_not_recorded)
+{
+    auto const first = accounting->charge(a_buffer(), client, mg::MemoryKind::shm);
+    auto const second = accounting->charge(a_buffer(), client, mg::MemoryKind::shm);
+
+    EXPECT_THROW(accounting->charge(a_buffer(), client, mg::MemoryKind::shm), mg::MemoryQuotaExceeded);
+    EXPECT_THAT(usage_of(client, mg::MemoryKind::shm).buffers, Eq(2u));
+}
+
+TEST_F(MemoryAccounting, per_client_quota_overrides_the_default)
+{
+    accounting->set_quota(client, buffer_bytes);
+    auto const first = accounting->charge(a_buffer(), client, mg::MemoryKind::shm);
+
+    EXPECT_THROW(accounting->charge(a_buffer(), client, mg::MemoryKind::shm), mg::MemoryQuotaExceeded);
+
+    accounting->set_quota(client, 0);
+    EXPECT_NO_THROW(accounting->charge(a_buffer(), client, mg::MemoryKind::shm));
+}
+
+TEST_F(MemoryAccounting, server_has_no_quota)
+{
+    std::vector<std::shared_ptr<mg::Buffer>> buffers;
+    for (int i = 0; i != 4; ++i)
+        buffers.push_back(accounting->charge(a_buffer(), accounting->server(), mg::MemoryKind::internal));
+
+    EXPECT_THAT(usage_of(accounting->server(), mg::MemoryKind::internal).buffers, Eq(4u));
+}
+
+TEST_F(MemoryAccounting, clients_in_the_server_process_have_a_quota)
+{
+    auto const socketpair_client = accounting->new_client(getpid());
+    auto const first = accounting->charge(a_buffer(), socketpair_client, mg::MemoryKind::shm);
+    auto const second = accounting->charge(a_buffer(), socketpair_client, mg::MemoryKind::shm);
+
+    EXPECT_THROW(accounting->charge(a_buffer(), socketpair_client, mg::MemoryKind::shm), mg::MemoryQuotaExceeded);
+}
+
+TEST_F(MemoryAccounting, clients_in_the_same_process_are_accounted_separately)
+{
+    auto const other_client = accounting->new_client(client_pid);
+    auto const first = accounting->charge(a_buffer(), client, mg::MemoryKind::shm);
+    auto const second = accounting->charge(a_buffer(), client, mg::MemoryKind::shm);
+
+    EXPECT_NO_THROW(accounting->charge(a_buffer(), other_client, mg::MemoryKind::shm));
+    EXPECT_THAT(usage_of(client, mg::MemoryKind::shm).buffers, Eq(2u));
+}
+
+TEST_F(MemoryAccounting, usage_reports_the_pid_of_each_client)
+{
+    auto const charged = accounting->charge(a_buffer(), client, mg::MemoryKind::shm);
+
+    EXPECT_THAT(accounting->usage()[client.id].pid, Eq(client_pid));
+}
+
+TEST_F(MemoryAccounting, removing_a_client_drops_its_quota)
+{
+    accounting->set_quota(client, buffer_bytes);
+    accounting->remove_client(client);
+
+    auto const first = accounting->charge(a_buffer(), client, mg::MemoryKind::shm);
+    EXPECT_NO_THROW(accounting->charge(a_buffer(), client, mg::MemoryKind::shm));
+}
+
+TEST_F(MemoryAccounting, one_charge_may_cover_several_buffers)
+{
+    auto const first = a_buffer();
+    auto charge = accounting->charge_for(*first, client, mg::MemoryKind::hardware);
+    auto charged_first = mg::with_charge(first, charge);
+    auto charged_second = mg::with_charge(a_buffer(), charge);
+    charge.reset();
+
+    EXPECT_THAT(usage_of(client, mg::MemoryKind::hardware).buffers, Eq(1u));
+    EXPECT_THAT(usage_of(client, mg::MemoryKind::hardware).bytes, Eq(buffer_bytes));
+
+    charged_first.reset();
+    EXPECT_THAT(usage_of(client, mg::MemoryKind::hardware).buffers, Eq(1u));
+
+    charged_second.reset();
+    EXPECT_THAT(accounting->usage(), IsEmpty());
+}
+
+TEST(MemoryAccountingLifetime, buffers_may_outlive_the_accounting)
+{
+    auto accounting = std::make_shared<mg::MemoryAccounting>(0);
+    auto charged = accounting->charge(a_buffer(), accounting->new_client(client_pid), mg::MemoryKind::shm);
+
+    accounting.reset();
+
+    EXPECT_THAT(charged->size(), Eq(geom::Size{100, 100}));
+    charged.reset();
+}
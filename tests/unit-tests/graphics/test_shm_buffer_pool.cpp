@@ -0,0 +1,134 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/common/server/shm_buffer_pool.h"
+#include "src/platforms/common/server/egl_context_executor.h"
+#include "mir/renderer/gl/context.h"
+
+#include "mir/test/doubles/mock_gl.h"
+#include "mir/test/doubles/mock_egl.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mgc = mir::graphics::common;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+using namespace testing;
+
+namespace
+{
+struct StubGLContext : mir::renderer::gl::Context
+{
+    void make_current() const override {}
+    void release_current() const override {}
+};
+
+struct ShmBufferPool : Test
+{
+    NiceMock<mtd::MockEGL> mock_egl;
+    NiceMock<mtd::MockGL> mock_gl;
+
+    MirPixelFormat const format{mir_pixel_format_argb_8888};
+    std::shared_ptr<mgc::EGLContextExecutor> const egl_delegate{
+        std::make_shared<mgc::EGLContextExecutor>(std::make_unique<StubGLContext>())};
+    std::shared_ptr<mgc::ShmBufferPool> const pool{std::make_shared<mgc::ShmBufferPool>(egl_delegate)};
+};
+}
+
+TEST_F(ShmBufferPool, released_buffer_storage_is_kept_for_reuse)
+{
+    pool->alloc({100, 100}, format).reset();
+    EXPECT_THAT(pool->cached_bytes(), Ge(100u * 100 * 4));
+
+    auto const buffer = pool->alloc({100, 100}, format);
+    EXPECT_THAT(pool->cached_bytes(), Eq(0u));
+}
+
+TEST_F(ShmBufferPool, slightly_larger_buffer_reuses_storage)
+{
+    pool->alloc({200, 100}, format).reset();
+
+    auto const buffer = pool->alloc({203, 100}, format);
+    EXPECT_THAT(pool->cached_bytes(), Eq(0u));
+}
+
+TEST_F(ShmBufferPool, small_buffer_does_not_take_much_larger_storage)
+{
+    pool->alloc({1000, 1000}, format).reset();
+    auto const cached = pool->cached_bytes();
+
+    auto const buffer = pool->alloc({10, 10}, format);
+    EXPECT_THAT(pool->cached_bytes(), Eq(cached));
+}
+
+TEST_F(ShmBufferPool, reused_storage_holds_new_content)
+{
+    pool->alloc({16, 16}, format).reset();
+
+    auto const buffer = pool->alloc({16, 16}, format);
+    std::vector<unsigned char> const content(16 * 16 * 4, 0xa5);
+    buffer->write(content.data(), content.size());
+
+    buffer->read([&](unsigned char const* pixels)
+        {
+            EXPECT_THAT(std::vector<unsigned char>(pixels, pixels + content.size()), Eq(content));
+        });
+}
+
+TEST_F(ShmBufferPool, cached_storage_is_limited)
+{
+    auto const small_pool = std::make_shared<mgc::ShmBufferPool>(egl_delegate, 64 * 1024);
+
+    small_pool->alloc({100, 100}, format).reset();
+    small_pool->alloc({100, 100}, format).reset();
+    small_pool->alloc({200, 200}, format).reset();
+
+    EXPECT_THAT(small_pool->cached_bytes(), Le(64u * 1024));
+}
+
+TEST_F(ShmBufferPool, texture_is_reused_by_buffer_of_the_same_size_and_format)
+{
+    GLuint const texture{0x8086};
+    EXPECT_CALL(mock_gl, glGenTextures(1, _))
+        .WillOnce(SetArgPointee<1>(texture));
+    EXPECT_CALL(mock_gl, glDeleteTextures(_, _)).Times(0);
+
+    pool->alloc({64, 32}, format)->bind();
+    EXPECT_THAT(pool->cached_textures(), Eq(1u));
+
+    EXPECT_CALL(mock_gl, glBindTexture(GL_TEXTURE_2D, texture));
+    EXPECT_CALL(mock_gl, glTexImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+    EXPECT_CALL(mock_gl, glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 64, 32, _, _, _));
+
+    auto const buffer = pool->alloc({64, 32}, format);
+    buffer->bind();
+    EXPECT_THAT(pool->cached_textures(), Eq(0u));
+
+    Mock::VerifyAndClearExpectations(&mock_gl);
+}
+
+TEST_F(ShmBufferPool, texture_is_not_reused_by_buffer_of_another_size)
+{
+    EXPECT_CALL(mock_gl, glGenTextures(1, _))
+        .WillOnce(SetArgPointee<1>(1))
+        .WillOnce(SetArgPointee<1>(2));
+
+    pool->alloc({64, 32}, format)->bind();
+    pool->alloc({64, 33}, format)->bind();
+
+    EXPECT_THAT(pool->cached_textures(), Eq(2u));
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/graphics/sigbus_guard.h"
+#include "mir/anonymous_shm_file.h"
+
+#include <gtest/gtest.h>
+
+#include <csetjmp>
+#include <csignal>
+#include <unistd.h>
+
+namespace mg = mir::graphics;
+
+namespace
+{
+size_t const file_size = 4 * 4096;
+
+sigjmp_buf previous_handler_jump;
+
+extern "C" void previous_handler(int)
+{
+    siglongjmp(previous_handler_jump, 1);
+}
+
+struct SigbusGuard : testing::Test
+{
+    SigbusGuard()
+    {
+        struct sigaction action{};
+        action.sa_handler = &previous_handler;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGBUS, &action, &original_action);
+
+        mg::install_sigbus_guard_handler();
+    }
+
+    ~SigbusGuard()
+    {
+        mg::remove_sigbus_guard_handler();
+        sigaction(SIGBUS, &original_action, nullptr);
+    }
+
+    struct sigaction original_action;
+};
+}
+
+TEST_F(SigbusGuard, access_sees_file_content)
+{
+    mir::AnonymousShmFile shm_file{file_size};
+    auto const data = static_cast<unsigned char*>(shm_file.base_ptr());
+    data[0] = 0x42;
+    data[file_size - 1] = 0x43;
+
+    unsigned char first{0}, last{0};
+    auto const complete = mg::access_guarding_sigbus(
+        data, file_size, [&]() { first = data[0]; last = data[file_size - 1]; });
+
+    EXPECT_TRUE(complete);
+    EXPECT_EQ(0x42, first);
+    EXPECT_EQ(0x43, last);
+}
+
+TEST_F(SigbusGuard, access_to_truncated_file_reads_zeros)
+{
+    mir::AnonymousShmFile shm_file{file_size};
+    auto const data = static_cast<unsigned char*>(shm_file.base_ptr());
+    data[file_size - 1] = 0x43;
+
+    ASSERT_EQ(0, ftruncate(shm_file.fd(), 0));
+
+    unsigned char last{0xff};
+    auto const complete = mg::access_guarding_sigbus(
+        data, file_size, [&]() { last = data[file_size - 1]; });
+
+    EXPECT_FALSE(complete);
+    EXPECT_EQ(0, last);
+}
+
+TEST_F(SigbusGuard, later_accesses_to_replaced_range_are_complete)
+{
+    mir::AnonymousShmFile shm_file{file_size};
+    auto const data = static_cast<unsigned char*>(shm_file.base_ptr());
+
+    ASSERT_EQ(0, ftruncate(shm_file.fd(), 0));
+
+    unsigned char value{0xff};
+    mg::access_guarding_sigbus(data, file_size, [&]() { value = data[0]; });
+
+    EXPECT_TRUE(mg::access_guarding_sigbus(data, file_size, [&]() { value = data[0]; }));
+    EXPECT_EQ(0, value);
+}
+
+TEST_F(SigbusGuard, sigbus_outside_the_guarded_range_goes_to_the_previous_handler)
+{
+    mir::AnonymousShmFile shm_file{file_size};
+    auto const data = static_cast<unsigned char volatile*>(shm_file.base_ptr());
+
+    ASSERT_EQ(0, ftruncate(shm_file.fd(), 0));
+
+    bool chained{false};
+    if (sigsetjmp(previous_handler_jump, 1) == 0)
+    {
+        unsigned char const value = data[0];
+        (void)value;
+    }
+    else
+    {
+        chained = true;
+    }
+
+    EXPECT_TRUE(chained);
+}
+
+TEST_F(SigbusGuard, removing_the_handler_restores_the_previous_one)
+{
+    mg::remove_sigbus_guard_handler();
+
+    struct sigaction current;
+    sigaction(SIGBUS, nullptr, &current);
+
+    EXPECT_EQ(&previous_handler, current.sa_handler);
+}
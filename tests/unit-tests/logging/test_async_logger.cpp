@@ -0,0 +1,278 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/logging/async_logger.h"
+#include "mir/logging/timestamped_logger.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ml = mir::logging;
+
+using namespace testing;
+
+namespace
+{
+class RecordingLogger : public ml::TimestampedLogger
+{
+public:
+    void log(ml::Severity severity, std::string const& message, std::string const& component) override
+    {
+        log(std::chrono::system_clock::now(), severity, message, component);
+    }
+
+    void log(
+        std::chrono::system_clock::time_point logged_at,
+        ml::Severity,
+        std::string const& message,
+        std::string const& component) override
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        messages.push_back(component + ": " + message);
+        timestamps.push_back(logged_at);
+        threads.push_back(std::this_thread::get_id());
+        written.notify_all();
+        blocked.wait(lock, [this] { return !blocking; });
+    }
+
+    void wait_for(size_t count)
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        written.wait(lock, [&] { return messages.size() >= count; });
+    }
+
+    void block()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        blocking = true;
+    }
+
+    void unblock()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            blocking = false;
+        }
+        blocked.notify_all();
+    }
+
+    std::mutex mutex;
+    std::condition_variable blocked;
+    std::condition_variable written;
+    bool blocking{false};
+    std::vector<std::string> messages;
+    std::vector<std::chrono::system_clock::time_point> timestamps;
+    std::vector<std::thread::id> threads;
+};
+
+struct AsyncLogger : Test
+{
+    std::shared_ptr<RecordingLogger> const sink = std::make_shared<RecordingLogger>();
+};
+}
+
+TEST_F(AsyncLogger, writes_messages_in_order_on_another_thread)
+{
+    {
+        ml::AsyncLogger logger{sink};
+        logger.log(ml::Severity::informational, "first", "test");
+        logger.log("test", ml::Severity::warning, "second %d", 2);
+    }
+
+    EXPECT_THAT(sink->messages, ElementsAre("test: first", "test: second 2"));
+    EXPECT_THAT(sink->threads, Each(Ne(std::this_thread::get_id())));
+}
+
+TEST_F(AsyncLogger, writes_critical_messages_immediately)
+{
+    ml::AsyncLogger logger{sink};
+
+    logger.log(ml::Severity::critical, "about to abort", "test");
+
+    EXPECT_THAT(sink->messages, ElementsAre("test: about to abort"));
+    EXPECT_THAT(sink->threads, ElementsAre(std::this_thread::get_id()));
+}
+
+TEST_F(AsyncLogger, collapses_repeated_messages)
+{
+    {
+        ml::AsyncLogger logger{sink};
+        for (int i = 0; i != 5; ++i)
+            logger.log(ml::Severity::debug, "again", "test");
+        logger.log(ml::Severity::debug, "different", "test");
+    }
+
+    EXPECT_THAT(sink->messages, ElementsAre(
+        "test: again",
+        "test: Previous message repeated 4 times",
+        "test: different"));
+}
+
+TEST_F(AsyncLogger, summarises_a_continuing_run_of_repeats_without_another_message)
+{
+    ml::AsyncLogger logger{sink};
+    for (int i = 0; i != 3; ++i)
+        logger.log(ml::Severity::debug, "again", "test");
+
+    sink->wait_for(2);
+
+    std::lock_guard<std::mutex> lock{sink->mutex};
+    EXPECT_THAT(sink->messages, ElementsAre("test: again", "test: Previous message repeated 2 times"));
+}
+
+TEST_F(AsyncLogger, drops_and_counts_messages_when_a_thread_outpaces_the_writer)
+{
+    int const logged = 100;
+    uint64_t dropped = 0;
+    {
+        ml::AsyncLogger logger{sink, 1024};
+
+        // Stall the writer on the first message so the ring fills
+        sink->block();
+        for (int i = 0; i != logged; ++i)
+            logger.log("test", ml::Severity::informational, "message %d of a reasonable length", i);
+        dropped = logger.dropped_messages();
+        sink->unblock();
+    }
+
+    EXPECT_THAT(dropped, Gt(0u));
+    EXPECT_THAT(sink->messages, Contains(HasSubstr("Dropped")));
+    EXPECT_THAT(sink->messages.size(), Eq(logged - dropped + 1));
+}
+
+TEST_F(AsyncLogger, wraps_records_around_the_end_of_the_ring)
+{
+    std::vector<std::string> expected;
+    {
+        ml::AsyncLogger logger{sink, 1024};
+
+        // Varying the length leaves every possible gap at the end of the ring (including
+        // capacity - 16 for 48 byte records), and flushing keeps the ring from filling
+        for (int i = 0; i != 200; ++i)
+        {
+            std::string const message(i % 41, 'a' + i % 26);
+            logger.log(ml::Severity::informational, message, "test");
+            expected.push_back("test: " + message);
+            logger.flush();
+        }
+    }
+
+    EXPECT_THAT(sink->messages, ContainerEq(expected));
+}
+
+TEST_F(AsyncLogger, writes_messages_from_threads_that_have_exited)
+{
+    {
+        ml::AsyncLogger logger{sink};
+        std::thread{[&] { logger.log(ml::Severity::informational, "from a thread", "test"); }}.join();
+        std::thread{[&] { logger.log(ml::Severity::informational, "from another", "test"); }}.join();
+    }
+
+    EXPECT_THAT(sink->messages, UnorderedElementsAre("test: from a thread", "test: from another"));
+}
+
+TEST_F(AsyncLogger, writes_messages_from_all_threads_in_the_order_they_were_logged)
+{
+    {
+        ml::AsyncLogger logger{sink};
+
+        // Hold the writer up, so the rest are all queued when it looks
+        sink->block();
+        logger.log(ml::Severity::informational, "first", "test");
+        sink->wait_for(1);
+
+        std::thread{[&] { logger.log(ml::Severity::informational, "second", "test"); }}.join();
+        logger.log(ml::Severity::informational, "third", "test");
+        std::thread{[&] { logger.log(ml::Severity::informational, "fourth", "test"); }}.join();
+        sink->unblock();
+    }
+
+    EXPECT_THAT(sink->messages, ElementsAre("test: first", "test: second", "test: third", "test: fourth"));
+}
+
+TEST_F(AsyncLogger, timestamps_messages_when_they_are_logged)
+{
+    auto const before = std::chrono::system_clock::now();
+    auto after = before;
+    {
+        ml::AsyncLogger logger{sink};
+
+        sink->block();
+        logger.log(ml::Severity::informational, "first", "test");
+        sink->wait_for(1);
+        logger.log(ml::Severity::informational, "second", "test");
+        after = std::chrono::system_clock::now();
+
+        std::this_thread::sleep_for(std::chrono::milliseconds{50});
+        sink->unblock();
+    }
+
+    ASSERT_THAT(sink->timestamps.size(), Eq(2u));
+    EXPECT_THAT(sink->timestamps[1], AllOf(Ge(before), Le(after)));
+}
+
+TEST_F(AsyncLogger, writes_queued_messages_before_a_critical_message)
+{
+    ml::AsyncLogger logger{sink};
+
+    sink->block();
+    logger.log(ml::Severity::informational, "first", "test");
+    sink->wait_for(1);
+    logger.log(ml::Severity::informational, "queued", "test");
+
+    std::thread critical{[&] { logger.log(ml::Severity::critical, "about to abort", "test"); }};
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    sink->unblock();
+    critical.join();
+
+    EXPECT_THAT(sink->messages, ElementsAre("test: first", "test: queued", "test: about to abort"));
+}
+
+TEST_F(AsyncLogger, flush_writes_queued_messages)
+{
+    ml::AsyncLogger logger{sink};
+
+    logger.log(ml::Severity::informational, "queued", "test");
+    logger.flush();
+
+    std::lock_guard<std::mutex> lock{sink->mutex};
+    EXPECT_THAT(sink->messages, ElementsAre("test: queued"));
+}
+
+TEST_F(AsyncLogger, flush_all_writes_messages_queued_for_every_logger)
+{
+    auto const other_sink = std::make_shared<RecordingLogger>();
+    ml::AsyncLogger logger{sink};
+    ml::AsyncLogger other_logger{other_sink};
+
+    logger.log(ml::Severity::informational, "queued", "test");
+    other_logger.log(ml::Severity::informational, "also queued", "test");
+    ml::AsyncLogger::flush_all();
+
+    {
+        std::lock_guard<std::mutex> lock{sink->mutex};
+        EXPECT_THAT(sink->messages, ElementsAre("test: queued"));
+    }
+    std::lock_guard<std::mutex> lock{other_sink->mutex};
+    EXPECT_THAT(other_sink->messages, ElementsAre("test: also queued"));
+}
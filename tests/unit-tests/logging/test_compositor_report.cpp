@@ -189,3 +189,31 @@ TEST_F(LoggingCompositorReport, bypass_has_no_render_time)
 
     report.stopped();
 }
+
+TEST_F(LoggingCompositorReport, reports_average_stage_times)
+{
+    using FrameStage = mrl::CompositorReport::FrameStage;
+    const void* const id = "My Screen";
+
+    report.started();
+
+    for (int f = 0; f < 3; ++f)
+    {
+        report.began_frame(id);
+        report.frame_stage_timing(id, FrameStage::occlusion, chrono::microseconds(250));
+        report.frame_stage_timing(id, FrameStage::gpu, chrono::microseconds(1000 + 500 * f));
+        report.rendered_frame(id);
+        report.finished_frame(id);
+        clock->advance_by(chrono::microseconds(1234567));
+    }
+    EXPECT_TRUE(recorder->last_message_contains("average stage times"))
+        << recorder->last_message();
+    EXPECT_TRUE(recorder->last_message_contains("occlusion 0.250 ms"))
+        << recorder->last_message();
+    EXPECT_TRUE(recorder->last_message_contains("gpu 2.000 ms"))
+        << recorder->last_message();
+    EXPECT_FALSE(recorder->last_message_contains("swap"))
+        << recorder->last_message();
+
+    report.stopped();
+}
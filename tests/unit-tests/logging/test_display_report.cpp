@@ -197,3 +197,14 @@ TEST_F(DisplayReport, reports_vsync_steady_interval_despite_missed_frames)
     frame.ust.nanoseconds += d2 * nanos_per_frame;
     report.report_vsync(id, frame);
 }
+
+TEST_F(DisplayReport, reports_bypass_failure_with_output_and_reason)
+{
+    EXPECT_CALL(*logger, log(
+        ml::Severity::informational,
+        AllOf(HasSubstr("output 42"), HasSubstr("topmost surface is translucent")),
+        component));
+
+    mrl::DisplayReport report(logger);
+    report.report_bypass_failure(42, "topmost surface is translucent");
+}
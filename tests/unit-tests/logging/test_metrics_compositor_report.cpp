@@ -0,0 +1,122 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/report/metrics/compositor_report.h"
+#include "src/server/report/metrics/registry.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <thread>
+
+namespace mrm = mir::report::metrics;
+
+using namespace testing;
+using FrameStage = mir::compositor::CompositorReport::FrameStage;
+
+namespace
+{
+struct MetricsCompositorReport : Test
+{
+    std::shared_ptr<mrm::Registry> const registry = std::make_shared<mrm::Registry>();
+    mrm::CompositorReport report{registry};
+
+    int const first_compositor{0};
+    int const second_compositor{0};
+};
+}
+
+TEST_F(MetricsCompositorReport, counts_rendered_and_bypassed_frames_per_display)
+{
+    report.added_display(1920, 1080, 0, 0, &first_compositor);
+    report.added_display(1280, 1024, -1280, 0, &second_compositor);
+
+    report.began_frame(&first_compositor);
+    report.rendered_frame(&first_compositor);
+    report.finished_frame(&first_compositor);
+    report.began_frame(&first_compositor);
+    report.finished_frame(&first_compositor);
+    report.began_frame(&second_compositor);
+    report.rendered_frame(&second_compositor);
+    report.finished_frame(&second_compositor);
+
+    auto const metrics = registry->render();
+    EXPECT_THAT(metrics, HasSubstr("\nmir_compositor_frames_total{display=\"1920x1080+0+0\"} 2\n"));
+    EXPECT_THAT(metrics, HasSubstr("\nmir_compositor_bypassed_frames_total{display=\"1920x1080+0+0\"} 1\n"));
+    EXPECT_THAT(metrics, HasSubstr("\nmir_compositor_frames_total{display=\"1280x1024-1280+0\"} 1\n"));
+    EXPECT_THAT(metrics, HasSubstr("\nmir_compositor_bypassed_frames_total{display=\"1280x1024-1280+0\"} 0\n"));
+    EXPECT_THAT(metrics, HasSubstr("\nmir_compositor_frame_seconds_count{display=\"1920x1080+0+0\"} 2\n"));
+}
+
+TEST_F(MetricsCompositorReport, records_renderables_and_stage_times)
+{
+    report.added_display(1920, 1080, 0, 0, &first_compositor);
+
+    report.renderables_in_frame(&first_compositor, {nullptr, nullptr, nullptr});
+    report.frame_stage_timing(&first_compositor, FrameStage::draw, std::chrono::milliseconds{3});
+
+    auto const metrics = registry->render();
+    EXPECT_THAT(metrics, HasSubstr("\nmir_compositor_renderables{display=\"1920x1080+0+0\"} 3\n"));
+    EXPECT_THAT(metrics, HasSubstr(
+        "\nmir_compositor_frame_stage_seconds_bucket{display=\"1920x1080+0+0\",stage=\"draw\",le=\"0.002\"} 0\n"
+        "mir_compositor_frame_stage_seconds_bucket{display=\"1920x1080+0+0\",stage=\"draw\",le=\"0.004\"} 1\n"));
+    EXPECT_THAT(metrics, HasSubstr(
+        "\nmir_compositor_frame_stage_seconds_sum{display=\"1920x1080+0+0\",stage=\"draw\"} 0.003\n"));
+    EXPECT_THAT(metrics, HasSubstr(
+        "\nmir_compositor_frame_stage_seconds_count{display=\"1920x1080+0+0\",stage=\"post\"} 0\n"));
+}
+
+TEST_F(MetricsCompositorReport, compositors_from_before_a_restart_are_forgotten)
+{
+    report.added_display(1920, 1080, 0, 0, &first_compositor);
+    report.began_frame(&first_compositor);
+    report.finished_frame(&first_compositor);
+    report.stopped();
+
+    // A compositor created after the restart may reuse the address of an old one
+    report.started();
+    report.added_display(3840, 2160, 0, 0, &first_compositor);
+    report.began_frame(&first_compositor);
+    report.finished_frame(&first_compositor);
+
+    auto const metrics = registry->render();
+    EXPECT_THAT(metrics, HasSubstr("\nmir_compositor_frames_total{display=\"1920x1080+0+0\"} 1\n"));
+    EXPECT_THAT(metrics, HasSubstr("\nmir_compositor_frames_total{display=\"3840x2160+0+0\"} 1\n"));
+}
+
+TEST_F(MetricsCompositorReport, counts_frames_from_concurrent_compositors)
+{
+    int const frames = 1000;
+    auto const composite = [&](int const* compositor, int x)
+        {
+            report.added_display(1920, 1080, x, 0, compositor);
+            for (int i = 0; i != frames; ++i)
+            {
+                report.began_frame(compositor);
+                report.rendered_frame(compositor);
+                report.finished_frame(compositor);
+            }
+        };
+
+    std::thread first{composite, &first_compositor, 0};
+    std::thread second{composite, &second_compositor, 1920};
+    first.join();
+    second.join();
+
+    auto const metrics = registry->render();
+    EXPECT_THAT(metrics, HasSubstr("\nmir_compositor_frames_total{display=\"1920x1080+0+0\"} 1000\n"));
+    EXPECT_THAT(metrics, HasSubstr("\nmir_compositor_frames_total{display=\"1920x1080+1920+0\"} 1000\n"));
+}
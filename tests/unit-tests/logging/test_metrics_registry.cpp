@@ -0,0 +1,166 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/report/metrics/endpoint.h"
+#include "src/server/report/metrics/registry.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace mrm = mir::report::metrics;
+
+using namespace testing;
+
+namespace
+{
+auto request(std::string const& path, std::string const& message) -> std::string
+{
+    mir::Fd const fd{socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path.c_str(), sizeof address.sun_path - 1);
+    if (connect(fd, reinterpret_cast<sockaddr const*>(&address), sizeof address) != 0)
+        return {};
+
+    if (!message.empty())
+        send(fd, message.data(), message.size(), MSG_NOSIGNAL);
+
+    std::string response;
+    char buffer[1024];
+    ssize_t received;
+    while ((received = recv(fd, buffer, sizeof buffer, 0)) > 0)
+        response.append(buffer, received);
+    return response;
+}
+}
+
+TEST(MetricsRegistry, counts_from_all_threads)
+{
+    mrm::Registry registry;
+    auto& counter = registry.counter("test_total", "A counter");
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i != 8; ++i)
+        threads.emplace_back([&] { for (int j = 0; j != 1000; ++j) counter.increment(); });
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_THAT(counter.value(), Eq(8000u));
+    EXPECT_THAT(registry.render(), HasSubstr("\ntest_total 8000\n"));
+}
+
+TEST(MetricsRegistry, same_name_and_labels_are_the_same_metric)
+{
+    mrm::Registry registry;
+
+    auto& a = registry.gauge("test", "A gauge", {{"display", "a"}});
+    auto& b = registry.gauge("test", "A gauge", {{"display", "b"}});
+
+    EXPECT_THAT(&registry.gauge("test", "A gauge", {{"display", "a"}}), Eq(&a));
+    EXPECT_THAT(&b, Ne(&a));
+}
+
+TEST(MetricsRegistry, conflicting_types_are_an_error)
+{
+    mrm::Registry registry;
+    registry.counter("test", "A counter");
+
+    EXPECT_THROW(registry.gauge("test", "A gauge"), std::logic_error);
+}
+
+TEST(MetricsRegistry, renders_prometheus_text_format)
+{
+    mrm::Registry registry;
+    registry.gauge("test_gauge", "A gauge", {{"name", "say \"hi\""}}).set(-3);
+    auto& histogram = registry.histogram("test_seconds", "A histogram", {0.1, 1}, {{"stage", "draw"}});
+    histogram.observe(0.05);
+    histogram.observe(0.5);
+    histogram.observe(5);
+
+    EXPECT_THAT(registry.render(), StrEq(
+        "# HELP test_gauge A gauge\n"
+        "# TYPE test_gauge gauge\n"
+        "test_gauge{name=\"say \\\"hi\\\"\"} -3\n"
+        "# HELP test_seconds A histogram\n"
+        "# TYPE test_seconds histogram\n"
+        "test_seconds_bucket{stage=\"draw\",le=\"0.1\"} 1\n"
+        "test_seconds_bucket{stage=\"draw\",le=\"1\"} 2\n"
+        "test_seconds_bucket{stage=\"draw\",le=\"+Inf\"} 3\n"
+        "test_seconds_sum{stage=\"draw\"} 5.55\n"
+        "test_seconds_count{stage=\"draw\"} 3\n"));
+}
+
+TEST(MetricsRegistry, collectors_write_after_registered_metrics)
+{
+    mrm::Registry registry;
+    int value = 1;
+    registry.add_collector([&](std::ostream& out) { out << "test_collected " << value << '\n'; });
+    registry.counter("test_total", "A counter").increment();
+
+    EXPECT_THAT(registry.render(), EndsWith("\ntest_total 1\ntest_collected 1\n"));
+
+    value = 2;
+    EXPECT_THAT(registry.render(), EndsWith("\ntest_collected 2\n"));
+}
+
+TEST(MetricsEndpoint, serves_metrics_over_http_and_plain_connections)
+{
+    auto const path = std::string{"/tmp/mir_test_metrics_"} + std::to_string(getpid());
+    auto const registry = std::make_shared<mrm::Registry>();
+    registry->counter("test_total", "A counter").increment(2);
+
+    mrm::Endpoint const endpoint{path, registry};
+
+    auto const http = request(path, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    EXPECT_THAT(http, StartsWith("HTTP/1.0 200 OK\r\n"));
+    EXPECT_THAT(http, HasSubstr("Content-Type: text/plain; version=0.0.4\r\n"));
+    EXPECT_THAT(http, EndsWith("\ntest_total 2\n"));
+
+    EXPECT_THAT(request(path, ""), StartsWith("# HELP test_total A counter\n"));
+}
+
+TEST(MetricsEndpoint, a_client_that_stops_reading_does_not_block_later_scrapes)
+{
+    auto const path = std::string{"/tmp/mir_test_metrics_"} + std::to_string(getpid());
+    auto const registry = std::make_shared<mrm::Registry>();
+
+    // Enough output to fill the socket buffers of a client that doesn't read it
+    std::string const padding(100, 'x');
+    for (int i = 0; i != 20000; ++i)
+        registry->gauge("test_gauge", "A gauge", {{"name", padding + std::to_string(i)}}).set(i);
+
+    mrm::Endpoint const endpoint{path, registry};
+
+    mir::Fd const stalled{socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path.c_str(), sizeof address.sun_path - 1);
+    ASSERT_THAT(connect(stalled, reinterpret_cast<sockaddr const*>(&address), sizeof address), Eq(0));
+    std::string const get{"GET /metrics HTTP/1.1\r\n\r\n"};
+    send(stalled, get.data(), get.size(), MSG_NOSIGNAL);
+
+    EXPECT_THAT(request(path, get), EndsWith("\ntest_gauge{name=\"" + padding + "9999\"} 9999\n"));
+}
@@ -0,0 +1,298 @@
+/*
+ * Copyright © 2018 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Christopher James Halse Rogers <christopher.halse.rogers@canonical.com>
+ */
+
+#include "kms-utils/drm_event_dispatcher.h"
+
+#include "mir/test/doubles/mock_drm.h"
+
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <system_error>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mgk = mir::graphics::kms;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+
+class DRMEventDispatcherTest : public testing::Test
+{
+private:
+    struct EventDetails
+    {
+        unsigned int frame_no = {};
+        unsigned int tv_sec = {};
+        unsigned int tv_usec = {};
+        void* userdata = {};
+    };
+
+public:
+    DRMEventDispatcherTest()
+        : mock_drm_fd{mock_drm.open(device_node, 0, 0)}
+    {
+        ON_CALL(mock_drm, drmHandleEvent(static_cast<int>(mock_drm_fd), _))
+            .WillByDefault(
+                Invoke(
+                    [this](auto drm_fd, drmEventContextPtr ctx) -> int
+                    {
+                        EXPECT_THAT(ctx->page_flip_handler, NotNull());
+                        if (!ctx->page_flip_handler)
+                            return -1;
+
+                        EventDetails event;
+                        {
+                            std::lock_guard<std::mutex> lock{event_mutex};
+                            if (expected_events.empty())
+                            {
+                                ADD_FAILURE() << "drmHandleEvent called with no pending event";
+                                return -1;
+                            }
+                            event = expected_events.front();
+                            expected_events.pop_front();
+                        }
+
+                        ctx->page_flip_handler(
+                            drm_fd,
+                            event.frame_no,
+                            event.tv_sec,
+                            event.tv_usec,
+                            event.userdata);
+
+                        mock_drm.consume_event_on(device_node);
+                        return 0;
+                    }));
+    }
+
+    void add_flip_event(
+        unsigned int frame_no,
+        unsigned int tv_sec,
+        unsigned int tv_usec,
+        void* userdata)
+    {
+        std::lock_guard<std::mutex> lock{event_mutex};
+
+        expected_events.emplace_back(
+            EventDetails
+            {
+                frame_no,
+                tv_sec,
+                tv_usec,
+                userdata
+            });
+
+        mock_drm.generate_event_on(device_node);
+    }
+
+    ::testing::NiceMock<mtd::MockDRM> mock_drm;
+
+    char const* const device_node = "/dev/dri/card0";
+    mir::Fd mock_drm_fd;
+
+private:
+    std::mutex event_mutex;
+    std::deque<EventDetails> expected_events;
+};
+
+TEST_F(DRMEventDispatcherTest, flip_completion_handle_becomes_ready_on_flip)
+{
+    using namespace std::literals::chrono_literals;
+
+    mgk::DRMEventDispatcher dispatcher{mock_drm_fd};
+    mgk::DRMEventDispatcher::CrtcId const crtc_id{55};
+
+    auto completion_handle = dispatcher.expect_flip_event(crtc_id, [](auto, auto){});
+
+    ASSERT_TRUE(completion_handle.valid());
+    EXPECT_THAT(completion_handle.wait_for(0ms), Not(Eq(std::future_status::ready)));
+
+    add_flip_event(0, 0, 0, dispatcher.event_data_for(crtc_id));
+
+    EXPECT_THAT(completion_handle.wait_for(30s), Eq(std::future_status::ready));
+}
+
+TEST_F(DRMEventDispatcherTest, calls_frame_callback_on_flip_completion)
+{
+    using namespace std::literals::chrono_literals;
+
+    mgk::DRMEventDispatcher dispatcher{mock_drm_fd};
+    mgk::DRMEventDispatcher::CrtcId const crtc_id{55};
+    int constexpr frame_sec{10};
+    int constexpr frame_usec{400};
+    unsigned int constexpr expected_frame_no{3441};
+
+    auto completion_handle = dispatcher.expect_flip_event(
+        crtc_id,
+        [frame_sec, frame_usec](unsigned int frame_no, std::chrono::nanoseconds frame_time)
+        {
+            EXPECT_THAT(frame_no, Eq(expected_frame_no));
+            EXPECT_THAT(frame_time, Eq(std::chrono::seconds{frame_sec} + std::chrono::microseconds{frame_usec}));
+        });
+
+    add_flip_event(expected_frame_no, frame_sec, frame_usec, dispatcher.event_data_for(crtc_id));
+    EXPECT_THAT(completion_handle.wait_for(30s), Eq(std::future_status::ready));
+}
+
+TEST_F(DRMEventDispatcherTest, handles_spurious_drm_events)
+{
+    using namespace std::literals::chrono_literals;
+
+    mgk::DRMEventDispatcher dispatcher{mock_drm_fd};
+    mgk::DRMEventDispatcher::CrtcId const crtc_id{55};
+    int constexpr frame_sec{10};
+    int constexpr frame_usec{400};
+    unsigned int constexpr expected_frame_no{3441};
+
+    auto completion_handle = dispatcher.expect_flip_event(
+        crtc_id,
+        [frame_sec, frame_usec](unsigned int frame_no, std::chrono::nanoseconds frame_time)
+        {
+            EXPECT_THAT(frame_no, Eq(expected_frame_no));
+            EXPECT_THAT(frame_time, Eq(std::chrono::seconds{frame_sec} + std::chrono::microseconds{frame_usec}));
+        });
+
+    add_flip_event(23, 10, 10, dispatcher.event_data_for(5));
+    add_flip_event(33, 20, 0, dispatcher.event_data_for(10));
+    add_flip_event(expected_frame_no, frame_sec, frame_usec, dispatcher.event_data_for(crtc_id));
+
+    EXPECT_THAT(completion_handle.wait_for(30s), Eq(std::future_status::ready));
+}
+
+TEST_F(DRMEventDispatcherTest, dispatches_event_for_correct_crtc)
+{
+    using namespace std::literals::chrono_literals;
+
+    mgk::DRMEventDispatcher dispatcher{mock_drm_fd};
+    mgk::DRMEventDispatcher::CrtcId const crtc_one{55};
+    mgk::DRMEventDispatcher::CrtcId const crtc_two{44};
+
+    std::atomic<bool> first_flip_done{false};
+    std::atomic<bool> second_flip_done{false};
+
+    auto first_handle = dispatcher.expect_flip_event(
+        crtc_one,
+        [&first_flip_done](auto, auto){ first_flip_done = true; });
+    auto second_handle = dispatcher.expect_flip_event(
+        crtc_two,
+        [&second_flip_done](auto, auto){ second_flip_done = true; });
+
+    add_flip_event(0, 0, 0, dispatcher.event_data_for(crtc_two));
+
+    EXPECT_THAT(second_handle.wait_for(30s), Eq(std::future_status::ready));
+    EXPECT_TRUE(second_flip_done);
+    EXPECT_FALSE(first_flip_done);
+
+    add_flip_event(0, 0, 0, dispatcher.event_data_for(crtc_one));
+    EXPECT_THAT(first_handle.wait_for(30s), Eq(std::future_status::ready));
+    EXPECT_TRUE(first_flip_done);
+}
+
+TEST_F(DRMEventDispatcherTest, callback_may_expect_the_next_flip)
+{
+    using namespace std::literals::chrono_literals;
+
+    mgk::DRMEventDispatcher dispatcher{mock_drm_fd};
+    mgk::DRMEventDispatcher::CrtcId const crtc_id{55};
+
+    std::future<void> next_handle;
+    auto first_handle = dispatcher.expect_flip_event(
+        crtc_id,
+        [&](auto, auto)
+        {
+            next_handle = dispatcher.expect_flip_event(crtc_id, [](auto, auto){});
+        });
+
+    add_flip_event(0, 0, 0, dispatcher.event_data_for(crtc_id));
+    ASSERT_THAT(first_handle.wait_for(30s), Eq(std::future_status::ready));
+
+    ASSERT_TRUE(next_handle.valid());
+    add_flip_event(1, 0, 0, dispatcher.event_data_for(crtc_id));
+    EXPECT_THAT(next_handle.wait_for(30s), Eq(std::future_status::ready));
+}
+
+TEST_F(DRMEventDispatcherTest, cancelled_flip_completes_without_callback)
+{
+    using namespace std::literals::chrono_literals;
+
+    mgk::DRMEventDispatcher dispatcher{mock_drm_fd};
+    mgk::DRMEventDispatcher::CrtcId const crtc_id{55};
+
+    auto handle = dispatcher.expect_flip_event(
+        crtc_id,
+        [](auto, auto) { ADD_FAILURE() << "Cancelled flip was dispatched"; });
+
+    dispatcher.cancel_flip_event(crtc_id);
+
+    EXPECT_THAT(handle.wait_for(0s), Eq(std::future_status::ready));
+    EXPECT_NO_THROW(dispatcher.expect_flip_event(crtc_id, [](auto, auto){}));
+}
+
+TEST_F(DRMEventDispatcherTest, failure_to_handle_events_fails_pending_flips)
+{
+    using namespace std::literals::chrono_literals;
+
+    EXPECT_CALL(mock_drm, drmHandleEvent(static_cast<int>(mock_drm_fd), _))
+        .WillOnce(
+            InvokeWithoutArgs(
+                [this]()
+                {
+                    mock_drm.consume_event_on(device_node);
+                    errno = EIO;
+                    return -1;
+                }));
+
+    mgk::DRMEventDispatcher dispatcher{mock_drm_fd};
+    mgk::DRMEventDispatcher::CrtcId const crtc_id{55};
+
+    auto handle = dispatcher.expect_flip_event(crtc_id, [](auto, auto){});
+
+    mock_drm.generate_event_on(device_node);
+
+    ASSERT_THAT(handle.wait_for(30s), Eq(std::future_status::ready));
+    EXPECT_THROW(handle.get(), std::system_error);
+}
+
+TEST_F(DRMEventDispatcherTest, losing_the_drm_fd_fails_pending_and_later_flips)
+{
+    using namespace std::literals::chrono_literals;
+
+    auto const dispatcher_fd = ::dup(mock_drm_fd);
+    ASSERT_THAT(dispatcher_fd, Ge(0));
+
+    mgk::DRMEventDispatcher dispatcher{mir::Fd{dispatcher_fd}};
+    mgk::DRMEventDispatcher::CrtcId const crtc_id{55};
+
+    auto pending = dispatcher.expect_flip_event(
+        crtc_id,
+        [](auto, auto) { ADD_FAILURE() << "Flip dispatched from a closed fd"; });
+
+    // Pull the fd out from under the dispatcher (it will get EBADF closing it again)
+    ::close(dispatcher_fd);
+
+    ASSERT_THAT(pending.wait_for(30s), Eq(std::future_status::ready));
+    EXPECT_THROW(pending.get(), std::system_error);
+
+    // Nothing is dispatching any more, so a later flip must not wait forever
+    auto later = dispatcher.expect_flip_event(crtc_id, [](auto, auto){});
+    ASSERT_THAT(later.wait_for(0s), Eq(std::future_status::ready));
+    EXPECT_THROW(later.get(), std::system_error);
+}
@@ -57,6 +57,11 @@ struct MockKMSOutput : public graphics::gbm::KMSOutput
         return schedule_page_flip_thunk(&fb);
     }
     MOCK_METHOD1(schedule_page_flip_thunk, bool(graphics::gbm::FBHandle const*));
+    bool schedule_async_page_flip(graphics::gbm::FBHandle const& fb) override
+    {
+        return schedule_async_page_flip_thunk(&fb);
+    }
+    MOCK_METHOD1(schedule_async_page_flip_thunk, bool(graphics::gbm::FBHandle const*));
     MOCK_METHOD0(wait_for_page_flip, void());
 
     MOCK_CONST_METHOD0(last_frame, graphics::Frame());
@@ -66,14 +71,20 @@ struct MockKMSOutput : public graphics::gbm::KMSOutput
     MOCK_METHOD0(clear_cursor, bool());
     MOCK_CONST_METHOD0(has_cursor, bool());
 
+    MOCK_METHOD1(set_vrr_enabled, bool(bool));
+    MOCK_CONST_METHOD1(supports_scanout_transformation, bool(glm::mat2 const&));
+    MOCK_METHOD1(set_scanout_transformation, bool(glm::mat2 const&));
     MOCK_METHOD1(set_power_mode, void(MirPowerMode));
     MOCK_METHOD1(set_gamma, void(mir::graphics::GammaCurves const&));
+    MOCK_METHOD2(set_colour_pipeline, void(mir::graphics::GammaCurves const&, glm::mat3 const&));
+    MOCK_METHOD1(set_hdr_metadata, void(mir::optional_value<mir::graphics::HdrOutputMetadata> const&));
 
     MOCK_METHOD0(refresh_hardware_state, void());
     MOCK_CONST_METHOD1(update_from_hardware_state, void(graphics::DisplayConfigurationOutput&));
 
     MOCK_CONST_METHOD1(fb_for, std::shared_ptr<graphics::gbm::FBHandle const>(gbm_bo*));
     MOCK_CONST_METHOD1(fb_for, std::shared_ptr<graphics::gbm::FBHandle const>(graphics::DMABufBuffer const&));
+    MOCK_CONST_METHOD1(prime_fb_for, std::shared_ptr<graphics::gbm::FBHandle const>(gbm_bo*));
     MOCK_CONST_METHOD1(buffer_requires_migration, bool(gbm_bo*));
     MOCK_CONST_METHOD0(drm_fd, int());
 };
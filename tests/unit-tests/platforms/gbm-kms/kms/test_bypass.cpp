@@ -268,3 +268,29 @@ TEST_F(BypassMatchTest, multimonitor_oversized_no_bypass)
     EXPECT_EQ(list.rend(), std::find_if(list.rbegin(), list.rend(), primary_matcher));
     EXPECT_EQ(list.rend(), std::find_if(list.rbegin(), list.rend(), secondary_matcher));
 }
+
+TEST_F(BypassMatchTest, cropped_fullscreen_window_not_bypassed)
+{
+    mgg::BypassMatch matcher(primary_monitor);
+
+    auto window = std::make_shared<mtd::FakeRenderable>(0, 0, 1920, 1200);
+    window->set_buffer(std::make_shared<mtd::StubBuffer>(geom::Size{3840, 2400}));
+    window->set_src_bounds(geom::Rectangle{{0, 0}, {1920, 1200}});
+    mg::RenderableList list{window};
+
+    EXPECT_EQ(list.rend(), std::find_if(list.rbegin(), list.rend(), matcher));
+}
+
+TEST_F(BypassMatchTest, fullscreen_window_with_whole_buffer_src_bounds_bypassed)
+{
+    mgg::BypassMatch matcher(primary_monitor);
+
+    auto window = std::make_shared<mtd::FakeRenderable>(0, 0, 1920, 1200);
+    window->set_buffer(std::make_shared<mtd::StubBuffer>(geom::Size{1920, 1200}));
+    window->set_src_bounds(geom::Rectangle{{0, 0}, {1920, 1200}});
+    mg::RenderableList list{window};
+
+    auto it = std::find_if(list.rbegin(), list.rend(), matcher);
+    EXPECT_NE(list.rend(), it);
+    EXPECT_EQ(window, *it);
+}
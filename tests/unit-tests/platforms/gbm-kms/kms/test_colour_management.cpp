@@ -0,0 +1,106 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/gbm-kms/server/kms/colour_management.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mg = mir::graphics;
+namespace mgc = mir::graphics::gbm::colour;
+
+using namespace testing;
+
+TEST(ColourManagement, ctm_is_row_major_sign_magnitude_fixed_point)
+{
+    glm::mat3 transform{1};
+    transform[1][0] = -0.5f;    // column 1, row 0
+
+    auto const ctm = mgc::drm_ctm_for(transform);
+
+    uint64_t const one = 1ull << 32;
+    EXPECT_THAT(ctm.matrix[0], Eq(one));
+    EXPECT_THAT(ctm.matrix[1], Eq((1ull << 63) | (one / 2)));
+    EXPECT_THAT(ctm.matrix[3], Eq(0u));
+    EXPECT_THAT(ctm.matrix[4], Eq(one));
+    EXPECT_THAT(ctm.matrix[8], Eq(one));
+}
+
+TEST(ColourManagement, only_per_channel_scales_are_diagonal)
+{
+    glm::mat3 const night_light{1.0f, 0, 0, 0, 0.8f, 0, 0, 0, 0.6f};
+    glm::mat3 const greyscale{glm::vec3{1.0f/3}, glm::vec3{1.0f/3}, glm::vec3{1.0f/3}};
+
+    EXPECT_TRUE(mgc::is_diagonal(glm::mat3{1}));
+    EXPECT_TRUE(mgc::is_diagonal(night_light));
+    EXPECT_FALSE(mgc::is_diagonal(greyscale));
+}
+
+TEST(ColourManagement, tint_scales_each_channel_of_the_gamma_ramp)
+{
+    mg::GammaCurves const ramp{{0, 32768, 65535}, {0, 32768, 65535}, {0, 32768, 65535}};
+    glm::mat3 const warm{1.0f, 0, 0, 0, 0.5f, 0, 0, 0, 0.25f};
+
+    auto const tinted = mgc::tinted(ramp, warm);
+
+    EXPECT_THAT(tinted.red, ElementsAre(0, 32768, 65535));
+    EXPECT_THAT(tinted.green, ElementsAre(0, 16384, 32768));
+    EXPECT_THAT(tinted.blue, ElementsAre(0, 8192, 16384));
+}
+
+TEST(ColourManagement, resampling_interpolates_between_entries)
+{
+    EXPECT_THAT(mgc::resample({0, 65535}, 5), ElementsAre(0, 16384, 32768, 49151, 65535));
+    EXPECT_THAT(mgc::resample({}, 3), ElementsAre(0, 32768, 65535));
+}
+
+TEST(ColourManagement, gamma_lut_for_linear_input_reencodes_srgb)
+{
+    mg::GammaCurves const linear{};
+
+    auto const encoded = mgc::drm_gamma_lut_for(linear, 256, false);
+    auto const from_linear = mgc::drm_gamma_lut_for(linear, 256, true);
+    auto const degamma = mgc::srgb_degamma_lut(256);
+
+    // sRGB encoding brightens mid-tones; the degamma LUT undoes it
+    EXPECT_THAT(from_linear[64].red, Gt(encoded[64].red));
+    EXPECT_THAT(degamma[64].red, Lt(encoded[64].red));
+    EXPECT_THAT(from_linear.front().green, Eq(0));
+    EXPECT_THAT(from_linear.back().blue, Eq(65535));
+    EXPECT_THAT(degamma.back().red, Eq(65535));
+}
+
+TEST(ColourManagement, hdr_metadata_uses_infoframe_units)
+{
+    mg::HdrOutputMetadata metadata;
+    metadata.eotf = mg::HdrOutputMetadata::Eotf::smpte_st2084;
+    metadata.primaries[0] = {0.708f, 0.292f};
+    metadata.white_point = {0.3127f, 0.3290f};
+    metadata.max_mastering_luminance = 1000;
+    metadata.min_mastering_luminance = 0.005f;
+    metadata.max_content_light_level = 800;
+    metadata.max_frame_average_light_level = 400;
+
+    auto const drm = mgc::drm_hdr_metadata_for(metadata);
+
+    EXPECT_THAT(drm.hdmi_metadata_type1.eotf, Eq(2));
+    EXPECT_THAT(drm.hdmi_metadata_type1.display_primaries[0].x, Eq(35400));
+    EXPECT_THAT(drm.hdmi_metadata_type1.white_point.y, Eq(16450));
+    EXPECT_THAT(drm.hdmi_metadata_type1.max_display_mastering_luminance, Eq(1000));
+    EXPECT_THAT(drm.hdmi_metadata_type1.min_display_mastering_luminance, Eq(50));
+    EXPECT_THAT(drm.hdmi_metadata_type1.max_cll, Eq(800));
+    EXPECT_THAT(drm.hdmi_metadata_type1.max_fall, Eq(400));
+}
@@ -929,3 +929,41 @@ TEST_F(MesaDisplayTest, can_change_configuration_metadata_without_invalidating_d
         EXPECT_THAT(display_buffer->transformation(), Eq(rotate_inverted));
     }
 }
+
+TEST_F(MesaDisplayTest, colour_changes_are_applied_without_invalidating_display_buffers)
+{
+    using namespace testing;
+
+    auto display = create_display(create_platform());
+
+    auto config = display->configuration();
+    config->for_each_output(
+        [](mg::UserDisplayConfigurationOutput& output)
+        {
+            output.gamma = mg::GammaCurves{{1}, {2}, {3}};
+        });
+
+    EXPECT_CALL(mock_drm, drmModeCrtcSetGamma(_, _, 1, _, _, _))
+        .Times(AtLeast(1));
+
+    EXPECT_TRUE(display->apply_if_configuration_preserves_display_buffers(*config));
+}
+
+TEST_F(MesaDisplayTest, hdr_metadata_changes_are_applied_without_invalidating_display_buffers)
+{
+    using namespace testing;
+
+    auto display = create_display(create_platform());
+
+    auto config = display->configuration();
+    config->for_each_output(
+        [](mg::UserDisplayConfigurationOutput& output)
+        {
+            mg::HdrOutputMetadata metadata;
+            metadata.eotf = mg::HdrOutputMetadata::Eotf::smpte_st2084;
+            metadata.max_mastering_luminance = 1000;
+            output.hdr_metadata = metadata;
+        });
+
+    EXPECT_TRUE(display->apply_if_configuration_preserves_display_buffers(*config));
+}
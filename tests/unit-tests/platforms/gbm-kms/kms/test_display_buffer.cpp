@@ -27,6 +27,7 @@
 #include "mir/test/doubles/mock_gl.h"
 #include "mir/test/doubles/mock_drm.h"
 #include "mir/test/doubles/mock_buffer.h"
+#include "mir/test/doubles/mock_display_report.h"
 #include "mir/test/doubles/mock_gbm.h"
 #include "mir/test/doubles/stub_gl_config.h"
 #include "mir/test/doubles/stub_gbm_native_buffer.h"
@@ -39,6 +40,10 @@
 #include <gmock/gmock.h>
 #include <gbm.h>
 
+#include <atomic>
+#include <future>
+#include <thread>
+
 using namespace testing;
 using namespace mir;
 using namespace std;
@@ -114,6 +119,8 @@ public:
                     [](auto) {}}));
         ON_CALL(*mock_kms_output, buffer_requires_migration(_))
             .WillByDefault(Return(false));
+        ON_CALL(*mock_kms_output, set_scanout_transformation(_))
+            .WillByDefault(Return(true));
 
         ON_CALL(*mock_bypassable_buffer, size())
             .WillByDefault(Return(display_area.size));
@@ -246,6 +253,221 @@ TEST_F(MesaDisplayBufferTest, frames_requiring_gl_are_not_throttled)
     }
 }
 
+TEST_F(MesaDisplayBufferTest, bypass_enables_variable_refresh_and_is_not_throttled)
+{
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    EXPECT_CALL(*mock_kms_output, set_vrr_enabled(true))
+        .WillRepeatedly(Return(true));
+
+    for (int frame = 0; frame < 5; ++frame)
+    {
+        ASSERT_TRUE(db.overlay(bypassable_list));
+        db.post();
+
+        ASSERT_EQ(0, db.recommended_sleep().count());
+    }
+}
+
+TEST_F(MesaDisplayBufferTest, composited_frames_disable_variable_refresh)
+{
+    graphics::RenderableList non_bypassable_list{
+        std::make_shared<FakeRenderable>(geometry::Rectangle{{12, 34}, {1, 1}})
+    };
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    InSequence seq;
+    EXPECT_CALL(*mock_kms_output, set_vrr_enabled(true))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*mock_kms_output, set_vrr_enabled(false))
+        .WillOnce(Return(false));
+
+    ASSERT_TRUE(db.overlay(bypassable_list));
+    db.post();
+
+    ASSERT_FALSE(db.overlay(non_bypassable_list));
+    db.swap_buffers();
+    db.post();
+}
+
+TEST_F(MesaDisplayBufferTest, bypass_without_vsync_flips_asynchronously)
+{
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    fake_bypassable_renderable->set_tearing_allowed(true);
+
+    EXPECT_CALL(*mock_kms_output, schedule_async_page_flip_thunk(_))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
+        .Times(0);
+
+    ASSERT_TRUE(db.overlay(bypassable_list));
+    db.post();
+
+    EXPECT_EQ(0, db.recommended_sleep().count());
+}
+
+TEST_F(MesaDisplayBufferTest, falls_back_to_vsynced_flip_if_async_flip_fails)
+{
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    fake_bypassable_renderable->set_tearing_allowed(true);
+
+    InSequence seq;
+    EXPECT_CALL(*mock_kms_output, schedule_async_page_flip_thunk(_))
+        .WillOnce(Return(false));
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
+        .WillOnce(Return(true));
+
+    ASSERT_TRUE(db.overlay(bypassable_list));
+    db.post();
+}
+
+TEST_F(MesaDisplayBufferTest, vsynced_bypass_does_not_flip_asynchronously)
+{
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    EXPECT_CALL(*mock_kms_output, schedule_async_page_flip_thunk(_))
+        .Times(0);
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
+        .WillOnce(Return(true));
+
+    ASSERT_TRUE(db.overlay(bypassable_list));
+    db.post();
+}
+
+TEST_F(MesaDisplayBufferTest, hybrid_frames_are_scanned_out_via_prime_when_possible)
+{
+    std::shared_ptr<FBHandle const> const prime_fb{
+        reinterpret_cast<FBHandle const*>(0xbeef),
+        [](auto) {}};
+
+    ON_CALL(*mock_kms_output, buffer_requires_migration(_))
+        .WillByDefault(Return(true));
+    ON_CALL(*mock_kms_output, prime_fb_for(_))
+        .WillByDefault(Return(prime_fb));
+
+    EXPECT_CALL(*mock_kms_output, fb_for(A<gbm_bo*>()))
+        .Times(0);
+    EXPECT_CALL(*mock_kms_output, set_crtc_thunk(prime_fb.get()));
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(prime_fb.get()))
+        .WillOnce(Return(true));
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    db.swap_buffers();
+    db.post();
+}
+
+TEST_F(MesaDisplayBufferTest, hybrid_frames_are_not_scanned_out_via_prime_across_devices)
+{
+    std::shared_ptr<MockKMSOutput> const other_device_output = std::make_shared<NiceMock<MockKMSOutput>>();
+    ON_CALL(*mock_kms_output, drm_fd())
+        .WillByDefault(Return(3));
+    ON_CALL(*other_device_output, drm_fd())
+        .WillByDefault(Return(4));
+
+    for (auto const& output : {mock_kms_output, other_device_output})
+    {
+        ON_CALL(*output, buffer_requires_migration(_))
+            .WillByDefault(Return(true));
+        ON_CALL(*output, prime_fb_for(_))
+            .WillByDefault(Return(std::shared_ptr<FBHandle const>{
+                reinterpret_cast<FBHandle const*>(0xbeef),
+                [](auto) {}}));
+        EXPECT_CALL(*output, set_crtc_thunk(_))
+            .Times(0);
+    }
+
+    // The framebuffer would only be imported on the first output's device
+    EXPECT_THROW(
+        (graphics::gbm::DisplayBuffer{
+            graphics::gbm::BypassOption::allowed,
+            null_display_report(),
+            {mock_kms_output, other_device_output},
+            make_output_surface(),
+            display_area,
+            identity}),
+        std::invalid_argument);
+}
+
+TEST_F(MesaDisplayBufferTest, reprogramming_between_flips_waits_for_post_to_schedule_its_flip)
+{
+    using namespace std::literals::chrono_literals;
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    std::promise<void> flipping;
+    std::promise<void> flip_scheduled;
+    auto const scheduled = flip_scheduled.get_future().share();
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
+        .WillOnce(InvokeWithoutArgs(
+            [&]
+            {
+                flipping.set_value();
+                scheduled.wait();
+                return true;
+            }));
+
+    db.swap_buffers();
+    std::thread compositor{[&] { db.post(); }};
+    flipping.get_future().wait();
+
+    std::atomic<bool> reprogrammed{false};
+    std::thread configurer{[&] { db.between_flips([&] { reprogrammed = true; }); }};
+
+    std::this_thread::sleep_for(50ms);
+    EXPECT_FALSE(reprogrammed);
+
+    flip_scheduled.set_value();
+    compositor.join();
+    configurer.join();
+    EXPECT_TRUE(reprogrammed);
+}
+
 TEST_F(MesaDisplayBufferTest, bypass_buffer_only_referenced_once_by_db)
 {
     graphics::gbm::DisplayBuffer db(
@@ -512,3 +734,105 @@ TEST_F(MesaDisplayBufferTest, skips_bypass_because_of_incompatible_bypass_buffer
 
     EXPECT_FALSE(db.overlay(list));
 }
+
+TEST_F(MesaDisplayBufferTest, cloned_outputs_with_matching_modes_scan_out_the_same_buffer)
+{
+    auto const clone = std::make_shared<NiceMock<MockKMSOutput>>();
+    for (auto const& output : {mock_kms_output, std::shared_ptr<MockKMSOutput>{clone}})
+    {
+        ON_CALL(*output, size()).WillByDefault(Return(display_area.size));
+        ON_CALL(*output, schedule_page_flip_thunk(_)).WillByDefault(Return(true));
+        ON_CALL(*output, set_crtc_thunk(_)).WillByDefault(Return(true));
+    }
+
+    auto const bypass_fb = reinterpret_cast<FBHandle const*>(0xe0e0);
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(bypass_fb));
+    EXPECT_CALL(*clone, schedule_page_flip_thunk(bypass_fb));
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output, clone},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    ASSERT_TRUE(db.overlay(bypassable_list));
+    db.post();
+}
+
+TEST_F(MesaDisplayBufferTest, cloned_outputs_with_different_modes_report_why_they_cannot_bypass)
+{
+    auto const clone = std::make_shared<NiceMock<MockKMSOutput>>();
+    ON_CALL(*mock_kms_output, id()).WillByDefault(Return(11u));
+    ON_CALL(*mock_kms_output, size()).WillByDefault(Return(display_area.size));
+    ON_CALL(*clone, id()).WillByDefault(Return(22u));
+    ON_CALL(*clone, size()).WillByDefault(Return(geometry::Size{1920, 1080}));
+
+    auto const report = std::make_shared<NiceMock<MockDisplayReport>>();
+    // Only changes in the reason are reported, not every frame
+    EXPECT_CALL(*report, report_bypass_failure(11u, StrEq("cloned outputs have different modes")));
+    EXPECT_CALL(*report, report_bypass_failure(22u, StrEq("cloned outputs have different modes")));
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        report,
+        {mock_kms_output, clone},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    EXPECT_FALSE(db.overlay(bypassable_list));
+    EXPECT_FALSE(db.overlay(bypassable_list));
+}
+
+TEST_F(MesaDisplayBufferTest, inverted_output_bypasses_via_scanout_rotation_where_supported)
+{
+    auto const rotation = transformation(mir_orientation_inverted);
+    ON_CALL(*mock_kms_output, supports_scanout_transformation(rotation)).WillByDefault(Return(true));
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        rotation);
+
+    {
+        InSequence seq;
+        // The rotation is decided on with the bypass...
+        EXPECT_CALL(*mock_kms_output, set_scanout_transformation(rotation)).WillOnce(Return(true));
+        EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_));
+        // ...and composited frames are rendered upright, so need no rotation
+        EXPECT_CALL(*mock_kms_output, set_scanout_transformation(glm::mat2{1})).WillOnce(Return(true));
+        EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_));
+    }
+
+    ASSERT_TRUE(db.overlay(bypassable_list));
+    db.post();
+
+    db.swap_buffers();
+    db.post();
+}
+
+TEST_F(MesaDisplayBufferTest, rotated_output_composites_if_scanout_rotation_cannot_be_set)
+{
+    auto const rotation = transformation(mir_orientation_inverted);
+    ON_CALL(*mock_kms_output, supports_scanout_transformation(rotation)).WillByDefault(Return(true));
+    ON_CALL(*mock_kms_output, set_scanout_transformation(rotation)).WillByDefault(Return(false));
+
+    auto const report = std::make_shared<NiceMock<MockDisplayReport>>();
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        report,
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        rotation);
+
+    EXPECT_CALL(*mock_kms_output, set_scanout_transformation(glm::mat2{1})).Times(AtLeast(1));
+    EXPECT_CALL(*report, report_bypass_failure(_, HasSubstr("could not be applied")));
+
+    EXPECT_FALSE(db.overlay(bypassable_list));
+}
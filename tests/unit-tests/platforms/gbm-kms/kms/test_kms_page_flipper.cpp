@@ -29,7 +29,9 @@
 #include <stdexcept>
 #include <atomic>
 #include <thread>
+#include <unordered_map>
 #include <unordered_set>
+#include <tuple>
 
 #include <sys/time.h>
 #include <fcntl.h>
@@ -85,6 +87,35 @@ TEST_F(KMSPageFlipperTest, schedule_flip_calls_drm_page_flip)
     page_flipper.schedule_flip(crtc_id, fb_id, connector_id);
 }
 
+TEST_F(KMSPageFlipperTest, async_flip_is_refused_without_driver_support)
+{
+    using namespace testing;
+
+    EXPECT_CALL(mock_drm, drmModePageFlip(_, _, _, _, _))
+        .Times(0);
+
+    EXPECT_FALSE(page_flipper.schedule_async_flip(10, 101, 345));
+}
+
+TEST_F(KMSPageFlipperTest, async_flip_requests_async_page_flip_from_drm)
+{
+    using namespace testing;
+
+    uint32_t const crtc_id{10};
+    uint32_t const fb_id{101};
+    uint32_t const connector_id{345};
+
+    ON_CALL(mock_drm, drmGetCap(_, DRM_CAP_ASYNC_PAGE_FLIP, _))
+        .WillByDefault(DoAll(SetArgPointee<2>(1), Return(0)));
+    mgg::KMSPageFlipper async_page_flipper{drm_fd, mt::fake_shared(report)};
+
+    EXPECT_CALL(mock_drm, drmModePageFlip(drm_fd, crtc_id, fb_id,
+                                          DRM_MODE_PAGE_FLIP_EVENT | DRM_MODE_PAGE_FLIP_ASYNC, _))
+        .WillOnce(Return(0));
+
+    EXPECT_TRUE(async_page_flipper.schedule_async_flip(crtc_id, fb_id, connector_id));
+}
+
 TEST_F(KMSPageFlipperTest, double_schedule_flip_throws)
 {
     using namespace testing;
@@ -171,19 +202,26 @@ TEST_F(KMSPageFlipperTest, failure_in_wait_for_flip_throws)
     uint32_t const crtc_id{10};
     uint32_t const fb_id{101};
     uint32_t const connector_id{345};
-    void* user_data{nullptr};
 
     EXPECT_CALL(mock_drm, drmModePageFlip(drm_fd, crtc_id, fb_id, _, _))
         .Times(1)
-        .WillOnce(DoAll(SaveArg<4>(&user_data), Return(0)));
+        .WillOnce(Return(0));
 
-    EXPECT_CALL(mock_drm, drmHandleEvent(_, _))
-        .Times(0);
+    /* Cause a failure in handling the DRM event */
+    EXPECT_CALL(mock_drm, drmHandleEvent(drm_fd, _))
+        .Times(1)
+        .WillOnce(
+            InvokeWithoutArgs(
+                [this]()
+                {
+                    mock_drm.consume_event_on(drm_device);
+                    errno = EIO;
+                    return -1;
+                }));
 
     page_flipper.schedule_flip(crtc_id, fb_id, connector_id);
 
-    /* Cause a failure in wait_for_flip */
-    close(drm_fd);
+    mock_drm.generate_event_on(drm_device);
 
     EXPECT_THROW({
         page_flipper.wait_for_flip(crtc_id);
@@ -274,134 +312,37 @@ private:
 
 }
 
-TEST_F(KMSPageFlipperTest, threads_switch_worker)
+TEST_F(KMSPageFlipperTest, flip_completes_while_another_crtc_is_pending)
 {
     using namespace testing;
 
-    size_t const worker_index{0};
-    size_t const other_index{1};
-    std::vector<uint32_t> const crtc_ids{10, 11};
-    std::vector<void*> user_data{nullptr, nullptr};
-    std::vector<std::unique_ptr<PageFlippingFunctor>> page_flipping_functors;
-    std::vector<std::thread> page_flipping_threads;
-    std::thread::id tid;
-
-    EXPECT_CALL(mock_drm, drmModePageFlip(drm_fd, _, _, _, _))
-        .Times(2)
-        .WillOnce(DoAll(SaveArg<4>(&user_data[worker_index]), Return(0)))
-        .WillOnce(DoAll(SaveArg<4>(&user_data[other_index]), Return(0)));
-
-    /*
-     * The first event releases the original worker, hence we expect that
-     * then the other thread will become the worker.
-     */
-    EXPECT_CALL(mock_drm, drmHandleEvent(drm_fd, _))
-        .Times(2)
-        .WillOnce(DoAll(InvokePageFlipHandler(&user_data[worker_index]), Return(0)))
-        .WillOnce(DoAll(InvokePageFlipHandler(&user_data[other_index]), Return(0)));
-
-    /* Start the page-flipping threads */
-    for (auto crtc_id : crtc_ids)
-    {
-        auto pf = std::unique_ptr<PageFlippingFunctor>(new PageFlippingFunctor{page_flipper, crtc_id});
-        page_flipping_functors.push_back(std::move(pf));
-        page_flipping_threads.push_back(std::thread{std::ref(*page_flipping_functors.back())});
-
-        /* Wait for page-flip request and tell flipper to stop after this iteration */
-        while (page_flipping_functors.back()->page_flip_count() == 0)
-            std::this_thread::sleep_for(std::chrono::milliseconds{1});
-        page_flipping_functors.back()->stop();
-
-        /* Wait until the (first) thread has become the worker */
-        while (tid == std::thread::id())
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds{1});
-            tid = page_flipper.debug_get_worker_tid();
-        }
-    }
-
-    EXPECT_EQ(page_flipping_threads[worker_index].get_id(), tid);
-
-    /* Fake a DRM event */
-    mock_drm.generate_event_on(drm_device);
-
-    page_flipping_threads[worker_index].join();
-
-    /* Wait for the worker to switch */
-    while (tid != page_flipping_threads[other_index].get_id())
-    {
-        std::this_thread::sleep_for(std::chrono::milliseconds{1});
-        tid = page_flipper.debug_get_worker_tid();
-    }
-
-    /* Fake another DRM event to unblock the remaining thread */
-    mock_drm.generate_event_on(drm_device);
-
-    page_flipping_threads[other_index].join();
-}
-
-TEST_F(KMSPageFlipperTest, threads_worker_notifies_non_worker)
-{
-    using namespace testing;
-
-    size_t const worker_index{0};
-    size_t const other_index{1};
-    std::vector<uint32_t> const crtc_ids{10, 11};
-    std::vector<void*> user_data{nullptr, nullptr};
-    std::vector<std::unique_ptr<PageFlippingFunctor>> page_flipping_functors;
-    std::vector<std::thread> page_flipping_threads;
-    std::thread::id tid;
+    uint32_t const fb_id{101};
+    uint32_t const slow_crtc_id{10};
+    uint32_t const fast_crtc_id{11};
+    void* slow_user_data{nullptr};
+    void* fast_user_data{nullptr};
 
-    EXPECT_CALL(mock_drm, drmModePageFlip(drm_fd, _, _, _, _))
+    EXPECT_CALL(mock_drm, drmModePageFlip(drm_fd, _, fb_id, _, _))
         .Times(2)
-        .WillOnce(DoAll(SaveArg<4>(&user_data[worker_index]), Return(0)))
-        .WillOnce(DoAll(SaveArg<4>(&user_data[other_index]), Return(0)));
+        .WillOnce(DoAll(SaveArg<4>(&slow_user_data), Return(0)))
+        .WillOnce(DoAll(SaveArg<4>(&fast_user_data), Return(0)));
 
-    /*
-     * The first event releases the non-worker thread, hence we expect that
-     * original worker not change.
-     */
     EXPECT_CALL(mock_drm, drmHandleEvent(drm_fd, _))
         .Times(2)
-        .WillOnce(DoAll(InvokePageFlipHandler(&user_data[other_index]), Return(0)))
-        .WillOnce(DoAll(InvokePageFlipHandler(&user_data[worker_index]), Return(0)));
+        .WillOnce(DoAll(InvokePageFlipHandler(&fast_user_data), Return(0)))
+        .WillOnce(DoAll(InvokePageFlipHandler(&slow_user_data), Return(0)));
 
-    /* Start the page-flipping threads */
-    for (auto crtc_id : crtc_ids)
-    {
-        auto pf = std::unique_ptr<PageFlippingFunctor>(new PageFlippingFunctor{page_flipper, crtc_id});
-        page_flipping_functors.push_back(std::move(pf));
-        page_flipping_threads.push_back(std::thread{std::ref(*page_flipping_functors.back())});
+    page_flipper.schedule_flip(slow_crtc_id, fb_id, 23);
 
-        /* Wait for page-flip request and tell flipper to stop after this iteration */
-        while (page_flipping_functors.back()->page_flip_count() == 0)
-            std::this_thread::sleep_for(std::chrono::milliseconds{1});
-        page_flipping_functors.back()->stop();
+    std::thread slow_waiter{[this, slow_crtc_id]() { page_flipper.wait_for_flip(slow_crtc_id); }};
 
-        /* Wait until the (first) thread has become the worker */
-        while (tid == std::thread::id())
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds{1});
-            tid = page_flipper.debug_get_worker_tid();
-        }
-    }
-
-    EXPECT_EQ(page_flipping_threads[worker_index].get_id(), tid);
-
-    /* Fake a DRM event */
+    /* Nothing the slow waiter does may stop the other CRTC's flip from completing */
+    page_flipper.schedule_flip(fast_crtc_id, fb_id, 45);
     mock_drm.generate_event_on(drm_device);
+    page_flipper.wait_for_flip(fast_crtc_id);
 
-    /* Wait for the non-worker thread to exit */
-    page_flipping_threads[other_index].join();
-
-    /* Check that the worker hasn't changed */
-    EXPECT_EQ(page_flipping_threads[worker_index].get_id(),
-              page_flipper.debug_get_worker_tid());
-
-    /* Fake another DRM event to unblock the remaining thread */
     mock_drm.generate_event_on(drm_device);
-
-    page_flipping_threads[worker_index].join();
+    slow_waiter.join();
 }
 
 namespace
@@ -415,7 +356,7 @@ public:
         std::lock_guard<std::mutex> lock{data_mutex};
 
         data.push_back({CountType::flip, crtc_id});
-        pending_flips.insert(user_data);
+        pending_flips[user_data] = crtc_id;
     }
 
     void add_handle_event(uint32_t crtc_id)
@@ -471,20 +412,20 @@ public:
         return true;
     }
 
-    void* get_pending_flip_data()
+    std::pair<uint32_t, void*> get_pending_flip_data()
     {
         std::lock_guard<std::mutex> lock{data_mutex};
 
         auto iter = pending_flips.begin();
         if (iter == pending_flips.end())
         {
-            return 0;
+            return {0, nullptr};
         }
         else
         {
             auto d = *iter;
             pending_flips.erase(iter);
-            return d;
+            return {d.second, d.first};
         }
     }
 
@@ -497,7 +438,7 @@ private:
     };
 
     std::vector<CountElement> data;
-    std::unordered_set<void*> pending_flips;
+    std::unordered_map<void*, uint32_t> pending_flips;
     std::mutex data_mutex;
 };
 
@@ -507,8 +448,9 @@ ACTION_P(InvokePageFlipHandlerWithPendingData, counter)
     int const drm_fd{arg0};
     char dummy;
 
-    auto user_data = static_cast<mgg::PageFlipEventData*>(counter->get_pending_flip_data());
-    uint32_t const crtc_id{user_data->crtc_id};
+    uint32_t crtc_id;
+    void* user_data;
+    std::tie(crtc_id, user_data) = counter->get_pending_flip_data();
 
     /* Remove the event from the drm event queue */
     ASSERT_EQ(1, read(drm_fd, &dummy, 1));
@@ -26,6 +26,8 @@
 #include "mir/test/doubles/mock_gbm.h"
 
 #include <stdexcept>
+#include <cstring>
+#include <fcntl.h>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
@@ -46,6 +48,7 @@ class NullPageFlipper : public mgg::PageFlipper
 {
 public:
     bool schedule_flip(uint32_t,uint32_t,uint32_t) override { return true; }
+    bool schedule_async_flip(uint32_t,uint32_t,uint32_t) override { return true; }
     mg::Frame wait_for_flip(uint32_t) override { return {}; }
 };
 
@@ -53,6 +56,7 @@ class MockPageFlipper : public mgg::PageFlipper
 {
 public:
     MOCK_METHOD3(schedule_flip, bool(uint32_t,uint32_t,uint32_t));
+    MOCK_METHOD3(schedule_async_flip, bool(uint32_t,uint32_t,uint32_t));
     MOCK_METHOD1(wait_for_flip, mg::Frame(uint32_t));
 };
 
@@ -148,6 +152,45 @@ public:
         mock_drm.prepare(drm_device);
     }
 
+    void provide_vrr_properties()
+    {
+        vrr_capable_prop.prop_id = vrr_capable_id;
+        strncpy(vrr_capable_prop.name, "vrr_capable", DRM_PROP_NAME_LEN);
+        vrr_enabled_prop.prop_id = vrr_enabled_id;
+        strncpy(vrr_enabled_prop.name, "VRR_ENABLED", DRM_PROP_NAME_LEN);
+
+        connector_props.count_props = 1;
+        connector_props.props = const_cast<uint32_t*>(&vrr_capable_id);
+        connector_props.prop_values = &vrr_capable_value;
+        crtc_props.count_props = 1;
+        crtc_props.props = const_cast<uint32_t*>(&vrr_enabled_id);
+        crtc_props.prop_values = &vrr_enabled_value;
+
+        ON_CALL(mock_drm, drmModeObjectGetProperties(_, connector_ids[0], DRM_MODE_OBJECT_CONNECTOR))
+            .WillByDefault(Return(&connector_props));
+        ON_CALL(mock_drm, drmModeObjectGetProperties(_, crtc_ids[0], DRM_MODE_OBJECT_CRTC))
+            .WillByDefault(Return(&crtc_props));
+        ON_CALL(mock_drm, drmModeGetProperty(_, vrr_capable_id))
+            .WillByDefault(Return(&vrr_capable_prop));
+        ON_CALL(mock_drm, drmModeGetProperty(_, vrr_enabled_id))
+            .WillByDefault(Return(&vrr_enabled_prop));
+    }
+
+    void provide_ctm_property()
+    {
+        ctm_prop.prop_id = ctm_id;
+        strncpy(ctm_prop.name, "CTM", DRM_PROP_NAME_LEN);
+
+        crtc_props.count_props = 1;
+        crtc_props.props = const_cast<uint32_t*>(&ctm_id);
+        crtc_props.prop_values = &ctm_value;
+
+        ON_CALL(mock_drm, drmModeObjectGetProperties(_, crtc_ids[0], DRM_MODE_OBJECT_CRTC))
+            .WillByDefault(Return(&crtc_props));
+        ON_CALL(mock_drm, drmModeGetProperty(_, ctm_id))
+            .WillByDefault(Return(&ctm_prop));
+    }
+
     void append_fb_id(uint32_t fb_id)
     {
         EXPECT_CALL(mock_drm, drmModeAddFB2(_,_,_,_,_,_,_,_,_))
@@ -173,6 +216,18 @@ public:
     std::vector<uint32_t> const connector_ids;
     std::vector<uint32_t> possible_encoder_ids1;
     std::vector<uint32_t> possible_encoder_ids2;
+
+    uint32_t const vrr_capable_id{0x1001};
+    uint32_t const vrr_enabled_id{0x1002};
+    uint64_t vrr_capable_value{1};
+    uint64_t vrr_enabled_value{0};
+    uint32_t const ctm_id{0x1003};
+    uint64_t ctm_value{0};
+    drmModePropertyRes ctm_prop{};
+    drmModePropertyRes vrr_capable_prop{};
+    drmModePropertyRes vrr_enabled_prop{};
+    drmModeObjectProperties connector_props{};
+    drmModeObjectProperties crtc_props{};
 };
 
 }
@@ -305,6 +360,51 @@ TEST_F(RealKMSOutputTest, set_crtc_failure_is_handled_gracefully)
     }, std::runtime_error);
 }
 
+TEST_F(RealKMSOutputTest, prime_fb_for_imports_buffer_from_other_device)
+{
+    using namespace testing;
+
+    int const dma_buf{open("/dev/null", O_RDONLY)};
+    uint32_t const imported_handle{0x42};
+
+    setup_outputs_connected_crtc();
+
+    ON_CALL(mock_gbm, gbm_bo_get_fd(fake_bo))
+        .WillByDefault(Return(dma_buf));
+    EXPECT_CALL(mock_drm, drmPrimeFDToHandle(drm_fd, dma_buf, _))
+        .WillOnce(DoAll(SetArgPointee<2>(imported_handle), Return(0)));
+    EXPECT_CALL(mock_drm, drmModeAddFB2(drm_fd, _, _, _, Pointee(imported_handle), _, _, _, _))
+        .WillOnce(Return(0));
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+
+    EXPECT_THAT(output.prime_fb_for(fake_bo), NotNull());
+}
+
+TEST_F(RealKMSOutputTest, prime_fb_for_returns_null_if_import_fails)
+{
+    using namespace testing;
+
+    setup_outputs_connected_crtc();
+
+    ON_CALL(mock_gbm, gbm_bo_get_fd(fake_bo))
+        .WillByDefault(Return(open("/dev/null", O_RDONLY)));
+    ON_CALL(mock_drm, drmPrimeFDToHandle(_, _, _))
+        .WillByDefault(Return(-1));
+    EXPECT_CALL(mock_drm, drmModeAddFB2(_, _, _, _, _, _, _, _, _))
+        .Times(0);
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+
+    EXPECT_THAT(output.prime_fb_for(fake_bo), IsNull());
+}
+
 TEST_F(RealKMSOutputTest, clear_crtc_gets_crtc_if_none_is_current)
 {
     using namespace testing;
@@ -548,3 +648,232 @@ TEST_F(RealKMSOutputTest, drm_set_gamma_failure_does_not_throw)
 
     EXPECT_NO_THROW(output.set_gamma(gamma););
 }
+
+TEST_F(RealKMSOutputTest, enables_variable_refresh_on_capable_display)
+{
+    using namespace testing;
+
+    uint32_t const fb_id{67};
+
+    setup_outputs_connected_crtc();
+    provide_vrr_properties();
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    append_fb_id(fb_id);
+    auto fb = output.fb_for(fake_bo);
+    EXPECT_TRUE(output.set_crtc(*fb));
+
+    EXPECT_CALL(mock_drm, drmModeObjectSetProperty(_, crtc_ids[0], DRM_MODE_OBJECT_CRTC, vrr_enabled_id, 1))
+        .WillOnce(Return(0));
+
+    EXPECT_TRUE(output.set_vrr_enabled(true));
+    // Already enabled; shouldn't touch the hardware again
+    EXPECT_TRUE(output.set_vrr_enabled(true));
+
+    mg::DisplayConfigurationOutput conf_output;
+    output.update_from_hardware_state(conf_output);
+    EXPECT_TRUE(conf_output.vrr_capable);
+
+    // Leave the CRTC as we found it
+    EXPECT_CALL(mock_drm, drmModeObjectSetProperty(_, crtc_ids[0], DRM_MODE_OBJECT_CRTC, vrr_enabled_id, 0))
+        .WillOnce(Return(0));
+}
+
+TEST_F(RealKMSOutputTest, variable_refresh_the_driver_refuses_is_not_retried_every_frame)
+{
+    using namespace testing;
+
+    uint32_t const fb_id{67};
+
+    setup_outputs_connected_crtc();
+    provide_vrr_properties();
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    append_fb_id(fb_id);
+    auto fb = output.fb_for(fake_bo);
+    EXPECT_TRUE(output.set_crtc(*fb));
+
+    EXPECT_CALL(mock_drm, drmModeObjectSetProperty(_, crtc_ids[0], DRM_MODE_OBJECT_CRTC, vrr_enabled_id, 1))
+        .WillOnce(Return(-EINVAL));
+
+    EXPECT_FALSE(output.set_vrr_enabled(true));
+    EXPECT_FALSE(output.set_vrr_enabled(true));
+    EXPECT_FALSE(output.set_vrr_enabled(false));
+    EXPECT_FALSE(output.set_vrr_enabled(true));
+
+    // The display is still capable; it's this configuration the driver refused
+    mg::DisplayConfigurationOutput conf_output;
+    output.update_from_hardware_state(conf_output);
+    EXPECT_TRUE(conf_output.vrr_capable);
+}
+
+TEST_F(RealKMSOutputTest, variable_refresh_the_driver_refused_is_retried_after_reconfiguring)
+{
+    using namespace testing;
+
+    uint32_t const fb_id{67};
+
+    setup_outputs_connected_crtc();
+    provide_vrr_properties();
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    append_fb_id(fb_id);
+    auto fb = output.fb_for(fake_bo);
+    EXPECT_TRUE(output.set_crtc(*fb));
+
+    EXPECT_CALL(mock_drm, drmModeObjectSetProperty(_, crtc_ids[0], DRM_MODE_OBJECT_CRTC, vrr_enabled_id, 1))
+        .WillOnce(Return(-EINVAL))
+        .WillOnce(Return(0));
+
+    EXPECT_FALSE(output.set_vrr_enabled(true));
+
+    output.configure({0, 0}, 0);
+    EXPECT_TRUE(output.set_vrr_enabled(true));
+
+    // Leave the CRTC as we found it
+    EXPECT_CALL(mock_drm, drmModeObjectSetProperty(_, crtc_ids[0], DRM_MODE_OBJECT_CRTC, vrr_enabled_id, 0))
+        .WillOnce(Return(0));
+}
+
+TEST_F(RealKMSOutputTest, does_not_enable_variable_refresh_on_incapable_display)
+{
+    using namespace testing;
+
+    uint32_t const fb_id{67};
+
+    setup_outputs_connected_crtc();
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    append_fb_id(fb_id);
+    auto fb = output.fb_for(fake_bo);
+    EXPECT_TRUE(output.set_crtc(*fb));
+
+    EXPECT_CALL(mock_drm, drmModeObjectSetProperty(_, _, _, _, _))
+        .Times(0);
+
+    EXPECT_FALSE(output.set_vrr_enabled(true));
+
+    mg::DisplayConfigurationOutput conf_output;
+    output.update_from_hardware_state(conf_output);
+    EXPECT_FALSE(conf_output.vrr_capable);
+}
+
+TEST_F(RealKMSOutputTest, colour_transform_is_applied_by_the_ctm)
+{
+    using namespace testing;
+
+    uint32_t const fb_id{67};
+    uint32_t const blob_id{0xb10b};
+
+    setup_outputs_connected_crtc();
+    provide_ctm_property();
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    append_fb_id(fb_id);
+    auto fb = output.fb_for(fake_bo);
+    EXPECT_TRUE(output.set_crtc(*fb));
+
+    mg::GammaCurves const gamma{{1}, {2}, {3}};
+    glm::mat3 const night_light{1.0f, 0, 0, 0, 0.8f, 0, 0, 0, 0.6f};
+
+    EXPECT_CALL(mock_drm, drmModeCreatePropertyBlob(_, _, sizeof(drm_color_ctm), _))
+        .WillOnce(DoAll(SetArgPointee<3>(blob_id), Return(0)));
+    EXPECT_CALL(mock_drm, drmModeObjectSetProperty(_, crtc_ids[0], DRM_MODE_OBJECT_CRTC, ctm_id, blob_id))
+        .WillOnce(Return(0));
+    EXPECT_CALL(mock_drm, drmModeDestroyPropertyBlob(_, blob_id));
+    EXPECT_CALL(mock_drm, drmModeCrtcSetGamma(drm_fd, crtc_ids[0], 1, _, _, _))
+        .WillOnce(Return(0));
+
+    output.set_colour_pipeline(gamma, night_light);
+    // Unchanged; shouldn't touch the hardware again
+    output.set_colour_pipeline(gamma, night_light);
+}
+
+TEST_F(RealKMSOutputTest, colour_temperature_is_folded_into_gamma_without_a_ctm)
+{
+    using namespace testing;
+
+    uint32_t const fb_id{67};
+
+    setup_outputs_connected_crtc();
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    append_fb_id(fb_id);
+    auto fb = output.fb_for(fake_bo);
+    EXPECT_TRUE(output.set_crtc(*fb));
+
+    mg::GammaCurves const gamma{{0, 65535}, {0, 65535}, {0, 65535}};
+    glm::mat3 const night_light{1.0f, 0, 0, 0, 0.5f, 0, 0, 0, 0.25f};
+
+    uint16_t red_max{0}, green_max{0}, blue_max{0};
+    EXPECT_CALL(mock_drm, drmModeObjectSetProperty(_, _, _, _, _))
+        .Times(0);
+    EXPECT_CALL(mock_drm, drmModeCrtcSetGamma(drm_fd, crtc_ids[0], 2, _, _, _))
+        .WillOnce(Invoke(
+            [&](int, uint32_t, uint32_t, uint16_t* red, uint16_t* green, uint16_t* blue)
+            {
+                red_max = red[1];
+                green_max = green[1];
+                blue_max = blue[1];
+                return 0;
+            }));
+
+    output.set_colour_pipeline(gamma, night_light);
+
+    EXPECT_THAT(red_max, Eq(65535));
+    EXPECT_THAT(green_max, Eq(32768));
+    EXPECT_THAT(blue_max, Eq(16384));
+}
+
+TEST_F(RealKMSOutputTest, colour_transform_the_hardware_cannot_apply_is_not_retried)
+{
+    using namespace testing;
+
+    uint32_t const fb_id{67};
+
+    setup_outputs_connected_crtc();
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    append_fb_id(fb_id);
+    auto fb = output.fb_for(fake_bo);
+    EXPECT_TRUE(output.set_crtc(*fb));
+
+    mg::GammaCurves const gamma{{1}, {2}, {3}};
+    // Mixes channels, so without a CTM it can't go into the gamma ramp
+    glm::mat3 const greyscale{0.3f, 0.3f, 0.3f, 0.6f, 0.6f, 0.6f, 0.1f, 0.1f, 0.1f};
+
+    EXPECT_CALL(mock_drm, drmModeCrtcSetGamma(drm_fd, crtc_ids[0], 1, _, _, _))
+        .WillOnce(Return(0));
+
+    output.set_colour_pipeline(gamma, greyscale);
+    // Reconfiguring with the same settings shouldn't try (and warn) again
+    output.set_colour_pipeline(gamma, greyscale);
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/headless/display_buffer.h"
+
+#include "mir/graphics/atomic_frame.h"
+#include "mir/test/doubles/mock_display_report.h"
+#include "mir/test/doubles/mock_egl.h"
+#include "mir/test/doubles/mock_gl.h"
+
+#include <GLES2/gl2ext.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mg = mir::graphics;
+namespace mgh = mg::headless;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+struct HeadlessDisplayBuffer : Test
+{
+    HeadlessDisplayBuffer()
+    {
+        ON_CALL(mock_gl, glGetString(GL_EXTENSIONS))
+            .WillByDefault(Return(reinterpret_cast<GLubyte const*>("GL_OES_rgb8_rgba8")));
+    }
+
+    auto make_display_buffer() -> std::unique_ptr<mgh::DisplayBuffer>
+    {
+        return std::make_unique<mgh::DisplayBuffer>(
+            mock_egl.fake_egl_display,
+            mock_egl.fake_configs[0],
+            EGL_NO_CONTEXT,
+            false,
+            mg::DisplayConfigurationOutputId{1},
+            size,
+            geom::Rectangle{{0, 0}, size},
+            60,
+            std::make_shared<mg::AtomicFrame>(),
+            std::make_shared<NiceMock<mtd::MockDisplayReport>>(),
+            "");
+    }
+
+    NiceMock<mtd::MockEGL> mock_egl;
+    NiceMock<mtd::MockGL> mock_gl;
+    geom::Size const size{640, 480};
+};
+}
+
+TEST_F(HeadlessDisplayBuffer, renders_into_an_rgba8_framebuffer_of_the_output_size)
+{
+    auto const display_buffer = make_display_buffer();
+
+    EXPECT_CALL(mock_gl, glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8_OES, 640, 480));
+    display_buffer->make_current();
+}
+
+TEST_F(HeadlessDisplayBuffer, framebuffer_is_recreated_when_the_mode_changes)
+{
+    auto const display_buffer = make_display_buffer();
+    display_buffer->make_current();
+    display_buffer->release_current();
+    Mock::VerifyAndClearExpectations(&mock_gl);
+    ON_CALL(mock_gl, glGetString(GL_EXTENSIONS))
+        .WillByDefault(Return(reinterpret_cast<GLubyte const*>("GL_OES_rgb8_rgba8")));
+    ON_CALL(mock_gl, glCheckFramebufferStatus(_)).WillByDefault(Return(GL_FRAMEBUFFER_COMPLETE));
+
+    display_buffer->set_pixel_size({1024, 768});
+
+    InSequence seq;
+    EXPECT_CALL(mock_gl, glDeleteFramebuffers(1, _));
+    EXPECT_CALL(mock_gl, glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8_OES, 1024, 768));
+    display_buffer->make_current();
+    Mock::VerifyAndClearExpectations(&mock_gl);
+}
+
+TEST_F(HeadlessDisplayBuffer, framebuffer_is_kept_while_the_mode_is_unchanged)
+{
+    auto const display_buffer = make_display_buffer();
+    display_buffer->make_current();
+    display_buffer->release_current();
+
+    display_buffer->set_pixel_size(size);
+
+    EXPECT_CALL(mock_gl, glDeleteFramebuffers(_, _)).Times(0);
+    EXPECT_CALL(mock_gl, glRenderbufferStorage(_, _, _, _)).Times(0);
+    display_buffer->make_current();
+    Mock::VerifyAndClearExpectations(&mock_gl);
+}
+
+TEST_F(HeadlessDisplayBuffer, fails_without_8_bit_per_channel_renderbuffers)
+{
+    auto const display_buffer = make_display_buffer();
+    ON_CALL(mock_gl, glGetString(GL_EXTENSIONS))
+        .WillByDefault(Return(reinterpret_cast<GLubyte const*>("GL_OES_EGL_image")));
+
+    EXPECT_CALL(mock_gl, glRenderbufferStorage(_, _, _, _)).Times(0);
+    EXPECT_THROW(display_buffer->make_current(), std::runtime_error);
+}
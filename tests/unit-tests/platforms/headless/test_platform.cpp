@@ -0,0 +1,85 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/headless/platform.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mir
+{
+namespace graphics
+{
+namespace headless
+{
+auto operator==(OutputSpec const& a, OutputSpec const& b) -> bool
+{
+    return a.size == b.size &&
+           testing::Value(a.refresh_hz, testing::DoubleEq(b.refresh_hz));
+}
+
+auto operator<<(std::ostream& os, OutputSpec const& spec) -> std::ostream&
+{
+    return os << "size: " << spec.size << ", refresh: " << spec.refresh_hz;
+}
+}
+}
+}
+
+namespace mgh = mir::graphics::headless;
+
+using namespace testing;
+
+TEST(HeadlessPlatform, parses_output_size_with_default_refresh)
+{
+    EXPECT_THAT(mgh::Platform::parse_outputs("1280x720"), ElementsAre(mgh::OutputSpec{{1280, 720}, 60}));
+}
+
+TEST(HeadlessPlatform, parses_output_refresh)
+{
+    EXPECT_THAT(mgh::Platform::parse_outputs("1920x1080@143.9"), ElementsAre(mgh::OutputSpec{{1920, 1080}, 143.9}));
+}
+
+TEST(HeadlessPlatform, parses_unthrottled_output)
+{
+    EXPECT_THAT(mgh::Platform::parse_outputs("640x480@0"), ElementsAre(mgh::OutputSpec{{640, 480}, 0}));
+}
+
+TEST(HeadlessPlatform, parses_multiple_outputs)
+{
+    EXPECT_THAT(mgh::Platform::parse_outputs("1280x1024:600x600@30:30x750@120"), ElementsAre(
+        mgh::OutputSpec{{1280, 1024}, 60},
+        mgh::OutputSpec{{600, 600}, 30},
+        mgh::OutputSpec{{30, 750}, 120}));
+}
+
+TEST(HeadlessPlatform, output_parsing_throws_on_bad_input)
+{
+    EXPECT_THROW(mgh::Platform::parse_outputs(""), std::runtime_error) << "Empty";
+    EXPECT_THROW(mgh::Platform::parse_outputs("1280"), std::runtime_error) << "No height or 'x'";
+    EXPECT_THROW(mgh::Platform::parse_outputs("1280x"), std::runtime_error) << "No height";
+    EXPECT_THROW(mgh::Platform::parse_outputs("x720"), std::runtime_error) << "No width";
+    EXPECT_THROW(mgh::Platform::parse_outputs("0x720"), std::runtime_error) << "Zero width";
+    EXPECT_THROW(mgh::Platform::parse_outputs("1280x720@"), std::runtime_error) << "No refresh after '@'";
+    EXPECT_THROW(mgh::Platform::parse_outputs("1280x720@-60"), std::runtime_error) << "Negative refresh";
+    EXPECT_THROW(mgh::Platform::parse_outputs("1280x720@sixty"), std::runtime_error) << "Non-numeric refresh";
+    EXPECT_THROW(mgh::Platform::parse_outputs("1280x720@nan"), std::runtime_error) << "NaN refresh";
+    EXPECT_THROW(mgh::Platform::parse_outputs("1280x720@inf"), std::runtime_error) << "Infinite refresh";
+    EXPECT_THROW(mgh::Platform::parse_outputs("1280x720@1e-300"), std::runtime_error) << "Vanishing refresh";
+    EXPECT_THROW(mgh::Platform::parse_outputs("1280x720@1e400"), std::runtime_error) << "Out of range refresh";
+    EXPECT_THROW(mgh::Platform::parse_outputs("99999999999x720"), std::runtime_error) << "Out of range width";
+    EXPECT_THROW(mgh::Platform::parse_outputs("1280x720:"), std::runtime_error) << "Trailing ':'";
+}
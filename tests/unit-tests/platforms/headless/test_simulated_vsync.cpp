@@ -0,0 +1,88 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/headless/simulated_vsync.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mg = mir::graphics;
+namespace mgh = mg::headless;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+TEST(SimulatedVsync, interval_matches_refresh_rate)
+{
+    EXPECT_THAT(mgh::SimulatedVsync{50}.interval(), Eq(20ms));
+    EXPECT_THAT(mgh::SimulatedVsync{0}.interval(), Eq(0ns));
+}
+
+TEST(SimulatedVsync, first_flip_is_immediate)
+{
+    mgh::SimulatedVsync vsync{60};
+    auto const before = mg::Frame::Timestamp::now(CLOCK_MONOTONIC);
+
+    auto const frame = vsync.flip();
+
+    EXPECT_THAT(frame.msc, Eq(1));
+    EXPECT_THAT(frame.ust - before, Lt(1ms));
+    EXPECT_THAT(vsync.last_flip().msc, Eq(1));
+}
+
+TEST(SimulatedVsync, flips_complete_on_the_next_vblank)
+{
+    mgh::SimulatedVsync vsync{100};
+    auto const first = vsync.flip();
+
+    auto const next = vsync.next_flip(first.ust + 3ms);
+    EXPECT_THAT(next.msc, Eq(2));
+    EXPECT_THAT(next.ust - first.ust, Eq(10ms));
+}
+
+TEST(SimulatedVsync, missed_vblanks_are_counted)
+{
+    mgh::SimulatedVsync vsync{100};
+    auto const first = vsync.flip();
+
+    auto const next = vsync.next_flip(first.ust + 25ms);
+    EXPECT_THAT(next.msc, Eq(4));
+    EXPECT_THAT(next.ust - first.ust, Eq(30ms));
+}
+
+TEST(SimulatedVsync, flip_waits_for_the_vblank)
+{
+    mgh::SimulatedVsync vsync{100};
+    auto const first = vsync.flip();
+
+    auto const second = vsync.flip();
+
+    EXPECT_THAT(second.msc, Eq(2));
+    EXPECT_THAT(second.ust - first.ust, Eq(10ms));
+    EXPECT_THAT(mg::Frame::Timestamp::now(CLOCK_MONOTONIC), Ge(second.ust));
+}
+
+TEST(SimulatedVsync, unthrottled_flips_do_not_wait)
+{
+    mgh::SimulatedVsync vsync{0};
+    vsync.flip();
+    auto const now = mg::Frame::Timestamp::now(CLOCK_MONOTONIC) + 1s;
+
+    auto const next = vsync.next_flip(now);
+
+    EXPECT_THAT(next.msc, Eq(2));
+    EXPECT_THAT(next.ust, Eq(now));
+}
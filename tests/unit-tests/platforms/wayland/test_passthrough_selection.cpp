@@ -0,0 +1,183 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/wayland/passthrough_selection.h"
+
+#include "mir/renderer/sw/pixel_source.h"
+#include "mir/test/doubles/mock_renderable.h"
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mg = mir::graphics;
+namespace mgw = mg::wayland;
+namespace mrs = mir::renderer::software;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+/// A shm-like client buffer: one we can read the pixels of
+struct ReadableBuffer : mtd::StubBuffer, mrs::ReadMappableBuffer
+{
+    ReadableBuffer(geom::Size size, MirPixelFormat format) :
+        StubBuffer{mg::BufferProperties{size, format, mg::BufferUsage::software}}
+    {
+    }
+
+    auto map_readable() -> std::unique_ptr<mrs::Mapping<unsigned char const>> override
+    {
+        BOOST_THROW_EXCEPTION(std::logic_error{"Selecting a passthrough shouldn't read the pixels"});
+    }
+};
+
+struct PassthroughSelection : Test
+{
+    auto renderable_at(geom::Rectangle const& position, MirPixelFormat format = mir_pixel_format_xrgb_8888)
+        -> std::shared_ptr<NiceMock<mtd::MockRenderable>>
+    {
+        auto const renderable = std::make_shared<NiceMock<mtd::MockRenderable>>();
+        ON_CALL(*renderable, screen_position()).WillByDefault(Return(position));
+        ON_CALL(*renderable, transformation()).WillByDefault(Return(glm::mat4{1}));
+        ON_CALL(*renderable, buffer()).WillByDefault(Return(std::make_shared<ReadableBuffer>(position.size, format)));
+        return renderable;
+    }
+
+    auto select(mg::RenderableList const& renderlist, float scale = 1.0f)
+    {
+        return mgw::select_passthrough(renderlist, output_area, scale);
+    }
+
+    geom::Rectangle const output_area{{1920, 0}, {1280, 1024}};
+    geom::Rectangle const in_output{{2000, 100}, {640, 480}};
+};
+}
+
+TEST_F(PassthroughSelection, selects_each_client_buffer_bottom_to_top)
+{
+    auto const bottom = renderable_at(output_area);
+    auto const top = renderable_at(in_output);
+
+    auto const sources = select({bottom, top});
+
+    ASSERT_TRUE(sources);
+    ASSERT_THAT(sources->size(), Eq(2u));
+    EXPECT_THAT((*sources)[0].buffer, Eq(dynamic_cast<mrs::ReadMappableBuffer*>(bottom->buffer().get())));
+    EXPECT_THAT((*sources)[1].buffer, Eq(dynamic_cast<mrs::ReadMappableBuffer*>(top->buffer().get())));
+}
+
+TEST_F(PassthroughSelection, positions_are_relative_to_the_output)
+{
+    auto const sources = select({renderable_at(in_output)});
+
+    ASSERT_TRUE(sources);
+    ASSERT_THAT(sources->size(), Eq(1u));
+    EXPECT_THAT((*sources)[0].position, Eq(geom::Rectangle{{80, 100}, {640, 480}}));
+}
+
+TEST_F(PassthroughSelection, keeps_the_buffer_format)
+{
+    auto const sources = select({renderable_at(in_output, mir_pixel_format_argb_8888)});
+
+    ASSERT_TRUE(sources);
+    ASSERT_THAT(sources->size(), Eq(1u));
+    EXPECT_THAT((*sources)[0].format, Eq(mir_pixel_format_argb_8888));
+}
+
+TEST_F(PassthroughSelection, composites_an_empty_frame)
+{
+    EXPECT_FALSE(select({}));
+}
+
+TEST_F(PassthroughSelection, composites_on_a_scaled_output)
+{
+    EXPECT_FALSE(select({renderable_at(in_output)}, 2.0f));
+}
+
+TEST_F(PassthroughSelection, composites_a_translucent_renderable)
+{
+    auto const renderable = renderable_at(in_output);
+    ON_CALL(*renderable, alpha()).WillByDefault(Return(0.5f));
+
+    EXPECT_FALSE(select({renderable}));
+}
+
+TEST_F(PassthroughSelection, composites_a_transformed_renderable)
+{
+    auto const renderable = renderable_at(in_output);
+    ON_CALL(*renderable, transformation()).WillByDefault(Return(glm::mat4{2}));
+
+    EXPECT_FALSE(select({renderable}));
+}
+
+TEST_F(PassthroughSelection, composites_a_clipped_renderable)
+{
+    auto const renderable = renderable_at(in_output);
+    ON_CALL(*renderable, clip_area())
+        .WillByDefault(Return(std::experimental::make_optional(geom::Rectangle{{2000, 100}, {320, 240}})));
+
+    EXPECT_FALSE(select({renderable}));
+}
+
+TEST_F(PassthroughSelection, composites_a_cropped_renderable)
+{
+    auto const renderable = renderable_at(in_output);
+    ON_CALL(*renderable, src_bounds())
+        .WillByDefault(Return(std::experimental::make_optional(geom::Rectangle{{0, 0}, {320, 240}})));
+
+    EXPECT_FALSE(select({renderable}));
+}
+
+TEST_F(PassthroughSelection, composites_a_scaled_renderable)
+{
+    auto const renderable = renderable_at(in_output);
+    ON_CALL(*renderable, buffer())
+        .WillByDefault(Return(std::make_shared<ReadableBuffer>(geom::Size{320, 240}, mir_pixel_format_xrgb_8888)));
+
+    EXPECT_FALSE(select({renderable}));
+}
+
+TEST_F(PassthroughSelection, composites_a_renderable_partly_outside_the_output)
+{
+    EXPECT_FALSE(select({renderable_at({{1600, 100}, {640, 480}})}));
+}
+
+TEST_F(PassthroughSelection, composites_a_buffer_that_cannot_be_read)
+{
+    auto const renderable = renderable_at(in_output);
+    ON_CALL(*renderable, buffer())
+        .WillByDefault(Return(std::make_shared<mtd::StubBuffer>(nullptr, in_output.size, mir_pixel_format_xrgb_8888)));
+
+    EXPECT_FALSE(select({renderable}));
+}
+
+TEST_F(PassthroughSelection, composites_a_buffer_in_a_format_the_host_may_not_support)
+{
+    EXPECT_FALSE(select({renderable_at(in_output, mir_pixel_format_abgr_8888)}));
+}
+
+TEST_F(PassthroughSelection, one_unsuitable_renderable_composites_the_whole_frame)
+{
+    auto const translucent = renderable_at(in_output);
+    ON_CALL(*translucent, alpha()).WillByDefault(Return(0.5f));
+
+    EXPECT_FALSE(select({renderable_at(output_area), translucent}));
+}
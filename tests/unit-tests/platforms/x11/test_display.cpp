@@ -24,6 +24,8 @@
 #include "src/server/report/null/display_report.h"
 
 #include "mir/graphics/display_configuration.h"
+#include "mir/graphics/display_buffer.h"
+#include "mir/renderer/gl/render_target.h"
 
 #include "mir/test/doubles/null_display_configuration_policy.h"
 #include "mir/test/doubles/mock_egl.h"
@@ -365,3 +367,38 @@ TEST_F(X11DisplayTest, updates_scale_property_correctly)
 
     EXPECT_THAT(new_scale, Eq(scale));
 }
+
+TEST_F(X11DisplayTest, each_output_tracks_its_own_frames)
+{
+    auto const pixel = geom::Size{2880, 1800};
+    auto const mm = geom::Size{677, 290};
+    auto const window_sizes = std::vector<mgx::X11OutputConfig>{{{1280, 1024}}, {{600, 500}}};
+
+    setup_x11_screen(pixel, mm, window_sizes);
+
+    auto display = create_display();
+
+    std::vector<unsigned> output_ids;
+    display->configuration()->for_each_output(
+        [&output_ids](mg::DisplayConfigurationOutput const& output)
+        {
+            output_ids.push_back(output.id.as_value());
+        });
+    ASSERT_THAT(output_ids.size(), Eq(2u));
+
+    bool first = true;
+    display->for_each_display_sync_group(
+        [&first](mg::DisplaySyncGroup& group)
+        {
+            group.for_each_display_buffer(
+                [&first](mg::DisplayBuffer& db)
+                {
+                    if (first)
+                        dynamic_cast<mir::renderer::gl::RenderTarget&>(db).swap_buffers();
+                    first = false;
+                });
+        });
+
+    EXPECT_THAT(display->last_frame_on(output_ids[0]).msc, Gt(0));
+    EXPECT_THAT(display->last_frame_on(output_ids[1]).msc, Eq(0));
+}
@@ -26,11 +26,13 @@
 #include <mir/test/doubles/mock_renderable.h>
 #include <mir/test/doubles/mock_buffer_stream.h>
 #include <mir/compositor/buffer_stream.h>
+#include <mir/graphics/solid_color_buffer.h>
 #include <mir/test/doubles/mock_gl.h>
 #include <mir/test/doubles/mock_egl.h>
 #include <src/renderers/gl/renderer.h>
 #include <mir/test/doubles/stub_gl_display_buffer.h>
 #include <mir/test/doubles/mock_gl_display_buffer.h>
+#include <mir_test_framework/temporary_environment_value.h>
 
 using testing::SetArgPointee;
 using testing::InSequence;
@@ -47,6 +49,7 @@ namespace mtd=mir::test::doubles;
 namespace mg=mir::graphics;
 namespace mgl=mir::gl;
 namespace mrg = mir::renderer::gl;
+namespace mtf = mir_test_framework;
 
 namespace
 {
@@ -220,6 +223,37 @@ TEST_F(GLRenderer, avoids_src_alpha_for_rgbx_blending)  // LP: #1423462
     renderer.render(renderable_list);
 }
 
+TEST_F(GLRenderer, draws_solid_color_buffers_without_a_texture)
+{
+    EXPECT_CALL(*renderable, buffer())
+        .WillRepeatedly(Return(std::make_shared<mg::SolidColorBuffer>(0xff336699)));
+    EXPECT_CALL(*renderable, shaped()).WillRepeatedly(Return(true));
+
+    EXPECT_CALL(mock_gl, glUniform4f(_, 0x33 / 255.0f, 0x66 / 255.0f, 0x99 / 255.0f, 1.0f));
+    EXPECT_CALL(mock_gl, glGenTextures(_, _)).Times(0);
+    EXPECT_CALL(mock_gl, glBindTexture(_, _)).Times(0);
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glDrawArrays(_, _, _));
+
+    mrg::Renderer renderer(display_buffer);
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, blends_translucent_solid_color_buffers)
+{
+    EXPECT_CALL(*renderable, buffer())
+        .WillRepeatedly(Return(std::make_shared<mg::SolidColorBuffer>(0x80402010)));
+    EXPECT_CALL(*renderable, shaped()).WillRepeatedly(Return(true));
+
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND)).Times(0);
+    EXPECT_CALL(mock_gl, glEnable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glBlendFuncSeparate(GL_ONE, GL_ONE_MINUS_SRC_ALPHA,
+                                             GL_ONE, GL_ONE_MINUS_SRC_ALPHA));
+
+    mrg::Renderer renderer(display_buffer);
+    renderer.render(renderable_list);
+}
+
 TEST_F(GLRenderer, clears_all_channels_zero)
 {
     InSequence seq;
@@ -291,6 +325,26 @@ TEST_F(GLRenderer, swaps_buffers_after_rendering)
     renderer.render(renderable_list);
 }
 
+TEST_F(GLRenderer, does_not_check_gl_errors_by_default)
+{
+    mtf::TemporaryEnvironmentValue no_checks{"MIR_GL_CHECK_ERRORS", nullptr};
+    mrg::Renderer renderer(display_buffer);
+
+    EXPECT_CALL(mock_gl, glGetError()).Times(0);
+
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, checks_gl_errors_when_requested)
+{
+    mtf::TemporaryEnvironmentValue checks{"MIR_GL_CHECK_ERRORS", "1"};
+    mrg::Renderer renderer(display_buffer);
+
+    EXPECT_CALL(mock_gl, glGetError()).Times(AtLeast(1));
+
+    renderer.render(renderable_list);
+}
+
 TEST_F(GLRenderer, sets_scissor_test)
 {
     EXPECT_CALL(*renderable, clip_area())
@@ -0,0 +1,233 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/software/renderer.h"
+#include "mir/renderer/sw/blend.h"
+
+#include "mir/graphics/buffer_properties.h"
+#include "mir/graphics/solid_color_buffer.h"
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/stub_buffer.h"
+#include "mir/test/doubles/stub_gl_display_buffer.h"
+#include "mir/test/doubles/stub_software_display_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <random>
+
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+using namespace testing;
+
+namespace
+{
+auto buffer_filled_with(geom::Size size, uint32_t pixel, MirPixelFormat format) -> std::shared_ptr<mg::Buffer>
+{
+    auto const buffer = std::make_shared<mtd::StubBuffer>(mg::BufferProperties{size, format, mg::BufferUsage::software});
+    std::vector<uint32_t> const content(size.width.as_int() * size.height.as_int(), pixel);
+    buffer->write(reinterpret_cast<unsigned char const*>(content.data()), content.size() * sizeof(uint32_t));
+    return buffer;
+}
+
+auto surface(geom::Rectangle position, std::shared_ptr<mg::Buffer> buffer, float alpha = 1.0f, bool shaped = false)
+    -> std::shared_ptr<mtd::FakeRenderable>
+{
+    auto const renderable = std::make_shared<mtd::FakeRenderable>(position, alpha, !shaped);
+    renderable->set_buffer(std::move(buffer));
+    return renderable;
+}
+
+struct SoftwareRenderer : Test
+{
+    geom::Rectangle const screen{{0, 0}, {8, 4}};
+    mtd::StubSoftwareDisplayBuffer display_buffer{screen};
+    mrs::Renderer renderer{display_buffer};
+
+    auto pixel_at(int x, int y) const -> uint32_t
+    {
+        return display_buffer.pixels[y * screen.size.width.as_int() + x];
+    }
+};
+}
+
+TEST(SoftwareRendererConstruction, throws_for_display_buffer_without_software_support)
+{
+    mtd::StubGLDisplayBuffer gl_display_buffer{{{0, 0}, {8, 4}}};
+
+    EXPECT_THROW(mrs::Renderer{gl_display_buffer}, std::logic_error);
+}
+
+TEST_F(SoftwareRenderer, presents_a_cleared_frame_when_nothing_is_visible)
+{
+    std::fill(begin(display_buffer.back), end(display_buffer.back), 0xdeadbeef);
+
+    renderer.render({});
+
+    EXPECT_THAT(display_buffer.frames_presented, Eq(1));
+    EXPECT_THAT(display_buffer.pixels, Each(Eq(0u)));
+}
+
+TEST_F(SoftwareRenderer, copies_opaque_surface_to_its_screen_position)
+{
+    renderer.render({surface({{2, 1}, {3, 2}}, buffer_filled_with({3, 2}, 0x00ff0000, mir_pixel_format_xrgb_8888))});
+
+    EXPECT_THAT(pixel_at(2, 1), Eq(0xffff0000));
+    EXPECT_THAT(pixel_at(4, 2), Eq(0xffff0000));
+    EXPECT_THAT(pixel_at(1, 1), Eq(0u));
+    EXPECT_THAT(pixel_at(5, 1), Eq(0u));
+    EXPECT_THAT(pixel_at(2, 3), Eq(0u));
+}
+
+TEST_F(SoftwareRenderer, blends_translucent_surfaces_over_those_below)
+{
+    renderer.render({
+        surface(screen, buffer_filled_with({8, 4}, 0x00ffffff, mir_pixel_format_xrgb_8888)),
+        surface(screen, buffer_filled_with({8, 4}, 0x80000000, mir_pixel_format_argb_8888), 1.0f, true)});
+
+    EXPECT_THAT(display_buffer.pixels, Each(Eq(0xff7f7f7fu)));
+}
+
+TEST_F(SoftwareRenderer, applies_surface_alpha)
+{
+    renderer.render({surface(screen, buffer_filled_with({8, 4}, 0x00ffffff, mir_pixel_format_xrgb_8888), 0.5f)});
+
+    EXPECT_THAT(display_buffer.pixels, Each(Eq(0x80808080u)));
+}
+
+TEST_F(SoftwareRenderer, scales_buffers_to_their_screen_position)
+{
+    renderer.render({surface({{0, 0}, {4, 2}}, buffer_filled_with({1, 1}, 0xffff0000, mir_pixel_format_argb_8888))});
+
+    EXPECT_THAT(pixel_at(0, 0), Eq(0xffff0000));
+    EXPECT_THAT(pixel_at(3, 1), Eq(0xffff0000));
+    EXPECT_THAT(pixel_at(4, 0), Eq(0u));
+    EXPECT_THAT(pixel_at(0, 2), Eq(0u));
+}
+
+TEST_F(SoftwareRenderer, fills_screen_position_with_solid_color_buffers)
+{
+    renderer.render({surface({{1, 1}, {3, 2}}, std::make_shared<mg::SolidColorBuffer>(0xff00ff00), 1.0f, true)});
+
+    EXPECT_THAT(pixel_at(1, 1), Eq(0xff00ff00));
+    EXPECT_THAT(pixel_at(3, 2), Eq(0xff00ff00));
+    EXPECT_THAT(pixel_at(0, 1), Eq(0u));
+    EXPECT_THAT(pixel_at(4, 2), Eq(0u));
+}
+
+TEST_F(SoftwareRenderer, converts_abgr_buffers)
+{
+    renderer.render({surface(screen, buffer_filled_with({8, 4}, 0xff0000ff, mir_pixel_format_abgr_8888))});
+
+    EXPECT_THAT(display_buffer.pixels, Each(Eq(0xffff0000u)));
+}
+
+TEST_F(SoftwareRenderer, converts_for_abgr_outputs)
+{
+    mtd::StubSoftwareDisplayBuffer abgr_display_buffer{screen, mir_pixel_format_abgr_8888};
+    mrs::Renderer abgr_renderer{abgr_display_buffer};
+
+    abgr_renderer.render({surface(screen, buffer_filled_with({8, 4}, 0xffff0000, mir_pixel_format_argb_8888))});
+
+    EXPECT_THAT(abgr_display_buffer.pixels, Each(Eq(0xff0000ffu)));
+}
+
+TEST_F(SoftwareRenderer, renders_relative_to_the_viewport)
+{
+    renderer.set_viewport({{8, 0}, {8, 4}});
+
+    renderer.render({surface({{9, 1}, {1, 1}}, buffer_filled_with({1, 1}, 0xffff0000, mir_pixel_format_argb_8888))});
+
+    EXPECT_THAT(pixel_at(1, 1), Eq(0xffff0000));
+    EXPECT_THAT(pixel_at(0, 0), Eq(0u));
+}
+
+TEST_F(SoftwareRenderer, skips_surfaces_outside_the_viewport)
+{
+    renderer.render({surface({{20, 20}, {4, 4}}, buffer_filled_with({4, 4}, 0xffff0000, mir_pixel_format_argb_8888))});
+
+    EXPECT_THAT(display_buffer.pixels, Each(Eq(0u)));
+}
+
+TEST(SoftwareBlend, matches_reference_for_every_span_length)
+{
+    auto const reference = [](uint32_t dst, uint32_t src, uint32_t alpha)
+        {
+            auto const mul_div255 = [](uint32_t x, uint32_t a) { return (x * a + 127) / 255; };
+            uint32_t s[4], result = 0;
+            for (auto c = 0; c != 4; ++c)
+                s[c] = mul_div255((src >> (8 * c)) & 0xff, alpha);
+            for (auto c = 0; c != 4; ++c)
+                result |= std::min(s[c] + mul_div255((dst >> (8 * c)) & 0xff, 255 - s[3]), 255u) << (8 * c);
+            return result;
+        };
+
+    std::mt19937 random{42};
+    for (auto count = 0u; count != 40; ++count)
+    {
+        std::vector<uint32_t> src(count), dst(count);
+        for (auto& pixel : src)
+        {
+            // Premultiplied: no colour channel may exceed alpha
+            uint32_t const a = random() % 256;
+            pixel = a << 24 | (random() % (a + 1)) << 16 | (random() % (a + 1)) << 8 | random() % (a + 1);
+        }
+        for (auto& pixel : dst)
+            pixel = random();
+
+        uint8_t const alpha = count % 2 ? 255 : random() % 256;
+        auto blended = dst;
+        mrs::blend_over(blended.data(), src.data(), count, alpha);
+
+        for (auto i = 0u; i != count; ++i)
+            EXPECT_THAT(blended[i], Eq(reference(dst[i], src[i], alpha))) << "count=" << count << " i=" << i;
+    }
+}
+
+TEST(SoftwareBlend, coverage_matches_reference_for_every_span_length)
+{
+    auto const reference = [](uint32_t dst, uint32_t color, uint32_t coverage)
+        {
+            auto const mul_div255 = [](uint32_t x, uint32_t a) { return (x * a + 127) / 255; };
+            uint32_t s[4], result = 0;
+            for (auto c = 0; c != 4; ++c)
+                s[c] = mul_div255((color >> (8 * c)) & 0xff, coverage);
+            for (auto c = 0; c != 4; ++c)
+                result |= std::min(s[c] + mul_div255((dst >> (8 * c)) & 0xff, 255 - s[3]), 255u) << (8 * c);
+            return result;
+        };
+
+    std::mt19937 random{42};
+    for (auto count = 0u; count != 40; ++count)
+    {
+        std::vector<uint8_t> coverage(count);
+        std::vector<uint32_t> dst(count);
+        for (auto& value : coverage)
+            value = random() % 3 ? random() % 256 : 0;
+        for (auto& pixel : dst)
+            pixel = random();
+
+        uint32_t const color = count % 2 ? 0xffa0a0a0 : 0x80402010;
+        auto blended = dst;
+        mrs::blend_coverage(blended.data(), coverage.data(), count, color);
+
+        for (auto i = 0u; i != count; ++i)
+            EXPECT_THAT(blended[i], Eq(reference(dst[i], color, coverage[i]))) << "count=" << count << " i=" << i;
+    }
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/scene/basic_idle_hub.h"
+
+#include "mir/test/doubles/fake_alarm_factory.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace ms = mir::scene;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+using namespace std::literals::chrono_literals;
+
+namespace
+{
+class MockIdleStateObserver : public ms::IdleStateObserver
+{
+public:
+    MOCK_METHOD0(idle, void());
+    MOCK_METHOD0(active, void());
+};
+
+struct BasicIdleHub : Test
+{
+    mtd::FakeAlarmFactory alarm_factory;
+    std::shared_ptr<ms::BasicIdleHub> const hub{std::make_shared<ms::BasicIdleHub>(alarm_factory)};
+    std::shared_ptr<MockIdleStateObserver> const observer{std::make_shared<StrictMock<MockIdleStateObserver>>()};
+};
+}
+
+TEST_F(BasicIdleHub, observer_is_told_when_idle_after_timeout)
+{
+    hub->register_interest(observer, 10s);
+
+    alarm_factory.advance_by(9s);
+    Mock::VerifyAndClearExpectations(observer.get());
+
+    EXPECT_CALL(*observer, idle());
+    alarm_factory.advance_by(2s);
+}
+
+TEST_F(BasicIdleHub, observer_is_only_told_idle_once)
+{
+    hub->register_interest(observer, 10s);
+
+    EXPECT_CALL(*observer, idle()).Times(1);
+    alarm_factory.advance_by(11s);
+    alarm_factory.advance_by(11s);
+}
+
+TEST_F(BasicIdleHub, poke_restarts_timeout)
+{
+    hub->register_interest(observer, 10s);
+
+    alarm_factory.advance_by(9s);
+    hub->poke();
+    alarm_factory.advance_by(9s);
+    Mock::VerifyAndClearExpectations(observer.get());
+
+    EXPECT_CALL(*observer, idle());
+    alarm_factory.advance_by(2s);
+}
+
+TEST_F(BasicIdleHub, poke_after_idle_makes_observer_active)
+{
+    hub->register_interest(observer, 10s);
+
+    EXPECT_CALL(*observer, idle());
+    alarm_factory.advance_by(11s);
+    Mock::VerifyAndClearExpectations(observer.get());
+
+    EXPECT_CALL(*observer, active());
+    hub->poke();
+    Mock::VerifyAndClearExpectations(observer.get());
+
+    EXPECT_CALL(*observer, idle());
+    alarm_factory.advance_by(11s);
+}
+
+TEST_F(BasicIdleHub, observers_with_different_timeouts_are_told_independently)
+{
+    auto const other_observer = std::make_shared<StrictMock<MockIdleStateObserver>>();
+    hub->register_interest(observer, 10s);
+    hub->register_interest(other_observer, 20s);
+
+    EXPECT_CALL(*observer, idle());
+    alarm_factory.advance_by(11s);
+    Mock::VerifyAndClearExpectations(observer.get());
+
+    EXPECT_CALL(*other_observer, idle());
+    alarm_factory.advance_by(10s);
+}
+
+TEST_F(BasicIdleHub, nothing_goes_idle_while_inhibited)
+{
+    hub->register_interest(observer, 10s);
+
+    auto const inhibition = hub->inhibit_idle();
+    alarm_factory.advance_by(60s);
+}
+
+TEST_F(BasicIdleHub, inhibiting_makes_idle_observer_active)
+{
+    hub->register_interest(observer, 10s);
+
+    EXPECT_CALL(*observer, idle());
+    alarm_factory.advance_by(11s);
+    Mock::VerifyAndClearExpectations(observer.get());
+
+    EXPECT_CALL(*observer, active());
+    auto const inhibition = hub->inhibit_idle();
+}
+
+TEST_F(BasicIdleHub, timeout_restarts_when_last_inhibition_is_released)
+{
+    hub->register_interest(observer, 10s);
+
+    auto inhibition_one = hub->inhibit_idle();
+    auto inhibition_two = hub->inhibit_idle();
+    alarm_factory.advance_by(20s);
+
+    inhibition_one.reset();
+    alarm_factory.advance_by(20s);
+    inhibition_two.reset();
+    alarm_factory.advance_by(9s);
+    Mock::VerifyAndClearExpectations(observer.get());
+
+    EXPECT_CALL(*observer, idle());
+    alarm_factory.advance_by(2s);
+}
+
+TEST_F(BasicIdleHub, unregistered_observer_is_not_told_idle)
+{
+    hub->register_interest(observer, 10s);
+    hub->unregister_interest(*observer);
+
+    alarm_factory.advance_by(20s);
+}
+
+TEST_F(BasicIdleHub, inhibition_may_outlive_hub)
+{
+    auto local_hub = std::make_shared<ms::BasicIdleHub>(alarm_factory);
+    auto const inhibition = local_hub->inhibit_idle();
+    local_hub.reset();
+}
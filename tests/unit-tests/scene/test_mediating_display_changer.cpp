@@ -105,6 +105,20 @@ struct MockServerActionQueue : mir::ServerActionQueue
     MOCK_METHOD1(resume_processing_for, void(void const*));
 };
 
+auto power_modes_of_used_outputs(mg::DisplayConfiguration const& conf) -> std::vector<MirPowerMode>
+{
+    std::vector<MirPowerMode> result;
+    conf.for_each_output(
+        [&](mg::DisplayConfigurationOutput const& output)
+        {
+            if (output.used)
+            {
+                result.push_back(output.power_mode);
+            }
+        });
+    return result;
+}
+
 struct MediatingDisplayChangerTest : public ::testing::Test
 {
     MediatingDisplayChangerTest()
@@ -1043,3 +1057,65 @@ TEST_F(MediatingDisplayChangerTest, all_sessions_get_notified_on_configuration_c
     EXPECT_THAT(*received_configuration, mt::DisplayConfigMatches(std::cref(*new_config)));
 }
 
+TEST_F(MediatingDisplayChangerTest, turning_outputs_off_applies_to_the_active_session_configuration)
+{
+    using namespace testing;
+    auto const conf = std::make_shared<mtd::StubDisplayConfig>(
+        std::vector<geom::Rectangle>{{{0, 0}, {640, 480}}, {{640, 0}, {640, 480}}});
+    auto session = std::make_shared<mtd::StubSession>();
+
+    session_event_sink.handle_focus_change(session);
+    changer->configure(session, conf);
+
+    EXPECT_TRUE(changer->set_outputs_off(true));
+
+    EXPECT_THAT(power_modes_of_used_outputs(*mock_display.config),
+                ElementsAre(mir_power_mode_off, mir_power_mode_off));
+    EXPECT_THAT(power_modes_of_used_outputs(*changer->base_configuration()),
+                Each(mir_power_mode_on));
+}
+
+TEST_F(MediatingDisplayChangerTest, turning_outputs_on_restores_the_active_session_configuration)
+{
+    using namespace testing;
+    auto const conf = std::make_shared<mtd::StubDisplayConfig>(
+        std::vector<geom::Rectangle>{{{0, 0}, {640, 480}}, {{640, 0}, {640, 480}}});
+    auto session = std::make_shared<mtd::StubSession>();
+
+    session_event_sink.handle_focus_change(session);
+    changer->configure(session, conf);
+    changer->set_outputs_off(true);
+
+    EXPECT_TRUE(changer->set_outputs_off(false));
+
+    EXPECT_THAT(*mock_display.config, mt::DisplayConfigMatches(std::cref(*conf)));
+}
+
+TEST_F(MediatingDisplayChangerTest, configuration_applied_while_outputs_are_off_keeps_them_off)
+{
+    using namespace testing;
+    auto const conf = std::make_shared<mtd::StubDisplayConfig>(
+        std::vector<geom::Rectangle>{{{0, 0}, {640, 480}}, {{640, 0}, {640, 480}}});
+    auto session = std::make_shared<mtd::StubSession>();
+
+    changer->set_outputs_off(true);
+
+    session_event_sink.handle_focus_change(session);
+    changer->configure(session, conf);
+
+    EXPECT_THAT(power_modes_of_used_outputs(*mock_display.config),
+                ElementsAre(mir_power_mode_off, mir_power_mode_off));
+}
+
+TEST_F(MediatingDisplayChangerTest, reports_failure_to_turn_outputs_off)
+{
+    using namespace testing;
+
+    EXPECT_CALL(mock_display, configure(_))
+        .WillOnce(InvokeWithoutArgs([]() { BOOST_THROW_EXCEPTION(std::runtime_error{"Ducks!"}); }))
+        .WillRepeatedly(DoDefault());
+    EXPECT_CALL(display_configuration_observer, configuration_failed(_, _));
+
+    EXPECT_FALSE(changer->set_outputs_off(true));
+    EXPECT_THAT(power_modes_of_used_outputs(*mock_display.config), Each(mir_power_mode_on));
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/shell/basic_idle_handler.h"
+#include "src/server/scene/basic_idle_hub.h"
+
+#include "mir/server_action_queue.h"
+#include "mir/shell/display_configuration_controller.h"
+#include "mir/test/doubles/fake_alarm_factory.h"
+#include "mir/test/doubles/mock_compositor.h"
+#include "mir/test/doubles/stub_buffer_allocator.h"
+#include "mir/test/doubles/stub_input_scene.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace msh = mir::shell;
+namespace ms = mir::scene;
+namespace mg = mir::graphics;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+using namespace std::literals::chrono_literals;
+
+namespace
+{
+struct StubServerActionQueue : mir::ServerActionQueue
+{
+    void enqueue(void const* /*owner*/, mir::ServerAction const& action) override
+    {
+        action();
+    }
+    void enqueue_with_guaranteed_execution(mir::ServerAction const& action) override
+    {
+        action();
+    }
+
+    void pause_processing_for(void const* /*owner*/) override {}
+    void resume_processing_for(void const* /*owner*/) override {}
+};
+
+struct MockDisplayConfigurationController : msh::DisplayConfigurationController
+{
+    MOCK_METHOD1(set_base_configuration, void(std::shared_ptr<mg::DisplayConfiguration> const&));
+    MOCK_METHOD0(base_configuration, std::shared_ptr<mg::DisplayConfiguration>());
+    MOCK_METHOD1(set_outputs_off, bool(bool));
+};
+
+// Short enough that the outputs aren't dimmed first
+auto const off_timeout = 5s;
+
+struct BasicIdleHandler : Test
+{
+    auto make_handler() -> std::unique_ptr<msh::BasicIdleHandler>
+    {
+        return std::make_unique<msh::BasicIdleHandler>(
+            hub,
+            std::make_shared<mtd::StubInputScene>(),
+            std::make_shared<mtd::StubBufferAllocator>(),
+            display_config_controller,
+            compositor,
+            std::make_shared<StubServerActionQueue>(),
+            off_timeout);
+    }
+
+    mtd::FakeAlarmFactory alarm_factory;
+    std::shared_ptr<ms::BasicIdleHub> const hub{std::make_shared<ms::BasicIdleHub>(alarm_factory)};
+    std::shared_ptr<MockDisplayConfigurationController> const display_config_controller{
+        std::make_shared<StrictMock<MockDisplayConfigurationController>>()};
+    std::shared_ptr<mtd::MockCompositor> const compositor{std::make_shared<StrictMock<mtd::MockCompositor>>()};
+};
+}
+
+TEST_F(BasicIdleHandler, does_nothing_before_the_timeout)
+{
+    auto const handler = make_handler();
+
+    alarm_factory.advance_by(off_timeout - 1s);
+}
+
+TEST_F(BasicIdleHandler, turns_outputs_off_and_stops_compositing_after_the_timeout)
+{
+    auto const handler = make_handler();
+
+    EXPECT_CALL(*display_config_controller, set_outputs_off(true)).WillOnce(Return(true));
+    EXPECT_CALL(*compositor, stop());
+    alarm_factory.advance_by(off_timeout + 1s);
+}
+
+TEST_F(BasicIdleHandler, keeps_compositing_if_the_outputs_cannot_be_turned_off)
+{
+    auto const handler = make_handler();
+
+    EXPECT_CALL(*display_config_controller, set_outputs_off(true)).WillOnce(Return(false));
+    alarm_factory.advance_by(off_timeout + 1s);
+}
+
+TEST_F(BasicIdleHandler, activity_restarts_compositing_before_turning_outputs_on)
+{
+    auto const handler = make_handler();
+
+    EXPECT_CALL(*display_config_controller, set_outputs_off(true)).WillOnce(Return(true));
+    EXPECT_CALL(*compositor, stop());
+    alarm_factory.advance_by(off_timeout + 1s);
+    Mock::VerifyAndClearExpectations(display_config_controller.get());
+    Mock::VerifyAndClearExpectations(compositor.get());
+
+    InSequence seq;
+    EXPECT_CALL(*compositor, start());
+    EXPECT_CALL(*display_config_controller, set_outputs_off(false)).WillOnce(Return(true));
+    hub->poke();
+}
+
+TEST_F(BasicIdleHandler, outputs_stay_on_while_idle_is_inhibited)
+{
+    auto const handler = make_handler();
+    auto inhibition = hub->inhibit_idle();
+
+    alarm_factory.advance_by(off_timeout * 3);
+    Mock::VerifyAndClearExpectations(display_config_controller.get());
+    Mock::VerifyAndClearExpectations(compositor.get());
+
+    inhibition.reset();
+
+    EXPECT_CALL(*display_config_controller, set_outputs_off(true)).WillOnce(Return(true));
+    EXPECT_CALL(*compositor, stop());
+    alarm_factory.advance_by(off_timeout + 1s);
+}
+
+TEST_F(BasicIdleHandler, inhibiting_idle_turns_outputs_back_on)
+{
+    auto const handler = make_handler();
+
+    EXPECT_CALL(*display_config_controller, set_outputs_off(true)).WillOnce(Return(true));
+    EXPECT_CALL(*compositor, stop());
+    alarm_factory.advance_by(off_timeout + 1s);
+    Mock::VerifyAndClearExpectations(display_config_controller.get());
+    Mock::VerifyAndClearExpectations(compositor.get());
+
+    EXPECT_CALL(*compositor, start());
+    EXPECT_CALL(*display_config_controller, set_outputs_off(false)).WillOnce(Return(true));
+    auto const inhibition = hub->inhibit_idle();
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/shell/decoration/glyph_cache.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+namespace msd = mir::shell::decoration;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+char32_t const ellipsis{U'\u2026'};
+
+struct DecorationGlyphCache : Test
+{
+    /// Every glyph is 10 pixels wide, except the ellipsis which is 6
+    auto rasterize(char32_t codepoint, geom::Height height) -> std::shared_ptr<msd::Glyph const>
+    {
+        rasterized.push_back(codepoint);
+        if (codepoint == unrenderable)
+            throw std::runtime_error{"Failed to render glyph"};
+
+        auto const glyph = std::make_shared<msd::Glyph>();
+        int const width = codepoint == ellipsis ? 6 : 10;
+        glyph->offset = {1, 2};
+        glyph->advance = {width, 0};
+        glyph->size = {width - 2, height.as_int() - 2};
+        glyph->coverage.resize(glyph->size.width.as_int() * glyph->size.height.as_int());
+        return glyph;
+    }
+
+    auto make_cache(size_t capacity) -> msd::GlyphCache
+    {
+        return msd::GlyphCache{
+            capacity,
+            [this](char32_t codepoint, geom::Height height) { return rasterize(codepoint, height); }};
+    }
+
+    static auto pen_positions(std::vector<msd::PlacedGlyph> const& line) -> std::vector<int>
+    {
+        std::vector<int> result;
+        for (auto const& placed : line)
+            result.push_back((placed.top_left - placed.glyph->offset).dx.as_int());
+        return result;
+    }
+
+    std::vector<char32_t> rasterized;
+    char32_t unrenderable{U'\uffff'};
+    geom::Height const height{12};
+};
+}
+
+TEST_F(DecorationGlyphCache, rasterizes_a_glyph_on_a_miss)
+{
+    auto cache = make_cache(16);
+
+    auto const glyph = cache.glyph(U'a', height);
+
+    ASSERT_THAT(glyph, NotNull());
+    EXPECT_THAT(rasterized, ElementsAre(U'a'));
+    EXPECT_THAT(cache.size(), Eq(1u));
+}
+
+TEST_F(DecorationGlyphCache, reuses_a_glyph_on_a_hit)
+{
+    auto cache = make_cache(16);
+
+    auto const first = cache.glyph(U'a', height);
+    auto const second = cache.glyph(U'a', height);
+
+    EXPECT_THAT(second, Eq(first));
+    EXPECT_THAT(rasterized, ElementsAre(U'a'));
+}
+
+TEST_F(DecorationGlyphCache, caches_each_height_separately)
+{
+    auto cache = make_cache(16);
+
+    auto const small = cache.glyph(U'a', height);
+    auto const large = cache.glyph(U'a', height * 2);
+
+    EXPECT_THAT(large, Ne(small));
+    EXPECT_THAT(rasterized, ElementsAre(U'a', U'a'));
+    EXPECT_THAT(cache.size(), Eq(2u));
+}
+
+TEST_F(DecorationGlyphCache, evicts_the_least_recently_used_glyph_when_full)
+{
+    auto cache = make_cache(2);
+    cache.glyph(U'a', height);
+    cache.glyph(U'b', height);
+    cache.glyph(U'a', height);
+
+    cache.glyph(U'c', height);
+    rasterized.clear();
+    cache.glyph(U'a', height);
+    cache.glyph(U'b', height);
+
+    EXPECT_THAT(rasterized, ElementsAre(U'b'));
+    EXPECT_THAT(cache.size(), Eq(2u));
+}
+
+TEST_F(DecorationGlyphCache, evicted_glyphs_stay_valid_for_their_users)
+{
+    auto cache = make_cache(1);
+    auto const a = cache.glyph(U'a', height);
+
+    cache.glyph(U'b', height);
+
+    EXPECT_THAT(a->size, Eq(geom::Size{8, 10}));
+}
+
+TEST_F(DecorationGlyphCache, failing_to_rasterize_does_not_cache)
+{
+    auto cache = make_cache(16);
+
+    EXPECT_THROW(cache.glyph(unrenderable, height), std::runtime_error);
+    EXPECT_THAT(cache.size(), Eq(0u));
+}
+
+TEST_F(DecorationGlyphCache, lays_out_glyphs_by_their_advance_and_offset)
+{
+    auto cache = make_cache(16);
+
+    auto const line = msd::lay_out_line(cache, U"abc", height, geom::Width{100});
+
+    ASSERT_THAT(line.size(), Eq(3u));
+    EXPECT_THAT(line[0].top_left, Eq(geom::Displacement{1, 2}));
+    EXPECT_THAT(line[1].top_left, Eq(geom::Displacement{11, 2}));
+    EXPECT_THAT(line[2].top_left, Eq(geom::Displacement{21, 2}));
+}
+
+TEST_F(DecorationGlyphCache, lays_out_repeated_characters_with_one_rasterization)
+{
+    auto cache = make_cache(16);
+
+    msd::lay_out_line(cache, U"aaa", height, geom::Width{100});
+
+    EXPECT_THAT(rasterized, ElementsAre(U'a'));
+}
+
+TEST_F(DecorationGlyphCache, skips_glyphs_that_cannot_be_rasterized)
+{
+    auto cache = make_cache(16);
+
+    auto const line = msd::lay_out_line(cache, {U'a', unrenderable, U'b'}, height, geom::Width{100});
+
+    EXPECT_THAT(pen_positions(line), ElementsAre(0, 10));
+}
+
+TEST_F(DecorationGlyphCache, text_that_exactly_fits_is_not_ellipsized)
+{
+    auto cache = make_cache(16);
+
+    auto const line = msd::lay_out_line(cache, U"abc", height, geom::Width{30});
+
+    EXPECT_THAT(pen_positions(line), ElementsAre(0, 10, 20));
+    EXPECT_THAT(rasterized, Not(Contains(ellipsis)));
+}
+
+TEST_F(DecorationGlyphCache, ellipsizes_text_that_is_too_wide)
+{
+    auto cache = make_cache(16);
+
+    // Room for two glyphs and an ellipsis (26 pixels), but not all three glyphs
+    auto const line = msd::lay_out_line(cache, U"abc", height, geom::Width{29});
+
+    ASSERT_THAT(line.size(), Eq(3u));
+    EXPECT_THAT(pen_positions(line), ElementsAre(0, 10, 20));
+    EXPECT_THAT(line[2].glyph, Eq(cache.glyph(ellipsis, height)));
+}
+
+TEST_F(DecorationGlyphCache, drops_as_many_glyphs_as_needed_to_fit_the_ellipsis)
+{
+    auto cache = make_cache(16);
+
+    auto const line = msd::lay_out_line(cache, U"abcdef", height, geom::Width{25});
+
+    ASSERT_THAT(line.size(), Eq(2u));
+    EXPECT_THAT(pen_positions(line), ElementsAre(0, 10));
+    EXPECT_THAT(line[1].glyph, Eq(cache.glyph(ellipsis, height)));
+}
+
+TEST_F(DecorationGlyphCache, omits_the_ellipsis_when_even_that_does_not_fit)
+{
+    auto cache = make_cache(16);
+
+    auto const line = msd::lay_out_line(cache, U"abc", height, geom::Width{5});
+
+    EXPECT_THAT(line, IsEmpty());
+}
+
+TEST_F(DecorationGlyphCache, truncates_without_an_ellipsis_if_the_font_lacks_one)
+{
+    auto cache = make_cache(16);
+    unrenderable = ellipsis;
+
+    auto const line = msd::lay_out_line(cache, U"abc", height, geom::Width{25});
+
+    EXPECT_THAT(pen_positions(line), ElementsAre(0, 10));
+}
@@ -0,0 +1,292 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/commit_queue.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <wayland-server-core.h>
+#include <wayland-server-protocol.h>
+
+#include "mir/test/fd_utils.h"
+
+#include <stdexcept>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace mt = mir::test;
+namespace mf = mir::frontend;
+
+using namespace testing;
+
+namespace
+{
+/// A pipe standing in for a buffer fence: the read end becomes readable once signal() is called
+struct FakeFence
+{
+    FakeFence()
+    {
+        int fds[2];
+        EXPECT_TRUE(mt::std_call_succeeded(pipe(fds)));
+        read_end = mir::Fd{fds[0]};
+        write_end = mir::Fd{fds[1]};
+    }
+
+    void signal()
+    {
+        char const c{'x'};
+        EXPECT_THAT(write(write_end, &c, 1), Eq(1));
+    }
+
+    mir::Fd read_end;
+    mir::Fd write_end;
+};
+
+/// A client of a display with no listening socket, just so we have somewhere to create resources
+struct FakeClient
+{
+    FakeClient()
+        : display{wl_display_create()}
+    {
+        int fds[2];
+        EXPECT_TRUE(mt::std_call_succeeded(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds)));
+        client = wl_client_create(display, fds[0]);
+        client_end = mir::Fd{fds[1]};
+    }
+
+    ~FakeClient()
+    {
+        wl_client_destroy(client);
+        wl_display_destroy(display);
+    }
+
+    auto create_buffer() -> wl_resource*
+    {
+        return wl_resource_create(client, &wl_buffer_interface, 1, 0);
+    }
+
+    wl_display* const display;
+    wl_client* client;
+    mir::Fd client_end;
+};
+
+class CommitQueueTest : public Test
+{
+public:
+    CommitQueueTest()
+        : the_event_loop{wl_event_loop_create()},
+          event_loop_fd{mir::IntOwnedFd{wl_event_loop_get_fd(the_event_loop)}}
+    {
+    }
+
+    ~CommitQueueTest()
+    {
+        wl_event_loop_destroy(the_event_loop);
+    }
+
+    void dispatch_pending()
+    {
+        while (mt::fd_is_readable(event_loop_fd))
+        {
+            wl_event_loop_dispatch(the_event_loop, 0);
+        }
+    }
+
+    wl_event_loop* const the_event_loop;
+    mir::Fd const event_loop_fd;
+    FakeClient client;
+};
+}
+
+TEST_F(CommitQueueTest, commit_without_fences_is_applied_immediately)
+{
+    mf::CommitQueue queue{the_event_loop, client.client};
+
+    bool applied{false};
+    queue.push({}, [&applied]() { applied = true; });
+
+    EXPECT_TRUE(applied);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(CommitQueueTest, commit_with_signalled_fence_is_applied_immediately)
+{
+    mf::CommitQueue queue{the_event_loop, client.client};
+    FakeFence fence;
+    fence.signal();
+
+    bool applied{false};
+    queue.push({fence.read_end}, [&applied]() { applied = true; });
+
+    EXPECT_TRUE(applied);
+}
+
+TEST_F(CommitQueueTest, commit_is_held_until_its_fence_signals)
+{
+    mf::CommitQueue queue{the_event_loop, client.client};
+    FakeFence fence;
+
+    bool applied{false};
+    queue.push({fence.read_end}, [&applied]() { applied = true; });
+
+    dispatch_pending();
+    EXPECT_FALSE(applied);
+    EXPECT_FALSE(queue.empty());
+
+    fence.signal();
+    dispatch_pending();
+    EXPECT_TRUE(applied);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(CommitQueueTest, later_commits_wait_for_earlier_ones)
+{
+    mf::CommitQueue queue{the_event_loop, client.client};
+    FakeFence fence;
+
+    std::vector<int> applied;
+    queue.push({fence.read_end}, [&applied]() { applied.push_back(1); });
+    queue.push({}, [&applied]() { applied.push_back(2); });
+
+    EXPECT_THAT(applied, IsEmpty());
+
+    fence.signal();
+    dispatch_pending();
+    EXPECT_THAT(applied, ElementsAre(1, 2));
+}
+
+TEST_F(CommitQueueTest, fences_are_those_of_queued_commits)
+{
+    mf::CommitQueue queue{the_event_loop, client.client};
+    FakeFence first, second;
+
+    queue.push({first.read_end}, [](){});
+    queue.push({second.read_end}, [](){});
+
+    EXPECT_THAT(queue.fences(), ElementsAre(first.read_end, second.read_end));
+
+    first.signal();
+    dispatch_pending();
+    EXPECT_THAT(queue.fences(), ElementsAre(second.read_end));
+}
+
+TEST_F(CommitQueueTest, flush_applies_commits_whose_fences_have_signalled)
+{
+    mf::CommitQueue queue{the_event_loop, client.client};
+    FakeFence fence;
+
+    bool applied{false};
+    queue.push({fence.read_end}, [&applied]() { applied = true; });
+
+    fence.signal();
+    queue.flush();
+    EXPECT_TRUE(applied);
+}
+
+TEST_F(CommitQueueTest, commit_is_given_its_buffer)
+{
+    mf::CommitQueue queue{the_event_loop, client.client};
+    FakeFence fence;
+    auto const buffer = client.create_buffer();
+
+    std::experimental::optional<wl_resource*> applied_buffer;
+    queue.push(
+        {fence.read_end},
+        buffer,
+        [&applied_buffer](std::experimental::optional<wl_resource*> buffer) { applied_buffer = buffer; });
+
+    fence.signal();
+    dispatch_pending();
+    ASSERT_TRUE(applied_buffer);
+    EXPECT_THAT(*applied_buffer, Eq(buffer));
+}
+
+TEST_F(CommitQueueTest, commit_attaches_nothing_if_its_buffer_is_destroyed_while_queued)
+{
+    mf::CommitQueue queue{the_event_loop, client.client};
+    FakeFence fence;
+    auto const buffer = client.create_buffer();
+
+    bool applied{false};
+    std::experimental::optional<wl_resource*> applied_buffer{buffer};
+    queue.push(
+        {fence.read_end},
+        buffer,
+        [&](std::experimental::optional<wl_resource*> buffer)
+        {
+            applied = true;
+            applied_buffer = buffer;
+        });
+
+    wl_resource_destroy(buffer);
+    fence.signal();
+    dispatch_pending();
+    EXPECT_TRUE(applied);
+    // Not even a null buffer, which would unmap the surface rather than leave its content as it was
+    EXPECT_FALSE(applied_buffer);
+}
+
+TEST_F(CommitQueueTest, flush_pushed_before_leaves_later_commits_queued)
+{
+    mf::CommitQueue queue{the_event_loop, client.client};
+    FakeFence fence;
+
+    std::vector<int> applied;
+    queue.push({fence.read_end}, [&applied]() { applied.push_back(1); });
+    auto const pushed = queue.pushed();
+    queue.push({}, [&applied]() { applied.push_back(2); });
+
+    fence.signal();
+    queue.flush_pushed_before(pushed);
+    EXPECT_THAT(applied, ElementsAre(1));
+    EXPECT_FALSE(queue.empty());
+
+    queue.flush();
+    EXPECT_THAT(applied, ElementsAre(1, 2));
+}
+
+TEST_F(CommitQueueTest, flush_pushed_before_still_waits_for_later_fences)
+{
+    mf::CommitQueue queue{the_event_loop, client.client};
+    FakeFence first, second;
+
+    std::vector<int> applied;
+    queue.push({first.read_end}, [&applied]() { applied.push_back(1); });
+    auto const pushed = queue.pushed();
+    queue.push({second.read_end}, [&applied]() { applied.push_back(2); });
+
+    first.signal();
+    queue.flush_pushed_before(pushed);
+    EXPECT_THAT(applied, ElementsAre(1));
+
+    second.signal();
+    dispatch_pending();
+    EXPECT_THAT(applied, ElementsAre(1, 2));
+}
+
+TEST_F(CommitQueueTest, client_is_sent_an_error_if_a_held_commit_fails)
+{
+    mf::CommitQueue queue{the_event_loop, client.client};
+    FakeFence fence;
+
+    queue.push({fence.read_end}, []() { throw std::runtime_error{"Over quota"}; });
+
+    fence.signal();
+    dispatch_pending();
+    wl_display_flush_clients(client.display);
+    EXPECT_TRUE(mt::fd_is_readable(client.client_end));
+}
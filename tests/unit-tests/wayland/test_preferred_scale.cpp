@@ -0,0 +1,68 @@
+/*
+ * Copyright © 2022 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/preferred_scale.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mf = mir::frontend;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+struct PreferredScale : Test
+{
+    geom::Rectangle const left{{0, 0}, {1920, 1080}};
+    geom::Rectangle const right{{1920, 0}, {2560, 1440}};
+    std::vector<mf::OutputScale> const outputs{{left, 1.0f}, {right, 1.25f}};
+
+    std::experimental::optional<geom::Rectangle> const unplaced;
+};
+}
+
+TEST_F(PreferredScale, unplaced_surface_gets_the_largest_output_scale)
+{
+    EXPECT_THAT(mf::preferred_scale(outputs, unplaced), Eq(150u));
+}
+
+TEST_F(PreferredScale, surface_gets_the_scale_of_the_output_it_is_on)
+{
+    EXPECT_THAT(mf::preferred_scale(outputs, geom::Rectangle{{100, 100}, {640, 480}}), Eq(120u));
+}
+
+TEST_F(PreferredScale, surface_moved_to_another_output_gets_that_outputs_scale)
+{
+    EXPECT_THAT(mf::preferred_scale(outputs, geom::Rectangle{{2000, 100}, {640, 480}}), Eq(150u));
+}
+
+TEST_F(PreferredScale, surface_spanning_outputs_gets_the_largest_of_their_scales)
+{
+    EXPECT_THAT(mf::preferred_scale(outputs, geom::Rectangle{{1600, 100}, {640, 480}}), Eq(150u));
+}
+
+TEST_F(PreferredScale, scale_is_one_without_outputs)
+{
+    EXPECT_THAT(mf::preferred_scale({}, unplaced), Eq(120u));
+    EXPECT_THAT(mf::preferred_scale({}, geom::Rectangle{{100, 100}, {640, 480}}), Eq(120u));
+}
+
+TEST_F(PreferredScale, surface_off_every_output_gets_a_scale_of_one)
+{
+    EXPECT_THAT(mf::preferred_scale(outputs, geom::Rectangle{{0, 2000}, {640, 480}}), Eq(120u));
+}